@@ -135,6 +135,8 @@ set(include_files_list
     langinfo.h
     libio.h
     linux/falloc.h
+    linux/io_uring.h
+    linux/mempolicy.h
     limits.h
     locale.h
     math.h
@@ -219,6 +221,7 @@ set(functions_list
     poll
     posix_fadvise
     pread pwrite
+    preadv pwritev
     pthread_cancel
     pthread_keycreate pthread_key_create
     pthread_mutexattr_setprotocol
@@ -113,6 +113,10 @@ static UCHAR debug_on = 0;		// able to turn this on in debug mode
 
 #ifdef HAVE_ZLIB_H
 static Firebird::InitInstance<Firebird::ZLib> zlib;
+
+// Single writer thread has to keep up with parallel readers, so prefer
+// speed to ratio. Level doesn't affect the stream format, restore is unchanged.
+static const int ZIP_COMPRESSION_LEVEL	= Z_BEST_SPEED;
 #endif // HAVE_ZLIB_H
 
 static void  bad_attribute(int, USHORT);
@@ -783,7 +787,7 @@ void MVOL_init_write(const char* file_name)
 		strm.zfree = Firebird::ZLib::freeFunc;
 		strm.opaque = Z_NULL;
 		checkCompression();
-		int ret = zlib().deflateInit(&strm, Z_DEFAULT_COMPRESSION);
+		int ret = zlib().deflateInit(&strm, ZIP_COMPRESSION_LEVEL);
 		if (ret != Z_OK)
 			BURP_error(384, true, SafeArg() << ret);
 		strm.next_out = Z_NULL;
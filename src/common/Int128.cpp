@@ -496,6 +496,18 @@ double Int128::toDouble() const
 Int128 Int128::mul(Int128 op2) const
 {
 	Int128 rc(*this);
+
+#ifdef FB_NATIVE_INT128
+	// Product of two 64-bit values always fits into 128 bits
+	const __int128 op1Native = getNative(), op2Native = op2.getNative();
+
+	if (op1Native == SINT64(op1Native) && op2Native == SINT64(op2Native))
+	{
+		rc.setNative(op1Native * op2Native);
+		return rc;
+	}
+#endif
+
 	if (rc.v.Mul(op2.v))
 		overflow();
 	return rc;
@@ -362,6 +362,11 @@ public:
 
 #include "../../extern/ttmath/ttmath.h"
 
+// Native compiler type used for the most frequent operations on 64-bit platforms
+#if defined(__SIZEOF_INT128__) && !defined(TTMATH_PLATFORM32)
+#define FB_NATIVE_INT128
+#endif
+
 namespace Firebird {
 
 class Decimal64;
@@ -408,7 +413,12 @@ public:
 
 	int compare(Int128 tgt) const
 	{
+#ifdef FB_NATIVE_INT128
+		const __int128 op1 = getNative(), op2 = tgt.getNative();
+		return op1 < op2 ? -1 : op1 > op2 ? 1 : 0;
+#else
 		return v < tgt.v ? -1 : v > tgt.v ? 1 : 0;
+#endif
 	}
 
 	Int128 operator/ (unsigned value) const
@@ -524,16 +534,30 @@ public:
 	Int128 add(Int128 op2) const
 	{
 		Int128 rc(*this);
+#ifdef FB_NATIVE_INT128
+		__int128 result;
+		if (__builtin_add_overflow(getNative(), op2.getNative(), &result))
+			overflow();
+		rc.setNative(result);
+#else
 		if (rc.v.Add(op2.v))
 			overflow();
+#endif
 		return rc;
 	}
 
 	Int128 sub(Int128 op2) const
 	{
 		Int128 rc(*this);
+#ifdef FB_NATIVE_INT128
+		__int128 result;
+		if (__builtin_sub_overflow(getNative(), op2.getNative(), &result))
+			overflow();
+		rc.setNative(result);
+#else
 		if (rc.v.Sub(op2.v))
 			overflow();
+#endif
 		return rc;
 	}
 
@@ -578,6 +602,20 @@ public:
 protected:
 	ttmath::Int<TTMATH_BITS(128)> v;
 
+#ifdef FB_NATIVE_INT128
+	__int128 getNative() const
+	{
+		__int128 rc;
+		memcpy(&rc, v.table, sizeof(rc));
+		return rc;
+	}
+
+	void setNative(__int128 value)
+	{
+		memcpy(v.table, &value, sizeof(value));
+	}
+#endif
+
 	static void overflow();
 	static void zerodivide();
 
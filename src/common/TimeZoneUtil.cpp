@@ -31,6 +31,7 @@
 #include "../common/classes/rwlock.h"
 #include "../common/classes/timestamp.h"
 #include "../common/classes/GenericMap.h"
+#include "../common/classes/locks.h"
 #include "../common/config/config.h"
 #include "../common/os/path_utils.h"
 #include "../common/os/os_utils.h"
@@ -70,9 +71,58 @@ namespace
 			return unicodeName.begin();
 		}
 
+		// Look for a cached interval between transitions containing the date
+		bool getCachedDisplacement(UDate date, SSHORT* displacement) const
+		{
+			MutexLockGuard guard(intervalsMutex, FB_FUNCTION);
+
+			for (unsigned i = 0; i < intervalsCount; ++i)
+			{
+				const Interval& interval = intervals[i];
+
+				if (date >= interval.start && date < interval.end)
+				{
+					*displacement = interval.displacement;
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void cacheDisplacement(UDate start, UDate end, SSHORT displacement) const
+		{
+			MutexLockGuard guard(intervalsMutex, FB_FUNCTION);
+
+			Interval& interval = intervals[intervalsNext];
+			interval.start = start;
+			interval.end = end;
+			interval.displacement = displacement;
+
+			intervalsNext = (intervalsNext + 1) % MAX_INTERVALS;
+
+			if (intervalsCount < MAX_INTERVALS)
+				++intervalsCount;
+		}
+
 	private:
+		struct Interval
+		{
+			UDate start;
+			UDate end;
+			SSHORT displacement;
+		};
+
+		static const unsigned MAX_INTERVALS = 16;
+
 		string asciiName;
 		Array<UChar> unicodeName;
+
+		// Recently used intervals with a constant displacement, to not call ICU for every value
+		mutable Mutex intervalsMutex;
+		mutable Interval intervals[MAX_INTERVALS];
+		mutable unsigned intervalsCount = 0;
+		mutable unsigned intervalsNext = 0;
 	};
 }
 
@@ -83,6 +133,7 @@ static inline bool isOffset(USHORT timeZone);
 static USHORT makeFromOffset(int sign, unsigned tzh, unsigned tzm);
 static inline SSHORT offsetZoneToDisplacement(USHORT timeZone);
 static inline USHORT displacementToOffsetZone(SSHORT displacement);
+static SSHORT getRegionDisplacement(USHORT timeZone, const ISC_TIMESTAMP& utcTimeStamp);
 static int parseNumber(const char*& p, const char* end);
 static void skipSpaces(const char*& p, const char* end);
 
@@ -589,36 +640,7 @@ void TimeZoneUtil::extractOffset(const ISC_TIMESTAMP_TZ& timeStampTz, SSHORT* of
 	else if (isOffset(timeStampTz.time_zone))
 		displacement = offsetZoneToDisplacement(timeStampTz.time_zone);
 	else
-	{
-		UErrorCode icuErrorCode = U_ZERO_ERROR;
-
-		Jrd::UnicodeUtil::ConversionICU& icuLib = Jrd::UnicodeUtil::getConversionICU();
-
-		UCalendar* icuCalendar = icuLib.ucalOpen(
-			getDesc(timeStampTz.time_zone)->getUnicodeName(), -1, NULL, UCAL_GREGORIAN, &icuErrorCode);
-
-		if (!icuCalendar)
-			status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_open.");
-
-		icuLib.ucalSetMillis(icuCalendar, timeStampToIcuDate(timeStampTz.utc_timestamp), &icuErrorCode);
-
-		if (U_FAILURE(icuErrorCode))
-		{
-			icuLib.ucalClose(icuCalendar);
-			status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_setMillis.");
-		}
-
-		displacement = (icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
-			icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode)) / U_MILLIS_PER_MINUTE;
-
-		if (U_FAILURE(icuErrorCode))
-		{
-			icuLib.ucalClose(icuCalendar);
-			status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_get.");
-		}
-
-		icuLib.ucalClose(icuCalendar);
-	}
+		displacement = getRegionDisplacement(timeStampTz.time_zone, timeStampTz.utc_timestamp);
 
 	*offset = displacement;
 }
@@ -748,40 +770,13 @@ bool TimeZoneUtil::decodeTimeStamp(const ISC_TIMESTAMP_TZ& timeStampTz, bool gmt
 		displacement = offsetZoneToDisplacement(timeStampTz.time_zone);
 	else
 	{
-		UErrorCode icuErrorCode = U_ZERO_ERROR;
-
 		try
 		{
 #ifdef DEV_BUILD
 			if (gmtFallback && getenv("MISSING_ICU_EMULATION"))
 				(Arg::Gds(isc_random) << "Emulating missing ICU").raise();
 #endif
-			Jrd::UnicodeUtil::ConversionICU& icuLib = Jrd::UnicodeUtil::getConversionICU();
-
-			UCalendar* icuCalendar = icuLib.ucalOpen(
-				getDesc(timeStampTz.time_zone)->getUnicodeName(), -1, NULL, UCAL_GREGORIAN, &icuErrorCode);
-
-			if (!icuCalendar)
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_open.");
-
-			icuLib.ucalSetMillis(icuCalendar, timeStampToIcuDate(timeStampTz.utc_timestamp), &icuErrorCode);
-
-			if (U_FAILURE(icuErrorCode))
-			{
-				icuLib.ucalClose(icuCalendar);
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_setMillis.");
-			}
-
-			displacement = (icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
-				icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode)) / U_MILLIS_PER_MINUTE;
-
-			if (U_FAILURE(icuErrorCode))
-			{
-				icuLib.ucalClose(icuCalendar);
-				status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_get.");
-			}
-
-			icuLib.ucalClose(icuCalendar);
+			displacement = getRegionDisplacement(timeStampTz.time_zone, timeStampTz.utc_timestamp);
 		}
 		catch (const Exception&)
 		{
@@ -1147,6 +1142,70 @@ static const TimeZoneDesc* getDesc(USHORT timeZone)
 	return nullptr;
 }
 
+// Returns the displacement (+- minutes) of a region-based time zone at an UTC timestamp.
+static SSHORT getRegionDisplacement(USHORT timeZone, const ISC_TIMESTAMP& utcTimeStamp)
+{
+	const TimeZoneDesc* const desc = getDesc(timeZone);
+	const UDate icuDate = TimeZoneUtil::timeStampToIcuDate(utcTimeStamp);
+
+	SSHORT displacement;
+
+	if (desc->getCachedDisplacement(icuDate, &displacement))
+		return displacement;
+
+	UErrorCode icuErrorCode = U_ZERO_ERROR;
+
+	Jrd::UnicodeUtil::ConversionICU& icuLib = Jrd::UnicodeUtil::getConversionICU();
+
+	UCalendar* icuCalendar = icuLib.ucalOpen(desc->getUnicodeName(), -1, NULL, UCAL_GREGORIAN, &icuErrorCode);
+
+	if (!icuCalendar)
+		status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_open.");
+
+	icuLib.ucalSetMillis(icuCalendar, icuDate, &icuErrorCode);
+
+	if (U_FAILURE(icuErrorCode))
+	{
+		icuLib.ucalClose(icuCalendar);
+		status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_setMillis.");
+	}
+
+	displacement = (icuLib.ucalGet(icuCalendar, UCAL_ZONE_OFFSET, &icuErrorCode) +
+		icuLib.ucalGet(icuCalendar, UCAL_DST_OFFSET, &icuErrorCode)) / U_MILLIS_PER_MINUTE;
+
+	if (U_FAILURE(icuErrorCode))
+	{
+		icuLib.ucalClose(icuCalendar);
+		status_exception::raise(Arg::Gds(isc_random) << "Error calling ICU's ucal_get.");
+	}
+
+	// The displacement is constant between the surrounding transitions, remember it.
+	// If ICU could not tell the transitions, just don't cache.
+
+	UDate start = MIN_ICU_TIMESTAMP, end = MAX_ICU_TIMESTAMP;
+
+	UBool hasStart = icuLib.ucalGetTimeZoneTransitionDate(icuCalendar, UCAL_TZ_TRANSITION_PREVIOUS_INCLUSIVE,
+		&start, &icuErrorCode);
+
+	UBool hasEnd = U_SUCCESS(icuErrorCode) &&
+		icuLib.ucalGetTimeZoneTransitionDate(icuCalendar, UCAL_TZ_TRANSITION_NEXT, &end, &icuErrorCode);
+
+	if (U_SUCCESS(icuErrorCode))
+	{
+		if (!hasStart)
+			start = MIN_ICU_TIMESTAMP;
+
+		if (!hasEnd)
+			end = MAX_ICU_TIMESTAMP + 1;
+
+		desc->cacheDisplacement(start, end, displacement);
+	}
+
+	icuLib.ucalClose(icuCalendar);
+
+	return displacement;
+}
+
 // Returns true if the time zone is offset-based or false if region-based.
 static inline bool isOffset(USHORT timeZone)
 {
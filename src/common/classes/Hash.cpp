@@ -73,6 +73,36 @@ namespace
 		return hash_value;
 	}
 
+	class Crc32CTable
+	{
+	public:
+		Crc32CTable()
+		{
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int value = i;
+
+				for (int bit = 0; bit < 8; bit++)
+					value = (value >> 1) ^ ((value & 1) ? 0x82F63B78 : 0);
+
+				table[i] = value;
+			}
+		}
+
+		unsigned int table[256];
+	};
+
+	unsigned int softCrc32C(unsigned int length, const UCHAR* value)
+	{
+		static const Crc32CTable crcTable;
+		unsigned int hash_value = 0;
+
+		for (const UCHAR* const end = value + length; value < end; value++)
+			hash_value = crcTable.table[(hash_value ^ *value) & 0xFF] ^ (hash_value >> 8);
+
+		return hash_value;
+	}
+
 #if defined(_M_IX86) || defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
 
 	bool SSE4_2Supported()
@@ -96,10 +126,12 @@ namespace
 	}
 
 	hash_func_t internalHash = SSE4_2Supported() ? CRC32C : basicHash;
+	hash_func_t crc32cHash = SSE4_2Supported() ? CRC32C : softCrc32C;
 
 #else	// architecture check
 
 	hash_func_t internalHash = basicHash;
+	hash_func_t crc32cHash = softCrc32C;
 
 #endif	// architecture check
 
@@ -110,6 +142,11 @@ unsigned int InternalHash::hash(unsigned int length, const UCHAR* value)
 	return internalHash(length, value);
 }
 
+unsigned int Crc32C::hash(unsigned int length, const UCHAR* value)
+{
+	return crc32cHash(length, value);
+}
+
 
 void WeakHashContext::update(const void* data, FB_SIZE_T length)
 {
@@ -343,6 +343,15 @@ namespace Firebird
 		}
 	};
 
+	// CRC-32C (Castagnoli polynomial, zero initial value, no final inversion).
+	// Unlike InternalHash it's the same on every platform, so it may be stored on disk.
+
+	class Crc32C
+	{
+	public:
+		static unsigned int hash(unsigned int length, const UCHAR* value);
+	};
+
 	class HashContext
 	{
 	public:
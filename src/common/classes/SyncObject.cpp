@@ -36,11 +36,44 @@
 #include "SyncObject.h"
 #include "Synchronize.h"
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#ifndef WIN_NT
+#include <unistd.h>
+#endif
+
 namespace Firebird {
 
 static const int WRITER_INCR	= 0x00010000L;
 static const int READERS_MASK	= 0x0000FFFFL;
 
+static inline void spinPause()
+{
+#if (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))) || defined(__i386__) || defined(__x86_64__)
+	_mm_pause();
+#endif
+}
+
+static bool multiProcessor()
+{
+	static const bool result = []
+	{
+#ifdef WIN_NT
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwNumberOfProcessors > 1;
+#else
+		return sysconf(_SC_NPROCESSORS_ONLN) > 1;
+#endif
+	}();
+
+	return result;
+}
+
 bool SyncObject::lock(Sync* sync, SyncType type, const char* from, int timeOut)
 {
 	ThreadSync* thread = NULL;
@@ -69,6 +102,15 @@ bool SyncObject::lock(Sync* sync, SyncType type, const char* from, int timeOut)
 		if (timeOut == 0)
 			return false;
 
+		if (spin(type, NULL))
+		{
+#ifdef DEV_BUILD
+			MutexLockGuard g(mutex, FB_FUNCTION);
+			reason(from);
+#endif
+			return true;
+		}
+
 		mutex.enter(FB_FUNCTION);
 		++waiters;
 
@@ -125,6 +167,15 @@ bool SyncObject::lock(Sync* sync, SyncType type, const char* from, int timeOut)
 		if (timeOut == 0)
 			return false;
 
+		if (spin(type, thread))
+		{
+#ifdef DEV_BUILD
+			MutexLockGuard g(mutex, FB_FUNCTION);
+#endif
+			reason(from);
+			return true;
+		}
+
 		mutex.enter(FB_FUNCTION);
 		waiters += WRITER_INCR;
 
@@ -262,6 +313,50 @@ void SyncObject::downgrade(SyncType type)
 	}
 }
 
+bool SyncObject::spin(SyncType type, ThreadSync* thread)
+{
+	// Busy wait for a short while before queueing and sleeping, most latches are
+	// held for a very short time. The spin limit adapts to the observed hold time:
+	// it's set to twice the number of iterations the last successful spin took and
+	// halved when the lock was not released in time. Spinning is useless on a single
+	// CPU and is not done when other threads are queued already (fair locking).
+
+	if (!multiProcessor())
+		return false;
+
+	const int limit = spinLimit;
+
+	for (int i = 0; i < limit; i++)
+	{
+		if (waiters)
+			return false;
+
+		spinPause();
+
+		const AtomicCounter::counter_type oldState = lockState;
+
+		if (type == SYNC_SHARED)
+		{
+			if (oldState < 0 || !lockState.compareExchange(oldState, oldState + 1))
+				continue;
+		}
+		else
+		{
+			if (oldState != 0 || !lockState.compareExchange(0, -1))
+				continue;
+
+			exclusiveThread = thread;
+		}
+
+		WaitForFlushCache();
+		spinLimit = MAX(SPIN_MIN, MIN(SPIN_MAX, 2 * (i + 1)));
+		return true;
+	}
+
+	spinLimit = MAX(SPIN_MIN, limit / 2);
+	return false;
+}
+
 bool SyncObject::wait(SyncType type, ThreadSync* thread, Sync* sync, int timeOut)
 {
 	if (thread->nextWaiting)
@@ -55,6 +55,7 @@ public:
 	SyncObject()
 		: waiters(0),
 		  monitorCount(0),
+		  spinLimit(SPIN_INITIAL),
 		  exclusiveThread(NULL),
 		  waitingThreads(NULL)
 	{
@@ -114,6 +115,12 @@ public:
 	bool ourExclusiveLock() const;
 
 protected:
+	// Bounds of the adaptive spin before a thread is put asleep
+	static const int SPIN_MIN = 16;
+	static const int SPIN_INITIAL = 64;
+	static const int SPIN_MAX = 2048;
+
+	bool spin(SyncType type, ThreadSync* thread);
 	bool wait(SyncType type, ThreadSync* thread, Sync* sync, int timeOut);
 	ThreadSync* dequeThread(ThreadSync* thread);
 	ThreadSync* grantThread(ThreadSync* thread);
@@ -123,6 +130,7 @@ protected:
 	AtomicCounter lockState;
 	AtomicCounter waiters;
 	int monitorCount;
+	int spinLimit;
 	Mutex mutex;
 	ThreadSync* volatile exclusiveThread;
 	ThreadSync* volatile waitingThreads;
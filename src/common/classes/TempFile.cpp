@@ -382,6 +382,20 @@ FB_SIZE_T TempFile::write(offset_t offset, const void* buffer, FB_SIZE_T length)
 	return bytes;
 }
 
+//
+// TempFile::prefetch
+//
+// Asks OS to read bytes into its cache in background
+//
+
+void TempFile::prefetch(offset_t offset, FB_SIZE_T length)
+{
+	fb_assert(offset + length <= size);
+#if defined(HAVE_POSIX_FADVISE) && defined(POSIX_FADV_WILLNEED)
+	os_utils::posix_fadvise(handle, offset, length, POSIX_FADV_WILLNEED);
+#endif
+}
+
 //
 // TempFile::unlink
 //
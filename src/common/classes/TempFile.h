@@ -51,6 +51,7 @@ public:
 	FB_SIZE_T read(offset_t, void*, FB_SIZE_T);
 	FB_SIZE_T write(offset_t, const void*, FB_SIZE_T);
 
+	void prefetch(offset_t, FB_SIZE_T);
 	void unlink();
 
 	offset_t getSize() const
@@ -94,6 +94,11 @@ static void* stopAddress = (void*) 0x2254938;
 #define MEM_DEBUG
 #endif
 
+// Debug builds track every block in the pool itself
+#if !defined(MEM_DEBUG) && !defined(USE_VALGRIND) && !defined(VALIDATE_POOL)
+#define USE_SMALL_BLOCK_CACHE
+#endif
+
 #ifdef MEM_DEBUG
 static const int GUARD_BYTES	= ALLOC_ALIGNMENT; // * 2048;
 static const UCHAR INIT_BYTE	= 0xCC;
@@ -1720,6 +1725,49 @@ private:
 };
 
 
+#ifdef USE_SMALL_BLOCK_CACHE
+
+// Free small blocks cached outside of the pool mutex. The cache is split into
+// stripes selected by the current thread, so threads working with the same pool
+// rarely meet at the same stripe. Blocks are moved between a stripe and the pool
+// in batches. The cache is created only when the pool mutex is found contended.
+
+class SmallBlockCache
+{
+public:
+	static const unsigned STRIPES = 8;
+	static const unsigned BATCH = 16;			// blocks moved from / to the pool at once
+
+	struct Stripe
+	{
+		Stripe()
+		{
+			memset(blocks, 0, sizeof(blocks));
+			memset(counts, 0, sizeof(counts));
+		}
+
+		Mutex mutex;
+		MemBlock* blocks[LowLimits::TOTAL_ELEMENTS];
+		unsigned counts[LowLimits::TOTAL_ELEMENTS];
+	};
+
+	Stripe& getStripe()
+	{
+#ifdef WIN_NT
+		const U_IPTR id = GetCurrentThreadId();
+#else
+		const U_IPTR id = (U_IPTR) pthread_self();
+#endif
+		return stripes[(id ^ (id >> 12)) % STRIPES];
+	}
+
+private:
+	Stripe stripes[STRIPES];
+};
+
+#endif // USE_SMALL_BLOCK_CACHE
+
+
 // Implementation of memory pool
 
 class MemPool
@@ -1760,6 +1808,17 @@ private:
 	int				blocksActive;
 	bool			pool_destroying, parent_redirect;
 
+#ifdef USE_SMALL_BLOCK_CACHE
+	// Number of times the pool mutex was found busy after which the cache is created
+	static const unsigned CONTENTION_THRESHOLD = 64;
+
+	std::atomic<SmallBlockCache*> smallCache;
+	unsigned contentions;
+
+	MemBlock* allocCached(SmallBlockCache* cache, size_t& length);
+	void releaseCached(SmallBlockCache* cache, MemBlock* block) noexcept;
+#endif
+
 	MemoryStats* stats;	// Statistics group for the pool
 	MemPool* parent;	// Parent pool if present
 	ExtentsCache* extentsCache;
@@ -2117,6 +2176,11 @@ void MemPool::initialize()
 	blocksAllocated = 0;
 	blocksActive = 0;
 
+#ifdef USE_SMALL_BLOCK_CACHE
+	smallCache = NULL;
+	contentions = 0;
+#endif
+
 #ifdef USE_VALGRIND
 	delayedFreeCount = 0;
 	delayedFreePos = 0;
@@ -2143,6 +2207,12 @@ MemPool::~MemPool(void)
 {
 	pool_destroying = true;
 
+#ifdef USE_SMALL_BLOCK_CACHE
+	// Cached blocks and the cache itself live in the pool extents, just destroy mutexes
+	if (SmallBlockCache* cache = smallCache.load())
+		cache->~SmallBlockCache();
+#endif
+
 	decrement_usage(used_memory.value());
 	decrement_mapping(mapped_memory.value());
 
@@ -2274,10 +2344,107 @@ void MemoryPool::setStatsGroup(MemoryStats& newStats) noexcept
 	pool->setStatsGroup(newStats);
 }
 
+#ifdef USE_SMALL_BLOCK_CACHE
+MemBlock* MemPool::allocCached(SmallBlockCache* cache, size_t& length)
+{
+	const unsigned slot = LowLimits::getSlot(length + LinkedList::MEM_OVERHEAD, SLOT_ALLOC);
+	SmallBlockCache::Stripe& stripe = cache->getStripe();
+
+	MutexLockGuard guard(stripe.mutex, "MemPool::allocCached");
+
+	MemBlock* block = stripe.blocks[slot];
+
+	if (block)
+	{
+		stripe.blocks[slot] = block->next;
+		stripe.counts[slot]--;
+	}
+	else
+	{
+		// Refill the stripe with a batch of blocks taken from the pool
+
+		MutexLockGuard poolGuard(mutex, "MemPool::allocCached");
+
+		for (unsigned n = 0; n < SmallBlockCache::BATCH; n++)
+		{
+			size_t size = length;
+			MemBlock* const blk = smallObjects.allocateBlock(this, 0, size);
+			fb_assert(blk && LowLimits::getSlot(size + LinkedList::MEM_OVERHEAD, SLOT_ALLOC) == slot);
+
+			++blocksAllocated;
+			++blocksActive;
+
+			if (!block)
+			{
+				block = blk;
+				continue;
+			}
+
+			blk->next = stripe.blocks[slot];
+			stripe.blocks[slot] = blk;
+			stripe.counts[slot]++;
+		}
+	}
+
+	length = LowLimits::getSize(slot) - LinkedList::MEM_OVERHEAD;
+	return block;
+}
+
+void MemPool::releaseCached(SmallBlockCache* cache, MemBlock* block) noexcept
+{
+	const unsigned slot = LowLimits::getSlot(block->getSize(), SLOT_ALLOC);
+	SmallBlockCache::Stripe& stripe = cache->getStripe();
+
+	MutexLockGuard guard(stripe.mutex, "MemPool::releaseCached");
+
+	block->next = stripe.blocks[slot];
+	stripe.blocks[slot] = block;
+
+	if (++stripe.counts[slot] < 2 * SmallBlockCache::BATCH)
+		return;
+
+	// Too many free blocks in the stripe, return a batch of them to the pool
+
+	MutexLockGuard poolGuard(mutex, "MemPool::releaseCached");
+
+	for (unsigned n = 0; n < SmallBlockCache::BATCH; n++)
+	{
+		MemBlock* const blk = stripe.blocks[slot];
+		stripe.blocks[slot] = blk->next;
+		stripe.counts[slot]--;
+
+		--blocksActive;
+		smallObjects.deallocateBlock(blk);
+	}
+}
+#endif // USE_SMALL_BLOCK_CACHE
+
 MemBlock* MemPool::alloc(size_t from, size_t& length, bool flagRedirect)
 {
+#ifdef USE_SMALL_BLOCK_CACHE
+	SmallBlockCache* const cache = smallCache.load(std::memory_order_acquire);
+	if (cache && !from && length + LinkedList::MEM_OVERHEAD <= LowLimits::TOP_LIMIT)
+		return allocCached(cache, length);
+#endif
+
 	MutexEnsureUnlock guard(mutex, "MemPool::alloc");
+
+#ifdef USE_SMALL_BLOCK_CACHE
+	if (!guard.tryEnter())
+	{
+		guard.enter();
+
+		if (++contentions == CONTENTION_THRESHOLD && !smallCache.load())
+		{
+			// The cache is placed into the pool memory and is never released separately
+			size_t size = sizeof(SmallBlockCache);
+			MemBlock* const blk = mediumObjects.allocateBlock(this, 0, size);
+			smallCache.store(new(&blk->body) SmallBlockCache, std::memory_order_release);
+		}
+	}
+#else
 	guard.enter();
+#endif
 
 	++blocksAllocated;
 	++blocksActive;
@@ -2457,6 +2624,19 @@ void MemPool::releaseBlock(MemBlock* block, bool decrUsage) noexcept
 
 	const size_t length = block->getSize();
 
+#ifdef USE_SMALL_BLOCK_CACHE
+	// Small blocks are never redirected to the parent, see alloc()
+	SmallBlockCache* const cache = smallCache.load(std::memory_order_acquire);
+	if (cache && length <= LowLimits::TOP_LIMIT)
+	{
+		if (decrUsage)
+			decrement_usage(length);
+
+		releaseCached(cache, block);
+		return;
+	}
+#endif
+
 	MutexEnsureUnlock guard(mutex, "MemPool::releaseBlock");
 	guard.enter();
 	--blocksActive;
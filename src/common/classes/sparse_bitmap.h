@@ -228,6 +228,27 @@ protected:
 	typedef BePlusTree<Bucket, T, MemoryPool, Bucket> BitmapTree;
 	typedef typename BitmapTree::Accessor BitmapTreeAccessor;
 
+	// Position of the lowest set bit, bits must not be zero
+	static unsigned lowestBit(BUNCH_T bits)
+	{
+		fb_assert(bits);
+#ifdef __GNUC__
+		return (unsigned) __builtin_ctzll(bits);
+#else
+		unsigned bit = 0;
+		for (unsigned shift = BUNCH_BITS / 2; shift; shift /= 2)
+		{
+			const BUNCH_T mask = (BUNCH_ONE << shift) - 1;
+			if (!(bits & mask))
+			{
+				bits >>= shift;
+				bit += shift;
+			}
+		}
+		return bit;
+#endif
+	}
+
 	// Set if bitmap contains a single value only
 	bool singular;
 	T singular_value;
@@ -424,18 +445,14 @@ public:
 				return false;
 
 			const BUNCH_T tree_bits = treeAccessor.current().bits;
-			bit_mask = BUNCH_ONE;
-			current_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & bit_mask)
-					return true;
-				bit_mask <<= 1;
-				current_value++;
-			} while (bit_mask);
 
 			// Bucket must contain one bit at least
-			fb_assert(false);
-			return false;
+			fb_assert(tree_bits);
+
+			const unsigned bit = lowestBit(tree_bits);
+			bit_mask = BUNCH_ONE << bit;
+			current_value = treeAccessor.current().start_value + bit;
+			return true;
 		}
 
 		// If method returns false it means list is empty and
@@ -476,49 +493,24 @@ public:
 			if (bitmap->singular)
 				return false;
 
-			// Use temporaries to avoid corrupting position if there is no next item in bitmap
-			BUNCH_T try_mask = bit_mask;
-			T try_value = current_value;
-
-			// Proceed to next value
-			try_mask <<= 1;
-			try_value++;
+			// Bits of the current bucket above the current position
+			BUNCH_T tree_bits = treeAccessor.current().bits & ~(bit_mask | (bit_mask - 1));
 
-			// Scan bucket forwards looking for a match
-			BUNCH_T tree_bits = treeAccessor.current().bits;
-			while (try_mask)
+			if (!tree_bits)
 			{
-				if (tree_bits & try_mask)
-				{
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask <<= 1;
-				try_value++;
-			}
+				// No match in this bucket, take the next one
+				// (there should be at least one bit set for a bucket)
+				if (!treeAccessor.getNext())
+					return false;
 
-			// We scanned bucket, but found no match.
-			// No problem, scan the next bucket (there should be at least one bit set for a bucket)
-			if (!treeAccessor.getNext())
-				return false;
-
-			tree_bits = treeAccessor.current().bits;
-			try_mask = BUNCH_ONE;
-			try_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & try_mask) {
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask <<= 1;
-				try_value++;
-			} while (try_mask);
+				tree_bits = treeAccessor.current().bits;
+				fb_assert(tree_bits);
+			}
 
-			// Bucket must contain one bit at least
-			fb_assert(false);
-			return false; // Absence of this statement makes GCC 3.4 generate wrong code here
+			const unsigned bit = lowestBit(tree_bits);
+			bit_mask = BUNCH_ONE << bit;
+			current_value = treeAccessor.current().start_value + bit;
+			return true;
 		}
 
 		// Accessor position must be establised via successful call to getFirst(),
@@ -0,0 +1,140 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/alloc.h"
+#include "../common/classes/tree.h"
+#include "../common/utils_proto.h"
+#include <thread>
+#include <vector>
+
+using namespace Firebird;
+
+// Micro-benchmarks of core data structures. They are disabled by default and
+// may be run explicitly, e.g. "common_test --run_test=CommonSuite/BenchmarkSuite".
+// Datasets are generated from a fixed seed, so runs are comparable.
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(BenchmarkSuite, * boost::unit_test::disabled())
+
+
+namespace
+{
+	class Timer
+	{
+	public:
+		Timer()
+			: start(fb_utils::query_performance_counter())
+		{}
+
+		double msec() const
+		{
+			return double(fb_utils::query_performance_counter() - start) * 1000 /
+				fb_utils::query_performance_frequency();
+		}
+
+	private:
+		const SINT64 start;
+	};
+
+	// Simple LCG, we need the same sequence on every platform and run
+	class Random
+	{
+	public:
+		explicit Random(ULONG seed)
+			: state(seed)
+		{}
+
+		ULONG next()
+		{
+			state = state * 1103515245 + 12345;
+			return state >> 1;
+		}
+
+	private:
+		ULONG state;
+	};
+
+	const unsigned TREE_ITEMS = 1000000;
+	const unsigned ALLOCS_PER_THREAD = 1000000;
+	const unsigned THREAD_COUNTS[] = {1, 2, 4, 8};
+}
+
+
+BOOST_AUTO_TEST_CASE(BePlusTreeBenchmark)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	BePlusTree<ULONG, ULONG, MemoryPool> tree(pool);
+	Random random(1);
+
+	Timer addTimer;
+
+	for (unsigned i = 0; i < TREE_ITEMS; i++)
+		tree.add(random.next());
+
+	const double addTime = addTimer.msec();
+
+	Random lookup(1);
+	unsigned found = 0;
+
+	Timer locateTimer;
+
+	for (unsigned i = 0; i < TREE_ITEMS; i++)
+	{
+		if (tree.locate(lookup.next()))
+			found++;
+	}
+
+	const double locateTime = locateTimer.msec();
+
+	BOOST_TEST(found == TREE_ITEMS);
+	BOOST_TEST_MESSAGE("BePlusTree: " << TREE_ITEMS << " adds " << addTime << " ms, " <<
+		TREE_ITEMS << " locates " << locateTime << " ms");
+}
+
+BOOST_AUTO_TEST_CASE(MemoryPoolContentionBenchmark)
+{
+	for (const auto threadCount : THREAD_COUNTS)
+	{
+		MemoryPool* const pool = MemoryPool::createPool();
+
+		Timer timer;
+
+		std::vector<std::thread> threads;
+
+		for (unsigned n = 0; n < threadCount; n++)
+		{
+			threads.emplace_back([pool, n]()
+			{
+				Random random(n + 1);
+				void* blocks[16] = {};
+
+				for (unsigned i = 0; i < ALLOCS_PER_THREAD; i++)
+				{
+					auto& block = blocks[i % FB_NELEM(blocks)];
+
+					if (block)
+						pool->deallocate(block);
+
+					block = pool->allocate(16 + random.next() % 512 ALLOC_ARGS);
+				}
+
+				for (const auto block : blocks)
+					pool->deallocate(block);
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		const double time = timer.msec();
+
+		MemoryPool::deletePool(pool);
+
+		BOOST_TEST_MESSAGE("MemoryPool: " << threadCount << " thread(s), " <<
+			threadCount * ALLOCS_PER_THREAD << " allocations " << time << " ms");
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BenchmarkSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
@@ -0,0 +1,30 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/Hash.h"
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(HashSuite)
+
+
+BOOST_AUTO_TEST_CASE(Crc32CTest)
+{
+	const UCHAR digits[] = "123456789";
+	BOOST_TEST(Crc32C::hash(9, digits) == 0x58E3FA20u);
+	BOOST_TEST(Crc32C::hash(1, (const UCHAR*) "a") == 0x93AD1061u);
+	BOOST_TEST(Crc32C::hash(2, (const UCHAR*) "ab") == 0x13C35EE4u);
+
+	UCHAR buffer[256 * 4 + 3];
+
+	for (unsigned i = 0; i < 256 * 4; i++)
+		buffer[i] = (UCHAR) i;
+
+	memcpy(buffer + 256 * 4, "xyz", 3);
+
+	BOOST_TEST(Crc32C::hash(sizeof(buffer), buffer) == 0x4AB3453Eu);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()	// HashSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
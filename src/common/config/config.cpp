@@ -141,6 +141,9 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	DbCachePolicyLRU	= "LRU";
+const char*	DbCachePolicy2Q		= "2Q";
+
 ConfigValue Config::defaults[MAX_CONFIG_KEY];
 
 /******************************************************************************
@@ -365,6 +368,28 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_DB_CACHE_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString cachePolicy(strVal);
+		if (cachePolicy != DbCachePolicyLRU && cachePolicy != DbCachePolicy2Q)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_DB_CACHE_POLICY] = defaults[KEY_DB_CACHE_POLICY];
+		}
+	}
+
+	strVal = values[KEY_DB_CACHE_NUMA].strVal;
+	if (strVal)
+	{
+		NoCaseString numaMode(strVal);
+		if (numaMode != "NONE" && numaMode != "INTERLEAVE" && numaMode != "LOCAL")
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_DB_CACHE_NUMA] = defaults[KEY_DB_CACHE_NUMA];
+		}
+	}
+
 	strVal = values[KEY_WIRE_CRYPT].strVal;
 	if (strVal)
 	{
@@ -418,6 +443,33 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_MAX_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_DB_CACHE_PARTITIONS, 1, true);
+	checkIntForHiBound(KEY_DB_CACHE_PARTITIONS, 1024, true);
+
+	checkIntForLoBound(KEY_READ_AHEAD_PAGES, 0, true);
+	checkIntForHiBound(KEY_READ_AHEAD_PAGES, 256, false);
+
+	checkIntForLoBound(KEY_WRITE_COALESCE_PAGES, 1, true);
+	checkIntForHiBound(KEY_WRITE_COALESCE_PAGES, 256, false);
+
+	checkIntForLoBound(KEY_CACHE_WRITERS, 1, true);
+	checkIntForHiBound(KEY_CACHE_WRITERS, 64, false);
+
+	checkIntForLoBound(KEY_INDEX_STATISTICS_SAMPLING, 1, true);
+	checkIntForHiBound(KEY_INDEX_STATISTICS_SAMPLING, 100, true);
+
+	checkIntForLoBound(KEY_RANGE_SUMMARY_PAGES, 0, true);
+	checkIntForHiBound(KEY_RANGE_SUMMARY_PAGES, 65536, true);
+
+	checkIntForLoBound(KEY_INDEX_PROBE_SLOTS, 0, true);
+	checkIntForHiBound(KEY_INDEX_PROBE_SLOTS, 16777216, true);
+
+	checkIntForLoBound(KEY_GC_WORKERS, 1, true);
+	checkIntForHiBound(KEY_GC_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_WIRE_COMPRESSION_LEVEL, -1, true);
+	checkIntForHiBound(KEY_WIRE_COMPRESSION_LEVEL, 9, true);
 }
 
 
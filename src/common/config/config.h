@@ -78,6 +78,9 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	DbCachePolicyLRU;
+extern const char*	DbCachePolicy2Q;
+
 const int WIRE_CRYPT_DISABLED = 0;
 const int WIRE_CRYPT_ENABLED = 1;
 const int WIRE_CRYPT_REQUIRED = 2;
@@ -192,6 +195,30 @@ enum ConfigKey
 	KEY_MAX_STATEMENT_CACHE_SIZE,
 	KEY_PARALLEL_WORKERS,
 	KEY_MAX_PARALLEL_WORKERS,
+	KEY_DB_CACHE_PARTITIONS,
+	KEY_READ_AHEAD_PAGES,
+	KEY_USE_IO_URING,
+	KEY_WRITE_COALESCE_PAGES,
+	KEY_DB_CACHE_WARMUP,
+	KEY_DB_CACHE_POLICY,
+	KEY_DB_CACHE_NUMA,
+	KEY_USE_HUGE_PAGES,
+	KEY_CACHE_WRITERS,
+	KEY_TEMP_COMPRESSION,
+	KEY_INDEX_STATISTICS_SAMPLING,
+	KEY_RANGE_SUMMARY_PAGES,
+	KEY_INDEX_PROBE_SLOTS,
+	KEY_DEFERRED_INDEX_GC,
+	KEY_LZ_RECORD_COMPRESSION,
+	KEY_BLOB_COMPRESSION,
+	KEY_PAGE_CHECKSUMS,
+	KEY_GC_WORKERS,
+	KEY_WIRE_COMPRESSION_LEVEL,
+	KEY_SLOW_STATEMENT_LOG,
+	KEY_SEQUENCE_CACHE,
+	KEY_IDLE_COMPACT_TIMEOUT,
+	KEY_SWEEP_PAGE_RATE,
+	KEY_MAX_DB_CACHE_PAGES,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -310,7 +337,31 @@ constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_STRING,	"TempTableDirectory",		false,	""},
 	{TYPE_INTEGER,	"MaxStatementCacheSize",	false,	2 * 1048576},	// bytes
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
-	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1}
+	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
+	{TYPE_INTEGER,	"DbCachePartitions",		false,	1},
+	{TYPE_INTEGER,	"ReadAheadPages",			false,	0},
+	{TYPE_BOOLEAN,	"UseIoUring",				false,	false},
+	{TYPE_INTEGER,	"WriteCoalescePages",		false,	16},
+	{TYPE_BOOLEAN,	"DbCacheWarmup",			false,	false},
+	{TYPE_STRING,	"DbCachePolicy",			false,	"LRU"},
+	{TYPE_STRING,	"DbCacheNuma",				false,	"none"},
+	{TYPE_BOOLEAN,	"UseHugePages",				true,	false},
+	{TYPE_INTEGER,	"CacheWriters",				false,	1},
+	{TYPE_BOOLEAN,	"TempCompression",			false,	false},
+	{TYPE_INTEGER,	"IndexStatisticsSampling",	false,	100},
+	{TYPE_INTEGER,	"RangeSummaryPages",		false,	0},
+	{TYPE_INTEGER,	"IndexProbeSlots",			false,	0},
+	{TYPE_BOOLEAN,	"DeferredIndexGC",			false,	false},
+	{TYPE_BOOLEAN,	"LZRecordCompression",		false,	false},
+	{TYPE_BOOLEAN,	"BlobCompression",			false,	false},
+	{TYPE_BOOLEAN,	"PageChecksums",			false,	false},
+	{TYPE_INTEGER,	"GCWorkers",				false,	1},
+	{TYPE_INTEGER,	"WireCompressionLevel",		false,	-1},
+	{TYPE_INTEGER,	"SlowStatementLog",			false,	0},
+	{TYPE_INTEGER,	"SequenceCache",			false,	0},
+	{TYPE_INTEGER,	"IdleCompactTimeout",		false,	0},
+	{TYPE_INTEGER,	"SweepPageRate",			false,	0},
+	{TYPE_INTEGER,	"MaxDbCachePages",			false,	0}
 };
 
 
@@ -638,6 +689,54 @@ public:
 	CONFIG_GET_GLOBAL_INT(getParallelWorkers, KEY_PARALLEL_WORKERS);
 
 	CONFIG_GET_GLOBAL_INT(getMaxParallelWorkers, KEY_MAX_PARALLEL_WORKERS);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getDbCachePartitions, KEY_DB_CACHE_PARTITIONS, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getReadAheadPages, KEY_READ_AHEAD_PAGES, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getUseIoUring, KEY_USE_IO_URING);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getWriteCoalescePages, KEY_WRITE_COALESCE_PAGES, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getDbCacheWarmup, KEY_DB_CACHE_WARMUP);
+
+	CONFIG_GET_PER_DB_STR(getDbCachePolicy, KEY_DB_CACHE_POLICY);
+
+	CONFIG_GET_PER_DB_STR(getDbCacheNuma, KEY_DB_CACHE_NUMA);
+
+	CONFIG_GET_GLOBAL_BOOL(getUseHugePages, KEY_USE_HUGE_PAGES);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getCacheWriters, KEY_CACHE_WRITERS, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getTempCompression, KEY_TEMP_COMPRESSION);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getIndexStatisticsSampling, KEY_INDEX_STATISTICS_SAMPLING, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getRangeSummaryPages, KEY_RANGE_SUMMARY_PAGES, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getIndexProbeSlots, KEY_INDEX_PROBE_SLOTS, getInt);
+
+	CONFIG_GET_PER_DB_BOOL(getDeferredIndexGC, KEY_DEFERRED_INDEX_GC);
+
+	CONFIG_GET_PER_DB_BOOL(getLZRecordCompression, KEY_LZ_RECORD_COMPRESSION);
+
+	CONFIG_GET_PER_DB_BOOL(getBlobCompression, KEY_BLOB_COMPRESSION);
+
+	CONFIG_GET_PER_DB_BOOL(getPageChecksums, KEY_PAGE_CHECKSUMS);
+
+	CONFIG_GET_PER_DB_INT(getGCWorkers, KEY_GC_WORKERS);
+
+	CONFIG_GET_PER_DB_INT(getWireCompressionLevel, KEY_WIRE_COMPRESSION_LEVEL);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getSlowStatementLog, KEY_SLOW_STATEMENT_LOG, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getSequenceCache, KEY_SEQUENCE_CACHE, getInt);
+
+	CONFIG_GET_PER_DB_KEY(unsigned int, getIdleCompactTimeout, KEY_IDLE_COMPACT_TIMEOUT, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getSweepPageRate, KEY_SWEEP_PAGE_RATE, getInt);
+
+	CONFIG_GET_PER_DB_KEY(ULONG, getMaxDbCachePages, KEY_MAX_DB_CACHE_PAGES, getInt);
 };
 
 // Implementation of interface to access master configuration file
@@ -130,7 +130,8 @@ struct event_t
 class MemoryHeader
 {
 public:
-	static const USHORT HEADER_VERSION = 2;
+	// Version 3: events are futex based on Linux
+	static const USHORT HEADER_VERSION = 3;
 
 	// Values for mhb_flags
 	static const USHORT FLAG_DELETED = 1;	// Shared file has been deleted
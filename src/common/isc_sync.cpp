@@ -104,6 +104,15 @@ static int process_id;
 
 #include <sys/mman.h>
 
+#ifdef LINUX
+// Events are implemented directly on top of shared futexes:
+// no mutex round trip to post an event and no spurious wakeups
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <limits.h>
+#define USE_FUTEX_EVENTS
+#endif
+
 #endif // UNIX
 
 #ifdef HAVE_SYS_PARAM_H
@@ -146,6 +155,19 @@ static bool		event_blocked(const event_t* event, const SLONG value);
 
 static GlobalPtr<Mutex> openFdInit;
 
+static void adviseHugePages(void* address, size_t length)
+{
+	// Works when mapped file is placed on tmpfs with transparent huge pages enabled
+
+	if (!Config::getUseHugePages())
+		return;
+
+	static std::atomic<bool> logged(false);
+
+	if (!os_utils::adviseHugePages(address, length) && !logged.exchange(true))
+		gds__log("Huge pages are not available for shared memory, regular pages are used");
+}
+
 class DevNode
 {
 public:
@@ -759,6 +781,13 @@ int SharedMemoryBase::eventInit(event_t* event)
 
 	return (event->event_handle) ? FB_SUCCESS : FB_FAILURE;
 
+#elif defined(USE_FUTEX_EVENTS)
+
+	event->event_count = 0;
+	event->pid = getpid();
+
+	return FB_SUCCESS;
+
 #else // pthread-based event
 
 	event->event_count = 0;
@@ -811,6 +840,10 @@ void SharedMemoryBase::eventFini(event_t* event)
 		CloseHandle(event->event_handle);
 	}
 
+#elif defined(USE_FUTEX_EVENTS)
+
+	// nothing to release
+
 #else // pthread-based event
 
 	if (event->pid == getpid())
@@ -848,6 +881,10 @@ SLONG SharedMemoryBase::eventClear(event_t* event)
 
 	return event->event_count + 1;
 
+#elif defined(USE_FUTEX_EVENTS)
+
+	return __atomic_load_n(&event->event_count, __ATOMIC_ACQUIRE) + 1;
+
 #else // pthread-based event
 
 	LOG_PTHREAD_ERROR(pthread_mutex_lock(event->event_mutex));
@@ -896,6 +933,63 @@ int SharedMemoryBase::eventWait(event_t* event, const SLONG value, const SLONG m
 			return FB_FAILURE;
 	}
 
+#elif defined(USE_FUTEX_EVENTS)
+
+	struct timespec deadline;
+	if (micro_seconds > 0)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += micro_seconds / 1000000;
+		deadline.tv_nsec += 1000 * (micro_seconds % 1000000);
+		if (deadline.tv_nsec >= 1000000000)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000;
+		}
+	}
+
+	for (;;)
+	{
+		const SLONG current = __atomic_load_n(&event->event_count, __ATOMIC_ACQUIRE);
+
+		if (current >= value)
+			return FB_SUCCESS;
+
+		// FUTEX_WAIT takes a relative timeout, recalculate it after every wakeup
+
+		struct timespec timeout;
+		struct timespec* timer = NULL;
+
+		if (micro_seconds > 0)
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+
+			timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+			timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+			if (timeout.tv_nsec < 0)
+			{
+				timeout.tv_sec--;
+				timeout.tv_nsec += 1000000000;
+			}
+
+			if (timeout.tv_sec < 0)
+				return FB_FAILURE;
+
+			timer = &timeout;
+		}
+
+		// The kernel puts us asleep only if the counter still has the value we've seen,
+		// so a post between the check above and the wait is never lost
+
+		if (syscall(SYS_futex, &event->event_count, FUTEX_WAIT, current, timer, NULL, 0) < 0 &&
+			errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT)
+		{
+			gds__log("ISC_event_wait: futex wait failed with errno = %d", errno);
+			return FB_FAILURE;
+		}
+	}
+
 #else // pthread-based event
 
 	// Set up timers if a timeout period was specified.
@@ -971,6 +1065,18 @@ int SharedMemoryBase::eventPost(event_t* event)
 
 	return SetEvent(event->event_handle) ? FB_SUCCESS : FB_FAILURE;
 
+#elif defined(USE_FUTEX_EVENTS)
+
+	__atomic_add_fetch(&event->event_count, 1, __ATOMIC_RELEASE);
+
+	if (syscall(SYS_futex, &event->event_count, FUTEX_WAKE, INT_MAX, NULL, NULL, 0) < 0)
+	{
+		gds__log("ISC_event_post: futex wake failed with errno = %d", errno);
+		return FB_FAILURE;
+	}
+
+	return FB_SUCCESS;
+
 #else // pthread-based event
 
 	PTHREAD_ERROR(pthread_mutex_lock(event->event_mutex));
@@ -1400,6 +1506,8 @@ SharedMemoryBase::SharedMemoryBase(const TEXT* filename, ULONG length, IpcObject
 		system_call_failed::raise("mmap", errno);
 	}
 
+	adviseHugePages(address, length);
+
 	// this class is needed to cleanup mapping in case of error
 	class AutoUnmap
 	{
@@ -2593,6 +2701,7 @@ bool SharedMemoryBase::remapFile(CheckStatusWrapper* statusVector, ULONG new_len
 		return false;
 	}
 
+	adviseHugePages(address, new_length);
 	munmap(sh_mem_header, sh_mem_length_mapped);
 
 	IPC_TRACE(("ISC_remap_file %p to %p %d\n", sh_mem_header, address, new_length));
@@ -51,6 +51,9 @@
 #include <dirent.h>
 #include <sys/mman.h>
 #include <sys/resource.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
 
 #define DEFAULT_OPEN_MODE (0666)
 #endif
@@ -81,6 +84,17 @@ namespace os_utils
 
 	bool isIPv6supported();
 
+	// NUMA topology and memory placement
+	unsigned getNumaNodes();		// number of NUMA nodes, 1 if unknown
+	int getCurrentNumaNode();		// node of CPU running current thread, -1 if unknown
+	bool bindMemory(void* address, size_t size, int node);	// negative node - interleave over all nodes
+
+	// Huge memory pages
+	size_t getHugePageSize();		// 0 if huge pages are not supported
+	void* allocHugePages(size_t& size);		// size is rounded up, NULL if can't allocate
+	void releaseHugePages(void* address, size_t size);
+	bool adviseHugePages(void* address, size_t size);	// ask to back memory by transparent huge pages
+
 	bool getCurrentModulePath(char* buffer, size_t bufferSize);
 
 	// force descriptor to have O_CLOEXEC set
@@ -237,6 +251,30 @@ namespace os_utils
 #endif
 	}
 
+#ifdef HAVE_PREADV
+	inline ssize_t preadv(int fd, const struct iovec* iov, int iovcnt, off_t offset)
+	{
+		// Don't check EINTR because it's done by caller
+#ifdef LSB_BUILD
+		return preadv64(fd, iov, iovcnt, offset);
+#else
+		return ::preadv(fd, iov, iovcnt, offset);
+#endif
+	}
+#endif
+
+#ifdef HAVE_PWRITEV
+	inline ssize_t pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset)
+	{
+		// Don't check EINTR because it's done by caller
+#ifdef LSB_BUILD
+		return pwritev64(fd, iov, iovcnt, offset);
+#else
+		return ::pwritev(fd, iov, iovcnt, offset);
+#endif
+	}
+#endif
+
 	inline struct dirent* readdir(DIR* dirp)
 	{
 		struct dirent* rc;
@@ -92,6 +92,15 @@
 
 #include <stdio.h>
 
+#ifdef HAVE_LINUX_MEMPOLICY_H
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#if defined(SYS_mbind) && defined(SYS_getcpu)
+#define USE_NUMA
+#endif
+#endif
+
 using namespace Firebird;
 
 namespace os_utils
@@ -343,6 +352,175 @@ bool isIPv6supported()
 #endif
 }
 
+#ifdef USE_NUMA
+// Nodes mask passed to mbind() is single word
+const unsigned MAX_NUMA_NODES = sizeof(unsigned long) * 8;
+
+static unsigned readNumaNodes()
+{
+	// File contains list of online nodes like "0-1,3"
+	FILE* file = os_utils::fopen("/sys/devices/system/node/online", "r");
+	if (!file)
+		return 1;
+
+	char buffer[256];
+	const bool read = fgets(buffer, sizeof(buffer), file);
+	fclose(file);
+
+	if (!read)
+		return 1;
+
+	unsigned nodes = 1;
+	for (const char* p = buffer; *p; )
+	{
+		if (*p < '0' || *p > '9')
+		{
+			p++;
+			continue;
+		}
+
+		char* end;
+		const unsigned long node = strtoul(p, &end, 10);
+		if (node + 1 > nodes)
+			nodes = node + 1;
+		p = end;
+	}
+
+	return MIN(nodes, MAX_NUMA_NODES);
+}
+#endif
+
+unsigned getNumaNodes()
+{
+#ifdef USE_NUMA
+	static const unsigned nodes = readNumaNodes();
+	return nodes;
+#else
+	return 1;
+#endif
+}
+
+int getCurrentNumaNode()
+{
+#ifdef USE_NUMA
+	unsigned cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+		return node;
+#endif
+	return -1;
+}
+
+bool bindMemory(void* address, size_t size, int node)
+{
+#ifdef USE_NUMA
+	const unsigned nodes = getNumaNodes();
+	if (nodes < 2 || node >= (int) nodes)
+		return false;
+
+	// Only whole memory pages can be bound
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	UCHAR* const begin = FB_ALIGN((UCHAR*) address, pageSize);
+	const UCHAR* const end = (UCHAR*) address + size;
+	if (begin >= end)
+		return false;
+
+	unsigned long mask;
+	int mode;
+
+	if (node < 0)
+	{
+		mask = (nodes == MAX_NUMA_NODES) ? ~0ul : (1ul << nodes) - 1;
+		mode = MPOL_INTERLEAVE;
+	}
+	else
+	{
+		mask = 1ul << node;
+		mode = MPOL_PREFERRED;
+	}
+
+	return syscall(SYS_mbind, begin, end - begin, mode, &mask, MAX_NUMA_NODES + 1, MPOL_MF_MOVE) == 0;
+#else
+	return false;
+#endif
+}
+
+#ifdef MAP_HUGETLB
+static size_t readHugePageSize()
+{
+	// Default huge page size is reported by line like "Hugepagesize:    2048 kB"
+	FILE* file = os_utils::fopen("/proc/meminfo", "r");
+	if (!file)
+		return 0;
+
+	size_t size = 0;
+	char buffer[256];
+
+	while (fgets(buffer, sizeof(buffer), file))
+	{
+		unsigned long kb;
+		if (sscanf(buffer, "Hugepagesize: %lu kB", &kb) == 1)
+		{
+			size = kb * 1024;
+			break;
+		}
+	}
+
+	fclose(file);
+	return size;
+}
+#endif
+
+size_t getHugePageSize()
+{
+#ifdef MAP_HUGETLB
+	static const size_t size = readHugePageSize();
+	return size;
+#else
+	return 0;
+#endif
+}
+
+void* allocHugePages(size_t& size)
+{
+#if defined(MAP_HUGETLB) && defined(MAP_ANONYMOUS)
+	const size_t hugeSize = getHugePageSize();
+	if (!hugeSize)
+		return NULL;
+
+	const size_t length = FB_ALIGN(size, hugeSize);
+	void* const result = os_utils::mmap(NULL, length, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+	if (result == MAP_FAILED)
+		return NULL;
+
+	size = length;
+	return result;
+#else
+	return NULL;
+#endif
+}
+
+void releaseHugePages(void* address, size_t size)
+{
+	munmap(address, size);
+}
+
+bool adviseHugePages(void* address, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+	const size_t pageSize = sysconf(_SC_PAGESIZE);
+	UCHAR* const begin = FB_ALIGN((UCHAR*) address, pageSize);
+	const UCHAR* const end = (UCHAR*) address + size;
+	if (begin >= end)
+		return false;
+
+	return madvise(begin, end - begin, MADV_HUGEPAGE) == 0;
+#else
+	return false;
+#endif
+}
+
 bool getCurrentModulePath(char* buffer, size_t bufferSize)
 {
 #ifdef HAVE_DLADDR
@@ -380,6 +380,67 @@ bool isIPv6supported()
 	return false;
 }
 
+unsigned getNumaNodes()
+{
+	ULONG highest = 0;
+	if (!GetNumaHighestNodeNumber(&highest))
+		return 1;
+
+	return highest + 1;
+}
+
+int getCurrentNumaNode()
+{
+	PROCESSOR_NUMBER processor;
+	GetCurrentProcessorNumberEx(&processor);
+
+	USHORT node;
+	if (!GetNumaProcessorNodeEx(&processor, &node))
+		return -1;
+
+	return node;
+}
+
+bool bindMemory(void* /*address*/, size_t /*size*/, int /*node*/)
+{
+	// Windows places memory by the node of allocating thread,
+	// explicit placement is possible at allocation time only
+	return false;
+}
+
+size_t getHugePageSize()
+{
+	return GetLargePageMinimum();
+}
+
+void* allocHugePages(size_t& size)
+{
+	// Requires SeLockMemoryPrivilege
+	const size_t hugeSize = getHugePageSize();
+	if (!hugeSize)
+		return NULL;
+
+	const size_t length = FB_ALIGN(size, hugeSize);
+	void* const result = VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+		PAGE_READWRITE);
+
+	if (result)
+		size = length;
+
+	return result;
+}
+
+void releaseHugePages(void* address, size_t /*size*/)
+{
+	VirtualFree(address, 0, MEM_RELEASE);
+}
+
+bool adviseHugePages(void* /*address*/, size_t /*size*/)
+{
+	// No transparent huge pages in Windows
+	return false;
+}
+
 bool getCurrentModulePath(char* buffer, size_t bufferSize)
 {
 	HMODULE hmod = 0;
@@ -550,6 +550,29 @@ static void getVersions(const string& configInfo, ObjectsArray<string>& versions
 }
 
 
+// Return the length of the leading ASCII part of a string, checking a word at a time.
+static inline ULONG asciiPrefixLength(const UCHAR* str, ULONG len)
+{
+	const FB_UINT64 HIGH_BITS = FB_CONST64(0x8080808080808080);
+
+	ULONG i = 0;
+
+	for (; i + sizeof(FB_UINT64) <= len; i += sizeof(FB_UINT64))
+	{
+		FB_UINT64 word;
+		memcpy(&word, str + i, sizeof(word));
+
+		if (word & HIGH_BITS)
+			break;
+	}
+
+	while (i < len && str[i] <= 0x7F)
+		++i;
+
+	return i;
+}
+
+
 // BOCU-1
 USHORT UnicodeUtil::utf16KeyLength(USHORT len)
 {
@@ -805,6 +828,15 @@ ULONG UnicodeUtil::utf8ToUtf16(ULONG srcLen, const UCHAR* src, ULONG dstLen, USH
 
 	for (ULONG i = 0; i < srcLen; )
 	{
+		// Widen ASCII runs without per character checks
+		const ULONG ascii = asciiPrefixLength(src + i, MIN(srcLen - i, ULONG(dstEnd - dst)));
+
+		for (const ULONG end = i + ascii; i < end; )
+			*dst++ = src[i++];
+
+		if (i == srcLen)
+			break;
+
 		if (dstEnd - dst == 0)
 		{
 			*err_code = CS_TRUNCATION_ERROR;
@@ -1037,7 +1069,7 @@ INTL_BOOL UnicodeUtil::utf8WellFormed(ULONG len, const UCHAR* str, ULONG* offend
 	fb_assert(str != NULL);
 
 	ConversionICU& cIcu(getConversionICU());
-	for (ULONG i = 0; i < len; )
+	for (ULONG i = asciiPrefixLength(str, len); i < len; )
 	{
 		UChar32 c = str[i++];
 
@@ -1053,6 +1085,8 @@ INTL_BOOL UnicodeUtil::utf8WellFormed(ULONG len, const UCHAR* str, ULONG* offend
 					*offending_position = save_i;
 				return false;	// malformed
 			}
+
+			i += asciiPrefixLength(str + i, len - i);
 		}
 	}
 
@@ -1977,6 +2011,12 @@ SSHORT UnicodeUtil::Utf16Collation::compare(ULONG len1, const USHORT* str1,
 		len2 = pad - str2 + 1;
 	}
 
+	// Equal code units are equal in every collation, there is no need
+	// to normalize them and call ICU. This is the common case in joins
+	// and key lookups.
+	if (len1 == len2 && memcmp(str1, str2, len1 * sizeof(*str1)) == 0)
+		return 0;
+
 	len1 *= sizeof(*str1);
 	len2 *= sizeof(*str2);
 
@@ -435,6 +435,24 @@ bool AggNode::aggPass(thread_db* tdbb, Request* request) const
 	return true;
 }
 
+bool AggNode::aggRevert(thread_db* tdbb, Request* request) const
+{
+	dsc* desc = NULL;
+
+	// Values of DISTINCT aggregates are not counted per record.
+	if (distinct)
+		return false;
+
+	if (arg)
+	{
+		desc = EVL_expr(tdbb, request, arg);
+		if (request->req_flags & req_null)
+			return true;
+	}
+
+	return aggRemove(tdbb, request, desc);
+}
+
 void AggNode::aggFinish(thread_db* /*tdbb*/, Request* request) const
 {
 	if (asb)
@@ -720,6 +738,39 @@ void AvgAggNode::aggPass(thread_db* tdbb, Request* request, dsc* desc) const
 		ArithmeticNode::add2(tdbb, desc, impure, this, blr_add);
 }
 
+void AvgAggNode::aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const
+{
+	if (!partial->vlux_count)
+		return;
+
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	impure->vlux_count += partial->vlux_count;
+
+	if (dialect1)
+		ArithmeticNode::add(tdbb, &partial->vlu_desc, impure, this, blr_add);
+	else
+		ArithmeticNode::add2(tdbb, &partial->vlu_desc, impure, this, blr_add);
+}
+
+bool AvgAggNode::aggRemove(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	fb_assert(impure->vlux_count > 0);
+
+	if (--impure->vlux_count == 0)
+	{
+		aggInit(tdbb, request);
+		return true;
+	}
+
+	if (dialect1)
+		ArithmeticNode::add(tdbb, desc, impure, this, blr_subtract);
+	else
+		ArithmeticNode::add2(tdbb, desc, impure, this, blr_subtract);
+
+	return true;
+}
+
 dsc* AvgAggNode::aggExecute(thread_db* tdbb, Request* request) const
 {
 	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
@@ -1018,6 +1069,28 @@ void CountAggNode::aggPass(thread_db* /*tdbb*/, Request* request, dsc* /*desc*/)
 		++impure->vlu_misc.vlu_int64;
 }
 
+void CountAggNode::aggMerge(thread_db* /*tdbb*/, Request* request, const impure_value_ex* partial) const
+{
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (dialect1)
+		impure->vlu_misc.vlu_long += partial->vlu_misc.vlu_long;
+	else
+		impure->vlu_misc.vlu_int64 += partial->vlu_misc.vlu_int64;
+}
+
+bool CountAggNode::aggRemove(thread_db* /*tdbb*/, Request* request, dsc* /*desc*/) const
+{
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+
+	if (dialect1)
+		--impure->vlu_misc.vlu_long;
+	else
+		--impure->vlu_misc.vlu_int64;
+
+	return true;
+}
+
 dsc* CountAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 {
 	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
@@ -1280,6 +1353,39 @@ void SumAggNode::aggPass(thread_db* tdbb, Request* request, dsc* desc) const
 		ArithmeticNode::add2(tdbb, desc, impure, this, blr_add);
 }
 
+void SumAggNode::aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const
+{
+	if (!partial->vlux_count)
+		return;
+
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	impure->vlux_count += partial->vlux_count;
+
+	if (dialect1)
+		ArithmeticNode::add(tdbb, &partial->vlu_desc, impure, this, blr_add);
+	else
+		ArithmeticNode::add2(tdbb, &partial->vlu_desc, impure, this, blr_add);
+}
+
+bool SumAggNode::aggRemove(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	fb_assert(impure->vlux_count > 0);
+
+	if (--impure->vlux_count == 0)
+	{
+		aggInit(tdbb, request);
+		return true;
+	}
+
+	if (dialect1)
+		ArithmeticNode::add(tdbb, desc, impure, this, blr_subtract);
+	else
+		ArithmeticNode::add2(tdbb, desc, impure, this, blr_subtract);
+
+	return true;
+}
+
 dsc* SumAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 {
 	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
@@ -1370,6 +1476,49 @@ void MaxMinAggNode::aggPass(thread_db* tdbb, Request* request, dsc* desc) const
 		EVL_make_value(tdbb, desc, impure);
 }
 
+void MaxMinAggNode::aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const
+{
+	if (!partial->vlux_count)
+		return;
+
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	const bool first = (impure->vlux_count == 0);
+	impure->vlux_count += partial->vlux_count;
+
+	if (!first)
+	{
+		const int result = MOV_compare(tdbb, &partial->vlu_desc, &impure->vlu_desc);
+
+		if (!(type == TYPE_MAX && result > 0) && !(type == TYPE_MIN && result < 0))
+			return;
+	}
+
+	EVL_make_value(tdbb, &partial->vlu_desc, impure);
+}
+
+// The extreme value itself cannot be taken back without knowing the next one, so the
+// caller has to aggregate the remaining values again. Other values change nothing.
+bool MaxMinAggNode::aggRemove(thread_db* tdbb, Request* request, dsc* desc) const
+{
+	impure_value_ex* const impure = request->getImpure<impure_value_ex>(impureOffset);
+	fb_assert(impure->vlux_count > 0);
+
+	if (impure->vlux_count == 1)
+	{
+		impure->vlux_count = 0;
+		impure->vlu_desc.dsc_dtype = 0;
+		return true;
+	}
+
+	const int result = MOV_compare(tdbb, desc, &impure->vlu_desc);
+
+	if ((type == TYPE_MAX && result >= 0) || (type == TYPE_MIN && result <= 0))
+		return false;
+
+	--impure->vlux_count;
+	return true;
+}
+
 dsc* MaxMinAggNode::aggExecute(thread_db* /*tdbb*/, Request* request) const
 {
 	impure_value_ex* impure = request->getImpure<impure_value_ex>(impureOffset);
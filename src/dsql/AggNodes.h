@@ -44,7 +44,9 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS |
+			(distinct ? 0 : CAP_COMBINES_STATES) |
+			(distinct || (nodFlags & (FLAG_DOUBLE | FLAG_DECFLOAT)) ? 0 : CAP_REMOVES_VALUES);
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -56,6 +58,8 @@ public:
 	virtual void aggInit(thread_db* tdbb, Request* request) const;
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const;
+	virtual void aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const;
+	virtual bool aggRemove(thread_db* tdbb, Request* request, dsc* desc) const;
 
 protected:
 	virtual AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/;
@@ -111,7 +115,8 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS |
+			(distinct ? 0 : CAP_COMBINES_STATES | CAP_REMOVES_VALUES);
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -123,6 +128,8 @@ public:
 	virtual void aggInit(thread_db* tdbb, Request* request) const;
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const;
+	virtual void aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const;
+	virtual bool aggRemove(thread_db* tdbb, Request* request, dsc* desc) const;
 
 protected:
 	virtual AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/;
@@ -142,7 +149,9 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS |
+			(distinct ? 0 : CAP_COMBINES_STATES) |
+			(distinct || (nodFlags & (FLAG_DOUBLE | FLAG_DECFLOAT)) ? 0 : CAP_REMOVES_VALUES);
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -153,6 +162,8 @@ public:
 	virtual void aggInit(thread_db* tdbb, Request* request) const;
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const;
+	virtual void aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const;
+	virtual bool aggRemove(thread_db* tdbb, Request* request, dsc* desc) const;
 
 protected:
 	virtual AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/;
@@ -173,7 +184,8 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS |
+			(distinct ? 0 : CAP_COMBINES_STATES | CAP_REMOVES_VALUES);
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -184,6 +196,8 @@ public:
 	virtual void aggInit(thread_db* tdbb, Request* request) const;
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const;
+	virtual void aggMerge(thread_db* tdbb, Request* request, const impure_value_ex* partial) const;
+	virtual bool aggRemove(thread_db* tdbb, Request* request, dsc* desc) const;
 
 protected:
 	virtual AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/;
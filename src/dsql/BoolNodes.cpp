@@ -52,6 +52,8 @@ namespace Jrd {
 // Bug 10061, bsriram - 19-Apr-1999
 static const int MAX_MEMBER_LIST = 1500;
 
+static bool getConstantValue(const BoolExprNode* node, bool& value);
+
 
 //--------------------
 
@@ -118,8 +120,23 @@ string BinaryBoolNode::internalPrint(NodePrinter& printer) const
 
 BoolExprNode* BinaryBoolNode::dsqlPass(DsqlCompilerScratch* dsqlScratch)
 {
+	BoolExprNode* const node1 = doDsqlPass(dsqlScratch, arg1);
+	BoolExprNode* const node2 = doDsqlPass(dsqlScratch, arg2);
+
+	// TRUE AND X and FALSE OR X are X, whatever X evaluates to (NULL included).
+	// Dropping such terms (e.g. the 1 = 1 prefix generated by many query builders)
+	// saves their evaluation per row and leaves the rest of the condition to the optimizer.
+	const bool identity = (blrOp == blr_and);
+	bool value;
+
+	if (getConstantValue(node1, value) && value == identity)
+		return node2;
+
+	if (getConstantValue(node2, value) && value == identity)
+		return node1;
+
 	return FB_NEW_POOL(dsqlScratch->getPool()) BinaryBoolNode(dsqlScratch->getPool(), blrOp,
-		doDsqlPass(dsqlScratch, arg1), doDsqlPass(dsqlScratch, arg2));
+		node1, node2);
 }
 
 void BinaryBoolNode::genBlr(DsqlCompilerScratch* dsqlScratch)
@@ -922,41 +939,9 @@ bool ComparativeBoolNode::stringBoolean(thread_db* tdbb, Request* request, dsc*
 	}
 	else if (nodFlags & FLAG_PATTERN_MATCHER_CACHE)
 	{
-		auto& cache = impure->vlu_misc.vlu_patternMatcherCache;
-		const bool cacheHit = cache &&
-			cache->matcher &&
-			cache->ttype == type1 &&
-			cache->patternLen == patternLen &&
-			cache->escapeLen == escapeLen &&
-			memcmp(cache->key, patternStr, patternLen) == 0 &&
-			memcmp(cache->key + patternLen, escapeStr, escapeLen) == 0;
-
-		if (cacheHit)
-			cache->matcher->reset();
-		else
-		{
-			if (cache && cache->keySize < patternLen + escapeLen)
-			{
-				delete cache;
-				cache = nullptr;
-			}
-
-			if (!cache)
-			{
-				cache = FB_NEW_RPT(*tdbb->getDefaultPool(), patternLen + escapeLen)
-					impure_value::PatternMatcherCache(patternLen + escapeLen);
-			}
-
-			cache->ttype = type1;
-			cache->patternLen = patternLen;
-			cache->escapeLen = escapeLen;
-			memcpy(cache->key, patternStr, patternLen);
-			memcpy(cache->key + patternLen, escapeStr, escapeLen);
-
-			cache->matcher = createMatcher();
-		}
-
-		evaluator = cache->matcher;
+		evaluator = impure_value::PatternMatcherCache::get(*tdbb->getDefaultPool(),
+			impure->vlu_misc.vlu_patternMatcherCache, type1, patternStr, patternLen, escapeStr, escapeLen,
+			createMatcher);
 	}
 	else
 		autoEvaluator = evaluator = desc1->isBlob() ? createMatcher() : nullptr;
@@ -1776,4 +1761,37 @@ BoolExprNode* RseBoolNode::convertNeqAllToNotAny(thread_db* tdbb, CompilerScratc
 }
 
 
+// Check if the node is a comparison of two literals, as generated for TRUE, FALSE or 1 = 1.
+static bool getConstantValue(const BoolExprNode* node, bool& value)
+{
+	const ComparativeBoolNode* const cmpNode = nodeAs<ComparativeBoolNode>(node);
+
+	if (!cmpNode || (cmpNode->blrOp != blr_eql && cmpNode->blrOp != blr_neq) || cmpNode->arg3)
+		return false;
+
+	const LiteralNode* const literal1 = nodeAs<LiteralNode>(cmpNode->arg1);
+	const LiteralNode* const literal2 = nodeAs<LiteralNode>(cmpNode->arg2);
+
+	if (!literal1 || !literal2)
+		return false;
+
+	const dsc& desc1 = literal1->litDesc;
+	const dsc& desc2 = literal2->litDesc;
+
+	// Only types whose equality is the equality of their bytes
+	if ((desc1.dsc_dtype != dtype_boolean && desc1.dsc_dtype != dtype_long) ||
+		desc1.dsc_dtype != desc2.dsc_dtype ||
+		desc1.dsc_scale != desc2.dsc_scale ||
+		desc1.dsc_length != desc2.dsc_length)
+	{
+		return false;
+	}
+
+	const bool equal = memcmp(desc1.dsc_address, desc2.dsc_address, desc1.dsc_length) == 0;
+	value = (cmpNode->blrOp == blr_eql) ? equal : !equal;
+
+	return true;
+}
+
+
 }	// namespace Jrd
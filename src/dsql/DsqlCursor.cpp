@@ -86,6 +86,8 @@ void DsqlCursor::close(thread_db* tdbb, DsqlCursor* cursor)
 				trace.fetch(true, ITracePlugin::RESULT_SUCCESS);
 			}
 
+			dsqlRequest->checkSlowStatement(tdbb);
+
 			if (dsqlRequest->req_traced && TraceManager::need_dsql_free(attachment))
 			{
 				TraceSQLStatementImpl stmt(dsqlRequest, NULL);
@@ -34,6 +34,7 @@
 #include "../dsql/errd_proto.h"
 #include "../dsql/movd_proto.h"
 #include "../jrd/exe_proto.h"
+#include "../jrd/optimizer/Optimizer.h"
 
 using namespace Firebird;
 using namespace Jrd;
@@ -358,6 +359,36 @@ void DsqlDmlRequest::setDelayedFormat(thread_db* tdbb, IMessageMetadata* metadat
 	delayedFormat = metadata;
 }
 
+void DsqlRequest::checkSlowStatement(thread_db* tdbb)
+{
+	const SINT64 elapsed = req_slow_elapsed;
+	req_slow_elapsed = -1;
+
+	if (elapsed < 0)
+		return;
+
+	const ULONG threshold = tdbb->getDatabase()->dbb_config->getSlowStatementLog();
+	const SINT64 msec = elapsed * 1000 / fb_utils::query_performance_frequency();
+
+	if (!threshold || msec < threshold)
+		return;
+
+	const auto& sqlText = dsqlStatement->getSqlText();
+	string plan;
+
+	try
+	{
+		if (const auto request = getRequest())
+			plan = Optimizer::getPlan(tdbb, request->getStatement(), true);
+	}
+	catch (const Exception&)
+	{} // plan is not essential here
+
+	gds__log("Statement executed for %" SQUADFORMAT" ms in database %s:\n%s\n%s",
+		msec, req_dbb->dbb_attachment->att_filename.c_str(),
+		sqlText ? sqlText->c_str() : "", plan.c_str());
+}
+
 // Fetch next record from a dynamic SQL cursor.
 bool DsqlDmlRequest::fetch(thread_db* tdbb, UCHAR* msgBuffer)
 {
@@ -394,6 +425,8 @@ bool DsqlDmlRequest::fetch(thread_db* tdbb, UCHAR* msgBuffer)
 	Jrd::Attachment* att = req_dbb->dbb_attachment;
 	TraceDSQLFetch trace(att, this);
 
+	const SINT64 slowStart = (req_slow_elapsed >= 0) ? fb_utils::query_performance_counter() : 0;
+
 	thread_db::TimerGuard timerGuard(tdbb, req_timer, false);
 	if (req_timer && req_timer->expired())
 		tdbb->checkCancelState();
@@ -423,9 +456,19 @@ bool DsqlDmlRequest::fetch(thread_db* tdbb, UCHAR* msgBuffer)
 			req_timer->stop();
 
 		trace.fetch(true, ITracePlugin::RESULT_SUCCESS);
+
+		if (req_slow_elapsed >= 0)
+		{
+			req_slow_elapsed += fb_utils::query_performance_counter() - slowStart;
+			checkSlowStatement(tdbb);
+		}
+
 		return false;
 	}
 
+	if (req_slow_elapsed >= 0)
+		req_slow_elapsed += fb_utils::query_performance_counter() - slowStart;
+
 	if (msgBuffer)
 		mapInOut(tdbb, true, message, NULL, msgBuffer);
 
@@ -727,6 +770,10 @@ void DsqlDmlRequest::execute(thread_db* tdbb, jrd_tra** traHandle,
 	setupTimer(tdbb);
 	thread_db::TimerGuard timerGuard(tdbb, req_timer, !have_cursor);
 
+	req_slow_elapsed = -1;
+	const bool logSlow = tdbb->getDatabase()->dbb_config->getSlowStatementLog();
+	const SINT64 slowStart = logSlow ? fb_utils::query_performance_counter() : 0;
+
 	if (needRestarts())
 		executeReceiveWithRestarts(tdbb, traHandle, outMetadata, outMsg, singleton, true, false);
 	else {
@@ -734,6 +781,16 @@ void DsqlDmlRequest::execute(thread_db* tdbb, jrd_tra** traHandle,
 	}
 
 	trace.finish(have_cursor, ITracePlugin::RESULT_SUCCESS);
+
+	if (logSlow)
+	{
+		// Cursor time is accounted until it's fetched to the end or closed
+
+		req_slow_elapsed = fb_utils::query_performance_counter() - slowStart;
+
+		if (!have_cursor)
+			checkSlowStatement(tdbb);
+	}
 }
 
 void DsqlDmlRequest::executeReceiveWithRestarts(thread_db* tdbb, jrd_tra** traHandle,
@@ -117,6 +117,9 @@ public:
 
 	USHORT parseMetadata(Firebird::IMessageMetadata* meta, const Firebird::Array<dsql_par*>& parameters_list);
 
+	// Write statement and its plan into firebird.log if it ran longer than SlowStatementLog
+	void checkSlowStatement(thread_db* tdbb);
+
 	static void destroy(thread_db* tdbb, DsqlRequest* request);
 
 public:
@@ -135,6 +138,7 @@ public:
 	SINT64 req_fetch_elapsed = 0;	// Number of clock ticks spent while fetching rows for this request since we reported it last time
 	SINT64 req_fetch_rowcount = 0;	// Total number of rows returned by this request
 	bool req_traced = false;		// request is traced via TraceAPI
+	SINT64 req_slow_elapsed = -1;	// Clock ticks spent executing and fetching, or -1 if not measured
 
 protected:
 	unsigned int req_timeout = 0;				// query timeout in milliseconds, set by the user
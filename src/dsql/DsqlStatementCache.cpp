@@ -73,12 +73,16 @@ int DsqlStatementCache::blockingAst(void* astObject)
 RefPtr<DsqlStatement> DsqlStatementCache::getStatement(thread_db* tdbb, const string& text, USHORT clientDialect,
 	bool isInternalRequest)
 {
-	RefStrPtr key;
-	buildStatementKey(tdbb, key, text, clientDialect, isInternalRequest);
+	// Lookups reuse the same key buffer, only stored entries own a key of their own
+	if (!searchKey)
+		searchKey = FB_NEW_POOL(getPool()) RefString(getPool());
+
+	buildStatementKey(tdbb, searchKey, text, clientDialect, isInternalRequest);
 
-	if (const auto entryPtr = map.get(key))
+	if (const auto entryPtr = map.get(searchKey))
 	{
 		const auto entry = *entryPtr;
+		auto& key = entry->key;
 		auto dsqlStatement(entry->dsqlStatement);
 
 		string verifyKey;
@@ -233,7 +237,8 @@ void DsqlStatementCache::buildStatementKey(thread_db* tdbb, RefStrPtr& key, cons
 	const SSHORT charSetId = isInternalRequest ? CS_METADATA : attachment->att_charset;
 	const int debugOptions = (int) attachment->getDebugOptions().getDsqlKeepBlr();
 
-	key = FB_NEW_POOL(getPool()) RefString(getPool());
+	if (!key)
+		key = FB_NEW_POOL(getPool()) RefString(getPool());
 
 	key->resize(1 + sizeof(charSetId) + text.length());
 	char* p = key->begin();
@@ -262,6 +267,18 @@ void DsqlStatementCache::buildVerifyKey(thread_db* tdbb, string& key, bool isInt
 	}
 }
 
+// Free all statements not used by any handle
+void DsqlStatementCache::compact()
+{
+	while (!inactiveStatementList.isEmpty())
+	{
+		const auto& front = inactiveStatementList.front();
+		map.remove(front.key);
+		cacheSize -= front.size;
+		inactiveStatementList.erase(inactiveStatementList.begin());
+	}
+}
+
 void DsqlStatementCache::shrink()
 {
 #ifdef DSQL_STATEMENT_CACHE_DEBUG
@@ -109,6 +109,7 @@ public:
 	void statementGoingInactive(Firebird::RefStrPtr& key);
 
 	void purge(thread_db* tdbb, bool releaseLock);
+	void compact();
 	void purgeAllAttachments(thread_db* tdbb);
 
 	void shutdown(thread_db* tdbb)
@@ -137,6 +138,7 @@ private:
 	Firebird::DoublyLinkedList<StatementEntry> activeStatementList;
 	Firebird::DoublyLinkedList<StatementEntry> inactiveStatementList;
 	Firebird::AutoPtr<Lock> lock;
+	Firebird::RefStrPtr searchKey;
 	unsigned maxCacheSize = 0;
 	unsigned cacheSize = 0;
 };
@@ -25,6 +25,7 @@
 #include "../common/TimeZoneUtil.h"
 #include "../common/classes/FpeControl.h"
 #include "../common/classes/VaryStr.h"
+#include "../common/classes/Hash.h"
 #include "../dsql/ExprNodes.h"
 #include "../dsql/BoolNodes.h"
 #include "../dsql/StmtNodes.h"
@@ -151,7 +152,9 @@ namespace
 	// referencing, and mark them as variant - the rule is that if a field from one RSE is
 	// referenced within the scope of another RSE, the inner RSE can't be invariant.
 	// This won't optimize all cases, but it is the simplest operating assumption for now.
-	void markVariant(CompilerScratch* csb, StreamType stream)
+	// Referenced fields are remembered so the results of the inner RSE may be cached per their
+	// values, references to the whole record make it uncacheable.
+	void markVariant(CompilerScratch* csb, StreamType stream, USHORT fieldId = MAX_USHORT)
 	{
 		if (csb->csb_current_nodes.isEmpty())
 			return;
@@ -167,6 +170,22 @@ namespace
 					break;
 
 				rseNode->flags |= RseNode::FLAG_VARIANT;
+
+				if (fieldId == MAX_USHORT)
+					rseNode->flags |= RseNode::FLAG_UNCACHEABLE;
+				else
+				{
+					if (!rseNode->rse_outer_refs)
+					{
+						rseNode->rse_outer_refs =
+							FB_NEW_POOL(csb->csb_pool) OuterReferenceArray(csb->csb_pool);
+					}
+
+					const ULONG reference = (stream << 16) | fieldId;
+
+					if (!rseNode->rse_outer_refs->exist(reference))
+						rseNode->rse_outer_refs->add(reference);
+				}
 			}
 			else if (*node)
 				(*node)->nodFlags &= ~ExprNode::FLAG_INVARIANT;
@@ -186,6 +205,7 @@ static const SCHAR DIALECT_1_TIMESTAMP_SCALE = 0;
 
 static bool couldBeDate(const dsc desc);
 static SINT64 getDayFraction(const dsc* d);
+static SINT64 getInt64(thread_db* tdbb, const dsc* desc, SSHORT scale);
 static SINT64 getTimeStampToIscTicks(thread_db* tdbb, const dsc* d);
 static bool isDateAndTime(const dsc& d1, const dsc& d2);
 static void setParameterInfo(dsql_par* parameter, const dsql_ctx* context);
@@ -2100,8 +2120,8 @@ dsc* ArithmeticNode::add2(thread_db* tdbb, const dsc* desc, impure_value* value,
 
 	// Everything else defaults to int64
 
-	SINT64 i1 = MOV_get_int64(tdbb, desc, node->nodScale);
-	const SINT64 i2 = MOV_get_int64(tdbb, &value->vlu_desc, node->nodScale);
+	SINT64 i1 = getInt64(tdbb, desc, node->nodScale);
+	const SINT64 i2 = getInt64(tdbb, &value->vlu_desc, node->nodScale);
 
 	result->dsc_dtype = dtype_int64;
 	result->dsc_length = sizeof(SINT64);
@@ -2319,8 +2339,8 @@ dsc* ArithmeticNode::multiply2(const dsc* desc, impure_value* value) const
 	// Everything else defaults to int64
 
 	const SSHORT scale = NUMERIC_SCALE(value->vlu_desc);
-	const SINT64 i1 = MOV_get_int64(tdbb, desc, nodScale - scale);
-	const SINT64 i2 = MOV_get_int64(tdbb, &value->vlu_desc, scale);
+	const SINT64 i1 = getInt64(tdbb, desc, nodScale - scale);
+	const SINT64 i2 = getInt64(tdbb, &value->vlu_desc, scale);
 
 	/*
 	We need to report an overflow if
@@ -3604,23 +3624,8 @@ dsc* CastNode::execute(thread_db* tdbb, Request* request) const
 
 		length = impure->vlu_desc.dsc_length;
 
-		// Allocate a string block of sufficient size.
-
-		VaryingString* string = impure->vlu_string;
-
-		if (string && string->str_length < length)
-		{
-			delete string;
-			string = NULL;
-		}
-
-		if (!string)
-		{
-			string = impure->vlu_string = FB_NEW_RPT(*tdbb->getDefaultPool(), length) VaryingString();
-			string->str_length = length;
-		}
-
-		impure->vlu_desc.dsc_address = string->str_data;
+		// Get a string block of sufficient size.
+		impure->vlu_desc.dsc_address = impure->getString(*tdbb->getDefaultPool(), length);
 	}
 
 	EVL_validate(tdbb, Item(Item::TYPE_CAST), itemInfo,
@@ -6579,7 +6584,7 @@ ValueExprNode* FieldNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 		if (relation && (relation->rel_flags & REL_being_scanned))
 			csb->csb_g_flags |= csb_reload;
 
-		markVariant(csb, stream);
+		markVariant(csb, stream, fieldId);
 		return ValueExprNode::pass1(tdbb, csb);
 	}
 
@@ -6659,7 +6664,7 @@ ValueExprNode* FieldNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 	{
 		if (!relation->rel_view_rse)
 		{
-			markVariant(csb, stream);
+			markVariant(csb, stream, fieldId);
 			return ValueExprNode::pass1(tdbb, csb);
 		}
 
@@ -6683,7 +6688,7 @@ ValueExprNode* FieldNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 		//			want their old/new contexts to be substituted
 		if (relation->rel_view_rse || !field->fld_computation)
 		{
-			markVariant(csb, stream);
+			markVariant(csb, stream, fieldId);
 			return ValueExprNode::pass1(tdbb, csb);
 		}
 	}
@@ -6854,23 +6859,9 @@ dsc* FieldNode::execute(thread_db* tdbb, Request* request) const
 
 		if (impure->vlu_desc.isText())
 		{
-			// Allocate a string block of sufficient size.
-			VaryingString* string = impure->vlu_string;
-
-			if (string && string->str_length < impure->vlu_desc.dsc_length)
-			{
-				delete string;
-				string = NULL;
-			}
-
-			if (!string)
-			{
-				string = impure->vlu_string = FB_NEW_RPT(*tdbb->getDefaultPool(),
-					impure->vlu_desc.dsc_length) VaryingString();
-				string->str_length = impure->vlu_desc.dsc_length;
-			}
-
-			impure->vlu_desc.dsc_address = string->str_data;
+			// Get a string block of sufficient size.
+			impure->vlu_desc.dsc_address =
+				impure->getString(*tdbb->getDefaultPool(), impure->vlu_desc.dsc_length);
 		}
 		else
 			impure->vlu_desc.dsc_address = (UCHAR*) &impure->vlu_misc;
@@ -7055,6 +7046,8 @@ ValueExprNode* GenIdNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 {
 	ValueExprNode::pass1(tdbb, csb);
 
+	RseNode::markUncacheable(csb);
+
 	if (!identity)
 	{
 		CMP_post_access(tdbb, csb, generator.secName, 0,
@@ -7098,7 +7091,9 @@ dsc* GenIdNode::execute(thread_db* tdbb, Request* request) const
 			status_exception::raise(Arg::Gds(isc_cant_modify_sysobj) << "generator" << generator.name);
 	}
 
-	const SINT64 new_val = DPM_gen_id(tdbb, generator.id, false, change);
+	const SINT64 new_val = (implicit && !sysGen) ?
+		DPM_next_gen_id(tdbb, generator.id, change) :
+		DPM_gen_id(tdbb, generator.id, false, change);
 
 	if (dialect1)
 		impure->make_long((SLONG) new_val);
@@ -11031,6 +11026,235 @@ dsc* StrLenNode::execute(thread_db* tdbb, Request* request) const
 //--------------------
 
 
+// Results of a correlated sub-query or a deterministic function, keyed by the values they
+// depend on. The least recently used entries are dropped when the cache is full. As the
+// results may read the database, all of them are forgotten when the attachment changes
+// any record.
+
+class ResultCache : public PermanentStorage
+{
+	static const ULONG HASH_SIZE = 1021;
+	static const ULONG MAX_ENTRIES = 4096;
+	static const FB_SIZE_T MAX_MEMORY = 1024 * 1024;
+
+	struct Entry
+	{
+		Entry* collision;
+		Entry* prior;		// more recently used
+		Entry* next;		// less recently used
+		ULONG hash;
+		ULONG keyLength;
+		ULONG size;
+		dsc value;
+		bool null;
+
+		UCHAR* getKey()
+		{
+			return reinterpret_cast<UCHAR*>(this + 1);
+		}
+	};
+
+public:
+	explicit ResultCache(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  m_key(pool),
+		  m_first(NULL), m_last(NULL),
+		  m_count(0), m_memory(0), m_changes(0)
+	{
+		memset(m_hash, 0, sizeof(m_hash));
+	}
+
+	~ResultCache()
+	{
+		clear();
+	}
+
+	// Get the cache stored in the impure area and start building the key. The cache is
+	// cleared if the flags have been reset since the last call.
+	static ResultCache* get(thread_db* tdbb, Request* request, ULONG offset, USHORT& flags)
+	{
+		ResultCache*& cache = *request->getImpure<ResultCache*>(offset);
+
+		if (!cache)
+			cache = FB_NEW_POOL(*request->req_pool) ResultCache(*request->req_pool);
+
+		const RuntimeStatistics& stats = tdbb->getAttachment()->att_stats;
+		const SINT64 changes = stats.getValue(RuntimeStatistics::RECORD_INSERTS) +
+			stats.getValue(RuntimeStatistics::RECORD_UPDATES) +
+			stats.getValue(RuntimeStatistics::RECORD_DELETES);
+
+		if (!(flags & VLU_computed) || changes != cache->m_changes)
+		{
+			cache->clear();
+			cache->m_changes = changes;
+			flags |= VLU_computed;
+		}
+
+		cache->m_key.clear();
+		return cache;
+	}
+
+	void addKey(const UCHAR* data, ULONG length)
+	{
+		m_key.add(data, length);
+	}
+
+	void addKey(const dsc* desc)
+	{
+		if (!desc)
+		{
+			m_key.add(0);
+			return;
+		}
+
+		// Type attributes are a part of the key, so equal values of different types
+		// are cached separately
+
+		const UCHAR header[] = {1, desc->dsc_dtype, (UCHAR) desc->dsc_scale,
+			(UCHAR) desc->dsc_sub_type, (UCHAR) (desc->dsc_sub_type >> 8)};
+		m_key.add(header, sizeof(header));
+
+		const UCHAR* data = desc->dsc_address;
+		ULONG length = desc->dsc_length;
+
+		if (desc->dsc_dtype == dtype_varying)
+		{
+			const vary* const string = reinterpret_cast<const vary*>(data);
+			data = reinterpret_cast<const UCHAR*>(string->vary_string);
+			length = string->vary_length;
+		}
+		else if (desc->dsc_dtype == dtype_cstring)
+			length = static_cast<ULONG>(strlen(reinterpret_cast<const char*>(data)));
+
+		m_key.add(reinterpret_cast<const UCHAR*>(&length), sizeof(length));
+		m_key.add(data, length);
+	}
+
+	// Look up the result for the key built, NULL value means a NULL result
+	bool find(const dsc** value)
+	{
+		const ULONG hash = InternalHash::hash(m_key.getCount(), m_key.begin());
+
+		for (Entry* entry = m_hash[hash % HASH_SIZE]; entry; entry = entry->collision)
+		{
+			if (entry->hash == hash && entry->keyLength == m_key.getCount() &&
+				!memcmp(entry->getKey(), m_key.begin(), entry->keyLength))
+			{
+				unlink(entry);
+				link(entry);
+
+				*value = entry->null ? NULL : &entry->value;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Remember the result for the key built
+	void store(const dsc* value)
+	{
+		const ULONG keyLength = m_key.getCount();
+		const ULONG valueOffset = sizeof(Entry) + FB_ALIGN(keyLength, FB_ALIGNMENT);
+		const ULONG size = valueOffset + (value ? value->dsc_length : 0);
+
+		if (size > MAX_MEMORY / 16)
+			return;
+
+		while (m_last && (m_count >= MAX_ENTRIES || m_memory + size > MAX_MEMORY))
+			remove(m_last);
+
+		UCHAR* const buffer = FB_NEW_POOL(getPool()) UCHAR[size];
+		Entry* const entry = reinterpret_cast<Entry*>(buffer);
+
+		entry->hash = InternalHash::hash(keyLength, m_key.begin());
+		entry->keyLength = keyLength;
+		entry->size = size;
+		entry->null = (value == NULL);
+		memcpy(entry->getKey(), m_key.begin(), keyLength);
+
+		if (value)
+		{
+			entry->value = *value;
+			entry->value.dsc_address = buffer + valueOffset;
+			memcpy(entry->value.dsc_address, value->dsc_address, value->dsc_length);
+		}
+
+		Entry** const head = &m_hash[entry->hash % HASH_SIZE];
+		entry->collision = *head;
+		*head = entry;
+
+		link(entry);
+
+		m_count++;
+		m_memory += size;
+	}
+
+	void clear()
+	{
+		while (m_first)
+			remove(m_first);
+	}
+
+private:
+	void link(Entry* entry)
+	{
+		entry->prior = NULL;
+		entry->next = m_first;
+
+		if (m_first)
+			m_first->prior = entry;
+		else
+			m_last = entry;
+
+		m_first = entry;
+	}
+
+	void unlink(Entry* entry)
+	{
+		if (entry->prior)
+			entry->prior->next = entry->next;
+		else
+			m_first = entry->next;
+
+		if (entry->next)
+			entry->next->prior = entry->prior;
+		else
+			m_last = entry->prior;
+	}
+
+	void remove(Entry* entry)
+	{
+		unlink(entry);
+
+		for (Entry** ptr = &m_hash[entry->hash % HASH_SIZE]; *ptr; ptr = &(*ptr)->collision)
+		{
+			if (*ptr == entry)
+			{
+				*ptr = entry->collision;
+				break;
+			}
+		}
+
+		m_count--;
+		m_memory -= entry->size;
+
+		delete[] reinterpret_cast<UCHAR*>(entry);
+	}
+
+	Array<UCHAR> m_key;
+	Entry* m_hash[HASH_SIZE];
+	Entry* m_first;
+	Entry* m_last;
+	ULONG m_count;
+	FB_SIZE_T m_memory;
+	SINT64 m_changes;
+};
+
+
+//--------------------
+
+
 // Only blr_via is generated by DSQL.
 static RegisterNode<SubQueryNode> regSubQueryNode({
 	blr_via, blr_from, blr_average, blr_count, blr_maximum, blr_minimum, blr_total
@@ -11044,7 +11268,9 @@ SubQueryNode::SubQueryNode(MemoryPool& pool, UCHAR aBlrOp, RecordSourceNode* aDs
 	  value2(aValue2),
 	  subQuery(NULL),
 	  blrOp(aBlrOp),
-	  ownSavepoint(true)
+	  ownSavepoint(true),
+	  cacheResults(false),
+	  cacheOffset(0)
 {
 }
 
@@ -11359,14 +11585,36 @@ ValueExprNode* SubQueryNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 
 	impureOffset = csb->allocImpure<impure_value_ex>();
 
-	{
-		dsc desc;
-		getDesc(tdbb, csb, &desc);
-	}
+	dsc desc;
+	getDesc(tdbb, csb, &desc);
 
 	if (blrOp == blr_average && !(nodFlags & FLAG_DECFLOAT))
 		nodFlags |= FLAG_DOUBLE;
 
+	// A correlated sub-query inside another RSE depends only on the outer fields it references,
+	// unless it contains something non-deterministic. Its results are cached per their values,
+	// the cache is reset when the top-level RSE is opened again.
+
+	if (!(nodFlags & FLAG_INVARIANT) && rse->rse_outer_refs &&
+		!(rse->flags & RseNode::FLAG_UNCACHEABLE) &&
+		!desc.isBlob() && desc.dsc_dtype != dtype_array &&
+		csb->csb_current_nodes.hasData() && nodeIs<RseNode>(csb->csb_current_nodes[0]))
+	{
+		cacheResults = true;
+		cacheOffset = csb->allocImpure<ResultCache*>();
+		csb->csb_invariants.push(&impureOffset);
+
+		RseNode* topRseNode = nodeAs<RseNode>(csb->csb_current_nodes[0]);
+
+		if (!topRseNode->rse_invariants)
+		{
+			topRseNode->rse_invariants =
+				FB_NEW_POOL(*tdbb->getDefaultPool()) VarInvariantArray(*tdbb->getDefaultPool());
+		}
+
+		topRseNode->rse_invariants->add(impureOffset);
+	}
+
 	// Bind values of invariant nodes to top-level RSE (if present).
 	if ((nodFlags & FLAG_INVARIANT) && csb->csb_current_nodes.hasData())
 	{
@@ -11417,6 +11665,38 @@ dsc* SubQueryNode::execute(thread_db* tdbb, Request* request) const
 		}
 	}
 
+	ResultCache* cache = NULL;
+
+	if (cacheResults)
+	{
+		cache = ResultCache::get(tdbb, request, cacheOffset, impure->vlu_flags);
+
+		for (const auto reference : *rse->rse_outer_refs)
+		{
+			const record_param* const rpb = &request->req_rpb[reference >> 16];
+			dsc fieldDesc;
+
+			const bool notNull = rpb->rpb_record &&
+				EVL_field(rpb->rpb_relation, rpb->rpb_record, (USHORT) reference, &fieldDesc);
+
+			cache->addKey(notNull ? &fieldDesc : NULL);
+		}
+
+		const dsc* cached;
+
+		if (cache->find(&cached))
+		{
+			if (!cached)
+			{
+				request->req_flags |= req_null;
+				return NULL;
+			}
+
+			EVL_make_value(tdbb, cached, impure);
+			return &impure->vlu_desc;
+		}
+	}
+
 	impure->vlu_misc.vlu_long = 0;
 	impure->vlu_desc.dsc_dtype = dtype_long;
 	impure->vlu_desc.dsc_length = sizeof(SLONG);
@@ -11553,6 +11833,9 @@ dsc* SubQueryNode::execute(thread_db* tdbb, Request* request) const
 			impure->vlu_desc = *desc;
 	}
 
+	if (cache)
+		cache->store((request->req_flags & req_null) ? NULL : desc);
+
 	return (request->req_flags & req_null) ? NULL : desc;
 }
 
@@ -12087,41 +12370,11 @@ dsc* SubstringSimilarNode::execute(thread_db* tdbb, Request* request) const
 	}
 	else if (nodFlags & FLAG_PATTERN_MATCHER_CACHE)
 	{
-		auto& cache = impure->vlu_misc.vlu_patternMatcherCache;
-		const bool cacheHit = cache &&
-			cache->matcher &&
-			cache->ttype == textType &&
-			cache->patternLen == patternLen &&
-			cache->escapeLen == escapeLen &&
-			memcmp(cache->key, patternStr, patternLen) == 0 &&
-			memcmp(cache->key + patternLen, escapeStr, escapeLen) == 0;
-
-		if (cacheHit)
-			cache->matcher->reset();
-		else
-		{
-			if (cache && cache->keySize < patternLen + escapeLen)
-			{
-				delete cache;
-				cache = nullptr;
-			}
-
-			if (!cache)
-			{
-				cache = FB_NEW_RPT(*tdbb->getDefaultPool(), patternLen + escapeLen)
-					impure_value::PatternMatcherCache(patternLen + escapeLen);
-			}
+		PatternMatcher* const matcher = impure_value::PatternMatcherCache::get(*tdbb->getDefaultPool(),
+			impure->vlu_misc.vlu_patternMatcherCache, textType, patternStr, patternLen, escapeStr, escapeLen,
+			createMatcher);
 
-			cache->ttype = textType;
-			cache->patternLen = patternLen;
-			cache->escapeLen = escapeLen;
-			memcpy(cache->key, patternStr, patternLen);
-			memcpy(cache->key + patternLen, escapeStr, escapeLen);
-
-			cache->matcher = createMatcher();
-		}
-
-		evaluator = static_cast<BaseSubstringSimilarMatcher*>(cache->matcher.get());
+		evaluator = static_cast<BaseSubstringSimilarMatcher*>(matcher);
 	}
 	else
 		autoEvaluator = evaluator = createMatcher();
@@ -12305,6 +12558,16 @@ bool SysFuncCallNode::sameAs(const ExprNode* other, bool ignoreStreams) const
 	return function && function == otherNode->function;
 }
 
+ValueExprNode* SysFuncCallNode::pass1(thread_db* tdbb, CompilerScratch* csb)
+{
+	ValueExprNode::pass1(tdbb, csb);
+
+	if (!function->isDeterministic())
+		RseNode::markUncacheable(csb);
+
+	return this;
+}
+
 ValueExprNode* SysFuncCallNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 {
 	ValueExprNode::pass2(tdbb, csb);
@@ -12756,7 +13019,9 @@ UdfCallNode::UdfCallNode(MemoryPool& pool, const QualifiedName& aName, ValueList
 	  args(aArgs),
 	  function(NULL),
 	  dsqlFunction(NULL),
-	  isSubRoutine(false)
+	  isSubRoutine(false),
+	  cacheResults(false),
+	  cacheOffset(0)
 {
 }
 
@@ -12978,6 +13243,9 @@ ValueExprNode* UdfCallNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 		CMP_post_resource(&csb->csb_resources, function, Resource::rsc_function, function->getId());
 	}
 
+	if (!function->fun_deterministic)
+		RseNode::markUncacheable(csb);
+
 	return this;
 }
 
@@ -13010,6 +13278,16 @@ ValueExprNode* UdfCallNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 
 		fb_assert(function->getOutputFormat()->fmt_length);
 		csb->allocImpure(FB_ALIGNMENT, function->getOutputFormat()->fmt_length);
+
+		// Results of a deterministic function are cached per arguments during the request
+
+		if (function->fun_deterministic && function->fun_inputs &&
+			!desc.isBlob() && desc.dsc_dtype != dtype_array)
+		{
+			cacheResults = true;
+			cacheOffset = csb->allocImpure<ResultCache*>();
+			csb->csb_invariants.push(&impureOffset);
+		}
 	}
 
 	return this;
@@ -13022,6 +13300,7 @@ dsc* UdfCallNode::execute(thread_db* tdbb, Request* request) const
 	impure_value* value = &impureArea->value;
 
 	USHORT& invariantFlags = value->vlu_flags;
+	ResultCache* cache = NULL;
 
 	// If the function is known as being both deterministic and invariant,
 	// check whether it has already been evaluated
@@ -13067,23 +13346,8 @@ dsc* UdfCallNode::execute(thread_db* tdbb, Request* request) const
 
 		if (value->vlu_desc.dsc_dtype <= dtype_varying)
 		{
-			const USHORT retLength = value->vlu_desc.dsc_length;
-			VaryingString* string = value->vlu_string;
-
-			if (string && string->str_length < retLength)
-			{
-				delete string;
-				string = NULL;
-			}
-
-			if (!string)
-			{
-				string = FB_NEW_RPT(*tdbb->getDefaultPool(), retLength) VaryingString;
-				string->str_length = retLength;
-				value->vlu_string = string;
-			}
-
-			value->vlu_desc.dsc_address = string->str_data;
+			value->vlu_desc.dsc_address =
+				value->getString(*tdbb->getDefaultPool(), value->vlu_desc.dsc_length);
 		}
 		else
 			value->vlu_desc.dsc_address = (UCHAR*) &value->vlu_misc;
@@ -13134,6 +13398,27 @@ dsc* UdfCallNode::execute(thread_db* tdbb, Request* request) const
 			}
 		}
 
+		if (cacheResults)
+		{
+			cache = ResultCache::get(tdbb, request, cacheOffset, invariantFlags);
+			cache->addKey(inMsg, inMsgLength);
+
+			const dsc* cached;
+
+			if (cache->find(&cached))
+			{
+				if (!cached)
+				{
+					request->req_flags |= req_null;
+					return NULL;
+				}
+
+				request->req_flags &= ~req_null;
+				EVL_make_value(tdbb, cached, value);
+				return &value->vlu_desc;
+			}
+		}
+
 		jrd_tra* transaction = request->req_transaction;
 
 		const SavNumber savNumber = transaction->tra_save_point ?
@@ -13223,6 +13508,9 @@ dsc* UdfCallNode::execute(thread_db* tdbb, Request* request) const
 			invariantFlags |= VLU_null;
 	}
 
+	if (cache)
+		cache->store((request->req_flags & req_null) ? NULL : &value->vlu_desc);
+
 	return (request->req_flags & req_null) ? NULL : &value->vlu_desc;
 }
 
@@ -13910,6 +14198,28 @@ static SINT64 getTimeStampToIscTicks(thread_db* tdbb, const dsc* d)
 	return TimeStamp::timeStampToTicks(result_timestamp.utc_timestamp);
 }
 
+// Get an integer value at the given scale. Integers already at that scale,
+// like PSQL counters, are read directly instead of going through CVT.
+static SINT64 getInt64(thread_db* tdbb, const dsc* desc, SSHORT scale)
+{
+	if (desc->dsc_scale == scale)
+	{
+		switch (desc->dsc_dtype)
+		{
+			case dtype_short:
+				return *(SSHORT*) desc->dsc_address;
+
+			case dtype_long:
+				return *(SLONG*) desc->dsc_address;
+
+			case dtype_int64:
+				return *(SINT64*) desc->dsc_address;
+		}
+	}
+
+	return MOV_get_int64(tdbb, desc, scale);
+}
+
 // One of d1, d2 is time, the other is date
 static bool isDateAndTime(const dsc& d1, const dsc& d2)
 {
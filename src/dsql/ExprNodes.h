@@ -1961,6 +1961,8 @@ public:
 	NestConst<SubQuery> subQuery;
 	const UCHAR blrOp;
 	bool ownSavepoint;
+	bool cacheResults;	// results are cached per values of the outer fields
+	ULONG cacheOffset;
 };
 
 
@@ -2066,6 +2068,7 @@ public:
 	virtual ValueExprNode* copy(thread_db* tdbb, NodeCopier& copier) const;
 	virtual bool dsqlMatch(DsqlCompilerScratch* dsqlScratch, const ExprNode* other, bool ignoreMapCast) const;
 	virtual bool sameAs(const ExprNode* other, bool ignoreStreams) const;
+	virtual ValueExprNode* pass1(thread_db* tdbb, CompilerScratch* csb);
 	virtual ValueExprNode* pass2(thread_db* tdbb, CompilerScratch* csb);
 	virtual dsc* execute(thread_db* tdbb, Request* request) const;
 
@@ -2168,6 +2171,8 @@ public:
 private:
 	dsql_udf* dsqlFunction;
 	bool isSubRoutine;
+	bool cacheResults;	// results of a deterministic function are cached per arguments
+	ULONG cacheOffset;
 };
 
 
@@ -920,6 +920,10 @@ public:
 	static const unsigned CAP_WANTS_AGG_CALLS		= 0x04;
 	// wants winPass call in a window
 	static const unsigned CAP_WANTS_WIN_PASS_CALL	= 0x08;
+	// partial states may be merged with aggMerge
+	static const unsigned CAP_COMBINES_STATES		= 0x10;
+	// values may be taken back with aggRevert
+	static const unsigned CAP_REMOVES_VALUES		= 0x20;
 
 protected:
 	struct AggInfo
@@ -1078,6 +1082,22 @@ public:
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const = 0;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const = 0;
 
+	// Merge the partial state saved from the impure area of this request.
+	virtual void aggMerge(thread_db* /*tdbb*/, Request* /*request*/,
+		const impure_value_ex* /*partial*/) const
+	{
+		fb_assert(false);
+	}
+
+	// Take back the value passed for the current record. Returns false if the state
+	// cannot be updated this way and should be computed again from scratch.
+	virtual bool aggRevert(thread_db* tdbb, Request* request) const;
+
+	virtual bool aggRemove(thread_db* /*tdbb*/, Request* /*request*/, dsc* /*desc*/) const
+	{
+		return false;
+	}
+
 	virtual AggNode* dsqlPass(DsqlCompilerScratch* dsqlScratch);
 
 protected:
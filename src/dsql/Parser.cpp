@@ -52,25 +52,83 @@ namespace Jrd
 		MetaName* str;
 	};
 
-	class KeywordsMap : public GenericMap<Pair<Left<MetaName, Keyword> > >
+	// Open addressing hash of the keywords, looked up directly with the lexer's
+	// buffer so that identifiers do not need to become a MetaName first.
+	class KeywordsMap
 	{
 	public:
 		explicit KeywordsMap(MemoryPool& pool)
-			: GenericMap<Pair<Left<MetaName, Keyword> > >(pool)
+			: keywords(pool),
+			  slots(pool)
 		{
 			for (const TOK* token = keywordGetTokens(); token->tok_string; ++token)
 			{
 				MetaName* str = FB_NEW_POOL(pool) MetaName(token->tok_string);
-				put(*str, Keyword(token->tok_ident, str));
+				keywords.add(Keyword(token->tok_ident, str));
+
+				if (str->length() > maxLength)
+					maxLength = str->length();
+			}
+
+			FB_SIZE_T size = 1;
+			while (size < keywords.getCount() * 4)
+				size <<= 1;
+
+			mask = size - 1;
+			slots.grow(size);
+
+			for (FB_SIZE_T i = 0; i < keywords.getCount(); ++i)
+			{
+				const MetaName* const str = keywords[i].str;
+				FB_SIZE_T slot = hash(str->c_str(), str->length()) & mask;
+
+				while (slots[slot])
+				{
+					fb_assert(*slots[slot]->str != *str);
+					slot = (slot + 1) & mask;
+				}
+
+				slots[slot] = &keywords[i];
 			}
 		}
 
 		~KeywordsMap()
 		{
-			Accessor accessor(this);
-			for (bool found = accessor.getFirst(); found; found = accessor.getNext())
-				delete accessor.current()->second.str;
+			for (auto& keyword : keywords)
+				delete keyword.str;
 		}
+
+		const Keyword* get(const char* str, FB_SIZE_T length) const
+		{
+			if (length > maxLength)
+				return NULL;
+
+			for (FB_SIZE_T slot = hash(str, length) & mask; slots[slot]; slot = (slot + 1) & mask)
+			{
+				const Keyword* const keyword = slots[slot];
+
+				if (keyword->str->length() == length && memcmp(keyword->str->c_str(), str, length) == 0)
+					return keyword;
+			}
+
+			return NULL;
+		}
+
+	private:
+		static FB_SIZE_T hash(const char* str, FB_SIZE_T length)
+		{
+			ULONG value = 2166136261u;
+
+			for (const char* const end = str + length; str < end; ++str)
+				value = (value ^ (UCHAR) *str) * 16777619u;
+
+			return value ^ (value >> 16);
+		}
+
+		Array<Keyword> keywords;
+		Array<const Keyword*> slots;
+		FB_SIZE_T mask = 0;
+		FB_SIZE_T maxLength = 0;
 	};
 
 	KeywordsMap* KeywordsMapAllocator::create()
@@ -91,9 +149,9 @@ namespace Jrd
 
 namespace
 {
-	const Keyword* getKeyword(Database* dbb, const MetaName& str)
+	const Keyword* getKeyword(Database* dbb, const char* str, FB_SIZE_T length)
 	{
-		return dbb->dbb_keywords_map().get(str);
+		return dbb->dbb_keywords_map().get(str, length);
 	}
 }
 
@@ -1254,11 +1312,7 @@ int Parser::yylexAux()
 		char* p = string;
 		check_copy_incr(p, UPPER (c), string);
 		for (; lex.ptr < lex.end && (classes(*lex.ptr) & CHR_IDENT); lex.ptr++)
-		{
-			if (lex.ptr >= lex.end)
-				return -1;
 			check_copy_incr(p, UPPER (*lex.ptr), string);
-		}
 
 		check_bound(p, string);
 		*p = 0;
@@ -1266,8 +1320,7 @@ int Parser::yylexAux()
 		if (p > &string[maxByteLength] || p > &string[maxCharLength])
 			yyabandon(yyposn, -104, isc_dyn_name_longer);
 
-		const MetaName str(string, p - string);
-		const Keyword* const keyVer = getKeyword(dbb, str);
+		const Keyword* const keyVer = getKeyword(dbb, string, p - string);
 
 		if (keyVer && (keyVer->keyword != TOK_COMMENT || lex.prev_keyword == -1))
 		{
@@ -1278,7 +1331,7 @@ int Parser::yylexAux()
 			return keyVer->keyword;
 		}
 
-		yylval.metaNamePtr = FB_NEW_POOL(pool) MetaName(pool, str);
+		yylval.metaNamePtr = FB_NEW_POOL(pool) MetaName(pool, string, p - string);
 		lex.last_token_bk = lex.last_token;
 		lex.line_start_bk = lex.line_start;
 		lex.lines_bk = lex.lines;
@@ -1289,8 +1342,7 @@ int Parser::yylexAux()
 
 	if (lex.last_token + 1 < lex.end && !isspace(UCHAR(lex.last_token[1])))
 	{
-		const MetaName str(lex.last_token, 2);
-		const Keyword* const keyVer = getKeyword(dbb, str);
+		const Keyword* const keyVer = getKeyword(dbb, lex.last_token, 2);
 
 		if (keyVer)
 		{
@@ -2210,14 +2210,8 @@ const StmtNode* DeclareVariableNode::execute(thread_db* tdbb, Request* request,
 
 		if (variable->vlu_desc.dsc_dtype <= dtype_varying)
 		{
-			if (!variable->vlu_string)
-			{
-				const USHORT len = variable->vlu_desc.dsc_length;
-				variable->vlu_string = FB_NEW_RPT(*tdbb->getDefaultPool(), len) VaryingString();
-				variable->vlu_string->str_length = len;
-			}
-
-			variable->vlu_desc.dsc_address = variable->vlu_string->str_data;
+			variable->vlu_desc.dsc_address =
+				variable->getString(*tdbb->getDefaultPool(), variable->vlu_desc.dsc_length);
 		}
 		else
 			variable->vlu_desc.dsc_address = (UCHAR*) &variable->vlu_misc;
@@ -7733,6 +7727,11 @@ void StoreNode::genBlr(DsqlCompilerScratch* dsqlScratch)
 	if (overrideClause.specified)
 		dsqlScratch->appendUChar(UCHAR(overrideClause.value));
 
+	// INSERT ... SELECT stores all records at once, let them fill new data pages
+
+	if (dsqlRse && !dsqlScratch->isPsql())
+		dsqlScratch->putBlrMarkers(StmtNode::MARK_BULK_INSERT);
+
 	GEN_expr(dsqlScratch, target);
 
 	statement->genBlr(dsqlScratch);
@@ -81,7 +81,9 @@ struct PerformanceInfo
 		FETCHES = 0,
 		READS,
 		MARKS,
-		WRITES
+		WRITES,
+		READ_WAIT,		// time (microseconds) spent reading pages
+		LOCK_WAIT		// time (microseconds) spent waiting for locks
 	};
 
 	ISC_INT64 pin_time;				// Total operation time in milliseconds
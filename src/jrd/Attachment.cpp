@@ -263,6 +263,7 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_procedures(*pool),
 	  att_functions(*pool),
 	  att_generators(*pool),
+	  att_sequence_cache(*pool),
 	  att_internal(*pool),
 	  att_dyn_req(*pool),
 	  att_dec_status(DecimalStatus::DEFAULT),
@@ -285,6 +286,9 @@ Jrd::Attachment::~Attachment()
 	if (att_idle_timer)
 		att_idle_timer->stop();
 
+	if (att_compact_timer)
+		att_compact_timer->stop();
+
 	delete att_trace_manager;
 
 	for (unsigned n = 0; n < att_batches.getCount(); ++n)
@@ -862,6 +866,14 @@ void Jrd::Attachment::releaseLocks(thread_db* tdbb)
 	if (att_profiler_listener_lock)
 		LCK_release(tdbb, att_profiler_listener_lock);
 
+	// Release the locks of cached sequence values
+
+	for (auto& entry : att_sequence_cache)
+	{
+		if (entry.second->lock)
+			LCK_release(tdbb, entry.second->lock);
+	}
+
 	// And release the system requests
 
 	for (Statement** itr = att_internal.begin(); itr != att_internal.end(); ++itr)
@@ -1066,6 +1078,32 @@ void StableAttachmentPart::doOnIdleTimer(TimerImpl*)
 	JRD_shutdown_attachment(att);
 }
 
+void StableAttachmentPart::doOnCompactTimer(TimerImpl*)
+{
+	// Ensure attachment is still alive and still idle
+
+	EnsureUnlock<Sync, NotRefCounted> guard(*this->getSync(), FB_FUNCTION);
+	if (!guard.tryEnter())
+		return;
+
+	Attachment* const att = this->getHandle();
+	if (!att || att->hasActiveRequests())
+		return;
+
+	FbLocalStatus status;
+	ThreadContextHolder tdbb(att->att_database, att, &status);
+	DatabaseContextHolder dbbHolder(tdbb);
+
+	try
+	{
+		att->compact(tdbb);
+	}
+	catch (const Exception& ex)
+	{
+		iscLogException("Idle attachment compaction", ex);
+	}
+}
+
 JAttachment* Attachment::getInterface() throw()
 {
 	return att_stable->getInterface();
@@ -1101,6 +1139,35 @@ void Attachment::setupIdleTimer(bool clear)
 
 		att_idle_timer->reset(timeout);
 	}
+
+	timeout = clear ? 0 : att_database->dbb_config->getIdleCompactTimeout() * 60;
+	if (!timeout || hasActiveRequests())
+	{
+		if (att_compact_timer)
+			att_compact_timer->reset(0);
+	}
+	else
+	{
+		if (!att_compact_timer)
+		{
+			using CompactTimer = TimerWithRef<StableAttachmentPart>;
+
+			auto compactTimer = FB_NEW CompactTimer(getStable());
+			compactTimer->setOnTimer(&StableAttachmentPart::onCompactTimer);
+			att_compact_timer = compactTimer;
+		}
+
+		att_compact_timer->reset(timeout);
+	}
+}
+
+void Attachment::compact(thread_db* tdbb)
+{
+	SET_TDBB(tdbb);
+
+	// Statements in use keep their handles valid, only the unused ones are freed
+	if (att_dsql_instance)
+		att_dsql_instance->dbb_statement_cache->compact();
 }
 
 UserId* Attachment::getUserId(const MetaString& userName)
@@ -199,6 +199,50 @@ private:
 };
 
 
+// Small direct-mapped cache of transactions known to be committed or dead.
+// These states are final, so cached entries never become stale. Attachment
+// is used by a single thread at a time, so no synchronization is needed and
+// hot scans rarely have to look into the shared TIP cache.
+
+class TransactionStates
+{
+public:
+	TransactionStates()
+	{
+		memset(m_entries, 0, sizeof(m_entries));
+	}
+
+	bool get(TraNumber number, CommitNumber& cn) const
+	{
+		const Entry& entry = m_entries[number % SIZE];
+		if (entry.number != number)
+			return false;
+
+		cn = entry.cn;
+		return true;
+	}
+
+	// Caller is responsible to put final states only
+	void put(TraNumber number, CommitNumber cn)
+	{
+		Entry& entry = m_entries[number % SIZE];
+		entry.number = number;
+		entry.cn = cn;
+	}
+
+private:
+	static const unsigned SIZE = 256;
+
+	struct Entry
+	{
+		TraNumber number;
+		CommitNumber cn;
+	};
+
+	Entry m_entries[SIZE];
+};
+
+
 //
 // RefCounted part of Attachment object, placed into permanent pool
 //
@@ -376,8 +420,14 @@ public:
 		doOnIdleTimer(timer);
 	}
 
+	void onCompactTimer(Firebird::TimerImpl* timer)
+	{
+		doOnCompactTimer(timer);
+	}
+
 protected:
 	virtual void doOnIdleTimer(Firebird::TimerImpl* timer);
+	virtual void doOnCompactTimer(Firebird::TimerImpl* timer);
 
 private:
 	Attachment* att;
@@ -563,6 +613,7 @@ public:
 	jrd_tra*	att_dbkey_trans;			// transaction to control db-key scope
 	TraNumber	att_oldest_snapshot;		// GTT's record versions older than this can be garbage-collected
 	ActiveSnapshots att_active_snapshots;	// List of currently active snapshots for GC purposes
+	TransactionStates att_tra_states;		// Recently resolved final states of transactions
 
 private:
 	jrd_tra*	att_sys_transaction;		// system transaction
@@ -648,6 +699,19 @@ public:
 	Firebird::Array<Function*>		att_functions;			// User defined functions
 	GeneratorFinder					att_generators;
 
+	// Sequence values reserved by this attachment, see SequenceCache setting.
+	// The range is valid while the lock is held, it's released by the blocking
+	// AST when some attachment resets the generator.
+	struct SequenceCacheEntry
+	{
+		SINT64 value;	// last value returned
+		SINT64 step;
+		ULONG left;		// reserved values after it
+		Lock* lock;
+	};
+
+	Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<SLONG, SequenceCacheEntry*> > > att_sequence_cache;
+
 	Firebird::Array<Statement*>	att_internal;			// internal statements
 	Firebird::Array<Statement*>	att_dyn_req;			// internal dyn statements
 	Firebird::ICryptKeyCallback*	att_crypt_callback;		// callback for DB crypt
@@ -765,9 +829,12 @@ public:
 		att_stmt_timeout = timeOut;
 	}
 
-	// evaluate new value or clear idle timer
+	// evaluate new value or clear idle and compact timers
 	void setupIdleTimer(bool clear);
 
+	// free the resources an idle attachment may recreate on demand
+	void compact(thread_db* tdbb);
+
 	// returns time when idle timer will be expired, if set
 	bool getIdleTimerClock(SINT64& clock) const
 	{
@@ -845,6 +912,7 @@ private:
 	unsigned int att_idle_timeout;		// seconds
 	unsigned int att_stmt_timeout;		// milliseconds
 	Firebird::RefPtr<Firebird::TimerImpl> att_idle_timer;
+	Firebird::RefPtr<Firebird::TimerImpl> att_compact_timer;
 
 	Firebird::Array<JBatch*> att_batches;
 	InitialOptions att_initial_options;	// Initial session options
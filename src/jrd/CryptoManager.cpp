@@ -1108,6 +1108,21 @@ namespace Jrd {
 								continue;
 							}
 
+							// read ahead the following pages, they are processed in order
+							if (dbb.dbb_prefetch_pages && !(currentPage % dbb.dbb_prefetch_sequence))
+							{
+								ULONG pages[MAX_READ_AHEAD_PAGES];
+								FB_SIZE_T count = 0;
+
+								for (ULONG next = currentPage + 1;
+									 count < dbb.dbb_prefetch_pages && next < lastPage; next++)
+								{
+									pages[count++] = next;
+								}
+
+								CCH_PREFETCH(tdbb, pages, count);
+							}
+
 							// writing page to disk will change it's crypt status in usual way
 							WIN window(DB_PAGE_SPACE, currentPage);
 							Ods::pag* page = CCH_FETCH(tdbb, &window, LCK_write, pag_undefined);
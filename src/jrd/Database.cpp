@@ -38,6 +38,8 @@
 #include "../jrd/tpc_proto.h"
 #include "../jrd/lck_proto.h"
 #include "../jrd/CryptoManager.h"
+#include "../jrd/RangeSummary.h"
+#include "../jrd/btr.h"
 #include "../jrd/os/pio_proto.h"
 #include "../common/os/os_utils.h"
 //#include "../dsql/Parser.h"
@@ -159,6 +161,8 @@ namespace Jrd
 		}
 
 		delete dbb_tip_cache;
+		delete dbb_range_summaries;
+		delete dbb_index_probes;
 		delete dbb_monitoring_data;
 		delete dbb_backup_manager;
 		delete dbb_crypto_manager;
@@ -88,6 +88,8 @@ class BackupManager;
 class ExternalFileDirectoryList;
 class MonitoringData;
 class GarbageCollector;
+class RangeSummaryCache;
+class IndexProbeCache;
 class CryptoManager;
 class KeywordsMap;
 
@@ -237,6 +239,7 @@ const ULONG DBB_no_fs_cache				= 0x40000L;		// Not using file system cache
 const ULONG DBB_sweep_starting			= 0x80000L;		// Auto-sweep is starting
 const ULONG DBB_creating				= 0x100000L;	// Database creation is in progress
 const ULONG DBB_shared					= 0x200000L;	// Database object is shared among connections
+const ULONG DBB_extended_storage		= 0x800000L;	// Extended storage formats are allowed, see hdr_extended_storage
 //const ULONG DBB_closing					= 0x400000L;	// Database closing, special backgroud threads should exit
 
 //
@@ -478,10 +481,8 @@ public:
 	USHORT dbb_max_records;				// max record per data page
 	USHORT dbb_max_idx;					// max number of indexes on a root page
 
-#ifdef SUPERSERVER_V2
 	USHORT dbb_prefetch_sequence;		// sequence to pace frequency of prefetch requests
 	USHORT dbb_prefetch_pages;			// prefetch pages per request
-#endif
 
 	Firebird::PathName dbb_filename;	// filename string
 	Firebird::PathName dbb_database_name;	// database visible name (file name or alias)
@@ -498,6 +499,9 @@ public:
 
 	Firebird::Mutex dbb_temp_cache_mutex;
 	FB_UINT64 dbb_temp_cache_size;		// total size of in-memory temp space chunks (see TempSpace class)
+	FB_UINT64 dbb_temp_granted;			// total size of memory granted to sorts (see TempMemoryGrant class)
+	ULONG dbb_temp_grantees;			// number of memory grant holders
+	FB_UINT64 dbb_temp_spilled;			// total size of temp space chunks allocated in files
 
 	TraNumber dbb_oldest_active;		// Cached "oldest active" transaction
 	TraNumber dbb_oldest_transaction;	// Cached "oldest interesting" transaction
@@ -510,6 +514,8 @@ public:
 	Firebird::Semaphore dbb_gc_sem;		// Event to wake up garbage collector
 	Firebird::Semaphore dbb_gc_init;	// Event for initialization garbage collector
 	ThreadFinishSync<Database*> dbb_gc_fini;	// Sync for finalization garbage collector
+	RangeSummaryCache*	dbb_range_summaries;	// summaries of data page ranges
+	IndexProbeCache*	dbb_index_probes;		// leaf pages of index key lookups
 
 	Firebird::MemoryStats dbb_memory_stats;
 	RuntimeStatistics dbb_stats;
@@ -542,6 +548,7 @@ public:
 	Lock* dbb_repl_lock;				// replication state lock
 	Firebird::SyncObject dbb_repl_sync;
 	FB_UINT64 dbb_repl_sequence;		// replication sequence
+	Firebird::AtomicCounter dbb_repl_conflicts;	// conflicts resolved while applying replicated changes
 	ReplicaMode dbb_replica_mode;		// replica access mode
 
 	unsigned dbb_compatibility_index;	// datatype backward compatibility level
@@ -606,7 +613,12 @@ private:
 		dbb_owner(*p),
 		dbb_pools(*p, 4),
 		dbb_sort_buffers(*p),
+		dbb_temp_granted(0),
+		dbb_temp_grantees(0),
+		dbb_temp_spilled(0),
 		dbb_gc_fini(*p, garbage_collector, THREAD_medium),
+		dbb_range_summaries(NULL),
+		dbb_index_probes(NULL),
 		dbb_stats(*p),
 		dbb_lock_owner_id(getLockOwnerId()),
 		dbb_tip_cache(NULL),
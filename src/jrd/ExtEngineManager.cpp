@@ -731,7 +731,9 @@ ExtEngineManager::Function::Function(thread_db* tdbb, ExtEngineManager* aExtMana
 		const Jrd::Function* aUdf)
 	: ExtRoutine(tdbb, aExtManager, aEngine, aMetadata),
 	  function(aFunction),
-	  udf(aUdf)
+	  udf(aUdf),
+	  charSet(CS_NONE),
+	  charSetResolved(false)
 {
 }
 
@@ -747,16 +749,34 @@ void ExtEngineManager::Function::execute(thread_db* tdbb, UCHAR* inMsg, UCHAR* o
 {
 	EngineAttachmentInfo* attInfo = extManager->getEngineAttachment(tdbb, engine);
 	const MetaString& userName = udf->invoker ? udf->invoker->getUserName() : "";
-	ContextManager<IExternalFunction> ctxManager(tdbb, attInfo, function,
-		(udf->getName().package.isEmpty() ?
-			CallerName(obj_udf, udf->getName().identifier, userName) :
-			CallerName(obj_package_header, udf->getName().package, userName)));
+	const CallerName callerName(udf->getName().package.isEmpty() ?
+		CallerName(obj_udf, udf->getName().identifier, userName) :
+		CallerName(obj_package_header, udf->getName().package, userName));
 
-	EngineCheckout cout(tdbb, FB_FUNCTION, checkoutType(attInfo->engine));
+	const auto doExecute = [&]()
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION, checkoutType(attInfo->engine));
 
-	FbLocalStatus status;
-	function->execute(&status, attInfo->context, inMsg, outMsg);
-	status.check();
+		FbLocalStatus status;
+		function->execute(&status, attInfo->context, inMsg, outMsg);
+		status.check();
+	};
+
+	// The function character set is constant, ask the engine for it (and look it up
+	// in metadata) only on the first call instead of once per row.
+
+	if (charSetResolved)
+	{
+		ContextManager<IExternalFunction> ctxManager(tdbb, attInfo, charSet, callerName);
+		doExecute();
+		return;
+	}
+
+	ContextManager<IExternalFunction> ctxManager(tdbb, attInfo, function, callerName);
+	charSet = tdbb->getAttachment()->att_charset;
+	charSetResolved = true;
+
+	doExecute();
 }
 
 
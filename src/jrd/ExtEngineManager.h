@@ -238,6 +238,8 @@ public:
 	private:
 		Firebird::IExternalFunction* function;
 		const Jrd::Function* udf;
+		mutable USHORT charSet;
+		mutable bool charSetResolved;
 	};
 
 	class ResultSet;
@@ -23,6 +23,7 @@
 #include "../common/classes/alloc.h"
 #include "../jrd/GarbageCollector.h"
 #include "../jrd/tra.h"
+#include "../jrd/btr.h"
 
 using namespace Jrd;
 using namespace Firebird;
@@ -33,6 +34,7 @@ namespace Jrd {
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_indexKeys.free();
 }
 
 
@@ -48,6 +50,8 @@ TraNumber GarbageCollector::RelationData::findPage(const ULONG pageno, const Tra
 	if (pages.current().tranid > tranid)
 		pages.current().tranid = tranid;
 
+	pages.current().hits++;
+
 	return pages.current().tranid;
 }
 
@@ -69,7 +73,8 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 	bool next = pages.getFirst();
 	while (next)
 	{
-		if (pages.current().tranid < oldest_snapshot)
+		if (pages.current().tranid < oldest_snapshot ||
+			pages.current().hits >= INTERMEDIATE_GC_HITS)
 		{
 			if (bm)
 			{
@@ -156,6 +161,103 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 }
 
 
+bool GarbageCollector::addIndexKey(const USHORT relID, const USHORT idxID, const ULONG root,
+	const temporary_key& key, const RecordNumber number)
+{
+	Sync syncGC(&m_sync, "GarbageCollector::addIndexKey");
+	RelationData* relData = getRelData(syncGC, relID, true);
+
+	SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::addIndexKey");
+	syncGC.unlock();
+
+	Array<UCHAR>& keys = relData->m_indexKeys;
+	const FB_SIZE_T size = GarbageKey::getSize(key.key_length);
+
+	// Let the caller remove the key itself if the garbage collector lags behind
+	if (keys.getCount() + size > MAX_INDEX_KEYS_SIZE)
+		return false;
+
+	GarbageKey* const item = reinterpret_cast<GarbageKey*>(keys.getBuffer(keys.getCount() + size) +
+		keys.getCount() - size);
+
+	item->number = number.getValue();
+	item->root = root;
+	item->idxID = idxID;
+	item->length = key.key_length;
+	item->nulls = key.key_nulls;
+	item->flags = key.key_flags;
+	memcpy(item + 1, key.key_data, key.key_length);
+
+	return true;
+}
+
+
+bool GarbageCollector::getIndexKeys(USHORT& relID, Array<UCHAR>& keys)
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getIndexKeys");
+
+	FB_SIZE_T pos;
+	if (!m_relations.find(m_nextKeysRelID, pos) && (pos == m_relations.getCount()))
+		pos = 0;
+
+	for (FB_SIZE_T n = 0; n < m_relations.getCount(); n++, pos++)
+	{
+		if (pos == m_relations.getCount())
+			pos = 0;
+
+		RelationData* relData = m_relations[pos];
+		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getIndexKeys");
+
+		if (relData->m_indexKeys.hasData())
+		{
+			keys.assign(relData->m_indexKeys);
+			relData->m_indexKeys.clear();
+
+			relID = relData->getRelID();
+			m_nextKeysRelID = relID + 1;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+void GarbageCollector::removeIndex(const USHORT relID, const USHORT idxID)
+{
+	Sync syncGC(&m_sync, "GarbageCollector::removeIndex");
+
+	RelationData* relData = getRelData(syncGC, relID, false);
+	if (relData)
+	{
+		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::removeIndex");
+		syncGC.unlock();
+
+		Array<UCHAR>& keys = relData->m_indexKeys;
+		FB_SIZE_T offset = 0, length = 0;
+
+		// Keep the keys of other indices in their order
+		while (offset < keys.getCount())
+		{
+			const GarbageKey* const item = reinterpret_cast<const GarbageKey*>(keys.begin() + offset);
+			const FB_SIZE_T size = GarbageKey::getSize(item->length);
+
+			if (item->idxID != idxID)
+			{
+				if (length != offset)
+					memmove(keys.begin() + length, item, size);
+
+				length += size;
+			}
+
+			offset += size;
+		}
+
+		keys.shrink(length);
+	}
+}
+
+
 void GarbageCollector::removeRelation(const USHORT relID)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::removeRelation");
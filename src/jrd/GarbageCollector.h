@@ -28,18 +28,20 @@
 #include "../common/classes/GenericMap.h"
 #include "../common/classes/SyncObject.h"
 #include "../jrd/sbm.h"
+#include "../jrd/RecordNumber.h"
 
 
 namespace Jrd {
 
 class Database;
 class Savepoint;
+struct temporary_key;
 
 class GarbageCollector
 {
 public:
 	GarbageCollector(MemoryPool& p, Database* dbb)
-	  : m_pool(p), m_relations(m_pool), m_nextRelID(0)
+	  : m_pool(p), m_relations(m_pool), m_nextRelID(0), m_nextKeysRelID(0)
 	{}
 
 	~GarbageCollector();
@@ -49,21 +51,60 @@ public:
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
 
+	// Garbage index keys whose removal is deferred to the garbage collector thread
+
+	struct GarbageKey
+	{
+		SINT64 number;		// record number
+		ULONG root;			// index root page when the key was queued
+		USHORT idxID;
+		USHORT length;
+		USHORT nulls;
+		UCHAR flags;
+		// key data follows
+
+		const UCHAR* getData() const
+		{
+			return reinterpret_cast<const UCHAR*>(this + 1);
+		}
+
+		static FB_SIZE_T getSize(USHORT length)
+		{
+			return FB_ALIGN(sizeof(GarbageKey) + length, alignof(GarbageKey));
+		}
+	};
+
+	static const FB_SIZE_T MAX_INDEX_KEYS_SIZE = 1024 * 1024;	// per relation
+
+	bool addIndexKey(const USHORT relID, const USHORT idxID, const ULONG root,
+		const temporary_key& key, const RecordNumber number);
+	bool getIndexKeys(USHORT& relID, Firebird::Array<UCHAR>& keys);
+	void removeIndex(const USHORT relID, const USHORT idxID);
+
 private:
+	// Number of notifications about a data page after which it's given to the
+	// garbage collector even if its garbage is not older than the oldest snapshot.
+	// Such pages usually have long version chains of hot records, the garbage
+	// collector prunes intermediate versions of all records on the page at once.
+	static const ULONG INTERMEDIATE_GC_HITS = 256;
+
 	struct PageTran
 	{
 		PageTran() :
 			pageno(0),
-			tranid(0)
+			tranid(0),
+			hits(0)
 		{}
 
 		PageTran(const ULONG _pageno, const TraNumber _tranid) :
 			pageno(_pageno),
-			tranid(_tranid)
+			tranid(_tranid),
+			hits(1)
 		{}
 
 		ULONG pageno;
 		TraNumber tranid;
+		ULONG hits;
 
 		static const ULONG& generate(const void*, const PageTran& item)
 		{
@@ -77,7 +118,7 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_indexKeys(p), m_relID(relID)
 		{}
 
 		~RelationData()
@@ -104,6 +145,7 @@ private:
 		Firebird::MemoryPool& m_pool;
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
+		Firebird::Array<UCHAR> m_indexKeys;		// sequence of GarbageKey
 		USHORT m_relID;
 	};
 
@@ -119,6 +161,7 @@ private:
 	Firebird::SyncObject m_sync;
 	RelGarbageArray m_relations;
 	USHORT m_nextRelID;
+	USHORT m_nextKeysRelID;
 };
 
 } // namespace Jrd
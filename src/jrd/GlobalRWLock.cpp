@@ -61,6 +61,7 @@ int GlobalRWLock::blocking_ast_cached_lock(void* ast_object)
 		AsyncContextHolder tdbb(dbb, FB_FUNCTION);
 
 		MutexLockGuard counterGuard(globalRWLock->counterMutex, FB_FUNCTION);
+		globalRWLock->disableFastRead();
 		globalRWLock->blockingAstHandler(tdbb);
 	}
 	catch (const Exception&)
@@ -71,11 +72,14 @@ int GlobalRWLock::blocking_ast_cached_lock(void* ast_object)
 
 GlobalRWLock::GlobalRWLock(thread_db* tdbb, MemoryPool& p, lck_t lckType,
 						   bool lock_caching, FB_SIZE_T lockLen, const UCHAR* lockStr)
-	: PermanentStorage(p), pendingLock(0), readers(0), pendingWriters(0), currentWriter(false),
+	: PermanentStorage(p), pendingLock(0), fastRead(false), pendingWriters(0), currentWriter(false),
 	  lockCaching(lock_caching), blocking(false)
 {
 	SET_TDBB(tdbb);
 
+	for (auto& slot : readerSlots)
+		slot.count = 0;
+
 	cachedLock = FB_NEW_RPT(getPool(), lockLen)
 		Lock(tdbb, lockLen, lckType, this, lockCaching ? blocking_ast_cached_lock : NULL);
 	memcpy(cachedLock->getKeyPtr(), lockStr, lockLen);
@@ -86,14 +90,60 @@ GlobalRWLock::~GlobalRWLock()
 	delete cachedLock;
 }
 
+GlobalRWLock::ReaderSlot& GlobalRWLock::getReaderSlot()
+{
+	const U_IPTR id = (U_IPTR) getThreadId();
+	return readerSlots[(id ^ (id >> 12)) % READER_SLOTS];
+}
+
+int GlobalRWLock::getReaders() const
+{
+	int count = 0;
+
+	for (const auto& slot : readerSlots)
+		count += slot.count;
+
+	return count;
+}
+
+void GlobalRWLock::enableFastRead()
+{
+	// Called with counterMutex locked by a reader owning the cached lock
+
+	if (lockCaching && !pendingLock && !pendingWriters && !currentWriter && !blocking &&
+		cachedLock->lck_physical >= LCK_read)
+	{
+		fastRead = true;
+	}
+}
+
+void GlobalRWLock::releaseUnused(thread_db* tdbb)
+{
+	// Called with counterMutex locked and fast path disabled when some reader has gone.
+	// Release the lock if nobody uses it and it's needed by somebody else.
+
+	if (getReaders())
+		return;
+
+	if (cachedLock->lck_physical > LCK_none && !currentWriter && !pendingLock &&
+		(!lockCaching || pendingWriters || blocking))
+	{
+		LCK_release(tdbb, cachedLock);	// Release since concurrent request needs LCK_write
+		invalidate(tdbb);
+	}
+
+	noReaders.notifyAll();
+}
+
 void GlobalRWLock::shutdownLock(thread_db* tdbb)
 {
 	SET_TDBB(tdbb);
 
 	CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
+	disableFastRead();
 
 	COS_TRACE(("(%p)->shutdownLock readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 	LCK_release(tdbb, cachedLock);
 }
@@ -106,17 +156,18 @@ bool GlobalRWLock::lockWrite(thread_db* tdbb, SSHORT wait)
 		CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
 
 		COS_TRACE(("(%p)->lockWrite stage 1 readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		disableFastRead();
 		++pendingWriters;
 
-		while (readers > 0 )
+		while (getReaders() > 0)
 		{
 			EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 			noReaders.wait(counterMutex);
 		}
 
 		COS_TRACE(("(%p)->lockWrite stage 2 readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 		while (currentWriter || pendingLock)
 		{
@@ -125,9 +176,9 @@ bool GlobalRWLock::lockWrite(thread_db* tdbb, SSHORT wait)
 		}
 
 		COS_TRACE(("(%p)->lockWrite stage 3 readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
-		fb_assert(!readers && !currentWriter);
+		fb_assert(!getReaders() && !currentWriter);
 
 		if (cachedLock->lck_physical == LCK_write)
 		{
@@ -149,7 +200,7 @@ bool GlobalRWLock::lockWrite(thread_db* tdbb, SSHORT wait)
 	}
 
 	COS_TRACE(("(%p)->lockWrite LCK_lock readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d), pendingLock(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical, pendingLock));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical, pendingLock));
 
 	if (!LCK_lock(tdbb, cachedLock, LCK_write, wait))
 	{
@@ -182,7 +233,7 @@ bool GlobalRWLock::lockWrite(thread_db* tdbb, SSHORT wait)
 		currentWriter = true;
 
 		COS_TRACE(("(%p)->lockWrite end readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 		return fetch(tdbb);
 	}
@@ -195,7 +246,7 @@ void GlobalRWLock::unlockWrite(thread_db* tdbb, const bool release)
 	CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
 
 	COS_TRACE(("(%p)->unlockWrite readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 	currentWriter = false;
 
@@ -211,27 +262,39 @@ void GlobalRWLock::unlockWrite(thread_db* tdbb, const bool release)
 
 	writerFinished.notifyAll();
 	COS_TRACE(("(%p)->unlockWrite end readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 }
 
 bool GlobalRWLock::lockRead(thread_db* tdbb, SSHORT wait, const bool queueJump)
 {
 	SET_TDBB(tdbb);
 
+	// Fast path, see comments in the header
+
+	ReaderSlot& slot = getReaderSlot();
+
+	++slot.count;
+	if (fastRead)
+		return true;
+	--slot.count;
+
 	bool needFetch;
 
 	{	// scope 1
 		CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
 
+		// Somebody could see our short living increment above and wait for readers to go
+		releaseUnused(tdbb);
+
 		COS_TRACE(("(%p)->lockRead stage 1 readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 		while (true)
 		{
-			if (readers > 0 && queueJump)
+			if (queueJump && getReaders() > 0)
 			{
 				COS_TRACE(("(%p)->lockRead queueJump", this));
-				readers++;
+				++slot.count;
 				return true;
 			}
 
@@ -242,7 +305,7 @@ bool GlobalRWLock::lockRead(thread_db* tdbb, SSHORT wait, const bool queueJump)
 			}
 
 			COS_TRACE(("(%p)->lockRead stage 3 readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-				this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+				this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
 			if (!pendingLock)
 				break;
@@ -255,7 +318,8 @@ bool GlobalRWLock::lockRead(thread_db* tdbb, SSHORT wait, const bool queueJump)
 		needFetch = cachedLock->lck_physical < LCK_read;
 		if (!needFetch)
 		{
-			++readers;
+			++slot.count;
+			enableFastRead();
 			return true;
 		}
 
@@ -279,12 +343,16 @@ bool GlobalRWLock::lockRead(thread_db* tdbb, SSHORT wait, const bool queueJump)
 	{	// scope 2
 		CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
 		--pendingLock;
-		++readers;
+		++slot.count;
 
 		COS_TRACE(("(%p)->lockRead end readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-			this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+			this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
-		return fetch(tdbb);
+		if (!fetch(tdbb))
+			return false;
+
+		enableFastRead();
+		return true;
 	}
 }
 
@@ -292,34 +360,31 @@ void GlobalRWLock::unlockRead(thread_db* tdbb)
 {
 	SET_TDBB(tdbb);
 
+	// The lock could be taken by other thread, slot counter may become negative then
+	--getReaderSlot().count;
+
+	if (fastRead)
+		return;
+
 	CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
 
 	COS_TRACE(("(%p)->unlockRead readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
-	readers--;
-
-	if (!readers)
-	{
-		if (!lockCaching || pendingWriters || blocking)
-		{
-			LCK_release(tdbb, cachedLock);	// Release since concurrent request needs LCK_write
-			invalidate(tdbb);
-		}
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+	releaseUnused(tdbb);
 
-		noReaders.notifyAll();
-	}
 	COS_TRACE(("(%p)->unlockRead end readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 }
 
 bool GlobalRWLock::tryReleaseLock(thread_db* tdbb)
 {
 	CheckoutLockGuard counterGuard(tdbb, counterMutex, FB_FUNCTION, true);
+	disableFastRead();
 
 	COS_TRACE(("(%p)->tryReleaseLock readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
 
-	if (readers || currentWriter)
+	if (getReaders() || currentWriter)
 		return false;
 
 	if (cachedLock->lck_physical > LCK_none)
@@ -335,9 +400,13 @@ void GlobalRWLock::blockingAstHandler(thread_db* tdbb)
 {
 	SET_TDBB(tdbb);
 
+	disableFastRead();
+
 	COS_TRACE(("(%p)->blockingAst enter", this));
 	COS_TRACE(("(%p)->blockingAst readers(%d), blocking(%d), pendingWriters(%d), currentWriter(%d), lck_physical(%d)",
-		this, readers, blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+		this, getReaders(), blocking, pendingWriters, currentWriter, cachedLock->lck_physical));
+
+	const int readers = getReaders();
 
 	if (!pendingLock && !currentWriter && !readers)
 	{
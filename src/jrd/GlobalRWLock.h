@@ -37,6 +37,7 @@
 #include "fb_types.h"
 #include "os/pio.h"
 #include "../common/classes/condition.h"
+#include <atomic>
 
 //#define COS_DEBUG
 
@@ -81,7 +82,7 @@ protected:
 	virtual bool fetch(thread_db* /*tdbb*/) { return true; }
 	virtual void invalidate(thread_db* /*tdbb*/)
 	{
-		fb_assert(readers == 0);
+		fb_assert(getReaders() == 0);
 		blocking = false;
 	}
 
@@ -89,10 +90,37 @@ protected:
 
 	Firebird::Mutex counterMutex;	// Protects counter and blocking flag
 
+	// Number of current readers, should be called with counterMutex locked and fast
+	// path disabled to be exact
+	int getReaders() const;
+
+	void disableFastRead()
+	{
+		fastRead = false;
+	}
+
 private:
+	// Readers are counted in cache line sized slots selected by thread, so concurrent
+	// readers do not share the same counter. While fastRead is set, readers don't
+	// take counterMutex: the lock is cached in the shared mode and nobody is waiting
+	// for it. Code that changes this clears fastRead first and then sums the slots,
+	// readers increment their slot first and then check fastRead.
+	static const unsigned READER_SLOTS = 16;
+
+	struct ReaderSlot
+	{
+		std::atomic<int> count;
+		char padding[64 - sizeof(std::atomic<int>)];
+	};
+
+	ReaderSlot& getReaderSlot();
+	void enableFastRead();
+	void releaseUnused(thread_db* tdbb);
+
 	ULONG pendingLock;
 
-	ULONG	readers;
+	ReaderSlot readerSlots[READER_SLOTS];
+	std::atomic<bool> fastRead;
 	Firebird::Condition noReaders;		// Semaphore to wait all readers unlock to start relock
 
 	ULONG	pendingWriters;
@@ -61,25 +61,22 @@ using namespace Jrd;
 
 namespace
 {
-	class DumpWriter : public SnapshotData::DumpRecord::Writer
+	class BufferWriter : public SnapshotData::DumpRecord::Writer
 	{
 	public:
-		DumpWriter(MonitoringData* data, AttNumber att_id, const char* user_name, ULONG generation)
-			: dump(data), offset(dump->setup(att_id, user_name, generation))
-		{
-			fb_assert(offset);
-		}
+		BufferWriter(UCharBuffer& buf)
+			: buffer(buf)
+		{}
 
 		void write(const SnapshotData::DumpRecord& record)
 		{
 			const ULONG length = record.getLength();
-			dump->write(offset, sizeof(ULONG), &length);
-			dump->write(offset, length, record.getData());
+			buffer.add(reinterpret_cast<const UCHAR*>(&length), sizeof(ULONG));
+			buffer.add(record.getData(), length);
 		}
 
 	private:
-		MonitoringData* const dump;
-		const ULONG offset;
+		UCharBuffer& buffer;
 	};
 
 	class TempWriter : public SnapshotData::DumpRecord::Writer
@@ -955,6 +952,14 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 		MutexLockGuard guard(dbb->dbb_stats_mutex, FB_FUNCTION);
 		putStatistics(record, dbb->dbb_stats, stat_id, stat_database);
 		putMemoryUsage(record, dbb->dbb_memory_stats, stat_id, stat_database);
+
+		// Page cache is the largest consumer of the database memory, report it separately.
+		// Its usage is a part of the database level usage reported above.
+		if (dbb->dbb_bcb)
+		{
+			putMemoryUsage(record, dbb->dbb_bcb->bcb_memory_stats,
+				fb_utils::genUniqueId(), stat_page_cache);
+		}
 	}
 	else
 	{
@@ -1466,10 +1471,11 @@ void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG g
 
 	attachment->att_monitor_generation = generation;
 
-	MonitoringData::Guard guard(dbb->dbb_monitoring_data);
-	dbb->dbb_monitoring_data->cleanup(attId);
+	// Collect the dump locally, so the shared memory mutex is held only while
+	// it's copied, not while plans and statistics are being prepared
 
-	DumpWriter writer(dbb->dbb_monitoring_data, attId, userName.c_str(), generation);
+	UCharBuffer dump(pool);
+	BufferWriter writer(dump);
 	SnapshotData::DumpRecord record(pool, writer);
 
 	putAttachment(record, attachment);
@@ -1530,6 +1536,15 @@ void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG g
 			putRequest(record, request, plan);
 		}
 	}
+
+	MonitoringData::Guard guard(dbb->dbb_monitoring_data);
+	dbb->dbb_monitoring_data->cleanup(attId);
+
+	const ULONG offset = dbb->dbb_monitoring_data->setup(attId, userName.c_str(), generation);
+	fb_assert(offset);
+
+	if (dump.hasData())
+		dbb->dbb_monitoring_data->write(offset, dump.getCount(), dump.begin());
 }
 
 
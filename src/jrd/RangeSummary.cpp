@@ -0,0 +1,552 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird development team
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 the Firebird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../common/classes/auto.h"
+#include "../jrd/RangeSummary.h"
+#include "../jrd/jrd.h"
+#include "../jrd/lck.h"
+#include "../jrd/req.h"
+#include "../jrd/tra.h"
+#include "../jrd/RecordSourceNodes.h"
+#include "../jrd/cch_proto.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/mov_proto.h"
+#include "../jrd/vio_proto.h"
+
+using namespace Jrd;
+using namespace Firebird;
+
+
+RangeSummary::RangeSummary(MemoryPool& p, USHORT relId, USHORT fieldId, USHORT formatVersion,
+						   const dsc& desc, ULONG rangePages)
+	: PermanentStorage(p),
+	  m_relId(relId),
+	  m_fieldId(fieldId),
+	  m_formatVersion(formatVersion),
+	  m_desc(desc),
+	  m_rangePages(rangePages),
+	  m_ranges(p),
+	  m_oldest(0),
+	  m_ready(false),
+	  m_scanning(true),
+	  m_obsolete(false)
+{
+	fb_assert(isSupported(desc));
+}
+
+bool RangeSummary::isSupported(const dsc& desc)
+{
+	switch (desc.dsc_dtype)
+	{
+		case dtype_short:
+		case dtype_long:
+		case dtype_int64:
+		case dtype_int128:
+		case dtype_real:
+		case dtype_double:
+		case dtype_sql_date:
+		case dtype_sql_time:
+		case dtype_sql_time_tz:
+		case dtype_timestamp:
+		case dtype_timestamp_tz:
+			return desc.dsc_length <= MAX_VALUE_LENGTH;
+
+		default:
+			return false;
+	}
+}
+
+void RangeSummary::build(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction)
+{
+	summarize(tdbb, relation, transaction, NULL);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	m_oldest = transaction->tra_oldest;
+	m_scanning = false;
+	m_ready = true;
+}
+
+void RangeSummary::refresh(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction)
+{
+	// Invalid ranges may be summarized again after the transactions
+	// that made them invalid are finished
+
+	Array<ULONG> ranges(*tdbb->getDefaultPool());
+
+	{ // scope
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_scanning || transaction->tra_oldest <= m_oldest)
+			return;
+
+		m_oldest = transaction->tra_oldest;
+
+		for (ULONG i = 0; i < m_ranges.getCount(); i++)
+		{
+			if (m_ranges[i].invalid)
+				ranges.add(i);
+		}
+
+		if (ranges.isEmpty())
+			return;
+
+		m_scanning = true;
+	}
+
+	try
+	{
+		summarize(tdbb, relation, transaction, &ranges);
+	}
+	catch (const Exception&)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_scanning = false;
+		throw;
+	}
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+	m_scanning = false;
+}
+
+void RangeSummary::add(thread_db* tdbb, jrd_rel* relation, RecordNumber number, Record* record)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_obsolete)
+		return;
+
+	// Values of other formats may not fit the summarized data type,
+	// the summary is to be built again for the new format
+
+	if (record->getFormat()->fmt_version != m_formatVersion)
+	{
+		m_obsolete = true;
+		return;
+	}
+
+	dsc desc;
+	if (EVL_field(relation, record, m_fieldId, &desc))
+		add(tdbb, getRangeNumber(tdbb, number), &desc);
+}
+
+void RangeSummary::getCandidates(thread_db* tdbb, const dsc* lower, const dsc* upper,
+								 UInt32Bitmap& candidates)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	for (ULONG i = 0; i < m_ranges.getCount(); i++)
+	{
+		if (isCandidate(tdbb, m_ranges[i], lower, upper))
+			candidates.set(i);
+	}
+}
+
+ULONG RangeSummary::getRangeNumber(thread_db* tdbb, RecordNumber number) const
+{
+	const Database* const dbb = tdbb->getDatabase();
+	return (ULONG) (number.getValue() / dbb->dbb_max_records / m_rangePages);
+}
+
+RangeSummary::Range* RangeSummary::getRange(ULONG number)
+{
+	// New ranges are valid and empty, records stored into them later
+	// are added to the summary when stored
+
+	if (number >= m_ranges.getCount())
+		m_ranges.grow(number + 1);
+
+	return &m_ranges[number];
+}
+
+void RangeSummary::summarize(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+							 const Array<ULONG>* ranges)
+{
+/**************************************
+ *
+ * Functional description
+ *	Walk primary record versions of the whole relation or of the given
+ *	ranges and add their values to the summary. Record versions are
+ *	summarized only when they are the only ones and are committed before
+ *	any active transaction started, otherwise their ranges are invalid.
+ *
+ **************************************/
+	const Database* const dbb = tdbb->getDatabase();
+	const TraNumber oldest = transaction->tra_oldest;
+	const SINT64 rangeRecords = (SINT64) m_rangePages * dbb->dbb_max_records;
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+	rpb.rpb_org_scans = relation->rel_scan_count++;
+
+	FB_SIZE_T pos = 0;
+	ULONG current = ranges ? (*ranges)[pos] : 0;
+	bool clean = true;
+
+	rpb.rpb_number.setValue(ranges ? current * rangeRecords - 1 : BOF_NUMBER);
+
+	try
+	{
+		while (true)
+		{
+			const bool found = DPM_next(tdbb, &rpb, LCK_read, DPM_next_all);
+			const ULONG number = found ? getRangeNumber(tdbb, rpb.rpb_number) : MAX_ULONG;
+
+			if (ranges && number != current)
+			{
+				// All records of the current range are seen
+
+				if (found)
+					CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+				if (clean)
+				{
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+					getRange(current)->invalid = false;
+				}
+
+				if (++pos >= ranges->getCount())
+					break;
+
+				current = (*ranges)[pos];
+				clean = true;
+
+				rpb.rpb_number.setValue(current * rangeRecords - 1);
+				continue;
+			}
+
+			if (!found)
+				break;
+
+			if (rpb.rpb_b_page || rpb.rpb_transaction_nr >= oldest ||
+				(rpb.rpb_flags & (rpb_deleted | rpb_damaged | rpb_gc_active)))
+			{
+				// Other versions of the record may be visible to somebody
+
+				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+				clean = false;
+
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				getRange(number)->invalid = true;
+			}
+			else
+			{
+				VIO_data(tdbb, &rpb, tdbb->getDefaultPool());
+
+				dsc desc;
+				if (EVL_field(relation, rpb.rpb_record, m_fieldId, &desc))
+				{
+					MutexLockGuard guard(m_mutex, FB_FUNCTION);
+					add(tdbb, number, &desc);
+				}
+			}
+
+			JRD_reschedule(tdbb);
+		}
+	}
+	catch (const Exception&)
+	{
+		if (relation->rel_scan_count)
+			relation->rel_scan_count--;
+
+		delete rpb.rpb_record;
+		throw;
+	}
+
+	if (relation->rel_scan_count)
+		relation->rel_scan_count--;
+
+	delete rpb.rpb_record;
+}
+
+void RangeSummary::add(thread_db* tdbb, ULONG number, const dsc* value)
+{
+	Range* const range = getRange(number);
+
+	dsc low = m_desc;
+	low.dsc_address = range->low;
+
+	dsc high = m_desc;
+	high.dsc_address = range->high;
+
+	try
+	{
+		if (!range->hasValues)
+		{
+			MOV_move(tdbb, const_cast<dsc*>(value), &low);
+			MOV_move(tdbb, const_cast<dsc*>(value), &high);
+			range->hasValues = true;
+		}
+		else if (MOV_compare(tdbb, value, &low) < 0)
+			MOV_move(tdbb, const_cast<dsc*>(value), &low);
+		else if (MOV_compare(tdbb, value, &high) > 0)
+			MOV_move(tdbb, const_cast<dsc*>(value), &high);
+
+		// Values of older formats must not be rounded while converted
+
+		if ((value->dsc_dtype != m_desc.dsc_dtype || value->dsc_scale != m_desc.dsc_scale) &&
+			(MOV_compare(tdbb, value, &low) < 0 || MOV_compare(tdbb, value, &high) > 0))
+		{
+			range->invalid = true;
+		}
+	}
+	catch (const Exception&)
+	{
+		range->invalid = true;
+	}
+}
+
+bool RangeSummary::isCandidate(thread_db* tdbb, Range& range, const dsc* lower, const dsc* upper) const
+{
+	if (range.invalid)
+		return true;
+
+	if (!range.hasValues)
+		return false;
+
+	dsc desc = m_desc;
+
+	if (lower)
+	{
+		desc.dsc_address = range.high;
+
+		if (MOV_compare(tdbb, &desc, lower) < 0)
+			return false;
+	}
+
+	if (upper)
+	{
+		desc.dsc_address = range.low;
+
+		if (MOV_compare(tdbb, &desc, upper) > 0)
+			return false;
+	}
+
+	return true;
+}
+
+
+RangeSummaryCache::~RangeSummaryCache()
+{
+	for (const auto summary : m_summaries)
+		summary->release();
+}
+
+UInt32Bitmap* RangeSummaryCache::getCandidates(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+											   const Array<FieldRangeNode*>& ranges, MemoryPool& pool)
+{
+/**************************************
+ *
+ * Functional description
+ *	Return numbers of the page ranges that may contain records matching
+ *	all the given field bounds, or NULL if summaries are not available.
+ *
+ **************************************/
+	Request* const request = tdbb->getRequest();
+
+	AutoPtr<UInt32Bitmap> result;
+
+	for (const auto node : ranges)
+	{
+		const dsc* lower = NULL;
+		const dsc* upper = NULL;
+
+		if (node->lower)
+		{
+			lower = EVL_expr(tdbb, request, node->lower);
+
+			// Comparison with NULL is never true, so nothing is to be scanned
+
+			if ((request->req_flags & req_null) || !lower)
+				return FB_NEW_POOL(pool) UInt32Bitmap(pool);
+		}
+
+		if (node->upper)
+		{
+			upper = EVL_expr(tdbb, request, node->upper);
+
+			if ((request->req_flags & req_null) || !upper)
+				return FB_NEW_POOL(pool) UInt32Bitmap(pool);
+		}
+
+		const auto summary = getSummary(tdbb, relation, transaction, node->fieldId);
+
+		if (!summary)
+			continue;
+
+		AutoPtr<UInt32Bitmap> candidates(FB_NEW_POOL(pool) UInt32Bitmap(pool));
+		summary->getCandidates(tdbb, lower, upper, *candidates);
+
+		if (result)
+		{
+			AutoPtr<UInt32Bitmap> common(FB_NEW_POOL(pool) UInt32Bitmap(pool));
+
+			if (result->getFirst())
+			{
+				do
+				{
+					const ULONG number = result->current();
+
+					if (candidates->test(number))
+						common->set(number);
+				} while (result->getNext());
+			}
+
+			result = common.release();
+		}
+		else
+			result = candidates.release();
+	}
+
+	return result.release();
+}
+
+void RangeSummaryCache::recordChanged(thread_db* tdbb, jrd_rel* relation, RecordNumber number, Record* record)
+{
+	if (!m_count.value())
+		return;
+
+	SyncLockGuard guard(&m_sync, SYNC_SHARED, FB_FUNCTION);
+
+	for (const auto summary : m_summaries)
+	{
+		if (summary->getRelationId() == relation->rel_id)
+			summary->add(tdbb, relation, number, record);
+	}
+}
+
+void RangeSummaryCache::removeRelation(USHORT relId)
+{
+	SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+	for (FB_SIZE_T i = 0; i < m_summaries.getCount();)
+	{
+		const auto summary = m_summaries[i];
+
+		if (summary->getRelationId() == relId)
+		{
+			m_summaries.remove(i);
+			--m_count;
+			summary->release();
+		}
+		else
+			i++;
+	}
+}
+
+RefPtr<RangeSummary> RangeSummaryCache::getSummary(thread_db* tdbb, jrd_rel* relation,
+	jrd_tra* transaction, USHORT fieldId)
+{
+	const Format* const format = MET_current(tdbb, relation);
+
+	if (fieldId >= format->fmt_count || !RangeSummary::isSupported(format->fmt_desc[fieldId]))
+		return RefPtr<RangeSummary>();
+
+	RefPtr<RangeSummary> summary;
+
+	{ // scope
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		for (FB_SIZE_T i = 0; i < m_summaries.getCount(); i++)
+		{
+			const auto item = m_summaries[i];
+
+			if (item->getRelationId() == relation->rel_id && item->getFieldId() == fieldId)
+			{
+				if (!item->isObsolete() && item->getFormatVersion() == format->fmt_version)
+				{
+					// Don't wait for the summary being built by another scan
+
+					if (!item->isReady())
+						return RefPtr<RangeSummary>();
+
+					summary = item;
+				}
+				else
+				{
+					m_summaries.remove(i);
+					--m_count;
+					item->release();
+				}
+
+				break;
+			}
+		}
+	}
+
+	if (summary)
+	{
+		summary->refresh(tdbb, relation, transaction);
+		return summary;
+	}
+
+	// Tables of a couple of page ranges are not worth summarizing
+
+	if (DPM_data_pages(tdbb, relation) < 2 * m_rangePages)
+		return RefPtr<RangeSummary>();
+
+	summary = FB_NEW_POOL(m_pool) RangeSummary(m_pool, relation->rel_id, fieldId,
+		format->fmt_version, format->fmt_desc[fieldId], m_rangePages);
+
+	{ // scope
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		// Another scan could register the summary meanwhile
+
+		for (const auto item : m_summaries)
+		{
+			if (item->getRelationId() == relation->rel_id && item->getFieldId() == fieldId)
+				return RefPtr<RangeSummary>();
+		}
+
+		// The summary must see changes made since now and up to the end of its building
+
+		summary->addRef();
+		m_summaries.add(summary);
+		++m_count;
+	}
+
+	try
+	{
+		summary->build(tdbb, relation, transaction);
+	}
+	catch (const Exception&)
+	{
+		SyncLockGuard guard(&m_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		FB_SIZE_T pos;
+		if (m_summaries.find(summary, pos))
+		{
+			m_summaries.remove(pos);
+			--m_count;
+			summary->release();
+		}
+
+		throw;
+	}
+
+	return summary;
+}
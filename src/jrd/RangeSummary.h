@@ -0,0 +1,156 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird development team
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 the Firebird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_RANGE_SUMMARY_H
+#define JRD_RANGE_SUMMARY_H
+
+#include "firebird.h"
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/fb_atomic.h"
+#include "../common/classes/locks.h"
+#include "../common/classes/RefCounted.h"
+#include "../common/classes/SyncObject.h"
+#include "../common/classes/tree.h"
+#include "../common/dsc.h"
+#include "../jrd/RecordNumber.h"
+#include "../jrd/sbm.h"
+
+
+namespace Jrd {
+
+class thread_db;
+class jrd_rel;
+class jrd_tra;
+class Record;
+class FieldRangeNode;
+
+// Minimum and maximum values of a table field kept for every range of
+// consecutive data pages. A range is invalid while some record versions
+// stored in its pages are not accounted for, such ranges are always scanned.
+
+class RangeSummary : public Firebird::RefCounted, public Firebird::PermanentStorage
+{
+	static const USHORT MAX_VALUE_LENGTH = 16;
+
+	struct Range
+	{
+		bool invalid;		// some record versions are not summarized
+		bool hasValues;		// low and high values are set
+		UCHAR low[MAX_VALUE_LENGTH];
+		UCHAR high[MAX_VALUE_LENGTH];
+	};
+
+public:
+	RangeSummary(MemoryPool& p, USHORT relId, USHORT fieldId, USHORT formatVersion,
+		const dsc& desc, ULONG rangePages);
+
+	static bool isSupported(const dsc& desc);
+
+	USHORT getRelationId() const
+	{
+		return m_relId;
+	}
+
+	USHORT getFieldId() const
+	{
+		return m_fieldId;
+	}
+
+	USHORT getFormatVersion() const
+	{
+		return m_formatVersion;
+	}
+
+	bool isReady() const
+	{
+		return m_ready;
+	}
+
+	bool isObsolete() const
+	{
+		return m_obsolete;
+	}
+
+	void build(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction);
+	void refresh(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction);
+	void add(thread_db* tdbb, jrd_rel* relation, RecordNumber number, Record* record);
+	void getCandidates(thread_db* tdbb, const dsc* lower, const dsc* upper, UInt32Bitmap& candidates);
+
+private:
+	ULONG getRangeNumber(thread_db* tdbb, RecordNumber number) const;
+	Range* getRange(ULONG number);
+	void summarize(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+		const Firebird::Array<ULONG>* ranges);
+	void add(thread_db* tdbb, ULONG number, const dsc* value);
+	bool isCandidate(thread_db* tdbb, Range& range, const dsc* lower, const dsc* upper) const;
+
+	const USHORT m_relId;
+	const USHORT m_fieldId;
+	const USHORT m_formatVersion;
+	const dsc m_desc;
+	const ULONG m_rangePages;
+
+	Firebird::Mutex m_mutex;
+	Firebird::Array<Range> m_ranges;
+	TraNumber m_oldest;				// oldest transaction of the last summarizing pass
+	bool m_ready;
+	bool m_scanning;
+	bool m_obsolete;
+};
+
+// Database-wide set of range summaries. It's used with the shared
+// database object only, as every record change must be seen by it.
+
+class RangeSummaryCache
+{
+public:
+	RangeSummaryCache(MemoryPool& p, ULONG rangePages)
+	  : m_pool(p), m_summaries(p), m_rangePages(rangePages)
+	{}
+
+	~RangeSummaryCache();
+
+	ULONG getRangePages() const
+	{
+		return m_rangePages;
+	}
+
+	UInt32Bitmap* getCandidates(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+		const Firebird::Array<FieldRangeNode*>& ranges, MemoryPool& pool);
+	void recordChanged(thread_db* tdbb, jrd_rel* relation, RecordNumber number, Record* record);
+	void removeRelation(USHORT relId);
+
+private:
+	Firebird::RefPtr<RangeSummary> getSummary(thread_db* tdbb, jrd_rel* relation,
+		jrd_tra* transaction, USHORT fieldId);
+
+	Firebird::MemoryPool& m_pool;
+	Firebird::SyncObject m_sync;
+	Firebird::Array<RangeSummary*> m_summaries;
+	Firebird::AtomicCounter m_count;
+	const ULONG m_rangePages;
+};
+
+} // namespace Jrd
+
+#endif // JRD_RANGE_SUMMARY_H
@@ -1211,6 +1211,9 @@ ProcedureSourceNode* ProcedureSourceNode::copy(thread_db* tdbb, NodeCopier& copi
 
 RecordSourceNode* ProcedureSourceNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 {
+	// Procedures are not known to return the same rows for the same inputs
+	RseNode::markUncacheable(csb);
+
 	doPass1(tdbb, csb, sourceList.getAddress());
 	doPass1(tdbb, csb, targetList.getAddress());
 	doPass1(tdbb, csb, in_msg.getAddress());
@@ -1648,12 +1651,25 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 		rse->flags |= RseNode::FLAG_OPT_FIRST_ROWS;
 	}
 
+	// Groups may be collected into a hash table unless the input
+	// is expected to be ordered by the index navigation
+
+	rse->flags &= ~(RseNode::FLAG_HASH_GROUPING | RseNode::FLAG_HASH_GROUPED);
+
+	if (group && !rse->rse_aggregate &&
+		AggregatedStream::isHashable(tdbb, csb, &group->expressions, map))
+	{
+		rse->flags |= RseNode::FLAG_HASH_GROUPING;
+	}
+
 	RecordSource* const nextRsb = opt->compile(rse, &deliverStack);
 
+	const bool hashed = (rse->flags & RseNode::FLAG_HASH_GROUPED);
+
 	// allocate and optimize the record source block
 
 	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+		stream, (group ? &group->expressions : NULL), map, nextRsb, hashed);
 
 	if (rse->rse_aggregate)
 	{
@@ -1980,7 +1996,34 @@ RecordSource* UnionSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool /*i
 	}
 
 	return FB_NEW_POOL(*tdbb->getDefaultPool()) Union(csb, stream, clauses.getCount(), rsbs.begin(),
-		maps.begin(), keyStreams);
+		maps.begin(), keyStreams, hashDistinct);
+}
+
+// Check whether the projection on the union stream may be done by hashing its records
+bool UnionSourceNode::isHashable(CompilerScratch* csb, const SortNode* project) const
+{
+	if (recursive)
+		return false;
+
+	const Format* const format = csb->csb_rpt[stream].csb_format;
+
+	if (!format)
+		return false;
+
+	for (const auto expr : project->expressions)
+	{
+		const auto fieldNode = nodeAs<FieldNode>(expr);
+
+		if (!fieldNode || fieldNode->fieldStream != stream || fieldNode->fieldId >= format->fmt_count)
+			return false;
+
+		const dsc& desc = format->fmt_desc[fieldNode->fieldId];
+
+		if (desc.isBlob() || desc.dsc_dtype == dtype_array)
+			return false;
+	}
+
+	return true;
 }
 
 // Identify all of the streams for which a dbkey may need to be carried through a sort.
@@ -2885,6 +2928,15 @@ RseNode* RseNode::pass1(thread_db* tdbb, CompilerScratch* csb)
 	return this;
 }
 
+void RseNode::markUncacheable(CompilerScratch* csb)
+{
+	for (const auto node : csb->csb_current_nodes)
+	{
+		if (const auto rseNode = nodeAs<RseNode>(node))
+			rseNode->flags |= FLAG_UNCACHEABLE;
+	}
+}
+
 void RseNode::pass1Source(thread_db* tdbb, CompilerScratch* csb, RseNode* rse,
 	BoolExprNode** boolean, RecordSourceNodeStack& stack)
 {
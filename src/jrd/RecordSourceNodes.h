@@ -268,6 +268,20 @@ public:
 	NestConst<ValueExprNode> upper;
 };
 
+// Bounds of a field used to skip page ranges by their summaries
+class FieldRangeNode
+{
+public:
+	FieldRangeNode(USHORT aFieldId, ValueExprNode* aLower, ValueExprNode* aUpper)
+		: fieldId(aFieldId), lower(aLower), upper(aUpper)
+	{
+	}
+
+	USHORT fieldId;
+	NestConst<ValueExprNode> lower;
+	NestConst<ValueExprNode> upper;
+};
+
 class WithClause : public Firebird::Array<SelectExprNode*>
 {
 public:
@@ -596,7 +610,8 @@ public:
 		  maps(pool),
 		  mapStream(0),
 		  dsqlAll(false),
-		  recursive(false)
+		  recursive(false),
+		  hashDistinct(NULL)
 	{
 	}
 
@@ -632,6 +647,8 @@ public:
 
 	virtual RecordSource* compile(thread_db* tdbb, Optimizer* opt, bool innerSubStream);
 
+	bool isHashable(CompilerScratch* csb, const SortNode* project) const;
+
 public:
 	RecSourceListNode* dsqlClauses;
 	RseNode* dsqlParentRse;
@@ -644,6 +661,7 @@ private:
 public:
 	bool dsqlAll;		// UNION ALL
 	bool recursive;		// union node is a recursive union
+	SortNode* hashDistinct;	// duplicates are removed by hashing inside the union
 };
 
 class WindowSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_WINDOW>
@@ -727,7 +745,10 @@ public:
 		FLAG_OPT_FIRST_ROWS		= 0x20,	// optimize retrieval for first rows
 		FLAG_LATERAL			= 0x40,	// lateral derived table
 		FLAG_SKIP_LOCKED		= 0x80,	// skip locked
-		FLAG_SUB_QUERY			= 0x100	// sub-query
+		FLAG_SUB_QUERY			= 0x100,	// sub-query
+		FLAG_HASH_GROUPING		= 0x200,	// groups may be aggregated by hashing
+		FLAG_HASH_GROUPED		= 0x400,	// groups are aggregated by hashing, input is not sorted
+		FLAG_UNCACHEABLE		= 0x800		// results can't be reused for the same outer values
 	};
 
 	bool isInvariant() const
@@ -765,6 +786,9 @@ public:
 		return (flags & FLAG_SKIP_LOCKED) != 0;
 	}
 
+	// Mark the RSEs being compiled as depending on something besides their outer fields
+	static void markUncacheable(CompilerScratch* csb);
+
 	explicit RseNode(MemoryPool& pool)
 		: TypedNode<RecordSourceNode, RecordSourceNode::TYPE_RSE>(pool),
 		  dsqlFirst(NULL),
@@ -780,6 +804,7 @@ public:
 		  dsqlOrder(NULL),
 		  dsqlStreams(NULL),
 		  rse_invariants(NULL),
+		  rse_outer_refs(NULL),
 		  rse_relations(pool),
 		  flags(0),
 		  rse_jointype(blr_inner),
@@ -815,6 +840,7 @@ public:
 		obj->rse_aggregate = rse_aggregate;
 		obj->rse_plan = rse_plan;
 		obj->rse_invariants = rse_invariants;
+		obj->rse_outer_refs = rse_outer_refs;
 		obj->flags = flags;
 		obj->rse_relations = rse_relations;
 
@@ -897,6 +923,7 @@ public:
 	NestConst<SortNode> rse_aggregate;	// singleton aggregate for optimizing to index
 	NestConst<PlanNode> rse_plan;		// user-specified access plan
 	NestConst<VarInvariantArray> rse_invariants; // Invariant nodes bound to top-level RSE
+	NestConst<OuterReferenceArray> rse_outer_refs;	// Outer fields the RSE depends on
 	Firebird::Array<NestConst<RecordSourceNode> > rse_relations;
 	USHORT flags;
 	USHORT rse_jointype;		// inner, left, full
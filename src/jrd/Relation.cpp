@@ -595,6 +595,7 @@ void RelationPages::free(RelationPages*& nextFree)
 	rel_slot_space = rel_pri_data_space = rel_sec_data_space = 0;
 	rel_last_free_pri_dp = rel_last_free_blb_dp = 0;
 	rel_instance_id = 0;
+	memset(rel_leaf_hints, 0, sizeof(rel_leaf_hints));
 
 	dpMap.clear();
 	dpMapMark = 0;
@@ -87,6 +87,19 @@ public:
 	ULONG rel_last_free_blb_dp;	// last blob data page found with space
 	USHORT rel_pg_space_id;
 
+	// Leaf page the last key of an index was inserted into, it's tried
+	// first by the next insertion into the index, see BTR_insert().
+	// Hints are updated without locking and are validated when used.
+	static const USHORT MAX_LEAF_HINTS = 16;
+
+	struct LeafHint
+	{
+		ULONG lh_root;			// index root page at the insertion time
+		ULONG lh_leaf;			// leaf page number
+	};
+
+	LeafHint rel_leaf_hints[MAX_LEAF_HINTS];	// by index id
+
 	RelationPages(Firebird::MemoryPool& pool)
 		: rel_pages(NULL), rel_instance_id(0),
 		  rel_index_root(0), rel_data_pages(0), rel_slot_space(0),
@@ -96,7 +109,9 @@ public:
 		  useCount(0),
 		  dpMap(pool),
 		  dpMapMark(0)
-	{}
+	{
+		memset(rel_leaf_hints, 0, sizeof(rel_leaf_hints));
+	}
 
 	inline SLONG addRef()
 	{
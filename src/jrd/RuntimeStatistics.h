@@ -57,6 +57,8 @@ public:
 		PAGE_READS,
 		PAGE_MARKS,
 		PAGE_WRITES,
+		PAGE_READ_WAIT,		// microseconds spent reading pages from disk
+		LOCK_WAIT,			// microseconds spent waiting in the lock manager
 		RECORD_FIRST_ITEM,
 		RECORD_SEQ_READS = RECORD_FIRST_ITEM,
 		RECORD_IDX_READS,
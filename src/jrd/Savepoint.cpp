@@ -205,8 +205,8 @@ void VerbAction::mergeTo(thread_db* tdbb, jrd_tra* transaction, VerbAction* next
 			}
 		} while (vct_undo->getNext());
 
-		delete vct_undo;
-		vct_undo = NULL;
+		// Keep the emptied tree, it will be reused by the next verb using this action
+		vct_undo->clear();
 	}
 
 	// Now merge bitmap
@@ -362,8 +362,7 @@ void VerbAction::release(jrd_tra* transaction)
 			} while (vct_undo->getNext());
 		}
 
-		delete vct_undo;
-		vct_undo = NULL;
+		vct_undo->clear();
 	}
 }
 
@@ -414,8 +413,7 @@ void Savepoint::cleanupTempData()
 					} while (action->vct_undo->getNext());
 				}
 
-				delete action->vct_undo;
-				action->vct_undo = NULL;
+				action->vct_undo->clear();
 			}
 		}
 	}
@@ -427,6 +425,12 @@ Savepoint* Savepoint::rollback(thread_db* tdbb, Savepoint* prior, bool preserveL
 	// Perform index and BLOB cleanup if needed.
 	// At the exit savepoint is clear and safe to reuse.
 
+	// Fast path for savepoints which have not recorded any changes,
+	// e.g. PSQL blocks with exception handlers executed in a loop
+
+	if (!m_actions && !(m_flags & SAV_force_dfw) && !m_transaction->tra_deferred_job)
+		return release(prior);
+
 	jrd_tra* const old_tran = tdbb->getTransaction();
 
 	try
@@ -473,6 +477,12 @@ Savepoint* Savepoint::rollforward(thread_db* tdbb, Savepoint* prior)
 	// Perform index and BLOB cleanup if needed.
 	// At the exit savepoint is clear and safe to reuse.
 
+	// Fast path for savepoints which have not recorded any changes.
+	// There is nothing to merge and the next savepoint does not grow.
+
+	if (!m_actions && !(m_flags & SAV_force_dfw))
+		return release(prior);
+
 	jrd_tra* const old_tran = tdbb->getTransaction();
 
 	try
@@ -191,6 +191,27 @@ Statement::Statement(thread_db* tdbb, MemoryPool* p, CompilerScratch* csb)
 			if (tail->csb_flags & csb_unstable)
 				rpb->rpb_stream_flags |= RPB_s_unstable;
 
+			// if the stream is read-only, remember how many leading fields
+			// have to be fetched to access all the referenced ones
+
+			if (tail->csb_fields && tail->csb_relation && !(tail->csb_flags & csb_update))
+			{
+				UInt32Bitmap::Accessor accessor(tail->csb_fields);
+
+				if (accessor.getFirst())
+				{
+					ULONG lastId = 0;
+
+					do
+					{
+						lastId = accessor.current();
+					} while (accessor.getNext());
+
+					if (lastId < MAX_USHORT)
+						rpb->rpb_field_count = lastId + 1;
+				}
+			}
+
 			rpb->rpb_relation = tail->csb_relation;
 
 			delete tail->csb_fields;
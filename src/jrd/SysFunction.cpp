@@ -59,6 +59,7 @@
 #include "../jrd/Collation.h"
 #include "../common/classes/FpeControl.h"
 #include "../jrd/extds/ExtDS.h"
+#include "../jrd/replication/Manager.h"
 #include "../jrd/align.h"
 
 #include <functional>
@@ -373,9 +374,14 @@ const char
 	EXT_CONN_POOL_ACTIVE[] = "EXT_CONN_POOL_ACTIVE_COUNT",
 	EXT_CONN_POOL_LIFETIME[] = "EXT_CONN_POOL_LIFETIME",
 	REPLICATION_SEQ_NAME[] = "REPLICATION_SEQUENCE",
+	REPLICATION_QUEUE_SIZE[] = "REPLICATION_QUEUE_SIZE",
+	REPLICATION_CONFLICTS[] = "REPLICATION_CONFLICTS",
 	DATABASE_GUID[] = "DB_GUID",
 	DATABASE_FILE_ID[] = "DB_FILE_ID",
 	REPLICA_MODE[] = "REPLICA_MODE",
+	TEMP_CACHE_SIZE[] = "TEMP_CACHE_SIZE",
+	TEMP_MEMORY_GRANTED[] = "TEMP_MEMORY_GRANTED",
+	TEMP_SPILLED[] = "TEMP_SPILLED",
 	// SYSTEM namespace: connection wise items
 	SESSION_ID_NAME[] = "SESSION_ID",
 	NETWORK_PROTOCOL_NAME[] = "NETWORK_PROTOCOL",
@@ -3610,8 +3616,8 @@ dsc* evlEncode64(thread_db* tdbb, const SysFunction* function, const NestValueAr
 
 UCHAR hexChar(UCHAR c)
 {
-	c &= 0xf;
-	return c + (c < 10 ? '0' : 'A' - 10);
+	static const char HEX_DIGITS[] = "0123456789ABCDEF";
+	return HEX_DIGITS[c & 0xf];
 }
 
 UCHAR binChar(UCHAR c, unsigned p)
@@ -3659,9 +3665,10 @@ dsc* evlEncodeDecodeHex(thread_db* tdbb, bool encodeFlag, const SysFunction* fun
 	else
 		ptr = CVT_get_bytes(arg, len);
 
-	for(;; --len, ++pos)
+	// Data is converted a whole portion at a time: the string at once, the blob by its chunks
+	for (;;)
 	{
-		if (arg->isBlob() && !len)
+		if (arg->isBlob())
 		{
 			// try to get next portion of data from the blob
 			len = inBlob->BLB_get_data(tdbb, in, sizeof in, false);
@@ -3670,21 +3677,36 @@ dsc* evlEncodeDecodeHex(thread_db* tdbb, bool encodeFlag, const SysFunction* fun
 		if (!len)
 			break;
 
-		UCHAR c = *ptr++;
+		const UCHAR* const end = ptr + len;
+
 		if (encodeFlag)
 		{
-			out.add(hexChar(c >> 4));
-			out.add(hexChar(c));
+			const FB_SIZE_T count = out.getCount();
+			UCHAR* to = out.getBuffer(count + len * 2) + count;
+
+			for (; ptr < end; ++ptr)
+			{
+				*to++ = hexChar(*ptr >> 4);
+				*to++ = hexChar(*ptr);
+			}
+
+			pos += len;
 		}
 		else
 		{
-			if (pos & 1)
-				out.add((last << 4) + binChar(c, pos));
-			else
-				last = binChar(c, pos);
+			for (; ptr < end; ++ptr, ++pos)
+			{
+				if (pos & 1)
+					out.add((last << 4) + binChar(*ptr, pos));
+				else
+					last = binChar(*ptr, pos);
+			}
 		}
 
-		if (out.getCount() >= BLOB_BUF && arg->isBlob())
+		if (!arg->isBlob())
+			break;
+
+		if (out.getCount() >= BLOB_BUF)
 		{
 			outBlob->BLB_put_data(tdbb, out.begin(), out.getCount());
 			out.clear();
@@ -4701,6 +4723,16 @@ dsc* evlGetContext(thread_db* tdbb, const SysFunction*, const NestValueArray& ar
 			else
 				return NULL;
 		}
+		else if (nameStr == TEMP_CACHE_SIZE || nameStr == TEMP_MEMORY_GRANTED ||
+			nameStr == TEMP_SPILLED)
+		{
+			MutexLockGuard guard(dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+
+			const FB_UINT64 value = (nameStr == TEMP_CACHE_SIZE) ? dbb->dbb_temp_cache_size :
+				(nameStr == TEMP_MEMORY_GRANTED) ? dbb->dbb_temp_granted : dbb->dbb_temp_spilled;
+
+			resultStr.printf("%" UQUADFORMAT, value);
+		}
 		else if (nameStr == EXT_CONN_POOL_SIZE)
 			resultStr.printf("%d", EDS::Manager::getConnPool(true)->getMaxCount());
 		else if (nameStr == EXT_CONN_POOL_IDLE)
@@ -4714,6 +4746,17 @@ dsc* evlGetContext(thread_db* tdbb, const SysFunction*, const NestValueArray& ar
 			resultStr.printf("%d", EDS::Manager::getConnPool(true)->getLifeTime());
 		else if (nameStr == REPLICATION_SEQ_NAME)
 			resultStr.printf("%" UQUADFORMAT, dbb->getReplSequence(tdbb));
+		else if (nameStr == REPLICATION_QUEUE_SIZE)
+		{
+			const auto replMgr = dbb->replManager();
+
+			if (!replMgr)
+				return NULL;
+
+			resultStr.printf("%" ULONGFORMAT, replMgr->getQueueSize());
+		}
+		else if (nameStr == REPLICATION_CONFLICTS)
+			resultStr.printf("%" UQUADFORMAT, (FB_UINT64) dbb->dbb_repl_conflicts.value());
 		else if (nameStr == EFFECTIVE_USER_NAME)
 		{
 			const MetaString& user = attachment->getEffectiveUserName();
@@ -6925,6 +6968,14 @@ const SysFunction* SysFunction::lookup(const MetaName& name)
 }
 
 
+// Whether the same arguments always produce the same result inside a statement
+bool SysFunction::isDeterministic() const
+{
+	return !(evlFunc == evlGenUuid || evlFunc == evlRand ||
+		evlFunc == evlGetContext || evlFunc == evlSetContext || evlFunc == evlGetTranCN ||
+		evlFunc == evlRsaEncrypt || evlFunc == evlRsaPrivate || evlFunc == evlRsaSign);
+}
+
 void SysFunction::checkArgsMismatch(int count) const
 {
 	if (count < minArgCount || (maxArgCount != -1 && count > maxArgCount))
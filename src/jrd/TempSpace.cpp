@@ -41,6 +41,7 @@ using namespace Jrd;
 GlobalPtr<Mutex> TempSpace::initMutex;
 TempDirectoryList* TempSpace::tempDirs = NULL;
 FB_SIZE_T TempSpace::minBlockSize = 0;
+AtomicCounter TempSpace::nextDirectory;
 
 namespace
 {
@@ -53,7 +54,8 @@ namespace
 			: m_dbb(GET_DBB()), m_size(size),
 			  m_guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION)
 		{
-			m_allowed = (m_dbb->dbb_temp_cache_size + size <= m_dbb->dbb_config->getTempCacheLimit());
+			m_allowed = (m_dbb->dbb_temp_cache_size + m_dbb->dbb_temp_granted + size <=
+				m_dbb->dbb_config->getTempCacheLimit());
 		}
 
 		bool isAllowed() const
@@ -74,6 +76,13 @@ namespace
 			dbb->dbb_temp_cache_size -= size;
 		}
 
+		static void spill(FB_SIZE_T size)
+		{
+			Database* const dbb = GET_DBB();
+			MutexLockGuard guard(dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+			dbb->dbb_temp_spilled += size;
+		}
+
 	private:
 		Database* const m_dbb;
 		FB_SIZE_T m_size;
@@ -82,6 +91,59 @@ namespace
 	};
 }
 
+//
+// Memory grant class
+//
+
+TempMemoryGrant::TempMemoryGrant(Database* dbb)
+	: m_dbb(dbb), m_size(0)
+{
+	MutexLockGuard guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+	m_dbb->dbb_temp_grantees++;
+}
+
+TempMemoryGrant::~TempMemoryGrant()
+{
+	MutexLockGuard guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+	fb_assert(m_dbb->dbb_temp_grantees && m_dbb->dbb_temp_granted >= m_size);
+	m_dbb->dbb_temp_granted -= m_size;
+	m_dbb->dbb_temp_grantees--;
+}
+
+FB_SIZE_T TempMemoryGrant::grant(FB_SIZE_T minSize, FB_SIZE_T maxSize)
+{
+	fb_assert(minSize <= maxSize);
+
+	MutexLockGuard guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+
+	const FB_UINT64 limit = m_dbb->dbb_config->getTempCacheLimit();
+	const FB_UINT64 used = m_dbb->dbb_temp_cache_size + m_dbb->dbb_temp_granted;
+	const FB_UINT64 share = limit / m_dbb->dbb_temp_grantees;
+
+	FB_UINT64 size = (used < limit) ? limit - used : 0;
+
+	if (m_size < share)
+		size = MIN(size, share - m_size);
+	else
+		size = 0;
+
+	size = MAX(MIN(size, maxSize), minSize);
+
+	m_size += size;
+	m_dbb->dbb_temp_granted += size;
+
+	return (FB_SIZE_T) size;
+}
+
+void TempMemoryGrant::release(FB_SIZE_T size)
+{
+	MutexLockGuard guard(m_dbb->dbb_temp_cache_mutex, FB_FUNCTION);
+
+	fb_assert(m_size >= size);
+	m_size -= size;
+	m_dbb->dbb_temp_granted -= size;
+}
+
 //
 // In-memory block class
 //
@@ -130,6 +192,16 @@ FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SI
 	return file->write(offset, buffer, length);
 }
 
+FB_SIZE_T TempSpace::FileBlock::prefetch(offset_t offset, FB_SIZE_T length)
+{
+	if (offset + length > size)
+	{
+		length = size - offset;
+	}
+	file->prefetch(offset + seek, length);
+	return length;
+}
+
 //
 // TempSpace::TempSpace
 //
@@ -139,8 +211,8 @@ FB_SIZE_T TempSpace::FileBlock::write(offset_t offset, const void* buffer, FB_SI
 TempSpace::TempSpace(MemoryPool& p, const PathName& prefix, bool dynamic)
 		: pool(p), filePrefix(p, prefix),
 		  logicalSize(0), physicalSize(0), localCacheUsage(0),
-		  head(NULL), tail(NULL), tempFiles(p),
-		  initialBuffer(p), initiallyDynamic(dynamic),
+		  head(NULL), tail(NULL), lastBlock(NULL), lastBlockStart(0), tempFiles(p),
+		  initialBuffer(p), firstDirectory(0), initiallyDynamic(dynamic),
 		  freeSegments(p)
 {
 	if (!tempDirs)
@@ -213,6 +285,30 @@ FB_SIZE_T TempSpace::read(offset_t offset, void* buffer, FB_SIZE_T length)
 	return length;
 }
 
+//
+// TempSpace::prefetch
+//
+// Starts reading bytes of the temporary space in background,
+// so that they're cached when actually read
+//
+
+void TempSpace::prefetch(offset_t offset, FB_SIZE_T length)
+{
+	fb_assert(offset + length <= logicalSize);
+
+	if (length)
+	{
+		// search for the first needed block
+		Block* const block = findBlock(offset);
+
+		FB_SIZE_T l = length;
+
+		// prefetch data of as many blocks as necessary
+		for (Block* itr = block; itr && l; itr = itr->next, offset = 0)
+			l -= itr->prefetch(offset, l);
+	}
+}
+
 //
 // TempSpace::write
 //
@@ -299,7 +395,7 @@ void TempSpace::extend(FB_SIZE_T size)
 		{
 			fb_assert(head == tail);
 			delete head;
-			head = tail = NULL;
+			head = tail = lastBlock = NULL;
 			size = static_cast<FB_SIZE_T>(FB_ALIGN(logicalSize, minBlockSize));
 			physicalSize = size;
 		}
@@ -338,6 +434,8 @@ void TempSpace::extend(FB_SIZE_T size)
 			// allocate block in the temp file
 			TempFile* const file = setupFile(size);
 			fb_assert(file);
+			TempCacheLimitGuard::spill(size);
+
 			if (tail && tail->sameFile(file))
 			{
 				fb_assert(!initialSize);
@@ -373,6 +471,30 @@ TempSpace::Block* TempSpace::findBlock(offset_t& offset) const
 {
 	fb_assert(offset <= logicalSize);
 
+	// Records are mostly read and written in order, so try the block found
+	// last time and the one after it before walking the chain
+
+	if (lastBlock && offset >= lastBlockStart)
+	{
+		if (offset - lastBlockStart < lastBlock->size)
+		{
+			offset -= lastBlockStart;
+			return lastBlock;
+		}
+
+		Block* const next = lastBlock->next;
+		const offset_t nextStart = lastBlockStart + lastBlock->size;
+
+		if (next && offset - nextStart < next->size)
+		{
+			lastBlock = next;
+			lastBlockStart = nextStart;
+			offset -= nextStart;
+			return next;
+		}
+	}
+
+	const offset_t globalOffset = offset;
 	Block* block = NULL;
 
 	if (offset < physicalSize / 2)
@@ -400,24 +522,36 @@ TempSpace::Block* TempSpace::findBlock(offset_t& offset) const
 	}
 
 	fb_assert(offset <= block->size);
+
+	lastBlock = block;
+	lastBlockStart = globalOffset - offset;
+
 	return block;
 }
 
 //
 // TempSpace::setupFile
 //
-// Allocates the required space in some temporary file
+// Allocates the required space in some temporary file.
+// Every temp space starts in the next directory of the list, so concurrent
+// sorts and spills are spread over all configured devices. Later extensions
+// keep using the same directory while it has room.
 //
 
 TempFile* TempSpace::setupFile(FB_SIZE_T size)
 {
 	StaticStatusVector status_vector;
 
-	for (FB_SIZE_T i = 0; i < tempDirs->getCount(); i++)
+	const FB_SIZE_T dirCount = tempDirs->getCount();
+
+	if (tempFiles.isEmpty() && dirCount > 1)
+		firstDirectory = (FB_SIZE_T) (nextDirectory.exchangeAdd(1) % dirCount);
+
+	for (FB_SIZE_T i = 0; i < dirCount; i++)
 	{
 		TempFile* file = NULL;
 
-		PathName directory = (*tempDirs)[i];
+		PathName directory = (*tempDirs)[(firstDirectory + i) % dirCount];
 		PathUtils::ensureSeparator(directory);
 
 		for (FB_SIZE_T j = 0; j < tempFiles.getCount(); j++)
@@ -30,6 +30,12 @@
 #include "../common/config/dir_list.h"
 #include "../common/classes/init.h"
 #include "../common/classes/tree.h"
+#include "../common/classes/fb_atomic.h"
+
+namespace Jrd
+{
+	class Database;
+}
 
 class TempSpace : public Firebird::File
 {
@@ -40,6 +46,7 @@ public:
 	FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length);
 	FB_SIZE_T write(offset_t offset, const void* buffer, FB_SIZE_T length);
 
+	void prefetch(offset_t offset, FB_SIZE_T length);
 	void unlink() {}
 
 	offset_t getSize() const
@@ -87,6 +94,12 @@ private:
 		virtual FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length) = 0;
 		virtual FB_SIZE_T write(offset_t offset, const void* buffer, FB_SIZE_T length) = 0;
 
+		virtual FB_SIZE_T prefetch(offset_t offset, FB_SIZE_T length)
+		{
+			// Nothing to read ahead for the memory blocks
+			return MIN(length, size - offset);
+		}
+
 		virtual UCHAR* inMemory(offset_t offset, size_t size) const = 0;
 		virtual bool sameFile(const Firebird::TempFile* file) const = 0;
 
@@ -157,6 +170,7 @@ private:
 
 		FB_SIZE_T read(offset_t offset, void* buffer, FB_SIZE_T length);
 		FB_SIZE_T write(offset_t offset, const void* buffer, FB_SIZE_T length);
+		FB_SIZE_T prefetch(offset_t offset, FB_SIZE_T length);
 
 		UCHAR* inMemory(offset_t /*offset*/, size_t /*a_size*/) const
 		{
@@ -205,8 +219,11 @@ private:
 	offset_t localCacheUsage;
 	Block* head;
 	Block* tail;
+	mutable Block* lastBlock;			// block found by the last findBlock()
+	mutable offset_t lastBlockStart;	// and its global offset
 	Firebird::Array<Firebird::TempFile*> tempFiles;
 	Firebird::Array<UCHAR> initialBuffer;
+	FB_SIZE_T firstDirectory;			// directory tried first by setupFile()
 	bool initiallyDynamic;
 
 	typedef Firebird::BePlusTree<Segment, offset_t, MemoryPool, Segment> FreeSegmentTree;
@@ -215,6 +232,30 @@ private:
 	static Firebird::GlobalPtr<Firebird::Mutex> initMutex;
 	static Firebird::TempDirectoryList* tempDirs;
 	static FB_SIZE_T minBlockSize;
+	static Firebird::AtomicCounter nextDirectory;
+};
+
+// Memory granted to a private buffer (e.g. sort one) out of TempCacheLimit.
+// In-memory temp space and the grant holders share that limit, every holder
+// may get an equal part of it. The minimal size asked for is always granted.
+
+class TempMemoryGrant
+{
+public:
+	explicit TempMemoryGrant(Jrd::Database* dbb);
+	~TempMemoryGrant();
+
+	FB_SIZE_T grant(FB_SIZE_T minSize, FB_SIZE_T maxSize);
+	void release(FB_SIZE_T size);
+
+	FB_UINT64 getSize() const
+	{
+		return m_size;
+	}
+
+private:
+	Jrd::Database* const m_dbb;
+	FB_UINT64 m_size;
 };
 
 #endif // JRD_TEMP_SPACE_H
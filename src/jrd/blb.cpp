@@ -47,6 +47,7 @@
 #include "../jrd/blb.h"
 #include "../jrd/ods.h"
 #include "../jrd/lls.h"
+#include "../jrd/sqz.h"
 #include "iberror.h"
 #include "../jrd/blob_filter.h"
 #include "../common/sdl.h"
@@ -639,9 +640,7 @@ ULONG blb::BLB_get_data(thread_db* tdbb, UCHAR* buffer, SLONG length, bool close
 
 	while (length > 0)
 	{
-		// I have no idea why this limit is 32768 instead of 32767
-		// 1994-August-12 David Schnepper
-		USHORT n = (USHORT) MIN(length, (SLONG) 32768);
+		USHORT n = (USHORT) MIN(length, (SLONG) MAX_USHORT);
 		n = BLB_get_segment(tdbb, p, n);
 		p += n;
 		length -= n;
@@ -2382,10 +2381,8 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	}
 
 	SET_TDBB(tdbb);
-#ifdef SUPERSERVER_V2
-	Database* dbb = tdbb->getDatabase();
-	ULONG pages[PREFETCH_MAX_PAGES];
-#endif
+	const Database* const dbb = tdbb->getDatabase();
+	ULONG pages[MAX_READ_AHEAD_PAGES + 1];
 
 	const vcl& vector = *blb_pages;
 
@@ -2393,21 +2390,18 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	// Level 1 blobs are much easier -- page number is in vector.
 	if (blb_level == 1)
 	{
-#ifdef SUPERSERVER_V2
 		// Perform prefetch of blob level 1 data pages.
 
-		if (!(blb_sequence % dbb->dbb_prefetch_sequence))
+		if (dbb->dbb_prefetch_pages && !(blb_sequence % dbb->dbb_prefetch_sequence))
 		{
-			USHORT sequence = blb_sequence;
-			USHORT i = 0;
+			ULONG sequence = blb_sequence + 1;
+			FB_SIZE_T i = 0;
 			while (i < dbb->dbb_prefetch_pages && sequence <= blb_max_sequence)
-			{
-				 pages[i++] = vector[sequence++];
-			}
+				pages[i++] = vector[sequence++];
 
 			CCH_PREFETCH(tdbb, pages, i);
 		}
-#endif
+
 		window->win_page = vector[blb_sequence];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
 	}
@@ -2415,14 +2409,14 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 	{
 		window->win_page = vector[blb_sequence / blb_pointers];
 		page = (blob_page*) CCH_FETCH(tdbb, window, LCK_read, pag_blob);
-#ifdef SUPERSERVER_V2
+
 		// Perform prefetch of blob level 2 data pages.
 
-		USHORT sequence = blb_sequence % blb_pointers;
-		if (!(sequence % dbb->dbb_prefetch_sequence))
+		ULONG sequence = blb_sequence % blb_pointers + 1;
+		if (dbb->dbb_prefetch_pages && !((sequence - 1) % dbb->dbb_prefetch_sequence))
 		{
-			ULONG abs_sequence = blb_sequence;
-			USHORT i = 0;
+			ULONG abs_sequence = blb_sequence + 1;
+			FB_SIZE_T i = 0;
 			while (i < dbb->dbb_prefetch_pages && sequence < blb_pointers &&
 				abs_sequence <= blb_max_sequence)
 			{
@@ -2430,9 +2424,18 @@ blob_page* blb::get_next_page(thread_db* tdbb, WIN* window)
 				abs_sequence++;
 			}
 
+			// If no more data pages, piggyback next pointer page.
+
+			const ULONG next = blb_sequence / blb_pointers + 1;
+			if (sequence >= blb_pointers && next < vector.count() &&
+				abs_sequence <= blb_max_sequence)
+			{
+				pages[i++] = vector[next];
+			}
+
 			CCH_PREFETCH(tdbb, pages, i);
 		}
-#endif
+
 		page = (blob_page*) CCH_HANDOFF(tdbb, window,
 										page->blp_page[blb_sequence % blb_pointers],
 										LCK_read, pag_blob);
@@ -2983,6 +2986,18 @@ void blb::getFromPage(USHORT length, const UCHAR* data)
 	}
 }
 
+// Used by DPM_get_blob for compressed level 0 blobs
+bool blb::getFromPackedPage(USHORT length, const UCHAR* data)
+{
+	fb_assert(blb_level == 0);
+
+	UCHAR* const buffer = (UCHAR*) ((blob_page*) getBuffer())->blp_page;
+	const UCHAR* const end = Compressor::unpack(length, data, blb_clump_size, buffer, true);
+	blb_space_remaining = end - buffer;
+
+	return (blb_space_remaining == blb_length);
+}
+
 // Used by DPM_store_blob
 void blb::storeToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data, void* stack)
 {
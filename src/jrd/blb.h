@@ -122,6 +122,7 @@ public:
 	void fromPageHeader(const Ods::blh* header);
 	void toPageHeader(Ods::blh* header) const;
 	void getFromPage(USHORT length, const UCHAR* data);
+	bool getFromPackedPage(USHORT length, const UCHAR* data);
 	void storeToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data, void* stack);
 
 	static bid copy(thread_db* tdbb, const bid* source)
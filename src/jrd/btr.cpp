@@ -32,6 +32,7 @@
 #include "../common/TimeZoneUtil.h"
 #include "../common/classes/vector.h"
 #include "../common/classes/VaryStr.h"
+#include "../common/classes/Hash.h"
 #include <stdio.h>
 #include "../jrd/jrd.h"
 #include "../jrd/ods.h"
@@ -45,6 +46,9 @@
 #include "../jrd/lck.h"
 #include "../jrd/cch.h"
 #include "../jrd/sort.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../jrd/GarbageCollector.h"
+#include "../common/Task.h"
 #include "../common/gdsassert.h"
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
@@ -190,9 +194,14 @@ static ULONG add_node(thread_db*, WIN*, index_insertion*, temporary_key*, Record
 					  ULONG*, ULONG*);
 static void compress(thread_db*, const dsc*, temporary_key*, USHORT, bool, USHORT);
 static USHORT compress_root(thread_db*, index_root_page*);
+static int compare_keys(const temporary_key&, const temporary_key&, bool);
 static void copy_key(const temporary_key*, temporary_key*);
 static contents delete_node(thread_db*, WIN*, UCHAR*);
 static void delete_tree(thread_db*, USHORT, USHORT, PageNumber, PageNumber);
+static ULONG equal_segments(const UCHAR*, USHORT, const UCHAR*, USHORT, USHORT, ULONG, bool);
+static void evaluate_range(thread_db*, const IndexRetrieval*, WIN*, btree_page*, index_desc&,
+						   temporary_key*, temporary_key*, RecordBitmap**, RecordBitmap*);
+static void evaluate_skip_scan(thread_db*, const IndexRetrieval*, RecordBitmap**, RecordBitmap*);
 static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
 
 static index_root_page* fetch_root(thread_db*, WIN*, const jrd_rel*, const RelationPages*);
@@ -204,19 +213,30 @@ static UCHAR* find_area_start_point(btree_page*, const temporary_key*, UCHAR*,
 
 static ULONG find_page(btree_page*, const temporary_key*, const index_desc*, RecordNumber = NO_VALUE,
 					   int = 0);
+static btree_page* find_leaf_optimistic(thread_db*, WIN*, const IndexRetrieval*, index_desc*,
+										const temporary_key*);
 
 static contents garbage_collect(thread_db*, WIN*, ULONG);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
 
+static bool insert_by_hint(thread_db*, WIN*, index_insertion*);
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
-						 RecordNumber*, ULONG*, ULONG*);
+						 RecordNumber*, ULONG*, ULONG*, bool = false);
 
 static INT64_KEY make_int64_key(SINT64, SSHORT);
+static void make_retrieval_keys(thread_db*, const IndexRetrieval*, temporary_key*, temporary_key*);
 #ifdef DEBUG_INDEXKEY
 static void print_int64_key(SINT64, SSHORT, INT64_KEY);
 #endif
 static string print_key(thread_db*, jrd_rel*, index_desc*, Record*);
+static bool probe_allowed(thread_db*, const IndexRetrieval*, const index_desc*);
+static bool probe_fits(const btree_page*, const IndexRetrieval*, const index_desc*,
+					   const temporary_key*);
+static btree_page* probe_leaf(thread_db*, WIN*, const IndexRetrieval*, const index_desc*,
+							  const temporary_key*);
+static void probe_remember(thread_db*, const IndexRetrieval*, const index_desc*,
+						   const temporary_key*, WIN*);
 static contents remove_node(thread_db*, index_insertion*, WIN*);
 static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
@@ -270,6 +290,47 @@ bool BtrPageGCLock::isPageGCAllowed(thread_db* tdbb, const PageNumber& page)
 	return true;
 }
 
+// IndexProbeCache class
+
+IndexProbeCache::IndexProbeCache(MemoryPool& p, ULONG slots)
+	: m_slots(p)
+{
+	// Round the number of slots up to the power of 2
+	ULONG count = 1;
+	while (count < slots)
+		count <<= 1;
+
+	m_slots.grow(count);
+	m_mask = count - 1;
+}
+
+ULONG IndexProbeCache::hash(const temporary_key* key)
+{
+	return Firebird::InternalHash::hash(key->key_length, key->key_data);
+}
+
+ULONG IndexProbeCache::get(ULONG root, const temporary_key* key) const
+{
+	const ULONG value = hash(key);
+	const Slot slot = getSlot(root, value);
+
+	return (slot.ips_root == root && slot.ips_hash == value) ? slot.ips_leaf : 0;
+}
+
+void IndexProbeCache::put(ULONG root, const temporary_key* key, ULONG leaf)
+{
+	const ULONG value = hash(key);
+	Slot& slot = const_cast<Slot&>(getSlot(root, value));
+
+	// Don't write the shared slot unless it changes
+	if (slot.ips_root != root || slot.ips_hash != value || slot.ips_leaf != leaf)
+	{
+		slot.ips_root = root;
+		slot.ips_hash = value;
+		slot.ips_leaf = leaf;
+	}
+}
+
 // IndexErrorContext class
 
 void IndexErrorContext::raise(thread_db* tdbb, idx_e result, Record* record)
@@ -806,6 +867,10 @@ bool BTR_delete_index(thread_db* tdbb, WIN* window, USHORT id)
 
 		CCH_RELEASE(tdbb, window);
 		delete_tree(tdbb, relation_id, id, next, prior);
+
+		// Forget the garbage keys of the index queued for removal
+		if (GarbageCollector* const gc = dbb->dbb_garbage_collector)
+			gc->removeIndex(relation_id, id);
 	}
 
 	return tree_exists;
@@ -1017,6 +1082,12 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
  **************************************/
 	SET_TDBB(tdbb);
 
+	if (retrieval->irb_generic & irb_skip_scan)
+	{
+		evaluate_skip_scan(tdbb, retrieval, bitmap, bitmap_and);
+		return;
+	}
+
 	// Remove ignore_nulls flag for older ODS
 	//const Database* dbb = tdbb->getDatabase();
 
@@ -1038,114 +1109,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 		btree_page* page = BTR_find_page(tdbb, retrieval, &window, &idx, lower, upper, first);
 		first = false;
 
-		const bool descending = (idx.idx_flags & idx_descending);
-		bool skipLowerKey = (retrieval->irb_generic & irb_exclude_lower);
-		const bool partLower = (retrieval->irb_lower_count < idx.idx_count);
-
-		// If there is a starting descriptor, search down index to starting position.
-		// This may involve sibling buckets if splits are in progress.  If there
-		// isn't a starting descriptor, walk down the left side of the index.
-		USHORT prefix;
-		UCHAR* pointer;
-		if (retrieval->irb_lower_count)
-		{
-			while (!(pointer = find_node_start_point(page, lower, 0, &prefix,
-				idx.idx_flags & idx_descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
-			{
-				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-			}
-
-			// Compute the number of matching characters in lower and upper bounds
-			if (retrieval->irb_upper_count)
-			{
-				prefix = IndexNode::computePrefix(upper->key_data, upper->key_length,
-													lower->key_data, lower->key_length);
-			}
-
-			if (skipLowerKey)
-			{
-				IndexNode node;
-				node.readNode(pointer, true);
-				checkForLowerKeySkip(skipLowerKey, partLower, node, *lower, idx, retrieval);
-			}
-		}
-		else
-		{
-			pointer = page->btr_nodes + page->btr_jump_size;
-			prefix = 0;
-			skipLowerKey = false;
-		}
-
-		// if there is an upper bound, scan the index pages looking for it
-		if (retrieval->irb_upper_count)
-		{
-			while (scan(tdbb, pointer, bitmap, bitmap_and, &idx, retrieval, prefix, upper,
-						skipLowerKey, *lower))
-			{
-				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-				pointer = page->btr_nodes + page->btr_jump_size;
-				prefix = 0;
-			}
-		}
-		else
-		{
-			// if there isn't an upper bound, just walk the index to the end of the level
-			const UCHAR* endPointer = (UCHAR*) page + page->btr_length;
-			const bool ignoreNulls =
-				(retrieval->irb_generic & irb_ignore_null_value_key) && (idx.idx_count == 1);
-
-			IndexNode node;
-			pointer = node.readNode(pointer, true);
-
-			// Check if pointer is still valid
-			if (pointer > endPointer)
-				BUGCHECK(204);	// msg 204 index inconsistent
-
-			while (true)
-			{
-				if (node.isEndLevel)
-					break;
-
-				if (!node.isEndBucket)
-				{
-					// If we're walking in a descending index and we need to ignore NULLs
-					// then stop at the first NULL we see (only for single segment!)
-					if (descending && ignoreNulls && node.prefix == 0 &&
-						node.length >= 1 && node.data[0] == 255)
-					{
-						break;
-					}
-
-					if (skipLowerKey)
-						checkForLowerKeySkip(skipLowerKey, partLower, node, *lower, idx, retrieval);
-
-					if (!skipLowerKey)
-					{
-						if (!bitmap_and || bitmap_and->test(node.recordNumber.getValue()))
-							RBM_SET(tdbb->getDefaultPool(), bitmap, node.recordNumber.getValue());
-					}
-
-					pointer = node.readNode(pointer, true);
-
-					// Check if pointer is still valid
-					if (pointer > endPointer)
-						BUGCHECK(204);	// msg 204 index inconsistent
-
-					continue;
-				}
-
-				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
-				endPointer = (UCHAR*) page + page->btr_length;
-				pointer = page->btr_nodes + page->btr_jump_size;
-				pointer = node.readNode(pointer, true);
-
-				// Check if pointer is still valid
-				if (pointer > endPointer)
-					BUGCHECK(204);	// msg 204 index inconsistent
-			}
-		}
-
-		CCH_RELEASE(tdbb, &window);
+		evaluate_range(tdbb, retrieval, &window, page, idx, lower, upper, bitmap, bitmap_and);
 	} while ((lower = lower->key_next.get()) && (upper = upper->key_next.get()));
 }
 
@@ -1200,44 +1164,14 @@ btree_page* BTR_find_page(thread_db* tdbb,
 		copy_key(retrieval->irb_key, upper);
 	}
 	else if (makeKeys)
-	{
-		idx_e errorCode = idx_e_ok;
-
-		const USHORT keyType =
-			(retrieval->irb_generic & irb_multi_starting) ? INTL_KEY_MULTI_STARTING :
-			(retrieval->irb_generic & irb_starting) ? INTL_KEY_PARTIAL :
-			(retrieval->irb_desc.idx_flags & idx_unique) ? INTL_KEY_UNIQUE :
-			INTL_KEY_SORT;
-
-		if (retrieval->irb_upper_count)
-		{
-			errorCode = BTR_make_key(tdbb, retrieval->irb_upper_count,
-									 retrieval->irb_value + retrieval->irb_desc.idx_count,
-									 &retrieval->irb_desc, upper,
-									 keyType);
-		}
-
-		if (errorCode == idx_e_ok)
-		{
-			if (retrieval->irb_lower_count)
-			{
-				errorCode = BTR_make_key(tdbb, retrieval->irb_lower_count,
-										 retrieval->irb_value, &retrieval->irb_desc, lower,
-										 keyType);
-			}
-		}
-
-		if (errorCode != idx_e_ok)
-		{
-			index_desc temp_idx = retrieval->irb_desc; // to avoid constness issues
-			IndexErrorContext context(retrieval->irb_relation, &temp_idx);
-			context.raise(tdbb, errorCode, NULL);
-		}
-	}
+		make_retrieval_keys(tdbb, retrieval, lower, upper);
 
 	RelationPages* relPages = retrieval->irb_relation->getPages(tdbb);
 	fb_assert(window->win_page.getPageSpaceID() == relPages->rel_pg_space_id);
 
+	if (btree_page* const leaf = find_leaf_optimistic(tdbb, window, retrieval, idx, lower))
+		return leaf;
+
 	window->win_page = relPages->rel_index_root;
 	index_root_page* rpage = (index_root_page*) CCH_FETCH(tdbb, window, LCK_read, pag_root);
 
@@ -1247,6 +1181,25 @@ btree_page* BTR_find_page(thread_db* tdbb,
 		IBERROR(260);	// msg 260 index unexpectedly deleted
 	}
 
+	const bool probe = probe_allowed(tdbb, retrieval, idx);
+
+	if (probe && tdbb->getDatabase()->dbb_index_probes->get(idx->idx_root, lower))
+	{
+		CCH_RELEASE(tdbb, window);
+
+		if (btree_page* const leaf = probe_leaf(tdbb, window, retrieval, idx, lower))
+			return leaf;
+
+		window->win_page = relPages->rel_index_root;
+		rpage = (index_root_page*) CCH_FETCH(tdbb, window, LCK_read, pag_root);
+
+		if (!BTR_description(tdbb, retrieval->irb_relation, rpage, idx, retrieval->irb_index))
+		{
+			CCH_RELEASE(tdbb, window);
+			IBERROR(260);	// msg 260 index unexpectedly deleted
+		}
+	}
+
 	btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
 
 	// If there is a starting descriptor, search down index to starting position.
@@ -1285,6 +1238,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 				page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
 			}
 		}
+
+		if (probe)
+			probe_remember(tdbb, retrieval, idx, lower, window);
 	}
 	else
 	{
@@ -1322,6 +1278,9 @@ void BTR_insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
  **************************************/
 	SET_TDBB(tdbb);
 
+	if (insert_by_hint(tdbb, root_window, insertion))
+		return;
+
 	index_desc* idx = insertion->iib_descriptor;
 	RelationPages* relPages = insertion->iib_relation->getPages(tdbb);
 	WIN window(relPages->rel_pg_space_id, idx->idx_root);
@@ -1905,6 +1864,44 @@ void BTR_make_null_key(thread_db* tdbb, const index_desc* idx, temporary_key* ke
 }
 
 
+void BTR_make_value_key(thread_db* tdbb, const index_desc* idx, const dsc* desc,
+						temporary_key* key, USHORT keyType)
+{
+/**************************************
+ *
+ *	B T R _ m a k e _ v a l u e _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Construct a search key for a single segment index
+ *	from an already known value (NULL if desc is NULL).
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	fb_assert(idx != NULL && idx->idx_count == 1);
+	fb_assert(key != NULL);
+
+	key->key_flags = key_empty;
+	key->key_nulls = desc ? 0 : 1;
+
+	const bool fuzzy = (keyType == INTL_KEY_PARTIAL || keyType == INTL_KEY_MULTI_STARTING);
+	const bool descending = (idx->idx_flags & idx_descending);
+
+	compress(tdbb, desc, key, idx->idx_rpt[0].idx_itype, descending, keyType);
+
+	if (fuzzy && (key->key_flags & key_empty))
+	{
+		key->key_length = 0;
+		key->key_next.reset();
+	}
+
+	if (descending)
+		BTR_complement_key(key);
+}
+
+
 bool BTR_next_index(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, index_desc* idx, WIN* window)
 {
 /**************************************
@@ -2188,20 +2185,23 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 }
 
 
-void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+double BTR_estimate(thread_db* tdbb, jrd_rel* relation, const index_desc* idx,
+					const temporary_key* lower, const temporary_key* upper, bool partial)
 {
 /**************************************
  *
- *	B T R _ s e l e c t i v i t y
+ *	B T R _ e s t i m a t e
  *
  **************************************
  *
  * Functional description
- *	Update index selectivity on the fly.
- *	Note that index leaf pages are walked
- *	without visiting data pages. Thus the
- *	effects of uncommitted transactions
- *	will be included in the calculation.
+ *	Estimate the fraction of the index entries with keys
+ *	between the given bounds (missing bound means no limit).
+ *	Every upper level of the tree is an equi-depth histogram
+ *	of the level below, so we walk down the pages covering
+ *	the range until the bounds split between different
+ *	child pages. Only one page per level is visited.
+ *	Returns a negative value if nothing can be estimated.
  *
  **************************************/
 
@@ -2211,177 +2211,710 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	index_root_page* root = fetch_root(tdbb, &window, relation, relPages);
 	if (!root)
-		return;
+		return -1;
 
 	ULONG page;
-	if (id >= root->irt_count || !(page = root->irt_rpt[id].getRoot()))
+	if (idx->idx_id >= root->irt_count || !(page = root->irt_rpt[idx->idx_id].getRoot()))
 	{
 		CCH_RELEASE(tdbb, &window);
-		return;
+		return -1;
 	}
 
-	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
-	const ULONG segments = root->irt_rpt[id].irt_keys;
-
-	window.win_flags = WIN_large_scan;
-	window.win_scans = 1;
 	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
 
-	// go down the left side of the index to leaf level
-	UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
-	while (bucket->btr_level)
+	double fraction = 1;
+	temporary_key key;
+
+	while (true)
 	{
-		IndexNode pageNode;
-		pageNode.readNode(pointer, false);
-		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
-		pointer = bucket->btr_nodes + bucket->btr_jump_size;
-		page = pageNode.pageNumber;
-	}
+		const bool leaf = (bucket->btr_level == 0);
 
-	FB_UINT64 nodes = 0;
-	FB_UINT64 duplicates = 0;
-	temporary_key key;
-	key.key_flags = 0;
-	key.key_length = 0;
-	SSHORT l;
-	bool firstNode = true;
+		ULONG entries = 0, matches = 0, first = 0, last = 0;
+		ULONG child = 0;
 
-	// SSHORT count, stuff_count, pos, i;
-	HalfStaticArray<FB_UINT64, 4> duplicatesList;
-	duplicatesList.grow(segments);
-	memset(duplicatesList.begin(), 0, segments * sizeof(FB_UINT64));
+		key.key_flags = 0;
+		key.key_length = 0;
 
-	//const Database* dbb = tdbb->getDatabase();
+		IndexNode node;
+		UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
 
-	// go through all the leaf nodes and count them;
-	// also count how many of them are duplicates
-	IndexNode node;
-	while (page)
-	{
-		pointer = node.readNode(pointer, true);
 		while (true)
 		{
-			if (node.isEndBucket || (nodes % 100 == 0))
-				JRD_reschedule(tdbb);
+			pointer = node.readNode(pointer, leaf);
 
 			if (node.isEndBucket || node.isEndLevel)
 				break;
 
-			++nodes;
-			l = node.length + node.prefix;
-
-			if (segments > 1 && !firstNode)
-			{
+			key.key_length = node.prefix + node.length;
+			memcpy(key.key_data + node.prefix, node.data, node.length);
 
-				// Initialize variables for segment duplicate check.
-				// count holds the current checking segment (starting by
-				// the maximum segment number to 1).
-				const UCHAR* p1 = key.key_data;
-				const UCHAR* const p1_end = p1 + key.key_length;
-				const UCHAR* p2 = node.data;
-				const UCHAR* const p2_end = p2 + node.length;
-				SSHORT count, stuff_count;
-				if (node.prefix == 0)
-				{
-					count = *p2;
-					//pos = 0;
-					stuff_count = 0;
-				}
-				else
-				{
-					const SSHORT pos = node.prefix;
-					// find the segment number were we're starting.
-					const SSHORT i = (pos / (STUFF_COUNT + 1)) * (STUFF_COUNT + 1);
-					if (i == pos)
-					{
-						// We _should_ pick number from data if available
-						count = *p2;
-					}
-					else
-						count = *(p1 + i);
+			const bool aboveLower = !lower || compare_keys(key, *lower, false) >= 0;
+			const bool belowUpper = !upper || compare_keys(key, *upper, partial) <= 0;
 
-					// update stuff_count to the current position.
-					stuff_count = STUFF_COUNT + 1 - (pos - i);
-					p1 += pos;
-				}
+			if (leaf)
+			{
+				if (aboveLower && belowUpper)
+					matches++;
+			}
+			else
+			{
+				// The child page of the last node below the lower bound is
+				// where the range starts, the last node not above the upper
+				// bound is where it ends
 
-				//Look for duplicates in the segments
-				while ((p1 < p1_end) && (p2 < p2_end))
+				if (!entries || !aboveLower)
 				{
-					if (stuff_count == 0)
-					{
-						if (*p1 != *p2)
-						{
-							// We're done
-							break;
-						}
-						count = *p2;
-						p1++;
-						p2++;
-						stuff_count = STUFF_COUNT;
-					}
-
-					if (*p1 != *p2)
-					{
-						//We're done
-						break;
-					}
-
-					p1++;
-					p2++;
-					stuff_count--;
+					first = entries;
+					child = node.pageNumber;
 				}
 
-				// For descending indexes the segment-number is also
-				// complemented, thus reverse it back.
-				// Note: values are complemented per UCHAR base.
-				if (descending)
-					count = (255 - count);
-
-				if ((p1 == p1_end) && (p2 == p2_end))
-					count = 0; // All segments are duplicates
-
-				for (ULONG i = count + 1; i <= segments; i++)
-					duplicatesList[segments - i]++;
+				if (!entries || belowUpper)
+					last = entries;
 			}
 
-			// figure out if this is a duplicate
-			bool dup;
-			if (node.nodePointer == bucket->btr_nodes + bucket->btr_jump_size)
-				dup = node.keyEqual(key.key_length, key.key_data);
-			else
-				dup = (!node.length && (l == key.key_length));
-
-			if (dup && !firstNode)
-				++duplicates;
+			entries++;
+		}
 
-			if (firstNode)
-				firstNode = false;
+		if (!entries)
+		{
+			fraction = -1;
+			break;
+		}
 
-			// keep the key value current for comparison with the next key
-			key.key_length = l;
-			memcpy(key.key_data + node.prefix, node.data, node.length);
-			pointer = node.readNode(pointer, true);
+		if (leaf)
+		{
+			fraction *= (double) matches / entries;
+			break;
 		}
 
-		if (node.isEndLevel || !(page = bucket->btr_sibling))
+		if (last != first)
+		{
+			fraction *= (last > first) ? (double) (last - first) / entries : 0;
 			break;
+		}
 
-		bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
-		pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		fraction /= entries;
+		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, child, LCK_read, pag_index);
 	}
 
-	CCH_RELEASE_TAIL(tdbb, &window);
+	CCH_RELEASE(tdbb, &window);
 
-	// calculate the selectivity
-	selectivity.grow(segments);
-	if (segments > 1)
-	{
-		for (ULONG i = 0; i < segments; i++)
-			selectivity[i] = (float) (nodes ? 1.0 / (float) (nodes - duplicatesList[i]) : 0.0);
-	}
-	else
-		selectivity[0] = (float) (nodes ? 1.0 / (float) (nodes - duplicates) : 0.0);
+	return fraction;
+}
+
+
+namespace
+{
+	// Minimal number of leaf pages worth to be read by parallel workers
+	const ULONG MIN_PARALLEL_LEAF_PAGES = 256;
+
+	// Number of leaf page ranges per parallel worker
+	const ULONG LEAF_RANGES_PER_WORKER = 8;
+
+	typedef HalfStaticArray<ULONG, 1024> LeafPageList;
+
+	// Accumulates the number of nodes and the number of key changes (for every
+	// leading part of the compound key) over a range of leaf pages. Some pages
+	// may be skipped, then the key changes inside the gap are estimated using
+	// the rate of changes seen. Adjacent ranges are joined in the index order.
+
+	class LeafStatistics
+	{
+	public:
+		LeafStatistics(MemoryPool& pool, ULONG segments, bool descending)
+			: m_segments(segments),
+			  m_descending(descending),
+			  m_changes(pool),
+			  m_gapCount(pool),
+			  m_gapSpan(pool),
+			  m_firstKey(pool),
+			  m_lastKey(pool)
+		{
+			m_changes.grow(segments);
+			m_gapCount.grow(segments);
+			m_gapSpan.grow(segments);
+		}
+
+		void skipPages(ULONG count)
+		{
+			if (m_nodes)
+				m_trailing += count;
+			else
+				m_leading += count;
+		}
+
+		void addPage(const btree_page* bucket);
+		void join(const LeafStatistics& next);
+		void getSelectivity(SelectivityList& selectivity) const;
+
+	private:
+		void addPair(ULONG equal, ULONG gap);
+		ULONG equalSegments(const UCHAR* data, USHORT length) const;
+
+		const ULONG m_segments;
+		const bool m_descending;
+		FB_UINT64 m_nodes = 0;
+		FB_UINT64 m_pairs = 0;				// adjacent nodes compared
+		ULONG m_pages = 0;
+		ULONG m_leading = 0;				// pages skipped before the first node
+		ULONG m_trailing = 0;				// pages skipped after the last node
+		HalfStaticArray<FB_UINT64, 4> m_changes;
+		HalfStaticArray<FB_UINT64, 4> m_gapCount;
+		HalfStaticArray<FB_UINT64, 4> m_gapSpan;
+		Array<UCHAR> m_firstKey;
+		Array<UCHAR> m_lastKey;
+	};
+
+	void LeafStatistics::addPage(const btree_page* bucket)
+	{
+		UCHAR* pointer = const_cast<UCHAR*>(bucket->btr_nodes + bucket->btr_jump_size);
+		bool firstNode = true;
+
+		IndexNode node;
+		while (true)
+		{
+			pointer = node.readNode(pointer, true);
+
+			if (node.isEndBucket || node.isEndLevel)
+				break;
+
+			if (firstNode)
+			{
+				// The first node of the page has no prefix, compare it
+				// with the last key of the previous page read
+				fb_assert(!node.prefix);
+
+				if (m_nodes)
+					addPair(equalSegments(node.data, node.length), m_trailing);
+
+				m_trailing = 0;
+			}
+			else
+			{
+				addPair(equal_segments(m_lastKey.begin(), m_lastKey.getCount(),
+					node.data, node.length, node.prefix, m_segments, m_descending), 0);
+			}
+
+			// keep the key value current for comparison with the next key
+			m_lastKey.resize(node.prefix + node.length);
+			memcpy(m_lastKey.begin() + node.prefix, node.data, node.length);
+
+			if (!m_nodes)
+				m_firstKey.assign(m_lastKey);
+
+			m_nodes++;
+			firstNode = false;
+		}
+
+		if (firstNode)
+			skipPages(1);
+		else
+			m_pages++;
+	}
+
+	void LeafStatistics::join(const LeafStatistics& next)
+	{
+		if (!next.m_nodes)
+		{
+			skipPages(next.m_leading);
+			return;
+		}
+
+		if (m_nodes)
+		{
+			addPair(equalSegments(next.m_firstKey.begin(), next.m_firstKey.getCount()),
+				m_trailing + next.m_leading);
+		}
+		else
+		{
+			m_leading += next.m_leading;
+			m_firstKey.assign(next.m_firstKey);
+		}
+
+		m_nodes += next.m_nodes;
+		m_pairs += next.m_pairs;
+		m_pages += next.m_pages;
+
+		for (ULONG i = 0; i < m_segments; i++)
+		{
+			m_changes[i] += next.m_changes[i];
+			m_gapCount[i] += next.m_gapCount[i];
+			m_gapSpan[i] += next.m_gapSpan[i];
+		}
+
+		m_trailing = next.m_trailing;
+		m_lastKey.assign(next.m_lastKey);
+	}
+
+	void LeafStatistics::getSelectivity(SelectivityList& selectivity) const
+	{
+		const double average = m_pages ? (double) m_nodes / m_pages : 0;
+
+		selectivity.grow(m_segments);
+
+		for (ULONG i = 0; i < m_segments; i++)
+		{
+			if (!m_nodes)
+			{
+				selectivity[i] = 0;
+				continue;
+			}
+
+			// Every gap between the pages read has at least one key change if the
+			// keys around it differ, and none if they are equal (the keys are ordered)
+			const double rate = m_pairs ? (double) m_changes[i] / m_pairs : 1;
+			const double gapChanges = MAX((double) m_gapCount[i], rate * average * m_gapSpan[i]);
+			const double distinct = 1 + m_changes[i] + gapChanges;
+
+			selectivity[i] = (float) (1.0 / distinct);
+		}
+	}
+
+	void LeafStatistics::addPair(ULONG equal, ULONG gap)
+	{
+		for (ULONG i = equal; i < m_segments; i++)
+		{
+			if (gap)
+			{
+				m_gapCount[i]++;
+				m_gapSpan[i] += gap + 1;
+			}
+			else
+				m_changes[i]++;
+		}
+
+		if (!gap)
+			m_pairs++;
+	}
+
+	ULONG LeafStatistics::equalSegments(const UCHAR* data, USHORT length) const
+	{
+		const UCHAR* const lastKey = m_lastKey.begin();
+		const USHORT lastLength = m_lastKey.getCount();
+
+		USHORT prefix = 0;
+		while (prefix < length && prefix < lastLength && lastKey[prefix] == data[prefix])
+			prefix++;
+
+		return equal_segments(lastKey, lastLength, data + prefix, length - prefix, prefix,
+			m_segments, m_descending);
+	}
+
+	void scanLeafPages(thread_db* tdbb, USHORT pageSpaceId, USHORT relationId, USHORT indexId,
+					   const ULONG* pages, ULONG count, LeafStatistics& stats)
+	{
+		for (ULONG i = 0; i < count; i++)
+		{
+			if (!pages[i])
+			{
+				stats.skipPages(1);
+				continue;
+			}
+
+			WIN window(pageSpaceId, pages[i]);
+			window.win_flags = WIN_large_scan;
+			window.win_scans = 1;
+
+			// The page could be released from the index and reused after
+			// its parent level was read, so don't insist on its type
+			const auto bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+			if (bucket->btr_header.pag_type == pag_index &&
+				!(bucket->btr_header.pag_flags & btr_released) &&
+				bucket->btr_relation == relationId && bucket->btr_id == (UCHAR) (indexId % 256) &&
+				bucket->btr_level == 0)
+			{
+				stats.addPage(bucket);
+			}
+			else
+				stats.skipPages(1);
+
+			CCH_RELEASE_TAIL(tdbb, &window);
+
+			JRD_reschedule(tdbb);
+		}
+	}
+
+
+	// Reads ranges of the leaf pages by parallel workers. Every worker uses
+	// its own attachment, the statistics of the ranges are joined afterwards.
+
+	class IndexStatisticsTask : public Task
+	{
+	public:
+		IndexStatisticsTask(thread_db* tdbb, MemoryPool* pool, USHORT pageSpaceId,
+							USHORT relationId, USHORT indexId, const LeafPageList& pages,
+							ULONG segments, bool descending, int workers) : Task(),
+			m_pool(pool),
+			m_dbb(tdbb->getDatabase()),
+			m_tdbb_flags(tdbb->tdbb_flags),
+			m_pageSpaceId(pageSpaceId),
+			m_relationId(relationId),
+			m_indexId(indexId),
+			m_pages(pages),
+			m_items(*m_pool),
+			m_ranges(*m_pool),
+			m_stop(false),
+			m_rangePages(0),
+			m_nextRange(0)
+		{
+			for (int i = 0; i < workers; i++)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+			const ULONG count = workers * LEAF_RANGES_PER_WORKER;
+			m_rangePages = (m_pages.getCount() + count - 1) / count;
+
+			for (ULONG i = 0; i * m_rangePages < m_pages.getCount(); i++)
+				m_ranges.add(FB_NEW_POOL(*m_pool) LeafStatistics(*m_pool, segments, descending));
+		}
+
+		virtual ~IndexStatisticsTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+
+			for (LeafStatistics** p = m_ranges.begin(); p < m_ranges.end(); p++)
+				delete *p;
+		}
+
+		bool handler(WorkItem& _item);
+		bool getWorkItem(WorkItem** pItem);
+		bool getResult(IStatus* status);
+
+		int getMaxWorkers()
+		{
+			return MIN(m_items.getCount(), m_ranges.getCount());
+		}
+
+		void collect(LeafStatistics& stats) const
+		{
+			for (const auto range : m_ranges)
+				stats.join(*range);
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(IndexStatisticsTask* task) : Task::WorkItem(task),
+				m_inuse(false),
+				m_range(0)
+			{}
+
+			virtual ~Item()
+			{
+				if (m_attStable)
+				{
+					FbLocalStatus status;
+					WorkerAttachment::releaseAttachment(&status, m_attStable);
+				}
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* status = tdbb->tdbb_status_vector;
+				Attachment* att = NULL;
+
+				if (!m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					Arg::Gds(isc_bad_db_handle).copyTo(status);
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+				return true;
+			}
+
+			IndexStatisticsTask* getTask() const
+			{
+				return reinterpret_cast<IndexStatisticsTask*> (m_task);
+			}
+
+			bool m_inuse;
+			RefPtr<StableAttachmentPart> m_attStable;
+			ULONG m_range;
+		};
+
+	private:
+		void setError(IStatus* status)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS)
+				m_status.save(status);
+
+			m_stop = true;
+		}
+
+		MemoryPool* m_pool;
+		Database* const m_dbb;
+		const ULONG m_tdbb_flags;
+		const USHORT m_pageSpaceId;
+		const USHORT m_relationId;
+		const USHORT m_indexId;
+		const LeafPageList& m_pages;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		HalfStaticArray<LeafStatistics*, 64> m_ranges;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+		ULONG m_rangePages;
+		ULONG m_nextRange;
+	};
+
+	bool IndexStatisticsTask::handler(WorkItem& _item)
+	{
+		Item* item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(NULL);
+		tdbb->tdbb_flags = m_tdbb_flags;
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		try
+		{
+			WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+			const ULONG start = item->m_range * m_rangePages;
+			const ULONG count = MIN(m_rangePages, m_pages.getCount() - start);
+
+			if (!m_stop)
+			{
+				scanLeafPages(tdbb, m_pageSpaceId, m_relationId, m_indexId,
+					m_pages.begin() + start, count, *m_ranges[item->m_range]);
+			}
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool IndexStatisticsTask::getWorkItem(WorkItem** pItem)
+	{
+		Item* item = reinterpret_cast<Item*> (*pItem);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop)
+			return false;
+
+		if (item == NULL)
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			{
+				if (!(*p)->m_inuse)
+				{
+					(*p)->m_inuse = true;
+					*pItem = item = *p;
+					break;
+				}
+			}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_inuse = (m_nextRange < m_ranges.getCount());
+
+		if (item->m_inuse)
+			item->m_range = m_nextRange++;
+
+		return item->m_inuse;
+	}
+
+	bool IndexStatisticsTask::getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+} // namespace
+
+
+void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+{
+/**************************************
+ *
+ *	B T R _ s e l e c t i v i t y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Update index selectivity on the fly.
+ *	Note that index leaf pages are walked
+ *	without visiting data pages. Thus the
+ *	effects of uncommitted transactions
+ *	will be included in the calculation.
+ *	Depending on IndexStatisticsSampling only
+ *	a part of leaf pages may be read, possibly
+ *	by parallel workers.
+ *
+ **************************************/
+
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	index_root_page* root = fetch_root(tdbb, &window, relation, relPages);
+	if (!root)
+		return;
+
+	ULONG page;
+	if (id >= root->irt_count || !(page = root->irt_rpt[id].getRoot()))
+	{
+		CCH_RELEASE(tdbb, &window);
+		return;
+	}
+
+	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
+	const ULONG segments = root->irt_rpt[id].irt_keys;
+
+	window.win_flags = WIN_large_scan;
+	window.win_scans = 1;
+	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
+
+	const ULONG sampling = dbb->dbb_config->getIndexStatisticsSampling();
+	const int workers = relation->isTemporary() ? 1 : tdbb->getAttachment()->att_parallel_workers;
+
+	LeafStatistics stats(pool, segments, descending);
+
+	if (bucket->btr_level && (sampling < 100 || workers > 1))
+	{
+		// go down the left side of the index to the level above leaves
+		UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		while (bucket->btr_level > 1)
+		{
+			IndexNode pageNode;
+			pageNode.readNode(pointer, false);
+			bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
+			pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		}
+
+		// collect all the leaf page numbers from it
+		LeafPageList leafPages(pool);
+		IndexNode node;
+		while (true)
+		{
+			pointer = node.readNode(pointer, false);
+
+			if (node.isEndBucket || node.isEndLevel)
+			{
+				if (node.isEndLevel || !(page = bucket->btr_sibling))
+					break;
+
+				bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
+				pointer = bucket->btr_nodes + bucket->btr_jump_size;
+
+				JRD_reschedule(tdbb);
+				continue;
+			}
+
+			leafPages.add(node.pageNumber);
+		}
+
+		CCH_RELEASE_TAIL(tdbb, &window);
+
+		// keep the first, the last and the evenly spaced leaf pages in between
+		ULONG sampled = leafPages.getCount();
+
+		if (sampling < 100 && sampled > 2)
+		{
+			const double step = 100.0 / sampling;
+			double next = 0;
+
+			for (ULONG i = 0; i < leafPages.getCount() - 1; i++)
+			{
+				if (i >= next)
+					next += step;
+				else
+				{
+					leafPages[i] = 0;
+					sampled--;
+				}
+			}
+		}
+
+		if (workers > 1 && sampled >= MIN_PARALLEL_LEAF_PAGES)
+		{
+			Coordinator coord(&pool);
+			IndexStatisticsTask task(tdbb, &pool, relPages->rel_pg_space_id, relation->rel_id, id,
+				leafPages, segments, descending, workers);
+
+			{
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+
+				FbLocalStatus local_status;
+				fb_utils::init_status(&local_status);
+
+				coord.runSync(&task);
+
+				if (!task.getResult(&local_status))
+					local_status.raise();
+			}
+
+			task.collect(stats);
+		}
+		else
+		{
+			scanLeafPages(tdbb, relPages->rel_pg_space_id, relation->rel_id, id,
+				leafPages.begin(), leafPages.getCount(), stats);
+		}
+	}
+	else
+	{
+		// go down the left side of the index to leaf level
+		UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		while (bucket->btr_level)
+		{
+			IndexNode pageNode;
+			pageNode.readNode(pointer, false);
+			bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
+			pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		}
+
+		// go through all the leaf nodes and count them;
+		// also count how many of them are duplicates
+		while (true)
+		{
+			stats.addPage(bucket);
+
+			if (!(page = bucket->btr_sibling))
+				break;
+
+			bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
+
+			JRD_reschedule(tdbb);
+		}
+
+		CCH_RELEASE_TAIL(tdbb, &window);
+	}
+
+	// calculate the selectivity
+	stats.getSelectivity(selectivity);
 
 	// Store the selectivity on the root page
 	window.win_page = relPages->rel_index_root;
@@ -3080,6 +3613,31 @@ static void compress(thread_db* tdbb,
 }
 
 
+static int compare_keys(const temporary_key& key1, const temporary_key& key2, bool partial)
+{
+/**************************************
+ *
+ *	c o m p a r e _ k e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compare two index keys. If partial is true, a key
+ *	starting with the second one is considered equal to it.
+ *
+ **************************************/
+	const USHORT length = MIN(key1.key_length, key2.key_length);
+
+	if (const int result = memcmp(key1.key_data, key2.key_data, length))
+		return result;
+
+	if (partial && key1.key_length >= key2.key_length)
+		return 0;
+
+	return (int) key1.key_length - (int) key2.key_length;
+}
+
+
 static USHORT compress_root(thread_db* tdbb, index_root_page* page)
 {
 /**************************************
@@ -3469,30 +4027,355 @@ static void delete_tree(thread_db* tdbb,
 			return;
 		}
 
-		// if we are at the beginning of a non-leaf level, position
-		// "down" to the beginning of the next level down
-		if (next.getPageNum() == down)
+		// if we are at the beginning of a non-leaf level, position
+		// "down" to the beginning of the next level down
+		if (next.getPageNum() == down)
+		{
+			if (page->btr_level)
+			{
+				UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+				IndexNode pageNode;
+				pageNode.readNode(pointer, false);
+				down = pageNode.pageNumber;
+			}
+			else
+				down = 0;
+		}
+
+		// go through all the sibling pages on this level and release them,
+		// marking them as released as they could be cached as leaf page hints
+		next = page->btr_sibling;
+		CCH_MARK(tdbb, &window);
+		page->btr_header.pag_flags |= btr_released;
+		CCH_RELEASE_TAIL(tdbb, &window);
+		PAG_release_page(tdbb, window.win_page, prior);
+		prior = window.win_page;
+
+		// if we are at end of level, go down to the next level
+		if (!next.getPageNum())
+			next = down;
+	}
+}
+
+
+static ULONG equal_segments(const UCHAR* prior, USHORT priorLength,
+							const UCHAR* data, USHORT length, USHORT prefix,
+							ULONG segments, bool descending)
+{
+/**************************************
+ *
+ *	e q u a l _ s e g m e n t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the number of leading segments the key has
+ *	in common with the prior one. The key is given by its
+ *	data following the prefix shared with the prior key.
+ *
+ **************************************/
+	if (segments == 1)
+		return (!length && prefix == priorLength) ? 1 : 0;
+
+	// Initialize variables for segment duplicate check.
+	// count holds the current checking segment (starting by
+	// the maximum segment number to 1).
+	const UCHAR* p1 = prior;
+	const UCHAR* const p1_end = p1 + priorLength;
+	const UCHAR* p2 = data;
+	const UCHAR* const p2_end = p2 + length;
+	SSHORT count, stuff_count;
+
+	if (prefix == 0)
+	{
+		count = length ? *p2 : 0;
+		stuff_count = 0;
+	}
+	else
+	{
+		// find the segment number were we're starting.
+		const SSHORT i = (prefix / (STUFF_COUNT + 1)) * (STUFF_COUNT + 1);
+		if (i == prefix && length)
+		{
+			// We _should_ pick number from data if available
+			count = *p2;
+		}
+		else
+			count = *(p1 + i);
+
+		// update stuff_count to the current position.
+		stuff_count = STUFF_COUNT + 1 - (prefix - i);
+		p1 += prefix;
+	}
+
+	// Look for duplicates in the segments
+	while ((p1 < p1_end) && (p2 < p2_end))
+	{
+		if (stuff_count == 0)
+		{
+			if (*p1 != *p2)
+			{
+				// We're done
+				break;
+			}
+			count = *p2;
+			p1++;
+			p2++;
+			stuff_count = STUFF_COUNT;
+		}
+
+		if (*p1 != *p2)
+		{
+			// We're done
+			break;
+		}
+
+		p1++;
+		p2++;
+		stuff_count--;
+	}
+
+	// For descending indexes the segment-number is also
+	// complemented, thus reverse it back.
+	// Note: values are complemented per UCHAR base.
+	if (descending)
+		count = (255 - count);
+
+	if ((p1 == p1_end) && (p2 == p2_end))
+		count = 0; // All segments are duplicates
+
+	return (count < (SSHORT) segments) ? segments - count : 0;
+}
+
+
+static void evaluate_range(thread_db* tdbb, const IndexRetrieval* retrieval, WIN* window,
+						   btree_page* page, index_desc& idx, temporary_key* lower, temporary_key* upper,
+						   RecordBitmap** bitmap, RecordBitmap* bitmap_and)
+{
+/**************************************
+ *
+ *	e v a l u a t e _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Scan the index from the leaf page found for the lower
+ *	key up to the upper key and set the record numbers in
+ *	the bitmap. The page is released at the end.
+ *
+ **************************************/
+	const bool descending = (idx.idx_flags & idx_descending);
+	bool skipLowerKey = (retrieval->irb_generic & irb_exclude_lower);
+	const bool partLower = (retrieval->irb_lower_count < idx.idx_count);
+
+	// If there is a starting descriptor, search down index to starting position.
+	// This may involve sibling buckets if splits are in progress.  If there
+	// isn't a starting descriptor, walk down the left side of the index.
+	USHORT prefix;
+	UCHAR* pointer;
+	if (retrieval->irb_lower_count)
+	{
+		while (!(pointer = find_node_start_point(page, lower, 0, &prefix,
+			idx.idx_flags & idx_descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
+		{
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+		}
+
+		// Compute the number of matching characters in lower and upper bounds
+		if (retrieval->irb_upper_count)
+		{
+			prefix = IndexNode::computePrefix(upper->key_data, upper->key_length,
+												lower->key_data, lower->key_length);
+		}
+
+		if (skipLowerKey)
+		{
+			IndexNode node;
+			node.readNode(pointer, true);
+			checkForLowerKeySkip(skipLowerKey, partLower, node, *lower, idx, retrieval);
+		}
+	}
+	else
+	{
+		pointer = page->btr_nodes + page->btr_jump_size;
+		prefix = 0;
+		skipLowerKey = false;
+	}
+
+	// if there is an upper bound, scan the index pages looking for it
+	if (retrieval->irb_upper_count)
+	{
+		while (scan(tdbb, pointer, bitmap, bitmap_and, &idx, retrieval, prefix, upper,
+					skipLowerKey, *lower))
+		{
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+			pointer = page->btr_nodes + page->btr_jump_size;
+			prefix = 0;
+		}
+	}
+	else
+	{
+		// if there isn't an upper bound, just walk the index to the end of the level
+		const UCHAR* endPointer = (UCHAR*) page + page->btr_length;
+		const bool ignoreNulls =
+			(retrieval->irb_generic & irb_ignore_null_value_key) && (idx.idx_count == 1);
+
+		IndexNode node;
+		pointer = node.readNode(pointer, true);
+
+		// Check if pointer is still valid
+		if (pointer > endPointer)
+			BUGCHECK(204);	// msg 204 index inconsistent
+
+		while (true)
+		{
+			if (node.isEndLevel)
+				break;
+
+			if (!node.isEndBucket)
+			{
+				// If we're walking in a descending index and we need to ignore NULLs
+				// then stop at the first NULL we see (only for single segment!)
+				if (descending && ignoreNulls && node.prefix == 0 &&
+					node.length >= 1 && node.data[0] == 255)
+				{
+					break;
+				}
+
+				if (skipLowerKey)
+					checkForLowerKeySkip(skipLowerKey, partLower, node, *lower, idx, retrieval);
+
+				if (!skipLowerKey)
+				{
+					if (!bitmap_and || bitmap_and->test(node.recordNumber.getValue()))
+						RBM_SET(tdbb->getDefaultPool(), bitmap, node.recordNumber.getValue());
+				}
+
+				pointer = node.readNode(pointer, true);
+
+				// Check if pointer is still valid
+				if (pointer > endPointer)
+					BUGCHECK(204);	// msg 204 index inconsistent
+
+				continue;
+			}
+
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+			endPointer = (UCHAR*) page + page->btr_length;
+			pointer = page->btr_nodes + page->btr_jump_size;
+			pointer = node.readNode(pointer, true);
+
+			// Check if pointer is still valid
+			if (pointer > endPointer)
+				BUGCHECK(204);	// msg 204 index inconsistent
+		}
+	}
+
+	CCH_RELEASE(tdbb, window);
+}
+
+
+static void evaluate_skip_scan(thread_db* tdbb, const IndexRetrieval* retrieval,
+							   RecordBitmap** bitmap, RecordBitmap* bitmap_and)
+{
+/**************************************
+ *
+ *	e v a l u a t e _ s k i p _ s c a n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Do an index scan not bounded by the leading segment.
+ *	Distinct values of the leading segment are taken from
+ *	the index one by one, every one of them is scanned for
+ *	the bounds of the next segments.
+ *
+ **************************************/
+	const Database* const dbb = tdbb->getDatabase();
+	RelationPages* relPages = retrieval->irb_relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+	index_desc idx;
+
+	fb_assert(!(retrieval->irb_generic & (irb_descending | irb_multi_starting)));
+	fb_assert(retrieval->irb_lower_count && retrieval->irb_upper_count);
+
+	// The leading segment is NULL in the retrieval, so it produces no key data
+	// and the keys contain only the following segments
+
+	temporary_key lowerTail, upperTail;
+	lowerTail.key_flags = upperTail.key_flags = 0;
+	lowerTail.key_length = upperTail.key_length = 0;
+
+	make_retrieval_keys(tdbb, retrieval, &lowerTail, &upperTail);
+
+	const UCHAR leadingSegment = retrieval->irb_desc.idx_count;
+	const USHORT maxKeyLength = dbb->getMaxIndexKeyLength();
+
+	temporary_key position;
+	position.key_flags = 0;
+	position.key_length = 0;
+
+	while (true)
+	{
+		// Find the first key at or after the position, it starts the next leading value
+
+		temporary_key found, dummy;
+		btree_page* page = BTR_find_page(tdbb, retrieval, &window, &idx, &position, &dummy, false);
+
+		UCHAR* pointer;
+		while (!(pointer = find_node_start_point(page, &position, found.key_data, NULL, false, 0)))
+			page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+
+		IndexNode node;
+		node.readNode(pointer, true);
+
+		CCH_RELEASE(tdbb, &window);
+
+		if (node.isEndLevel)
+			break;
+
+		found.key_length = node.prefix + node.length;
+
+		// The leading segment occupies the starting groups
+		// of the compound key marked with its number
+
+		USHORT length = 0;
+		while (length < found.key_length && found.key_data[length] == leadingSegment)
+			length += STUFF_COUNT + 1;
+
+		length = MIN(length, found.key_length);
+
+		if (length + MAX(lowerTail.key_length, upperTail.key_length) >= maxKeyLength)
 		{
-			if (page->btr_level)
-			{
-				UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
-				IndexNode pageNode;
-				pageNode.readNode(pointer, false);
-				down = pageNode.pageNumber;
-			}
-			else
-				down = 0;
+			index_desc temp_idx = retrieval->irb_desc; // to avoid constness issues
+			IndexErrorContext context(retrieval->irb_relation, &temp_idx);
+			context.raise(tdbb, idx_e_keytoobig, NULL);
 		}
 
-		// go through all the sibling pages on this level and release them
-		next = page->btr_sibling;
-		CCH_RELEASE_TAIL(tdbb, &window);
-		PAG_release_page(tdbb, window.win_page, prior);
-		prior = window.win_page;
+		// Scan the range of the next segments inside this leading value
 
-		// if we are at end of level, go down to the next level
-		if (!next.getPageNum())
-			next = down;
+		temporary_key lower, upper;
+		lower.key_flags = lowerTail.key_flags;
+		lower.key_nulls = lowerTail.key_nulls;
+		lower.key_length = length + lowerTail.key_length;
+		memcpy(lower.key_data, found.key_data, length);
+		memcpy(lower.key_data + length, lowerTail.key_data, lowerTail.key_length);
+
+		upper.key_flags = upperTail.key_flags;
+		upper.key_nulls = upperTail.key_nulls;
+		upper.key_length = length + upperTail.key_length;
+		memcpy(upper.key_data, found.key_data, length);
+		memcpy(upper.key_data + length, upperTail.key_data, upperTail.key_length);
+
+		page = BTR_find_page(tdbb, retrieval, &window, &idx, &lower, &upper, false);
+		evaluate_range(tdbb, retrieval, &window, page, idx, &lower, &upper, bitmap, bitmap_and);
+
+		// Keys with the same leading value continue with the marker of the next
+		// segment, so the leading marker positions after all of them
+
+		memcpy(position.key_data, found.key_data, length);
+		position.key_data[length] = leadingSegment;
+		position.key_length = length + 1;
 	}
 }
 
@@ -3541,17 +4424,22 @@ static ULONG fast_load(thread_db* tdbb,
 	// indices, cause this value is stored on each page.
 	// Remember, the lower the value how more jumpkeys are generated and
 	// how faster jumpkeys are recalculated on insert.
-
-	const USHORT jumpAreaSize = 512 + ((int) sqrt((float) key_length) * 16);
-
-	//  key_size  |  jumpAreaSize
-	//  ----------+-----------------
-	//         4  |    544
-	//         8  |    557
-	//        16  |    576
-	//        64  |    640
-	//       128  |    693
-	//       256  |    768
+	// A search walks the jump nodes first and then the nodes of one area,
+	// both linearly, so the number of jump nodes is kept close to the
+	// number of nodes in an area, i.e. the area size grows as a square
+	// root of the page size multiplied by an estimated node size.
+
+	const USHORT jumpAreaSize =
+		(USHORT) sqrt((double) dbb->dbb_page_size * (8 + key_length / 4));
+
+	//  key_size  |  jumpAreaSize (8K page)  |  jumpAreaSize (32K page)
+	//  ----------+--------------------------+-------------------------
+	//         4  |    271                   |    543
+	//         8  |    286                   |    572
+	//        16  |    313                   |    627
+	//        64  |    443                   |    886
+	//       128  |    572                   |   1144
+	//       256  |    768                   |   1536
 
 	WIN* window = NULL;
 	bool error = false;
@@ -3569,6 +4457,13 @@ static ULONG fast_load(thread_db* tdbb,
 	HalfStaticArray<FB_UINT64, 4> duplicatesList(pool);
 	HalfStaticArray<FastLoadLevel, 4> levels(pool);
 
+	// Let the sort partitions be merged by a separate thread while the b-tree
+	// is built. It takes one more CPU, so do it if parallel work is allowed.
+	if (tdbb->getAttachment()->att_parallel_workers > 1)
+		creation.sort->startMergeAhead();
+
+	Cleanup stopMergeAhead([&creation] { creation.sort->stopMergeAhead(); });
+
 	try
 	{
 		levels.resize(1);
@@ -4688,6 +5583,138 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 }
 
 
+static btree_page* find_leaf_optimistic(thread_db* tdbb, WIN* window, const IndexRetrieval* retrieval,
+										index_desc* idx, const temporary_key* lower)
+{
+/**************************************
+ *
+ *	f i n d _ l e a f _ o p t i m i s t i c
+ *
+ **************************************
+ *
+ * Functional description
+ *	Search down the index to the starting leaf page
+ *	by copies of the upper level pages made without
+ *	latching them, see CCH_copy_page. The copy of every
+ *	page is validated after the copy of its child is made
+ *	and the copy of the last upper level page is validated
+ *	after the leaf page is latched, as pages can't be
+ *	removed from the tree without changing their parent.
+ *	Return NULL if some page is not cached or has been
+ *	changed on the way, the caller should search down
+ *	the index latching its pages then.
+ *
+ **************************************/
+	const Database* const dbb = tdbb->getDatabase();
+	jrd_rel* const relation = retrieval->irb_relation;
+	RelationPages* const relPages = relation->getPages(tdbb);
+
+	// Keep page image aligned as its structures are accessed directly
+	HalfStaticArray<SINT64, 1024> image;
+	pag* const buffer = (pag*) image.getBuffer(dbb->dbb_page_size / sizeof(SINT64));
+
+	PageVersion parent;
+	if (!CCH_copy_page(tdbb, PageNumber(relPages->rel_pg_space_id, relPages->rel_index_root),
+			buffer, parent))
+	{
+		return NULL;
+	}
+
+	if (buffer->pag_type != pag_root ||
+		!BTR_description(tdbb, relation, (index_root_page*) buffer, idx, retrieval->irb_index))
+	{
+		return NULL;
+	}
+
+	// See BTR_find_page for this logic
+	const bool ignoreNulls = ((idx->idx_count == 1) && !(idx->idx_flags & idx_descending) &&
+		(retrieval->irb_generic & irb_ignore_null_value_key) && !(retrieval->irb_lower_count));
+
+	if (!retrieval->irb_lower_count && !ignoreNulls)
+		return NULL;
+
+	const bool probe = probe_allowed(tdbb, retrieval, idx);
+
+	if (probe)
+	{
+		if (btree_page* const leaf = probe_leaf(tdbb, window, retrieval, idx, lower))
+			return leaf;
+	}
+
+	temporary_key firstNotNullKey;
+	firstNotNullKey.key_flags = 0;
+	firstNotNullKey.key_data[0] = 0;
+	firstNotNullKey.key_length = 1;
+
+	const temporary_key* const key = ignoreNulls ? &firstNotNullKey : lower;
+	const btree_page* const page = (btree_page*) buffer;
+
+	PageVersion current;
+	ULONG number = idx->idx_root;
+	UCHAR level = 0;
+
+	while (true)
+	{
+		if (!CCH_copy_page(tdbb, PageNumber(relPages->rel_pg_space_id, number), buffer, current) ||
+			!CCH_validate_copy(parent))
+		{
+			return NULL;
+		}
+
+		// Small indices have no upper level pages, while unexpected level
+		// means the page has been released and allocated again.
+		if (page->btr_header.pag_type != pag_index ||
+			page->btr_relation != relation->rel_id ||
+			page->btr_id != (UCHAR) (idx->idx_id % 256) ||
+			page->btr_length > dbb->dbb_page_size ||
+			page->btr_level == 0 ||
+			(level && page->btr_level != level))
+		{
+			return NULL;
+		}
+
+		level = page->btr_level;
+		parent = current;
+
+		const ULONG child = find_page((btree_page*) page, key, idx,
+			NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
+
+		if (child == END_BUCKET)
+		{
+			if (!(number = page->btr_sibling))
+				return NULL;
+
+			continue;
+		}
+
+		number = child;
+
+		if (level == 1)
+			break;
+
+		level--;
+	}
+
+	window->win_page = number;
+	btree_page* const leaf = (btree_page*) CCH_FETCH(tdbb, window, LCK_read, pag_undefined);
+
+	if (!CCH_validate_copy(parent) ||
+		leaf->btr_header.pag_type != pag_index ||
+		leaf->btr_relation != relation->rel_id ||
+		leaf->btr_id != (UCHAR) (idx->idx_id % 256) ||
+		leaf->btr_level != 0)
+	{
+		CCH_RELEASE(tdbb, window);
+		return NULL;
+	}
+
+	if (probe)
+		probe_remember(tdbb, retrieval, idx, lower, window);
+
+	return leaf;
+}
+
+
 static ULONG find_page(btree_page* bucket, const temporary_key* key,
 					   const index_desc* idx, RecordNumber find_record_number,
 					   int retrieval)
@@ -5514,13 +6541,98 @@ static void generate_jump_nodes(thread_db* tdbb, btree_page* page,
 }
 
 
+static bool insert_by_hint(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
+{
+/**************************************
+ *
+ *	i n s e r t _ b y _ h i n t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Try to insert a node into the leaf page the previous
+ *	node of the index was inserted into, without search
+ *	down the index. It works if the key is greater than
+ *	the first key of the page and is not greater than its
+ *	last key (or the page is the last one), and the page
+ *	has room for the node. Bulk inserts of increasing or
+ *	clustered keys get there most of the time.
+ *
+ **************************************/
+	index_desc* const idx = insertion->iib_descriptor;
+	RelationPages* const relPages = insertion->iib_relation->getPages(tdbb);
+
+	// Keys of descending indices are compared in a special way, see find_node_start_point
+	if ((idx->idx_flags & idx_descending) || idx->idx_id >= RelationPages::MAX_LEAF_HINTS)
+		return false;
+
+	const RelationPages::LeafHint hint = relPages->rel_leaf_hints[idx->idx_id];
+
+	if (!hint.lh_leaf || hint.lh_root != idx->idx_root || hint.lh_leaf == idx->idx_root)
+		return false;
+
+	WIN window(relPages->rel_pg_space_id, hint.lh_leaf);
+	const btree_page* const page = (btree_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_undefined);
+
+	// The page could be released or reused since the last insertion
+	if (page->btr_header.pag_type != pag_index ||
+		(page->btr_header.pag_flags & btr_released) ||
+		page->btr_relation != insertion->iib_relation->rel_id ||
+		page->btr_id != (UCHAR) (idx->idx_id % 256) ||
+		page->btr_level != 0)
+	{
+		CCH_RELEASE(tdbb, &window);
+		return false;
+	}
+
+	// The key equal to or less than the first key of the page may belong to the left sibling
+	const temporary_key* const key = insertion->iib_key;
+
+	IndexNode node;
+	node.readNode((UCHAR*) page->btr_nodes + page->btr_jump_size, true);
+
+	if (node.isEndBucket || node.isEndLevel)
+	{
+		CCH_RELEASE(tdbb, &window);
+		return false;
+	}
+
+	const int result = memcmp(key->key_data, node.data, MIN(key->key_length, node.length));
+
+	if (result < 0 || (result == 0 && key->key_length <= node.length))
+	{
+		CCH_RELEASE(tdbb, &window);
+		return false;
+	}
+
+	temporary_key newKey;
+	newKey.key_flags = 0;
+	newKey.key_length = 0;
+
+	RecordNumber recordNumber(0);
+	BtrPageGCLock lock(tdbb);
+	insertion->iib_dont_gc_lock = &lock;
+
+	// Page split has to be propagated to the upper levels, so search down the index then
+	if (insert_node(tdbb, &window, insertion, &newKey, &recordNumber, NULL, NULL, true) != NO_SPLIT)
+	{
+		CCH_RELEASE(tdbb, &window);
+		return false;
+	}
+
+	CCH_RELEASE(tdbb, root_window);
+	return true;
+}
+
+
 static ULONG insert_node(thread_db* tdbb,
 						 WIN* window,
 						 index_insertion* insertion,
 						 temporary_key* new_key,
 						 RecordNumber* new_record_number,
 						 ULONG* original_page,
-						 ULONG* sibling_page)
+						 ULONG* sibling_page,
+						 bool noSplit)
 {
 /**************************************
  *
@@ -5533,6 +6645,8 @@ static ULONG insert_node(thread_db* tdbb,
  *  If this isn't the right bucket, return NO_VALUE.
  *  If it splits, return the split page number and
  *	leading string.  This is the workhorse for add_node.
+ *	If the caller can't handle split, return NO_VALUE
+ *	instead of splitting, leaving the page unchanged.
  *
  **************************************/
 
@@ -5793,9 +6907,34 @@ static ULONG insert_node(thread_db* tdbb,
 			BTR_key_length(tdbb, insertion->iib_relation, insertion->iib_descriptor));
 	}
 
+	const bool fits = (newBucket->btr_length + ensureEndInsert +
+		jumpersNewSize - jumpersOriginalSize <= dbb->dbb_page_size);
+
+	if (leafPage && (fits || !noSplit) && idx->idx_id < RelationPages::MAX_LEAF_HINTS)
+	{
+		// Remember the leaf page for the next insertion
+		RelationPages* const relPages = insertion->iib_relation->getPages(tdbb);
+		RelationPages::LeafHint& hint = relPages->rel_leaf_hints[idx->idx_id];
+		hint.lh_root = idx->idx_root;
+		hint.lh_leaf = window->win_page.getPageNum();
+	}
+
+	if (!fits && noSplit)
+	{
+		if (fragmentedOffset)
+		{
+			IndexJumpNode* walkJumpNode = jumpNodes->begin();
+			for (size_t i = 0; i < jumpNodes->getCount(); i++)
+				delete[] walkJumpNode[i].data;
+		}
+
+		jumpNodes->clear();
+
+		return NO_VALUE_PAGE;
+	}
+
 	// If the bucket still fits on a page, we're almost done.
-	if (newBucket->btr_length + ensureEndInsert +
-		jumpersNewSize - jumpersOriginalSize <= dbb->dbb_page_size)
+	if (fits)
 	{
 		// if we are a pointer page, make sure that the page we are
 		// pointing to gets written before we do for on-disk integrity
@@ -6140,6 +7279,55 @@ static ULONG insert_node(thread_db* tdbb,
 }
 
 
+static void make_retrieval_keys(thread_db* tdbb, const IndexRetrieval* retrieval,
+								temporary_key* lower, temporary_key* upper)
+{
+/**************************************
+ *
+ *	m a k e _ r e t r i e v a l _ k e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Make the lower and upper search keys from
+ *	the values of the index retrieval.
+ *
+ **************************************/
+	idx_e errorCode = idx_e_ok;
+
+	const USHORT keyType =
+		(retrieval->irb_generic & irb_multi_starting) ? INTL_KEY_MULTI_STARTING :
+		(retrieval->irb_generic & irb_starting) ? INTL_KEY_PARTIAL :
+		(retrieval->irb_desc.idx_flags & idx_unique) ? INTL_KEY_UNIQUE :
+		INTL_KEY_SORT;
+
+	if (retrieval->irb_upper_count)
+	{
+		errorCode = BTR_make_key(tdbb, retrieval->irb_upper_count,
+								 retrieval->irb_value + retrieval->irb_desc.idx_count,
+								 &retrieval->irb_desc, upper,
+								 keyType);
+	}
+
+	if (errorCode == idx_e_ok)
+	{
+		if (retrieval->irb_lower_count)
+		{
+			errorCode = BTR_make_key(tdbb, retrieval->irb_lower_count,
+									 retrieval->irb_value, &retrieval->irb_desc, lower,
+									 keyType);
+		}
+	}
+
+	if (errorCode != idx_e_ok)
+	{
+		index_desc temp_idx = retrieval->irb_desc; // to avoid constness issues
+		IndexErrorContext context(retrieval->irb_relation, &temp_idx);
+		context.raise(tdbb, errorCode, NULL);
+	}
+}
+
+
 static INT64_KEY make_int64_key(SINT64 q, SSHORT scale)
 {
 /**************************************
@@ -6276,6 +7464,123 @@ string print_key(thread_db* tdbb, jrd_rel* relation, index_desc* idx, Record* re
 }
 
 
+static bool probe_allowed(thread_db* tdbb, const IndexRetrieval* retrieval, const index_desc* idx)
+{
+/**************************************
+ *
+ *	p r o b e _ a l l o w e d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the leaf page of a lookup could be got from
+ *	the probe cache. Only full key equality lookups of
+ *	ascending indices are cached, as keys of other lookups
+ *	are not compared with the index keys in the plain way.
+ *
+ **************************************/
+	return tdbb->getDatabase()->dbb_index_probes &&
+		(retrieval->irb_generic & irb_equality) &&
+		!(retrieval->irb_generic & (irb_partial | irb_starting | irb_descending |
+			irb_multi_starting | irb_skip_scan)) &&
+		!(idx->idx_flags & idx_descending) &&
+		retrieval->irb_lower_count == idx->idx_count;
+}
+
+
+static bool probe_fits(const btree_page* page, const IndexRetrieval* retrieval,
+					   const index_desc* idx, const temporary_key* key)
+{
+/**************************************
+ *
+ *	p r o b e _ f i t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the search for a key could start at the page.
+ *	The page must be a leaf page of the index and the key
+ *	must be greater than its first key, so no lesser page
+ *	could contain the key. The key greater than the keys
+ *	of the page is looked for at its siblings as usual.
+ *
+ **************************************/
+	if (page->btr_header.pag_type != pag_index ||
+		(page->btr_header.pag_flags & btr_released) ||
+		page->btr_relation != retrieval->irb_relation->rel_id ||
+		page->btr_id != (UCHAR) (idx->idx_id % 256) ||
+		page->btr_level != 0)
+	{
+		return false;
+	}
+
+	IndexNode node;
+	node.readNode((UCHAR*) page->btr_nodes + page->btr_jump_size, true);
+
+	if (node.isEndBucket || node.isEndLevel)
+		return false;
+
+	const int result = memcmp(key->key_data, node.data, MIN(key->key_length, node.length));
+
+	return (result > 0 || (result == 0 && key->key_length > node.length));
+}
+
+
+static btree_page* probe_leaf(thread_db* tdbb, WIN* window, const IndexRetrieval* retrieval,
+							  const index_desc* idx, const temporary_key* key)
+{
+/**************************************
+ *
+ *	p r o b e _ l e a f
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fetch the leaf page of a key lookup from the probe cache.
+ *	Return NULL if the key is not cached or the page is not
+ *	valid for the key anymore.
+ *
+ **************************************/
+	const ULONG number = tdbb->getDatabase()->dbb_index_probes->get(idx->idx_root, key);
+
+	if (!number)
+		return NULL;
+
+	// The page could be released from the index and reused since it was cached
+	window->win_page = number;
+	btree_page* const leaf = (btree_page*) CCH_FETCH(tdbb, window, LCK_read, pag_undefined);
+
+	if (!probe_fits(leaf, retrieval, idx, key))
+	{
+		CCH_RELEASE(tdbb, window);
+		return NULL;
+	}
+
+	return leaf;
+}
+
+
+static void probe_remember(thread_db* tdbb, const IndexRetrieval* retrieval, const index_desc* idx,
+						   const temporary_key* key, WIN* window)
+{
+/**************************************
+ *
+ *	p r o b e _ r e m e m b e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put the leaf page found by the key lookup into the probe cache.
+ *
+ **************************************/
+	if (probe_fits((btree_page*) window->win_buffer, retrieval, idx, key))
+	{
+		tdbb->getDatabase()->dbb_index_probes->put(idx->idx_root, key,
+			window->win_page.getPageNum());
+	}
+}
+
+
 static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* window)
 {
 /**************************************
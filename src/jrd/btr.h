@@ -232,6 +232,7 @@ const int irb_descending	= 16;			// Base index uses descending order
 const int irb_exclude_lower	= 32;			// exclude lower bound keys while scanning index
 const int irb_exclude_upper	= 64;			// exclude upper bound keys while scanning index
 const int irb_multi_starting	= 128;		// Use INTL_KEY_MULTI_STARTING
+const int irb_skip_scan		= 256;			// Scan every distinct value of the leading segment
 
 typedef Firebird::HalfStaticArray<float, 4> SelectivityList;
 
@@ -279,6 +280,37 @@ private:
 #endif
 };
 
+// Hash directory of the leaf pages found by equality lookups of indices.
+// Slots are read and written without locking, so the leaf page found by
+// the directory is always validated before use, see BTR_find_page.
+
+class IndexProbeCache
+{
+	struct Slot
+	{
+		ULONG ips_root;			// index root page
+		ULONG ips_hash;			// hash value of the key
+		ULONG ips_leaf;			// leaf page the key was found at
+	};
+
+public:
+	IndexProbeCache(MemoryPool& p, ULONG slots);
+
+	ULONG get(ULONG root, const temporary_key* key) const;
+	void put(ULONG root, const temporary_key* key, ULONG leaf);
+
+private:
+	static ULONG hash(const temporary_key* key);
+
+	const Slot& getSlot(ULONG root, ULONG hash) const
+	{
+		return m_slots[(hash ^ (root * 2654435761u)) & m_mask];
+	}
+
+	Firebird::Array<Slot> m_slots;
+	ULONG m_mask;
+};
+
 // Struct used for index creation
 
 struct IndexCreation
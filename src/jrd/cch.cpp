@@ -62,6 +62,7 @@
 #include "../common/classes/MsgPrint.h"
 #include "../jrd/CryptoManager.h"
 #include "../common/utils_proto.h"
+#include "../common/os/os_utils.h"
 
 // Use lock-free lists in hash table implementation
 #define HASH_USE_CDS_LIST
@@ -87,11 +88,6 @@ using namespace Firebird;
 IMPLEMENT_TRACE_ROUTINE(cch_trace, "CCH")
 #endif
 
-#ifdef SUPERSERVER_V2
-#define CACHE_READER
-#endif
-
-
 static inline void PAGE_LOCK_RELEASE(thread_db* tdbb, BufferControl* bcb, Lock* lock)
 {
 	if (!(bcb->bcb_flags & BCB_exclusive))
@@ -116,6 +112,14 @@ static inline void PAGE_LOCK_RE_POST(thread_db* tdbb, BufferControl* bcb, Lock*
 	}
 }
 
+// Page fetches and reads seen by the cache writer at the last adaptive sizing check
+struct CacheSample
+{
+	SINT64 fetches = 0;
+	SINT64 reads = 0;
+	SINT64 counter = 0;
+};
+
 enum LatchState
 {
 	lsOk,
@@ -125,31 +129,31 @@ enum LatchState
 
 static void adjust_scan_count(WIN* window, bool mustRead);
 static int blocking_ast_bdb(void*);
-#ifdef CACHE_READER
-static void prefetch_epilogue(Prefetch*, FbStatusVector *);
-static void prefetch_init(Prefetch*, thread_db*);
-static void prefetch_io(Prefetch*, FbStatusVector *);
-static void prefetch_prologue(Prefetch*, SLONG *);
-#endif
 static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
 static void down_grade(thread_db*, BufferDesc*, int high = 0);
 static bool expand_buffers(thread_db*, ULONG);
+static void adapt_cache_size(thread_db*, BufferControl*, CacheSample&);
 static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int);
 static int get_related(BufferDesc*, PagesArray&, int, const ULONG);
 static ULONG get_prec_walk_mark(BufferControl*);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
 static ULONG memory_init(thread_db*, BufferControl*, ULONG);
+static USHORT page_checksum(pag*, ULONG);
 static void page_validation_error(thread_db*, win*, SSHORT);
 static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
 static int write_buffer(thread_db*, BufferDesc*, const PageNumber, const bool, FbStatusVector* const,
 	const bool);
 static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool);
+static void write_page_done(thread_db*, BufferDesc*, const bool);
+static bool write_buffers(thread_db*, BufferDesc* const*, FB_SIZE_T, const bool, FbStatusVector* const);
+static bool write_run(thread_db*, BufferDesc* const*, FB_SIZE_T, FbStatusVector* const);
+static bool write_dirty_run(thread_db*, BufferDesc*, FbStatusVector* const);
 static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
 
-static BufferDesc* get_dirty_buffer(thread_db*);
+static BufferDesc* get_dirty_buffer(thread_db*, ULONG first = 0, ULONG step = 1);
 
 
 static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
@@ -167,6 +171,12 @@ static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
 	QUE_INSERT(bcb->bcb_dirty, bdb->bdb_dirty);
 }
 
+static inline void wakeWriters(BufferControl* bcb)
+{
+	if (!(bcb->bcb_flags & BCB_writer_active))
+		bcb->bcb_writer_sem.release(MAX(bcb->bcb_writers.getCount(), 1u));
+}
+
 static inline void removeDirty(BufferControl* bcb, BufferDesc* bdb)
 {
 	if (bdb->bdb_dirty.que_forward == &bdb->bdb_dirty)
@@ -188,9 +198,15 @@ static inline void removeDirty(BufferControl* bcb, BufferDesc* bdb)
 static void flushDirty(thread_db* tdbb, SLONG transaction_mask, const bool sys_only);
 static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
+static void flushRun(thread_db* tdbb, BufferDesc** begin, FB_SIZE_T count, const bool release_flag);
+static void saveWarmup(thread_db* tdbb, BufferControl* bcb);
+static void loadWarmup(thread_db* tdbb, BufferControl* bcb, Array<ULONG>& pages);
 
 static void recentlyUsed(BufferDesc* bdb);
-static void requeueRecentlyUsed(BufferControl* bcb);
+static void requeueRecentlyUsed(LruPartition* lru);
+static void admitPage(BufferControl*, BufferDesc*, const PageNumber*);
+static inline que& lruQue(LruPartition* lru, const BufferDesc* bdb);
+static inline void victimQues(LruPartition* lru, que** queues);
 
 
 const ULONG MIN_BUFFER_SEGMENT = 65536;
@@ -347,20 +363,80 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 	}
 
 	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+		LruPartition* const lru = bdb->bdb_lru;
+		Sync lruSync(&lru->lru_sync, "CCH_release");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
+			requeueRecentlyUsed(lru);
 
 		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		QUE_APPEND(lruQue(lru, bdb), bdb->bdb_in_use);
 	}
 
 	bdb->release(tdbb, true);
 }
 
 
+bool CCH_copy_page(thread_db* tdbb, PageNumber page, pag* buffer, PageVersion& version)
+{
+/**************************************
+ *
+ *	C C H _ c o p y _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Copy the image of a cached page without latching its
+ *	buffer. Buffer incarnation is changed by every page
+ *	read and CCH_mark, and pages are changed under the
+ *	exclusive latch only, so they work like a sequence
+ *	lock to validate the copy after it's made. Return
+ *	false if the page isn't cached or is being changed,
+ *	the caller should fetch the page in the usual way then.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	// Page locks must be taken if the database is shared with other processes
+	if (!(bcb->bcb_flags & BCB_exclusive))
+		return false;
+
+	BufferDesc* bdb = nullptr;
+	{
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+		bdb = bcb->bcb_hashTable->find(page);
+	}
+
+	if (!bdb)
+		return false;
+
+	version.pv_bdb = bdb;
+	version.pv_page = page;
+	version.pv_incarnation = bdb->bdb_incarnation;
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	if ((bdb->bdb_flags & (BDB_read_pending | BDB_free_pending | BDB_not_valid | BDB_io_error)) ||
+		!CCH_validate_copy(version))
+	{
+		return false;
+	}
+
+	memcpy(buffer, bdb->bdb_buffer, dbb->dbb_page_size);
+
+	if (!CCH_validate_copy(version))
+		return false;
+
+	recentlyUsed(bdb);
+	tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
+	return true;
+}
+
+
 int CCH_down_grade_dbb(void* ast_object)
 {
 /**************************************
@@ -752,7 +828,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= (BDB_lru_chained | BDB_probation);	// yes, clear all except LRU que state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -889,6 +965,16 @@ LockState CCH_fetch_lock(thread_db* tdbb, WIN* window, int lock_type, int wait,
 	if (bcb->bcb_flags & BCB_exclusive)
 		return (bdb->bdb_flags & BDB_read_pending) ? lsLocked : lsLockedHavePage;
 
+	// Pages of a read-only database never change, so readers don't need page locks
+	// to keep the caches of different processes coherent. The access mode itself
+	// may be changed by an exclusive attachment only.
+
+	if (dbb->readOnly() && lock_type < LCK_write && !window->win_page.isTemporary() &&
+		!(bdb->bdb_flags & (BDB_dirty | BDB_writer)))
+	{
+		return (bdb->bdb_flags & BDB_read_pending) ? lsLocked : lsLockedHavePage;
+	}
+
 	// lock_buffer returns 0 or 1 or -1.
 	const LockState lock_result = lock_buffer(tdbb, bdb, wait, page_type);
 
@@ -961,6 +1047,18 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 			Database *dbb = tdbb->getDatabase();
 			int retryCount = 0;
 
+			if (bdb->bdb_flags & BDB_read_ahead)
+			{
+				// Page image is already in the buffer, repeated call means re-read
+				bdb->bdb_flags &= ~BDB_read_ahead;
+				return true;
+			}
+
+			const SINT64 startCounter = fb_utils::query_performance_counter();
+			Cleanup accountWait([&] {
+				tdbb->bumpWaitTime(RuntimeStatistics::PAGE_READ_WAIT, startCounter);
+			});
+
 			while (!PIO_read(tdbb, file, bdb, page, status))
 	 		{
 				if (isTempPage || !read_shadow)
@@ -1030,6 +1128,8 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 	{
 		NBAK_TRACE(("Reading page %d, state=%d, diff page=%d from DIFFERENCE",
 			bdb->bdb_page, bak_state, diff_page));
+		bdb->bdb_flags &= ~BDB_read_ahead;
+
 		if (!bm->readDifference(tdbb, diff_page, page))
 		{
 			PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
@@ -1059,7 +1159,28 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 		}
 	}
 
-	bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending);
+	// Verify the page checksum, if any. Checksums are stored only in databases
+	// with extended storage, elsewhere the field may contain garbage written by
+	// older engines. Pages with a checksum are verified even if PageChecksums
+	// has been switched off since they were written.
+
+	if (!isTempPage && (dbb->dbb_flags & DBB_extended_storage) && page->pag_checksum &&
+		page->pag_checksum != page_checksum(page, dbb->dbb_page_size))
+	{
+		gds__log("Database: %s\n\tchecksum error on database page %" ULONGFORMAT,
+			dbb->dbb_filename.c_str(), bdb->bdb_page.getPageNum());
+
+		// Like an I/O error, the failure is left in the status for validation
+		ERR_build_status(status, Arg::Gds(isc_badpage) << Arg::Num(bdb->bdb_page.getPageNum()));
+
+		if (read_shadow)
+		{
+			PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+			CCH_unwind(tdbb, true);
+		}
+	}
+
+	bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending | BDB_read_ahead);
 	window->win_buffer = bdb->bdb_buffer;
 }
 
@@ -1097,9 +1218,17 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 
 	// remove from LRU list
 	{
-		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
-		requeueRecentlyUsed(bcb);
+		LruPartition* const lru = bdb->bdb_lru;
+		SyncLockGuard lruSync(&lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+		requeueRecentlyUsed(lru);
 		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INIT(bdb->bdb_in_use);
+
+		if (bdb->bdb_flags & BDB_probation)
+		{
+			lru->lru_probation_count--;
+			bdb->bdb_flags &= ~BDB_probation;
+		}
 	}
 
 	// remove from hash table and put into empty list
@@ -1150,6 +1279,7 @@ void CCH_fini(thread_db* tdbb)
 		return;
 
 	delete bcb->bcb_hashTable;
+	delete[] bcb->bcb_lru;
 
 	for (auto blk : bcb->bcb_bdbBlocks)
 	{
@@ -1169,6 +1299,11 @@ void CCH_fini(thread_db* tdbb)
 	while (bcb->bcb_memory.hasData())
 		bcb->bcb_bufferpool->deallocate(bcb->bcb_memory.pop());
 
+	for (const auto& huge : bcb->bcb_hugeBlocks)
+		os_utils::releaseHugePages(huge.m_memory, huge.m_size);
+
+	bcb->bcb_hugeBlocks.clear();
+
 	BufferControl::destroy(bcb);
 	dbb->dbb_bcb = NULL;
 }
@@ -1575,6 +1710,27 @@ void CCH_init(thread_db* tdbb, ULONG number)
 
 	// Allocate and initialize buffers control block
 	BufferControl* bcb = BufferControl::create(dbb);
+
+	// Split LRU queue into partitions, it makes no sense to have partitions
+	// smaller than minimal cache size
+
+	ULONG partitions = MIN(dbb->dbb_config->getDbCachePartitions(),
+		MAX(number / MIN_PAGE_BUFFERS, 1u));
+
+	// Every NUMA node gets the same number of partitions in local NUMA mode
+
+	const NoCaseString numaMode(dbb->dbb_config->getDbCacheNuma());
+	const unsigned numaNodes = os_utils::getNumaNodes();
+
+	if (numaNodes > 1 && numaMode == "LOCAL")
+	{
+		bcb->bcb_numa_nodes = numaNodes;
+		partitions = FB_ALIGN(partitions, numaNodes);
+	}
+
+	bcb->bcb_lru = FB_NEW_POOL(*bcb->bcb_bufferpool) LruPartition[partitions];
+	bcb->bcb_lru_count = partitions;
+
 	while (true)
 	{
 		try
@@ -1600,7 +1756,12 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
-	QUE_INIT(bcb->bcb_in_use);
+	if (NoCaseString(dbb->dbb_config->getDbCachePolicy()) == DbCachePolicy2Q)
+		bcb->bcb_flags |= BCB_scan_resistant;
+
+	if (numaNodes > 1 && numaMode == "INTERLEAVE")
+		bcb->bcb_flags |= BCB_numa_interleave;
+
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
 	QUE_INIT(bcb->bcb_empty);
@@ -1631,38 +1792,66 @@ void CCH_init2(thread_db* tdbb)
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
 
-	if (!(bcb->bcb_flags & BCB_exclusive) || (bcb->bcb_flags & (BCB_cache_writer | BCB_writer_start)))
+	if (!(bcb->bcb_flags & BCB_exclusive))
 		return;
 
-#ifdef CACHE_READER
-	if (gds__thread_start(cache_reader, dbb, THREAD_high, 0, 0))
+	const Attachment* att = tdbb->getAttachment();
+
+	if ((dbb->dbb_prefetch_pages || dbb->dbb_config->getDbCacheWarmup()) &&
+		!(att->att_flags & ATT_security_db) &&
+		!(bcb->bcb_flags & (BCB_cache_reader | BCB_reader_start)))
 	{
-		ERR_bugcheck_msg("cannot start thread");
-	}
+		// reader startup in progress
+		bcb->bcb_flags |= BCB_reader_start;
+
+		try
+		{
+			bcb->bcb_reader_fini.run(bcb);
+		}
+		catch (const Exception&)
+		{
+			bcb->bcb_flags &= ~BCB_reader_start;
+			ERR_bugcheck_msg("cannot start cache reader thread");
+		}
 
-	{ // scope
-		Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-		dbb->dbb_reader_init.enter();
+		bcb->bcb_reader_init.enter();
 	}
-#endif
 
-	const Attachment* att = tdbb->getAttachment();
+	if (bcb->bcb_flags & (BCB_cache_writer | BCB_writer_start))
+		return;
+
 	if (!(dbb->dbb_flags & DBB_read_only) && !(att->att_flags & ATT_security_db))
 	{
-		// writer startup in progress
-		bcb->bcb_flags |= BCB_writer_start;
+		// Writers without partitions make no sense
 
-		try
+		if (bcb->bcb_writers.isEmpty())
 		{
-			bcb->bcb_writer_fini.run(bcb);
+			const ULONG writers = MIN(dbb->dbb_config->getCacheWriters(), bcb->bcb_lru_count);
+
+			for (ULONG i = 0; i < writers; i++)
+			{
+				bcb->bcb_writers.add(FB_NEW_POOL(*bcb->bcb_bufferpool)
+					BufferControl::CacheWriter(*bcb->bcb_bufferpool, bcb, i));
+			}
 		}
-		catch (const Exception&)
+
+		for (auto writer : bcb->bcb_writers)
 		{
-			bcb->bcb_flags &= ~BCB_writer_start;
-			ERR_bugcheck_msg("cannot start cache writer thread");
-		}
+			// writer startup in progress
+			bcb->bcb_flags |= BCB_writer_start;
+
+			try
+			{
+				writer->cw_fini.run(writer);
+			}
+			catch (const Exception&)
+			{
+				bcb->bcb_flags &= ~BCB_writer_start;
+				ERR_bugcheck_msg("cannot start cache writer thread");
+			}
 
-		bcb->bcb_writer_init.enter();
+			bcb->bcb_writer_init.enter();
+		}
 	}
 }
 
@@ -1836,8 +2025,7 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
-#ifdef CACHE_READER
-void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
+void CCH_prefetch(thread_db* tdbb, const ULONG* pages, FB_SIZE_T count)
 {
 /**************************************
  *
@@ -1846,15 +2034,14 @@ void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
  **************************************
  *
  * Functional description
- *	Given a vector of pages, set corresponding bits
- *	in global prefetch bitmap. Initiate an asynchronous
- *	I/O and get the cache reader reading in our behalf
- *	as well.
+ *	Given a vector of database pages, queue the ones which
+ *	are not in the cache yet and get the cache reader reading
+ *	them in our behalf.
  *
  **************************************/
 	SET_TDBB(tdbb);
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
 
 	if (!count || !(bcb->bcb_flags & BCB_cache_reader))
 	{
@@ -1862,60 +2049,44 @@ void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
 		return;
 	}
 
-	// Switch default pool to permanent pool for setting bits in prefetch bitmap.
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
+	// Don't let the queue grow too much, otherwise pages read ahead
+	// could displace each other from the cache before they are used
 
-	// The global prefetch bitmap is the key to the I/O coalescense mechanism which dovetails
-	// all thread prefetch requests to minimize sequential I/O requests.
-	// It also enables multipage I/O by implicitly sorting page vector requests.
+	const FB_SIZE_T maxQueued = bcb->bcb_count / 4;
+	bool queued = false;
 
-	SLONG first_page = 0;
-	for (const SLONG* const end = pages + count; pages < end;)
-	{
-		const SLONG page = *pages++;
-		if (page)
+	{	// scope
+		SyncLockGuard prefetchSync(&bcb->bcb_syncPrefetch, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		for (const ULONG* const end = pages + count; pages < end; pages++)
 		{
-			SBM_set(tdbb, &bcb->bcb_prefetch, page);
-			if (!first_page)
-				first_page = page;
-		}
-	}
+			if (bcb->bcb_prefetch.getCount() >= maxQueued)
+				break;
 
-	// Not likely that the caller's page vector was empty but check anyway.
+			const ULONG pageNum = *pages;
+			if (!pageNum)
+				continue;
 
-	if (first_page)
-	{
-		prf prefetch;
+			const PageNumber page(DB_PAGE_SPACE, pageNum);
+			BufferDesc* bdb = nullptr;
+			{
+#ifndef HASH_USE_CDS_LIST
+				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+				bdb = bcb->bcb_hashTable->find(page);
+			}
 
-		prefetch_init(&prefetch, tdbb);
-		prefetch_prologue(&prefetch, &first_page);
-		prefetch_io(&prefetch, tdbb->tdbb_status_vector);
-		prefetch_epilogue(&prefetch, tdbb->tdbb_status_vector);
+			if (!bdb)
+			{
+				bcb->bcb_prefetch.add(pageNum);
+				queued = true;
+			}
+		}
 	}
-}
-
-
-bool CCH_prefetch_pages(thread_db* tdbb)
-{
-/**************************************
- *
- *	C C H _ p r e f e t c h _ p a g e s
- *
- **************************************
- *
- * Functional description
- *	Check the prefetch bitmap for a set
- *	of pages and read them into the cache.
- *
- **************************************/
-
-	// Placeholder to be implemented when predictive prefetch is
-	// enabled. This is called by VIO/garbage_collector() when it
-	// is idle to help satisfy the prefetch demand.
 
-	return false;
+	if (queued && !(bcb->bcb_flags & BCB_reader_active))
+		bcb->bcb_reader_sem.release();
 }
-#endif // CACHE_READER
 
 
 bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
@@ -1924,9 +2095,7 @@ bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 	BackupManager* const bm = dbb->dbb_backup_manager;
 
 	// Temporary pages don't write to delta and need no SCN
-	PageSpace* pageSpace = dbb->dbb_page_manager.findPageSpace(bdb->bdb_page.getPageSpaceID());
-	fb_assert(pageSpace);
-	if (pageSpace->isTemporary())
+	if (bdb->bdb_page.isTemporary())
 		return true;
 
 	// Take backup state lock
@@ -2107,17 +2276,18 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+				{ // lru_sync scope
+					LruPartition* const lru = bdb->bdb_lru;
+					Sync lruSync(&lru->lru_sync, "CCH_release");
 					lruSync.lock(SYNC_EXCLUSIVE);
 
 					if (bdb->bdb_flags & BDB_lru_chained)
 					{
-						requeueRecentlyUsed(bcb);
+						requeueRecentlyUsed(lru);
 					}
 
 					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					QUE_APPEND(lruQue(lru, bdb), bdb->bdb_in_use);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
@@ -2126,10 +2296,7 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 					insertDirty(bcb, bdb);
 
 					bcb->bcb_flags |= BCB_free_pending;
-					if (!(bcb->bcb_flags & BCB_writer_active))
-					{
-						bcb->bcb_writer_sem.release();
-					}
+					wakeWriters(bcb);
 				}
 			}
 		}
@@ -2216,33 +2383,51 @@ void CCH_shutdown(thread_db* tdbb)
 	if (!bcb)
 		return;
 
-#ifdef CACHE_READER
+	// Wait for cache reader startup to complete
+
+	while (bcb->bcb_flags & BCB_reader_start)
+		Thread::yield();
+
 	// Shutdown the dedicated cache reader for this database
 
 	if (bcb->bcb_flags & BCB_cache_reader)
 	{
 		bcb->bcb_flags &= ~BCB_cache_reader;
-		dbb->dbb_reader_sem.release();
-		dbb->dbb_reader_fini.enter();
+		bcb->bcb_reader_sem.release(); // Wake up running thread
+		bcb->bcb_reader_fini.waitForCompletion();
 	}
-#endif
 
 	// Wait for cache writer startup to complete
 
 	while (bcb->bcb_flags & BCB_writer_start)
 		Thread::yield();
 
-	// Shutdown the dedicated cache writer for this database
+	// Shutdown the dedicated cache writers for this database
 
 	if (bcb->bcb_flags & BCB_cache_writer)
 	{
 		bcb->bcb_flags &= ~BCB_cache_writer;
-		bcb->bcb_writer_sem.release(); // Wake up running thread
-		bcb->bcb_writer_fini.waitForCompletion();
+		bcb->bcb_writer_sem.release(bcb->bcb_writers.getCount()); // Wake up running threads
+
+		for (auto writer : bcb->bcb_writers)
+		{
+			writer->cw_fini.waitForCompletion();
+			delete writer;
+		}
+
+		bcb->bcb_writers.clear();
 	}
 
 	SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
 
+	// Remember cached pages to warm up the cache when database is opened next time
+
+	if (bcb->bcb_count && (bcb->bcb_flags & BCB_exclusive) && !(dbb->dbb_flags & DBB_bugcheck) &&
+		dbb->dbb_config->getDbCacheWarmup())
+	{
+		saveWarmup(tdbb, bcb);
+	}
+
 	// Flush and release page buffers
 
 	if (bcb->bcb_count)
@@ -2412,6 +2597,28 @@ bool CCH_validate(WIN* window)
 }
 
 
+bool CCH_validate_copy(const PageVersion& version)
+{
+/**************************************
+ *
+ *	C C H _ v a l i d a t e _ c o p y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the page copied by CCH_copy_page
+ *	is not changed and is not being changed.
+ *
+ **************************************/
+	const BufferDesc* const bdb = version.pv_bdb;
+	std::atomic_thread_fence(std::memory_order_acquire);
+
+	return bdb->bdb_syncPage.getState() != SYNC_EXCLUSIVE &&
+		bdb->bdb_incarnation == version.pv_incarnation &&
+		bdb->bdb_page == version.pv_page;
+}
+
+
 bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods::pag* page,
 	FbStatusVector* status, const bool inAst)
 {
@@ -2445,6 +2652,8 @@ bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods
 		memcpy(newPage, page, HDR_SIZE);
 		page = newPage;
 		memset((UCHAR*) page + HDR_SIZE, 0, dbb->dbb_page_size - HDR_SIZE);
+		// Checksum of the full header page doesn't fit the truncated copy
+		page->pag_checksum = 0;
 	}
 	page->pag_pageno = bdb->bdb_page.getPageNum();
 
@@ -2781,16 +2990,20 @@ extern "C" {
 // no such pages (i.e. all of not written yet pages have high precedence pages)
 // then write them all at last iteration (of course write_buffer will also check
 // for precedence before write).
+// Pages going to be written are collected into runs of adjacent pages, thus
+// write_buffers could coalesce them. Run is flushed before purging precedence
+// of a page as the page could depend on pages of the run.
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count)
 {
-	FbStatusVector* const status = tdbb->tdbb_status_vector;
+	Database* const dbb = tdbb->getDatabase();
 	const bool all_flag = (flush_flag & FLUSH_ALL) != 0;
 	const bool release_flag = (flush_flag & FLUSH_RLSE) != 0;
-	const bool write_thru = release_flag;
+	const FB_SIZE_T maxRun = dbb->dbb_config->getWriteCoalescePages();
 
 	qsort(begin, count, sizeof(BufferDesc*), cmpBdbs);
 
 	MarkIterator<BufferDesc*> iter(begin, count);
+	Firebird::HalfStaticArray<BufferDesc*, 16> run;
 
 	FB_SIZE_T written = 0;
 	bool writeAll = false;
@@ -2808,8 +3021,13 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			bdb->addRef(tdbb, release_flag ? SYNC_EXCLUSIVE : SYNC_SHARED);
 
 			BufferControl* bcb = bdb->bdb_bcb;
-			if (!writeAll)
+			if (!writeAll && QUE_NOT_EMPTY(bdb->bdb_higher))
+			{
+				flushRun(tdbb, run.begin(), run.getCount(), release_flag);
+				run.clear();
+
 				purgePrecedence(bcb, bdb);
+			}
 
 			if (writeAll || QUE_EMPTY(bdb->bdb_higher))
 			{
@@ -2821,16 +3039,29 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 
 				if (!all_flag || bdb->bdb_flags & (BDB_db_dirty | BDB_dirty))
 				{
-					if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
-						CCH_unwind(tdbb, true);
-				}
+					if (run.hasData())
+					{
+						const PageNumber& last = run.back()->bdb_page;
 
-				// release lock before losing control over bdb, it prevents
-				// concurrent operations on released lock
-				if (release_flag)
-					PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+						if (run.getCount() >= maxRun ||
+							bdb->bdb_page.getPageSpaceID() != last.getPageSpaceID() ||
+							bdb->bdb_page.getPageNum() != last.getPageNum() + 1)
+						{
+							flushRun(tdbb, run.begin(), run.getCount(), release_flag);
+							run.clear();
+						}
+					}
+
+					// buffer is released when run is written
+					run.add(bdb);
+				}
+				else
+				{
+					if (release_flag)
+						PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
 
-				bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
+					bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
+				}
 
 				iter.mark();
 				found = true;
@@ -2842,6 +3073,9 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 			}
 		}
 
+		flushRun(tdbb, run.begin(), run.getCount(), release_flag);
+		run.clear();
+
 		if (!found)
 			writeAll = true;
 
@@ -2852,161 +3086,426 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 }
 
 
-#ifdef CACHE_READER
-void BufferControl::cache_reader(BufferControl* bcb)
+// Write buffers collected by flushPages and release them. Buffers which are
+// not dirty anymore are just released.
+static void flushRun(thread_db* tdbb, BufferDesc** begin, FB_SIZE_T count, const bool release_flag)
+{
+	if (!count)
+		return;
+
+	FbStatusVector* const status = tdbb->tdbb_status_vector;
+	const bool write_thru = release_flag;
+
+	if (!write_buffers(tdbb, begin, count, write_thru, status))
+		CCH_unwind(tdbb, true);
+
+	for (BufferDesc** ptr = begin; ptr < begin + count; ptr++)
+	{
+		BufferDesc* const bdb = *ptr;
+
+		// release lock before losing control over bdb, it prevents
+		// concurrent operations on released lock
+		if (release_flag)
+			PAGE_LOCK_RELEASE(tdbb, bdb->bdb_bcb, bdb->bdb_lock);
+
+		bdb->release(tdbb, !release_flag && !(bdb->bdb_flags & BDB_dirty));
+	}
+}
+
+
+// Warm-up file keeps numbers of pages which were in the page cache when database
+// was closed last time, most recently used pages go first.
+
+const char* const WARMUP_FILE_SUFFIX = ".warmup";
+const ULONG WARMUP_FILE_MAGIC = 0x57415243;	// "CRAW"
+
+struct WarmupHeader
+{
+	ULONG wuh_magic;
+	ULONG wuh_page_size;
+	ULONG wuh_count;
+	Guid wuh_guid;
+};
+
+
+static void saveWarmup(thread_db* tdbb, BufferControl* bcb)
 {
 /**************************************
  *
- *	c a c h e _ r e a d e r
+ *	s a v e W a r m u p
  *
  **************************************
  *
  * Functional description
- *	Prefetch pages into cache for sequential scans.
- *	Use asynchronous I/O to keep two prefetch requests
- *	busy at a time.
+ *	Save numbers of cached pages in LRU order. Partitions
+ *	are walked all together interleaving their pages, so
+ *	most recently used pages of every partition go first.
+ *	Cache is not used by anybody else at shutdown.
  *
  **************************************/
-	Database* dbb = bcb->bcb_database;
-	Database::SyncGuard dsGuard(dbb);
+	Database* const dbb = tdbb->getDatabase();
 
-	FbLocalStatus status_vector;
+	try
+	{
+		Array<ULONG> pages(bcb->bcb_inuse);
 
-	// Establish a thread context.
-	ThreadContextHolder tdbb(status_vector);
+		// main LRU ques go first, then probation ones
 
-	// Dummy attachment needed for lock owner identification.
-	tdbb->setDatabase(dbb);
-	Jrd::Attachment* const attachment = Attachment::create(dbb, nullptr);
-	tdbb->setAttachment(attachment);
-	attachment->att_filename = dbb->dbb_filename;
-	Jrd::ContextPoolHolder context(tdbb, bcb->bcb_bufferpool);
+		Array<que*> heads;
+		Array<QUE> positions;
+		for (LruPartition* lru = bcb->bcb_lru; lru < bcb->bcb_lru + bcb->bcb_lru_count; lru++)
+		{
+			SyncLockGuard lruSync(&lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+			requeueRecentlyUsed(lru);
+			heads.add(&lru->lru_in_use);
+		}
 
-	// This try block is specifically to protect the LCK_init call: if
-	// LCK_init fails we won't be able to accomplish anything anyway, so
-	// return, unlike the other try blocks further down the page.
+		for (LruPartition* lru = bcb->bcb_lru; lru < bcb->bcb_lru + bcb->bcb_lru_count; lru++)
+			heads.add(&lru->lru_probation);
 
-	BufferControl* bcb = NULL;
+		for (que* const head : heads)
+			positions.add(head->que_forward);
 
-	try {
+		for (FB_SIZE_T first = 0; first < heads.getCount(); first += bcb->bcb_lru_count)
+		{
+			for (bool found = true; found; )
+			{
+				found = false;
 
-		LCK_init(tdbb, LCK_OWNER_attachment);
-		TRA_init(attachment);
-		bcb = dbb->dbb_bcb;
-		bcb->bcb_flags |= BCB_cache_reader;
-		dbb->dbb_reader_init.post();	// Notify our creator that we have started
-	}
-	catch (const Firebird::Exception& ex)
-	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
-		return 0;
-	}
+				for (FB_SIZE_T i = first; i < first + bcb->bcb_lru_count; i++)
+				{
+					QUE& que_inst = positions[i];
 
-	try {
+					if (que_inst == heads[i])
+						continue;
+
+					const BufferDesc* const bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+					que_inst = que_inst->que_forward;
+					found = true;
+
+					if (bdb->bdb_page.getPageSpaceID() == DB_PAGE_SPACE && !(bdb->bdb_flags & BDB_not_valid))
+						pages.add(bdb->bdb_page.getPageNum());
+				}
+			}
+		}
 
-	// Set up dual prefetch control blocks to keep multiple prefetch
-	// requests active at a time. Also helps to prevent the cache reader
-	// from becoming dedicated or locked into a single request's prefetch demands.
+		WarmupHeader header;
+		memset(&header, 0, sizeof(header));
+		header.wuh_magic = WARMUP_FILE_MAGIC;
+		header.wuh_page_size = dbb->dbb_page_size;
+		header.wuh_count = pages.getCount();
+		header.wuh_guid = dbb->dbb_guid;
 
-	prf prefetch1, prefetch2;
-	prefetch_init(&prefetch1, tdbb);
-	prefetch_init(&prefetch2, tdbb);
+		const PathName fileName = dbb->dbb_filename + WARMUP_FILE_SUFFIX;
 
-	while (bcb->bcb_flags & BCB_cache_reader)
-	{
-		bcb->bcb_flags |= BCB_reader_active;
-		bool found = false;
-		SLONG starting_page = -1;
-		prf* next_prefetch = &prefetch1;
+		EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
-		if (dbb->dbb_flags & DBB_suspend_bgio)
+		FILE* const file = os_utils::fopen(fileName.c_str(), "wb");
+		if (!file)
 		{
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
-			continue;
+			gds__log("Database: %s\n\tcannot create cache warm-up file, errno %d",
+				dbb->dbb_filename.c_str(), errno);
+			return;
 		}
 
-		// Make a pass thru the global prefetch bitmap looking for something
-		// to read. When the entire bitmap has been scanned and found to be
-		// empty then wait for new requests.
+		bool success = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+			(fwrite(pages.begin(), sizeof(ULONG), pages.getCount(), file) == pages.getCount());
 
-		do {
-			if (!(prefetch1.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-			{
-				found = true;
-				prefetch_prologue(&prefetch1, &starting_page);
-				prefetch_io(&prefetch1, status_vector);
-			}
+		success = (fclose(file) == 0) && success;
 
-			if (!(prefetch2.prf_flags & PRF_active) &&
-				SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-			{
-				found = true;
-				prefetch_prologue(&prefetch2, &starting_page);
-				prefetch_io(&prefetch2, status_vector);
-			}
+		if (!success)
+			unlink(fileName.c_str());
+	}
+	catch (const Exception&)
+	{
+		// Warm-up is not essential, don't fail shutdown because of it
+	}
+}
 
-			prf* post_prefetch = next_prefetch;
-			next_prefetch = (post_prefetch == &prefetch1) ? &prefetch2 : &prefetch1;
 
-			if (post_prefetch->prf_flags & PRF_active)
-				prefetch_epilogue(post_prefetch, status_vector);
+// Used in qsort below
+extern "C" {
+	static int cmpPages(const void* a, const void* b)
+	{
+		const ULONG pageA = *(const ULONG*) a;
+		const ULONG pageB = *(const ULONG*) b;
 
-			if (found)
-			{
-				// If the cache writer or garbage collector is idle, put
-				// them to work prefetching pages.
-#ifdef CACHE_WRITER
-				if ((bcb->bcb_flags & BCB_cache_writer) && !(bcb->bcb_flags & BCB_writer_active))
-					dbb_writer_sem.release();
-#endif
-#ifdef GARBAGE_THREAD
-				if ((dbb->dbb_flags & DBB_garbage_collector) && !(dbb->dbb_flags & DBB_gc_active))
-					dbb->dbb_gc_sem.release();
-#endif
-			}
-		} while (prefetch1.prf_flags & PRF_active || prefetch2.prf_flags & PRF_active);
+		return (pageA > pageB) ? 1 : (pageA < pageB) ? -1 : 0;
+	}
+} // extern C
 
-		// If there's more work to do voluntarily ask to be rescheduled.
-		// Otherwise, wait for event notification.
-		BufferDesc* bdb;
-		if (found)
-			JRD_reschedule(tdbb, true);
-		else if (bcb->bcb_flags & BCB_free_pending && (bdb = get_dirty_buffer(tdbb)))
+
+static void loadWarmup(thread_db* tdbb, BufferControl* bcb, Array<ULONG>& pages)
+{
+/**************************************
+ *
+ *	l o a d W a r m u p
+ *
+ **************************************
+ *
+ * Functional description
+ *	Load numbers of pages to warm the cache up and sort
+ *	them in physical order. If cache became smaller, fill
+ *	it with most recently used pages. File is removed as
+ *	it becomes obsolete as soon as database is changed.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	const PathName fileName = dbb->dbb_filename + WARMUP_FILE_SUFFIX;
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	FILE* const file = os_utils::fopen(fileName.c_str(), "rb");
+	if (!file)
+		return;
+
+	WarmupHeader header;
+	if (fread(&header, sizeof(header), 1, file) == 1 &&
+		header.wuh_magic == WARMUP_FILE_MAGIC &&
+		header.wuh_page_size == dbb->dbb_page_size &&
+		!memcmp(&header.wuh_guid, &dbb->dbb_guid, sizeof(Guid)))
+	{
+		const ULONG count = MIN(header.wuh_count, bcb->bcb_count);
+		ULONG* const buffer = pages.getBuffer(count, false);
+
+		pages.shrink(fread(buffer, sizeof(ULONG), count, file));
+		qsort(pages.begin(), pages.getCount(), sizeof(ULONG), cmpPages);
+	}
+
+	fclose(file);
+	unlink(fileName.c_str());
+}
+
+
+void BufferControl::cache_reader(BufferControl* bcb)
+{
+/**************************************
+ *
+ *	c a c h e _ r e a d e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read into the cache pages queued by sequential scans,
+ *	thus scans don't wait for every page to be read.
+ *
+ **************************************/
+	FbLocalStatus status_vector;
+	Database* const dbb = bcb->bcb_database;
+
+	try
+	{
+		UserId user;
+		user.setUserName("Cache Reader");
+
+		Jrd::Attachment* const attachment = Jrd::Attachment::create(dbb, nullptr);
+		RefPtr<SysStableAttachment> sAtt(FB_NEW SysStableAttachment(attachment));
+		attachment->setStable(sAtt);
+		attachment->att_filename = dbb->dbb_filename;
+		attachment->att_user = &user;
+
+		BackgroundContextHolder tdbb(dbb, attachment, &status_vector, FB_FUNCTION);
+		Jrd::Attachment::UseCountHolder use(attachment);
+
+		try
 		{
-			// In our spare time, help writer clean the cache.
+			LCK_init(tdbb, LCK_OWNER_attachment);
+			PAG_header(tdbb, true);
+			PAG_attachment_id(tdbb);
+			TRA_init(attachment);
+
+			Monitoring::publishAttachment(tdbb);
+
+			sAtt->initDone();
+
+			bcb->bcb_flags |= BCB_cache_reader;
+			bcb->bcb_flags &= ~BCB_reader_start;
+
+			// Notify our creator that we have started
+			bcb->bcb_reader_init.release();
+
+			PagesArray pages;
+			Array<BufferDesc*> buffers;
+			Array<bool> readDone;
+
+			Array<ULONG> warmup;
+			FB_SIZE_T warmupNext = 0;
+
+			if (dbb->dbb_config->getDbCacheWarmup())
+				loadWarmup(tdbb, bcb, warmup);
+
+			const FB_SIZE_T batchSize = dbb->dbb_prefetch_pages ?
+				dbb->dbb_prefetch_pages : MAX_READ_AHEAD_PAGES;
+
+			while (bcb->bcb_flags & BCB_cache_reader)
+			{
+				bcb->bcb_flags |= BCB_reader_active;
+
+				if (dbb->dbb_flags & DBB_suspend_bgio)
+				{
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_reader_sem.tryEnter(10);
+					continue;
+				}
+
+				{	// scope
+					SyncLockGuard prefetchSync(&bcb->bcb_syncPrefetch, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+					// Sorted array lets read pages in physical order and removes duplicates
+					for (const auto pageNum : bcb->bcb_prefetch)
+					{
+						if (!pages.exist(pageNum))
+							pages.add(pageNum);
+					}
+
+					bcb->bcb_prefetch.clear();
+				}
+
+				// Warm the cache up when there are no requests from scans.
+				// Use free buffers only, pages in use are more valuable.
+
+				if (pages.isEmpty() && warmupNext < warmup.getCount())
+				{
+					if (bcb->bcb_inuse >= bcb->bcb_count)
+						warmupNext = warmup.getCount();
+
+					const FB_SIZE_T end = MIN(warmup.getCount(), warmupNext + MAX_READ_AHEAD_PAGES);
+
+					while (warmupNext < end)
+						pages.add(warmup[warmupNext++]);
+
+					if (warmupNext == warmup.getCount())
+						warmup.free();
+				}
+
+				if (pages.isEmpty())
+				{
+					bcb->bcb_flags &= ~BCB_reader_active;
+
+					// Re-check the queue as CCH_prefetch could see us active
+					// and didn't wake us up
+					if (bcb->bcb_prefetch.hasData())
+						continue;
+
+					EngineCheckout cout(tdbb, FB_FUNCTION);
+					bcb->bcb_reader_sem.tryEnter(10);
+					continue;
+				}
+
+				for (FB_SIZE_T start = 0; start < pages.getCount(); )
+				{
+					if (!(bcb->bcb_flags & BCB_cache_reader))
+						break;
+
+					// Latch a batch of buffers whose pages are not in the cache yet.
+					// Don't wait for latch: if page buffer is busy, the page is
+					// either in the cache already or someone is reading it now.
+
+					const FB_SIZE_T end = MIN(pages.getCount(), start + batchSize);
+					buffers.clear();
+
+					try
+					{
+						for (; start < end; start++)
+						{
+							WIN window(DB_PAGE_SPACE, pages[start]);
+
+							switch (CCH_fetch_lock(tdbb, &window, LCK_read, LCK_NO_WAIT, pag_undefined))
+							{
+							case lsLocked:
+								buffers.add(window.win_bdb);
+								break;
+
+							case lsLockedHavePage:
+								CCH_RELEASE(tdbb, &window);
+								break;
+							}
+						}
+
+						if (buffers.isEmpty())
+							continue;
+
+						// Read page images at once and let CCH_fetch_page decrypt
+						// them, pages not read here are read from disk as usual
+
+						PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+						bool* const done = readDone.getBuffer(buffers.getCount(), false);
+
+						if (PIO_read_batch(tdbb, pageSpace->file, buffers.begin(), buffers.getCount(), done))
+						{
+							for (FB_SIZE_T i = 0; i < buffers.getCount(); i++)
+							{
+								if (done[i])
+									buffers[i]->bdb_flags |= BDB_read_ahead;
+							}
+						}
+
+						for (auto bdb : buffers)
+						{
+							WIN window(bdb->bdb_page);
+							window.win_bdb = bdb;
+							window.win_buffer = bdb->bdb_buffer;
+
+							CCH_fetch_page(tdbb, &window, true);
+							bdb->downgrade(SYNC_SHARED);
+							adjust_scan_count(&window, true);
+							CCH_RELEASE(tdbb, &window);
+						}
+					}
+					catch (const Firebird::Exception&)
+					{
+						// Error will be reported to those who really need the page.
+						// Nobody but us sets BDB_read_ahead thus it's safe to reset
+						// it for the buffers we already released.
+						for (auto bdb : buffers)
+							bdb->bdb_flags &= ~BDB_read_ahead;
+
+						fb_utils::init_status(tdbb->tdbb_status_vector);
+						CCH_unwind(tdbb, false);
+						start = end;
+					}
+				}
 
-			write_buffer(tdbb, bdb, bdb->bdb_page, true, status_vector, true);
+				pages.clear();
+				JRD_reschedule(tdbb, true);
+			}
 		}
-		else
+		catch (const Firebird::Exception& ex)
 		{
-			bcb->bcb_flags &= ~BCB_reader_active;
-			Database::Checkout dcoHolder(dbb, FB_FUNCTION);
-			dbb->dbb_reader_sem.tryEnter(10);
+			ex.stuffException(&status_vector);
+			iscDbLogStatus(dbb->dbb_filename.c_str(), &status_vector);
+			// continue execution to clean up
 		}
-		bcb = dbb->dbb_bcb;
+
+		Monitoring::cleanupAttachment(tdbb);
+		attachment->releaseLocks(tdbb);
+		LCK_fini(tdbb, LCK_OWNER_attachment);
+
+		attachment->releaseRelations(tdbb);
+	}	// try
+	catch (const Firebird::Exception& ex)
+	{
+		bcb->exceptionHandler(ex, cache_reader);
 	}
 
-	LCK_fini(tdbb, LCK_OWNER_attachment);
-	Jrd::Attachment::destroy(attachment);	// no need saving warning error strings here
-	tdbb->setAttachment(NULL);
 	bcb->bcb_flags &= ~BCB_cache_reader;
-	dbb->dbb_reader_fini.post();
 
-	}	// try
+	try
+	{
+		if (bcb->bcb_flags & BCB_reader_start)
+		{
+			bcb->bcb_flags &= ~BCB_reader_start;
+			bcb->bcb_reader_init.release();
+		}
+	}
 	catch (const Firebird::Exception& ex)
 	{
-		ex.stuffException(status_vector);
-		iscDbLogStatus(dbb->dbb_filename.c_str(), status_vector);
+		bcb->exceptionHandler(ex, cache_reader);
 	}
-	return 0;
 }
-#endif
 
 
-void BufferControl::cache_writer(BufferControl* bcb)
+void BufferControl::cache_writer(CacheWriter* writer)
 {
 /**************************************
  *
@@ -3019,6 +3518,7 @@ void BufferControl::cache_writer(BufferControl* bcb)
  *
  **************************************/
 	FbLocalStatus status_vector;
+	BufferControl* const bcb = writer->cw_bcb;
 	Database* const dbb = bcb->bcb_database;
 
 	try
@@ -3052,12 +3552,14 @@ void BufferControl::cache_writer(BufferControl* bcb)
 			// Notify our creator that we have started
 			bcb->bcb_writer_init.release();
 
+			CacheSample sample;
+
 			while (bcb->bcb_flags & BCB_cache_writer)
 			{
 				bcb->bcb_flags |= BCB_writer_active;
-#ifdef CACHE_READER
-				SLONG starting_page = -1;
-#endif
+
+				if (writer->cw_number == 0)
+					adapt_cache_size(tdbb, bcb, sample);
 
 				if (dbb->dbb_flags & DBB_suspend_bgio)
 				{
@@ -3078,9 +3580,10 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 				if (bcb->bcb_flags & BCB_free_pending)
 				{
-					BufferDesc* const bdb = get_dirty_buffer(tdbb);
+					BufferDesc* const bdb = get_dirty_buffer(tdbb, writer->cw_number,
+						bcb->bcb_writers.getCount());
 					if (bdb)
-						write_buffer(tdbb, bdb, bdb->bdb_page, true, &status_vector, true);
+						write_dirty_run(tdbb, bdb, &status_vector);
 				}
 
 				// If there's more work to do voluntarily ask to be rescheduled.
@@ -3088,19 +3591,6 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 				if ((bcb->bcb_flags & BCB_free_pending) || dbb->dbb_flush_cycle)
 					JRD_reschedule(tdbb, true);
-#ifdef CACHE_READER
-				else if (SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
-				{
-					// Prefetch some pages in our spare time and in the process
-					// garbage collect the prefetch bitmap.
-					prf prefetch;
-
-					prefetch_init(&prefetch, tdbb);
-					prefetch_prologue(&prefetch, &starting_page);
-					prefetch_io(&prefetch, status_vector);
-					prefetch_epilogue(&prefetch, status_vector);
-				}
-#endif
 				else
 				{
 					bcb->bcb_flags &= ~BCB_writer_active;
@@ -3124,7 +3614,7 @@ void BufferControl::cache_writer(BufferControl* bcb)
 	}	// try
 	catch (const Firebird::Exception& ex)
 	{
-		bcb->exceptionHandler(ex, cache_writer);
+		bcb->exceptionHandler(ex, nullptr);
 	}
 
 	bcb->bcb_flags &= ~BCB_cache_writer;
@@ -3139,7 +3629,7 @@ void BufferControl::cache_writer(BufferControl* bcb)
 	}
 	catch (const Firebird::Exception& ex)
 	{
-		bcb->exceptionHandler(ex, cache_writer);
+		bcb->exceptionHandler(ex, nullptr);
 	}
 }
 
@@ -3588,122 +4078,201 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 }
 
 
-static BufferDesc* get_dirty_buffer(thread_db* tdbb)
+static void adapt_cache_size(thread_db* tdbb, BufferControl* bcb, CacheSample& sample)
+{
+/**************************************
+ *
+ *	a d a p t _ c a c h e _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Called by the first cache writer. Once a second look at the page
+ *	fetches and reads of the database and grow the cache by a quarter
+ *	when it was busy and more than 10% of fetches missed it. Cache never
+ *	grows above MaxDbCachePages and it's never shrunk back.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	const ULONG maxCount = MIN(dbb->dbb_config->getMaxDbCachePages(), MAX_PAGE_BUFFERS);
+
+	if (maxCount <= bcb->bcb_count)
+		return;
+
+	const SINT64 counter = fb_utils::query_performance_counter();
+
+	if (sample.counter && counter - sample.counter < fb_utils::query_performance_frequency())
+		return;
+
+	const SINT64 fetches = dbb->dbb_stats.getValue(RuntimeStatistics::PAGE_FETCHES);
+	const SINT64 reads = dbb->dbb_stats.getValue(RuntimeStatistics::PAGE_READS);
+
+	const bool first = (sample.counter == 0);
+	const SINT64 fetchDelta = fetches - sample.fetches;
+	const SINT64 readDelta = reads - sample.reads;
+
+	sample.fetches = fetches;
+	sample.reads = reads;
+	sample.counter = counter;
+
+	if (first || fetchDelta < (SINT64) bcb->bcb_count || readDelta * 10 < fetchDelta)
+		return;
+
+	const ULONG count = bcb->bcb_count;
+	const ULONG number = MIN(maxCount, count + MAX(count / 4, MIN_PAGE_BUFFERS));
+
+	if (expand_buffers(tdbb, number))
+	{
+		gds__log("Database: %s\n\tPage cache expanded from %" ULONGFORMAT " to %" ULONGFORMAT " buffers",
+			dbb->dbb_filename.c_str(), count, bcb->bcb_count);
+	}
+}
+
+
+static BufferDesc* get_dirty_buffer(thread_db* tdbb, ULONG first, ULONG step)
 {
 	// This code is only used by the background I/O threads:
 	// cache writer, cache reader and garbage collector.
+	// Cache writer looks at its own LRU partitions only, see CacheWriter.
 
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
-	int walk = bcb->bcb_free_minimum;
-	int chained = walk;
+	bool requeued = false;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	lruSync.lock(SYNC_SHARED);
-
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
+	for (LruPartition* lru = bcb->bcb_lru + first; lru < bcb->bcb_lru + bcb->bcb_lru_count; lru += step)
 	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		int walk = bcb->bcb_free_minimum;
+		int chained = walk;
 
-		if (bdb->bdb_flags & BDB_lru_chained)
-		{
-			if (!--chained)
-				break;
-			continue;
-		}
+		Sync lruSync(&lru->lru_sync, FB_FUNCTION);
+		lruSync.lock(SYNC_SHARED);
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
+		que* queues[2];
+		victimQues(lru, queues);
 
-		if (bdb->bdb_flags & BDB_db_dirty)
+		for (que* const queue : queues)
 		{
-			//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
-			return bdb;
+			for (QUE que_inst = queue->que_backward;
+				 que_inst != queue && walk && chained; que_inst = que_inst->que_backward)
+			{
+				BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+
+				if (bdb->bdb_flags & BDB_lru_chained)
+				{
+					--chained;
+					continue;
+				}
+
+				if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+					continue;
+
+				if (bdb->bdb_flags & BDB_db_dirty)
+				{
+					//tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES); shouldn't it be here?
+					return bdb;
+				}
+
+				--walk;
+			}
 		}
 
-		if (!--walk)
-			break;
+		if (!chained)
+		{
+			lruSync.unlock();
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(lru);
+			requeued = true;
+		}
 	}
 
-	if (!chained)
-	{
-		lruSync.unlock();
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-	}
-	else
+	if (!requeued)
 		bcb->bcb_flags &= ~BCB_free_pending;
 
 	return NULL;
 }
 
 
-static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
+static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb, const PageNumber& page)
 {
 /**************************************
  * Function description:
  *       Get candidate for preemption
  *       Found page buffer must have SYNC_EXCLUSIVE lock.
+ *       Partition chosen by page number is looked first,
+ *       others are looked only if there is no candidate there.
  **************************************/
 
 	int walk = bcb->bcb_free_minimum;
 	BufferDesc* bdb = nullptr;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	if (bcb->bcb_lru_chain.load() != NULL)
-	{
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-		lruSync.downgrade(SYNC_SHARED);
-	}
-	else
-		lruSync.lock(SYNC_SHARED);
+	LruPartition* const first = bcb->getLru(tdbb, page);
+	LruPartition* const end = bcb->bcb_lru + bcb->bcb_lru_count;
+	LruPartition* lru = first;
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
-		 que_inst = que_inst->que_backward)
+	do
 	{
-		bdb = nullptr;
+		Sync lruSync(&lru->lru_sync, FB_FUNCTION);
+		if (lru->lru_chain.load() != NULL)
+		{
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(lru);
+			lruSync.downgrade(SYNC_SHARED);
+		}
+		else
+			lruSync.lock(SYNC_SHARED);
 
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
+		que* queues[2];
+		victimQues(lru, queues);
 
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
+		for (que* const queue : queues)
+		{
+			for (QUE que_inst = queue->que_backward;
+				 que_inst != queue;
+				 que_inst = que_inst->que_backward)
+			{
+				bdb = nullptr;
 
-		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+				// get the oldest buffer as the least recently used
 
-		if (oldest->bdb_flags & BDB_lru_chained)
-			continue;
+				BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-			continue;
+				if (oldest->bdb_flags & BDB_lru_chained)
+					continue;
 
-		/*if (!writeable(oldest))
-		{
-			oldest->release(tdbb, true);
-			continue;
-		}*/
+				if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
+					continue;
 
-		bdb = oldest;
-		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+				/*if (!writeable(oldest))
+				{
+					oldest->release(tdbb, true);
+					continue;
+				}*/
 
-		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+				bdb = oldest;
+				if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
+					break;
 
-		bcb->bcb_flags |= BCB_free_pending;
-		if (!(bcb->bcb_flags & BCB_writer_active))
-			bcb->bcb_writer_sem.release();
+				if (!(bcb->bcb_flags & BCB_cache_writer))
+					break;
 
-		bdb->release(tdbb, true);
-		bdb = nullptr;
-		--walk;
-	}
+				bcb->bcb_flags |= BCB_free_pending;
+				wakeWriters(bcb);
+
+				bdb->release(tdbb, true);
+				bdb = nullptr;
+				--walk;
+			}
+
+			if (bdb)
+				break;
+		}
+
+		lruSync.unlock();
 
-	lruSync.unlock();
+		if (++lru == end)
+			lru = bcb->bcb_lru;
+	} while (!bdb && lru != first);
 
 	if (!bdb)
 		return nullptr;
@@ -3840,7 +4409,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				bdb->addRef(tdbb, SYNC_EXCLUSIVE);
 			else
 			{
-				bdb = get_oldest_buffer(tdbb, bcb);
+				bdb = get_oldest_buffer(tdbb, bcb, page);
 				if (!bdb)
 				{
 					Thread::yield();
@@ -3870,8 +4439,9 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				bdb2 = bcb->bcb_hashTable->emplace(bdb, page, !is_empty);
 				if (!bdb2)
 				{
+					const PageNumber oldPage = bdb->bdb_page;
 					bdb->bdb_page = page;
-					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+					bdb->bdb_flags &= (BDB_lru_chained | BDB_probation); // yes, clear all except LRU que state
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
 					if (bdb->bdb_lock)
@@ -3881,13 +4451,16 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
+					if (bcb->bcb_flags & BCB_scan_resistant)
+						admitPage(bcb, bdb, is_empty ? nullptr : &oldPage);
+					else if (!(bdb->bdb_flags & BDB_lru_chained))
 					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
+						LruPartition* const lru = bdb->bdb_lru;
+						Sync syncLRU(&lru->lru_sync, FB_FUNCTION);
 						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
 						{
 							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+							QUE_INSERT(lru->lru_in_use, bdb->bdb_in_use);
 						}
 						else
 							recentlyUsed(bdb);
@@ -4188,6 +4761,12 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 	const UCHAR* memory_end = nullptr;
 	BufferDesc* tail = nullptr;
 
+	// In local NUMA mode memory blocks are bound to nodes in turn and
+	// buffers of a block are given to the partitions of its node
+	const ULONG nodes = bcb->bcb_numa_nodes;
+	const ULONG nodePartitions = bcb->bcb_lru_count / nodes;
+	ULONG node = 0;
+
 	const size_t lock_key_extra = PageNumber::getLockLen() > Lock::KEY_STATIC_SIZE ?
 		PageNumber::getLockLen() - Lock::KEY_STATIC_SIZE : 0;
 
@@ -4201,6 +4780,13 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			// Allocate memory block big enough to accomodate BufferDesc's, Lock's and page buffers.
 
 			ULONG to_alloc = number;
+			bool is_huge = false;
+
+			if (nodes > 1)
+			{
+				node = bcb->bcb_bdbBlocks.getCount() % nodes;
+				to_alloc = MIN(number, (number + buffers + nodes - 1) / nodes);
+			}
 
 			while (true)
 			{
@@ -4213,10 +4799,36 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 					return buffers;
 				}
 
+				if (Config::getUseHugePages() && !(bcb->bcb_flags & BCB_no_huge_pages))
+				{
+					size_t huge_size = memory_size;
+					memory = (UCHAR*) os_utils::allocHugePages(huge_size);
+
+					if (memory)
+					{
+						BufferControl::HugeBlock huge;
+						huge.m_memory = memory;
+						huge.m_size = huge_size;
+						bcb->bcb_hugeBlocks.push(huge);
+
+						memory_end = memory + memory_size;
+						is_huge = true;
+						break;
+					}
+
+					bcb->bcb_flags |= BCB_no_huge_pages;
+					gds__log("Database: %s\n\tPreallocated huge pages are not available for page cache",
+						dbb->dbb_filename.c_str());
+				}
+
 				try
 				{
 					memory = (UCHAR*) bcb->bcb_bufferpool->allocate(memory_size ALLOC_ARGS);
 					memory_end = memory + memory_size;
+
+					if (Config::getUseHugePages())
+						os_utils::adviseHugePages(memory, memory_size);
+
 					break;
 				}
 				catch (Firebird::BadAlloc&)
@@ -4228,7 +4840,15 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 					to_alloc >>= 1;
 				}
 			}
-			bcb->bcb_memory.push(memory);
+			if (!is_huge)
+				bcb->bcb_memory.push(memory);
+
+			// Memory is not touched yet, bind it before BufferDesc's are constructed
+
+			if (bcb->bcb_flags & BCB_numa_interleave)
+				os_utils::bindMemory(memory, memory_end - memory, -1);
+			else if (nodes > 1)
+				os_utils::bindMemory(memory, memory_end - memory, node);
 
 			tail = (BufferDesc*) FB_ALIGN(memory, alignof(BufferDesc));
 
@@ -4252,6 +4872,15 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 		}
 
 		tail = ::new(tail) BufferDesc(bcb);
+		if (nodes > 1)
+		{
+			const ULONG n = (bcb->bcb_count + buffers) / nodes;
+			tail->bdb_lru = &bcb->bcb_lru[node + nodes * (n % nodePartitions)];
+		}
+		else
+			tail->bdb_lru = &bcb->bcb_lru[(bcb->bcb_count + buffers) % bcb->bcb_lru_count];
+
+		tail->bdb_lru->lru_buffers++;
 
 		if (!(bcb->bcb_flags & BCB_exclusive))
 		{
@@ -4299,6 +4928,30 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 }
 
 
+static USHORT page_checksum(pag* page, ULONG pageSize)
+{
+/**************************************
+ *
+ *	p a g e _ c h e c k s u m
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compute the checksum of a page image. The stored checksum is
+ *	excluded from the computation. CRC32C is folded to 16 bits and
+ *	zero is reserved for pages written without a checksum.
+ *
+ **************************************/
+	const USHORT saved = page->pag_checksum;
+	page->pag_checksum = 0;
+	const ULONG crc = Crc32C::hash(pageSize, reinterpret_cast<const UCHAR*>(page));
+	page->pag_checksum = saved;
+
+	const USHORT checksum = (USHORT) (crc ^ (crc >> 16));
+	return checksum ? checksum : 1;
+}
+
+
 static void page_validation_error(thread_db* tdbb, WIN* window, SSHORT type)
 {
 /**************************************
@@ -4334,200 +4987,6 @@ static void page_validation_error(thread_db* tdbb, WIN* window, SSHORT type)
 }
 
 
-#ifdef CACHE_READER
-static void prefetch_epilogue(Prefetch* prefetch, FbStatusVector* status_vector)
-{
-/**************************************
- *
- *	p r e f e t c h _ e p i l o g u e
- *
- **************************************
- *
- * Functional description
- *	Stall on asynchronous I/O completion.
- *	Move data from prefetch buffer to database
- *	buffers, compute the checksum, and release
- *	the latch.
- *
- **************************************/
-	if (!(prefetch->prf_flags & PRF_active))
-		return;
-
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
-
-	prefetch->prf_piob.piob_wait = TRUE;
-	const bool async_status = PIO_status(dbb, &prefetch->prf_piob, status_vector);
-
-	// If there was an I/O error release all buffer latches acquired for the prefetch request.
-
-	if (!async_status)
-	{
-		BufferDesc** next_bdb = prefetch->prf_bdbs;
-		for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-		{
-			if (*next_bdb)
-				release_bdb(tdbb, *next_bdb, true, false, false);
-
-			next_bdb++;
-		}
-		prefetch->prf_flags &= ~PRF_active;
-		return;
-	}
-
-	const SCHAR* next_buffer = prefetch->prf_io_buffer;
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
-
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-	{
-		if (*next_bdb)
-		{
-			pag* page = (*next_bdb)->bdb_buffer;
-			if (next_buffer != reinterpret_cast<char*>(page))
-				memcpy(page, next_buffer, (ULONG) dbb->dbb_page_size);
-
-			if (page->pag_pageno == (*next_bdb)->bdb_page.getPageNum())
-			{
-				(*next_bdb)->bdb_flags &= ~(BDB_read_pending | BDB_not_valid);
-				(*next_bdb)->bdb_flags |= BDB_prefetch;
-			}
-
-			release_bdb(tdbb, *next_bdb, true, false, false);
-		}
-
-		next_buffer += dbb->dbb_page_size;
-		next_bdb++;
-	}
-
-	prefetch->prf_flags &= ~PRF_active;
-}
-
-
-static void prefetch_init(Prefetch* prefetch, thread_db* tdbb)
-{
-/**************************************
- *
- *	p r e f e t c h _ i n i t
- *
- **************************************
- *
- * Functional description
- *	Initialize prefetch data structure.
- *	Most systems that allow access to "raw" I/O
- *	interfaces want the buffer address aligned.
- *
- **************************************/
-	Database* dbb = tdbb->getDatabase();
-
-	prefetch->prf_tdbb = tdbb;
-	prefetch->prf_flags = 0;
-	prefetch->prf_max_prefetch = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
-	prefetch->prf_aligned_buffer =
-		(SCHAR*) (((U_IPTR) &prefetch->prf_unaligned_buffer + MIN_PAGE_SIZE - 1) &
-		~((U_IPTR) MIN_PAGE_SIZE - 1));
-}
-
-
-static void prefetch_io(Prefetch* prefetch, FbStatusVector* status_vector)
-{
-/**************************************
- *
- *	p r e f e t c h _ i o
- *
- **************************************
- *
- * Functional description
- *	Queue an asynchronous I/O to read
- *	multiple pages into prefetch buffer.
- *
- **************************************/
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
-
-	if (!prefetch->prf_page_count)
-		prefetch->prf_flags &= ~PRF_active;
-	else
-	{
-		// Get the cache reader working on our behalf too
-
-		if (!(dbb->dbb_bcb->bcb_flags & BCB_reader_active))
-			dbb->dbb_reader_sem.post();
-
-		const bool async_status =
-			PIO_read_ahead(dbb, prefetch->prf_start_page, prefetch->prf_io_buffer,
-						   prefetch->prf_page_count, &prefetch->prf_piob, status_vector);
-		if (!async_status)
-		{
-			BufferDesc** next_bdb = prefetch->prf_bdbs;
-			for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-			{
-				if (*next_bdb)
-					release_bdb(tdbb, *next_bdb, true, false, false);
-
-				next_bdb++;
-			}
-			prefetch->prf_flags &= ~PRF_active;
-		}
-	}
-}
-
-
-static void prefetch_prologue(Prefetch* prefetch, SLONG* start_page)
-{
-/**************************************
- *
- *	p r e f e t c h _ p r o l o g u e
- *
- **************************************
- *
- * Functional description
- *	Search for consecutive pages to be prefetched
- *	and latch them for I/O.
- *
- **************************************/
-	thread_db* tdbb = prefetch->prf_tdbb;
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
-
-	prefetch->prf_start_page = *start_page;
-	prefetch->prf_page_count = 0;
-	prefetch->prf_flags |= PRF_active;
-
-	BufferDesc** next_bdb = prefetch->prf_bdbs;
-	for (USHORT i = 0; i < prefetch->prf_max_prefetch; i++)
-	{
-		*next_bdb = 0;
-		if (SBM_clear(bcb->bcb_prefetch, *start_page) &&
-			(*next_bdb = get_buffer(tdbb, *start_page, LATCH_shared, 0)))
-		{
-			if ((*next_bdb)->bdb_flags & BDB_read_pending)
-				prefetch->prf_page_count = i + 1;
-			else
-			{
-				release_bdb(tdbb, *next_bdb, true, false, false);
-				*next_bdb = 0;
-			}
-		}
-
-		next_bdb++;
-		(*start_page)++;
-	}
-
-	// Optimize non-sequential list prefetching to transfer directly to database buffers.
-
-	BufferDesc* bdb;
-	if (prefetch->prf_page_count == 1 && (bdb = prefetch->prf_bdbs[0]))
-		prefetch->prf_io_buffer = reinterpret_cast<char*>(bdb->bdb_buffer);
-	else
-		prefetch->prf_io_buffer = prefetch->prf_aligned_buffer;
-
-	// Reset starting page for next bitmap walk
-
-	--(*start_page);
-}
-#endif // CACHE_READER
-
-
 static SSHORT related(BufferDesc* low, const BufferDesc* high, SSHORT limit, const ULONG mark)
 {
 /**************************************
@@ -4875,6 +5334,12 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 			fb_assert(backup_state != Ods::hdr_nbak_unknown);
 			page->pag_pageno = bdb->bdb_page.getPageNum();
 
+			if (dbb->dbb_flags & DBB_extended_storage)
+			{
+				page->pag_checksum = dbb->dbb_config->getPageChecksums() ?
+					page_checksum(page, dbb->dbb_page_size) : 0;
+			}
+
 #ifdef NBAK_DEBUG
 			// We cannot call normal trace functions here as they are signal-unsafe
 			// "Write page=%d, dir=%d, diff=%d, scn=%d"
@@ -4983,6 +5448,26 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 			bdb->bdb_flags &= ~BDB_db_dirty;
 	}
 
+	write_page_done(tdbb, bdb, result);
+	return result;
+}
+
+
+static void write_page_done(thread_db* tdbb, BufferDesc* bdb, const bool result)
+{
+/**************************************
+ *
+ *	w r i t e _ p a g e _ d o n e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Adjust buffer state after its page was written
+ *	(or write failed).
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+
 	if (!result)
 	{
 		// If there was a write error then idle background threads
@@ -5020,10 +5505,316 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 			dbb->dbb_flags &= ~DBB_suspend_bgio;
 		}
 	}
+}
+
+static inline bool coalescable(const BufferDesc* bdb, const bool write_thru)
+{
+	// Page could be written by write_run instead of write_buffer
+
+	return bdb->bdb_page.getPageSpaceID() == DB_PAGE_SPACE &&
+		bdb->bdb_page != HEADER_PAGE_NUMBER &&
+		(bdb->bdb_flags & BDB_dirty || (write_thru && bdb->bdb_flags & BDB_db_dirty)) &&
+		!(bdb->bdb_flags & (BDB_marked | BDB_not_valid)) &&
+		QUE_EMPTY(bdb->bdb_higher);
+}
+
+
+static bool write_buffers(thread_db* tdbb, BufferDesc* const* bdbs, FB_SIZE_T count,
+	const bool write_thru, FbStatusVector* const status)
+{
+/**************************************
+ *
+ *	w r i t e _ b u f f e r s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write dirty buffers sorted by page number.
+ *	Runs of adjacent pages with no higher precedence
+ *	pages are written by write_run, the rest pages are
+ *	written by write_buffer. As pages of the run don't
+ *	depend on each other, they could be written in
+ *	any order.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	const FB_SIZE_T maxRun = dbb->dbb_config->getWriteCoalescePages();
+
+	const bool coalesce = (maxRun > 1) && !dbb->dbb_shadow &&
+		dbb->dbb_backup_manager->getState() == Ods::hdr_nbak_normal;
+
+	for (FB_SIZE_T n = 0; n < count; )
+	{
+		const FB_SIZE_T start = n;
+
+		// Wait for IO lock of the first page of the run only, next page could
+		// be marked by the thread which waits for the lock we already hold
+
+		while (coalesce && n < count && n - start < maxRun)
+		{
+			BufferDesc* const bdb = bdbs[n];
+
+			if (n == start)
+				bdb->lockIO(tdbb);
+			else
+			{
+				const PageNumber& prior = bdbs[n - 1]->bdb_page;
+
+				if (bdb->bdb_page.getPageSpaceID() != prior.getPageSpaceID() ||
+					bdb->bdb_page.getPageNum() != prior.getPageNum() + 1 ||
+					!bdb->lockIOConditional(tdbb))
+				{
+					break;
+				}
+			}
+
+			if (!coalescable(bdb, write_thru))
+			{
+				bdb->unLockIO(tdbb);
+				break;
+			}
+
+			n++;
+		}
+
+		if (n - start > 1)
+		{
+			if (!write_run(tdbb, bdbs + start, n - start, status))
+				return false;
+
+			continue;
+		}
+
+		BufferDesc* const bdb = bdbs[start];
+
+		if (n > start)
+			bdb->unLockIO(tdbb);
+
+		if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, status, true))
+			return false;
+
+		n = start + 1;
+	}
+
+	return true;
+}
+
+
+static bool write_run(thread_db* tdbb, BufferDesc* const* bdbs, FB_SIZE_T count,
+	FbStatusVector* const status)
+{
+/**************************************
+ *
+ *	w r i t e _ r u n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write IO locked buffers of adjacent pages using
+ *	vectored writes. Every page is processed the same
+ *	way as write_page does, then buffers are unlocked
+ *	and their precedence is cleared as write_buffer does.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	const ULONG pageSize = dbb->dbb_page_size;
+
+	// Crypt manager passes page image to be written into callback. Remember
+	// it for vectored write, encrypted image is temporary and copied.
+
+	class Capture : public CryptoManager::IOCallback
+	{
+	public:
+		Capture(BufferDesc* b, Array<UCHAR>& s, FB_SIZE_T i, FB_SIZE_T c, ULONG ps)
+			: bdb(b), scratch(s), index(i), count(c), pageSize(ps), image(NULL)
+		{ }
+
+		bool callback(thread_db*, FbStatusVector*, Ods::pag* page)
+		{
+			if (page == bdb->bdb_buffer)
+			{
+				image = page;
+				return true;
+			}
+
+			if (scratch.isEmpty())
+				scratch.getBuffer(count * pageSize + PAGE_ALIGNMENT);
+
+			UCHAR* const copy = FB_ALIGN(scratch.begin(), PAGE_ALIGNMENT) + index * pageSize;
+			memcpy(copy, page, pageSize);
+			image = reinterpret_cast<Ods::pag*>(copy);
+
+			return true;
+		}
+
+		Ods::pag* getImage() const
+		{
+			return image;
+		}
+
+	private:
+		BufferDesc* bdb;
+		Array<UCHAR>& scratch;
+		FB_SIZE_T index, count;
+		ULONG pageSize;
+		Ods::pag* image;
+	};
+
+	Array<UCHAR> scratch;
+	HalfStaticArray<Ods::pag*, 16> images;
+	FB_SIZE_T captured = 0;
+
+	for (; captured < count; captured++)
+	{
+		BufferDesc* const bdb = bdbs[captured];
+		pag* const page = bdb->bdb_buffer;
+
+		CCH_TRACE(("WRITE   %d:%06d", bdb->bdb_page.getPageSpaceID(), bdb->bdb_page.getPageNum()));
+
+		page->pag_generation++;
+		page->pag_pageno = bdb->bdb_page.getPageNum();
+
+		if (dbb->dbb_flags & DBB_extended_storage)
+		{
+			page->pag_checksum = dbb->dbb_config->getPageChecksums() ?
+				page_checksum(page, pageSize) : 0;
+		}
+
+		tdbb->bumpStats(RuntimeStatistics::PAGE_WRITES);
+
+		Capture io(bdb, scratch, captured, count, pageSize);
+		if (!dbb->dbb_crypto_manager->write(tdbb, status, page, &io))
+			break;
+
+		images.add(io.getImage());
+	}
+
+	PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(DB_PAGE_SPACE);
+	fb_assert(pageSpace);
+
+	HalfStaticArray<bool, 16> done;
+	bool* const ok = done.getBuffer(captured);
+	bool result = (captured == count);
+
+	if (PIO_write_batch(tdbb, pageSpace->file, bdbs, images.begin(), captured, status))
+	{
+		for (FB_SIZE_T i = 0; i < captured; i++)
+			ok[i] = true;
+	}
+	else
+	{
+		// Write pages one by one to find out which of them can't be written
+
+		if (result)
+			fb_utils::init_status(status);
+
+		for (FB_SIZE_T i = 0; i < captured; i++)
+		{
+			ok[i] = PIO_write(tdbb, pageSpace->file, bdbs[i], images[i], status);
+			result = result && ok[i];
+		}
+	}
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		BufferDesc* const bdb = bdbs[i];
+
+		if (i < captured)
+		{
+			if (ok[i])
+				bdb->bdb_flags &= ~BDB_db_dirty;
+
+			write_page_done(tdbb, bdb, ok[i]);
+		}
+		else if (i == captured)
+			write_page_done(tdbb, bdb, false);	// encryption failed
+
+		bdb->unLockIO(tdbb);
+
+		if (i < captured && ok[i])
+			clear_precedence(tdbb, bdb);
+	}
+
+	return result;
+}
+
+
+static bool write_dirty_run(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const status)
+{
+/**************************************
+ *
+ *	w r i t e _ d i r t y _ r u n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a buffer found by get_dirty_buffer together
+ *	with the following adjacent dirty pages not in use.
+ *	Buffers are latched to not be reassigned while the
+ *	run is being collected and written.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+	const FB_SIZE_T maxRun = dbb->dbb_config->getWriteCoalescePages();
+	const PageNumber page = bdb->bdb_page;
+
+	if (maxRun <= 1 || page.getPageSpaceID() != DB_PAGE_SPACE ||
+		!bdb->addRefConditional(tdbb, SYNC_SHARED))
+	{
+		return write_buffer(tdbb, bdb, page, true, status, true) != 0;
+	}
+
+	if (bdb->bdb_page != page)
+	{
+		// buffer is reassigned, nothing to write
+		bdb->release(tdbb, false);
+		return true;
+	}
+
+	HalfStaticArray<BufferDesc*, 16> run;
+	run.add(bdb);
+
+	while (run.getCount() < maxRun)
+	{
+		const PageNumber next(DB_PAGE_SPACE, page.getPageNum() + run.getCount());
+
+#ifndef HASH_USE_CDS_LIST
+		Sync bcbSync(&bcb->bcb_syncObject, FB_FUNCTION);
+		bcbSync.lock(SYNC_SHARED);
+#endif
+
+		BufferDesc* const nextBdb = bcb->bcb_hashTable->find(next);
+
+#ifndef HASH_USE_CDS_LIST
+		bcbSync.unlock();
+#endif
+
+		if (!nextBdb || nextBdb->bdb_use_count ||
+			(nextBdb->bdb_flags & BDB_free_pending) || !(nextBdb->bdb_flags & BDB_db_dirty) ||
+			!nextBdb->addRefConditional(tdbb, SYNC_SHARED))
+		{
+			break;
+		}
+
+		if (nextBdb->bdb_page != next)
+		{
+			nextBdb->release(tdbb, false);
+			break;
+		}
+
+		run.add(nextBdb);
+	}
+
+	const bool result = write_buffers(tdbb, run.begin(), run.getCount(), true, status);
+
+	for (auto runBdb : run)
+		runBdb->release(tdbb, !(runBdb->bdb_flags & BDB_dirty));
 
 	return result;
 }
 
+
 static void clear_dirty_flag_and_nbak_state(thread_db* tdbb, BufferDesc* bdb)
 {
 	const AtomicCounter::counter_type oldFlags = bdb->bdb_flags.exchangeBitAnd(
@@ -5046,10 +5837,10 @@ void recentlyUsed(BufferDesc* bdb)
 	if (oldFlags & BDB_lru_chained)
 		return;
 
-	BufferControl* bcb = bdb->bdb_bcb;
+	LruPartition* const lru = bdb->bdb_lru;
 
 #ifdef DEV_BUILD
-	volatile BufferDesc* chain = bcb->bcb_lru_chain;
+	volatile BufferDesc* chain = lru->lru_chain;
 	for (; chain; chain = chain->bdb_lru_chain)
 	{
 		if (chain == bdb)
@@ -5058,14 +5849,14 @@ void recentlyUsed(BufferDesc* bdb)
 #endif
 	for (;;)
 	{
-		bdb->bdb_lru_chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
+		bdb->bdb_lru_chain = lru->lru_chain;
+		if (lru->lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
 			break;
 	}
 }
 
 
-void requeueRecentlyUsed(BufferControl* bcb)
+void requeueRecentlyUsed(LruPartition* lru)
 {
 	BufferDesc* chain = NULL;
 
@@ -5073,8 +5864,8 @@ void requeueRecentlyUsed(BufferControl* bcb)
 
 	for (;;)
 	{
-		chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(chain, NULL))
+		chain = lru->lru_chain;
+		if (lru->lru_chain.compare_exchange_strong(chain, NULL))
 			break;
 	}
 
@@ -5096,14 +5887,178 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+		fb_assert(bdb->bdb_lru == lru);
+
+		// buffers in probation que are not moved when referenced
+		if (!(bdb->bdb_flags & BDB_probation))
+		{
+			QUE_DELETE(bdb->bdb_in_use);
+			QUE_INSERT(lru->lru_in_use, bdb->bdb_in_use);
+		}
 
 		bdb->bdb_lru_chain = NULL;
 		bdb->bdb_flags &= ~BDB_lru_chained;
 	}
 
-	chain = bcb->bcb_lru_chain;
+	chain = lru->lru_chain;
+}
+
+
+static inline FB_UINT64 ghostKey(const PageNumber& page)
+{
+	return ((FB_UINT64) page.getPageSpaceID() << 32) | page.getPageNum();
+}
+
+
+static void admitPage(BufferControl* bcb, BufferDesc* bdb, const PageNumber* evicted)
+{
+/**************************************
+ *
+ *	a d m i t P a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put buffer just assigned to the new page into LRU partition
+ *	when 2Q replacement policy is used. Page that was evicted from
+ *	probation que not long ago goes into main LRU que, any other
+ *	page goes into probation que. Number of page evicted from
+ *	probation que is remembered to recognize it later.
+ *
+ **************************************/
+	bool hot = false;
+
+	{
+		SyncLockGuard ghostSync(&bcb->bcb_syncGhost, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+		if (evicted && (bdb->bdb_flags & BDB_probation))
+			bcb->bcb_ghost.add(ghostKey(*evicted), bcb->bcb_count / 2);
+
+		hot = bcb->bcb_ghost.remove(ghostKey(bdb->bdb_page));
+	}
+
+	LruPartition* const lru = bdb->bdb_lru;
+	SyncLockGuard lruSync(&lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+	if (bdb->bdb_flags & BDB_lru_chained)
+		requeueRecentlyUsed(lru);
+
+	QUE_DELETE(bdb->bdb_in_use);
+
+	if (hot)
+	{
+		if (bdb->bdb_flags & BDB_probation)
+		{
+			lru->lru_probation_count--;
+			bdb->bdb_flags &= ~BDB_probation;
+		}
+		QUE_INSERT(lru->lru_in_use, bdb->bdb_in_use);
+	}
+	else
+	{
+		if (!(bdb->bdb_flags & BDB_probation))
+		{
+			lru->lru_probation_count++;
+			bdb->bdb_flags |= BDB_probation;
+		}
+		QUE_INSERT(lru->lru_probation, bdb->bdb_in_use);
+	}
+}
+
+
+static inline que& lruQue(LruPartition* lru, const BufferDesc* bdb)
+{
+	// LRU partition que buffer belongs to
+	return (bdb->bdb_flags & BDB_probation) ? lru->lru_probation : lru->lru_in_use;
+}
+
+
+static inline void victimQues(LruPartition* lru, que** queues)
+{
+	// Order to look for replacement candidate in LRU partition ques. Probation
+	// que is looked first when it grows over 25% of partition buffers (always
+	// empty if 2Q policy is not used).
+
+	if (lru->lru_probation_count > lru->lru_buffers / 4)
+	{
+		queues[0] = &lru->lru_probation;
+		queues[1] = &lru->lru_in_use;
+	}
+	else
+	{
+		queues[0] = &lru->lru_in_use;
+		queues[1] = &lru->lru_probation;
+	}
+}
+
+
+void GhostPages::add(FB_UINT64 page, ULONG capacity)
+{
+	// Page is remembered already, don't waste another slot for it
+
+	if (gh_tree.get(page))
+		return;
+
+	// Forget the oldest page if there is no room for new one
+
+	FB_SIZE_T slot;
+
+	if (gh_fifo.getCount() < capacity)
+		slot = gh_fifo.add(page);
+	else if (gh_fifo.hasData())
+	{
+		if (gh_next >= gh_fifo.getCount())
+			gh_next = 0;
+
+		slot = gh_next++;
+
+		if (gh_fifo[slot] != EMPTY_SLOT)
+			gh_tree.remove(gh_fifo[slot]);
+
+		gh_fifo[slot] = page;
+	}
+	else
+		return;
+
+	gh_tree.put(page, slot);
+}
+
+
+bool GhostPages::remove(FB_UINT64 page)
+{
+	FB_SIZE_T slot;
+
+	if (!gh_tree.get(page, slot))
+		return false;
+
+	gh_tree.remove(page);
+
+	// The slot is reused when its turn comes, so it can't evict the page
+	// if it's added again meanwhile
+	gh_fifo[slot] = EMPTY_SLOT;
+
+	return true;
+}
+
+
+LruPartition* BufferControl::getLru(thread_db* tdbb, const PageNumber& page) const
+{
+	// Prefer partitions with memory at the node of current thread
+
+	if (bcb_numa_nodes > 1)
+	{
+		if (tdbb->tdbb_numa_node == thread_db::NUMA_NODE_UNQUERIED)
+			tdbb->tdbb_numa_node = os_utils::getCurrentNumaNode();
+
+		const int node = tdbb->tdbb_numa_node;
+		if (node >= 0)
+		{
+			const ULONG nodePartitions = bcb_lru_count / bcb_numa_nodes;
+			return &bcb_lru[node % bcb_numa_nodes + bcb_numa_nodes * (page.getPageNum() % nodePartitions)];
+		}
+	}
+
+	return &bcb_lru[page.getPageNum() % bcb_lru_count];
 }
 
 
@@ -5227,6 +6182,21 @@ void BufferDesc::lockIO(thread_db* tdbb)
 }
 
 
+bool BufferDesc::lockIOConditional(thread_db* tdbb)
+{
+	if (!bdb_syncIO.lockConditional(SYNC_EXCLUSIVE, FB_FUNCTION))
+		return false;
+
+	fb_assert(!bdb_io_locks && bdb_io != tdbb || bdb_io_locks && bdb_io == tdbb);
+
+	bdb_io = tdbb;
+	bdb_io->registerBdb(this);
+	++bdb_io_locks;
+	++bdb_use_count;
+	return true;
+}
+
+
 void BufferDesc::unLockIO(thread_db* tdbb)
 {
 	fb_assert(bdb_io && bdb_io == tdbb);
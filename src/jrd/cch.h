@@ -29,11 +29,9 @@
 #include "../common/classes/RefCounted.h"
 #include "../common/classes/semaphore.h"
 #include "../common/classes/SyncObject.h"
+#include "../common/classes/tree.h"
+#include "../common/classes/GenericMap.h"
 #include "../common/ThreadStart.h"
-#ifdef SUPERSERVER_V2
-#include "../jrd/sbm.h"
-#include "../jrd/pag.h"
-#endif
 
 #include "../jrd/que.h"
 #include "../jrd/lls.h"
@@ -73,6 +71,67 @@ const ULONG MAX_PAGE_BUFFERS = 131072;
 const ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// LruPartition -- independently locked part of the LRU queue of page buffers.
+// Every buffer belongs to the single partition for its whole life. Replacement
+// candidate for a page is looked for in the partition chosen by page number
+// first, thus threads reading different pages rarely contend for the same lock.
+
+class LruPartition
+{
+public:
+	LruPartition()
+		: lru_probation_count(0),
+		  lru_buffers(0),
+		  lru_chain(nullptr)
+	{
+		QUE_INIT(lru_in_use);
+		QUE_INIT(lru_probation);
+	}
+
+	que			lru_in_use;			// Que of buffers in use, LRU que of partition
+
+	// Newly read pages when 2Q policy is used (see DbCachePolicy setting).
+	// It's FIFO - buffers are not moved there when referenced.
+	que			lru_probation;
+	ULONG		lru_probation_count;	// Number of buffers in lru_probation
+	ULONG		lru_buffers;			// Number of buffers assigned to partition
+
+	// Recently used buffer put there without locking LRU que (lru_in_use).
+	// When lru_sync is locked this chain is merged into lru_in_use. See also
+	// requeueRecentlyUsed() and recentlyUsed()
+	std::atomic<BufferDesc*>	lru_chain;
+
+	Firebird::SyncObject		lru_sync;
+};
+
+
+// Pages recently evicted from probation que of 2Q policy, page space ID is
+// kept in high 32 bits of page number.
+// If page is read again while it's still remembered there, it's considered
+// hot and goes into main LRU que. Oldest entries are forgotten first.
+
+class GhostPages
+{
+public:
+	explicit GhostPages(MemoryPool& p)
+		: gh_tree(p),
+		  gh_fifo(p),
+		  gh_next(0)
+	{}
+
+	void add(FB_UINT64 page, ULONG capacity);
+	bool remove(FB_UINT64 page);
+
+private:
+	// Marks the slot of a page which was removed before it got old
+	static const FB_UINT64 EMPTY_SLOT = ~FB_UINT64(0);
+
+	Firebird::NonPooledMap<FB_UINT64, FB_SIZE_T>	gh_tree;	// page -> its slot in gh_fifo
+	Firebird::Array<FB_UINT64>	gh_fifo;	// pages in order they were added
+	FB_SIZE_T				gh_next;	// oldest entry in gh_fifo when it's full
+};
+
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -81,11 +140,17 @@ class BufferControl : public pool_alloc<type_bcb>
 		: bcb_bufferpool(&p),
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
-		  bcb_writer_fini(p, cache_writer, THREAD_medium),
-		  bcb_bdbBlocks(p)
+		  bcb_writers(p),
+		  bcb_reader_fini(p, cache_reader, THREAD_medium),
+		  bcb_prefetch(p),
+		  bcb_ghost(p),
+		  bcb_bdbBlocks(p),
+		  bcb_hugeBlocks(p)
 	{
 		bcb_database = NULL;
-		QUE_INIT(bcb_in_use);
+		bcb_lru = nullptr;
+		bcb_lru_count = 0;
+		bcb_numa_nodes = 1;
 		QUE_INIT(bcb_pending);
 		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
@@ -99,9 +164,6 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
 		bcb_hashTable = nullptr;
-#ifdef SUPERSERVER_V2
-		bcb_prefetch = NULL;
-#endif
 	}
 
 public:
@@ -115,15 +177,12 @@ public:
 	Firebird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
+	LruPartition*	bcb_lru;		// LRU partitions, see DbCachePartitions setting
+	ULONG		bcb_lru_count;		// Number of LRU partitions
+	ULONG		bcb_numa_nodes;		// Number of NUMA nodes partitions are bound to, see DbCacheNuma setting
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
 	que			bcb_empty;			// Que of empty buffers
 
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
-	std::atomic<BufferDesc*>	bcb_lru_chain;
-
 	que			bcb_dirty;			// que of dirty buffers
 	SLONG		bcb_dirty_count;	// count of pages in dirty page btree
 
@@ -140,23 +199,45 @@ public:
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
 	Firebird::SyncObject	bcb_syncEmpty;
 	Firebird::SyncObject	bcb_syncPrecedence;
-	Firebird::SyncObject	bcb_syncLRU;
 
 	typedef ThreadFinishSync<BufferControl*> BcbThreadSync;
 
-	static void cache_writer(BufferControl* bcb);
-	Firebird::Semaphore bcb_writer_sem;		// Wake up cache writer
+	// Cache writer thread, there could be few of them (see CacheWriters setting).
+	// Every writer looks for dirty buffers in its own LRU partitions - ones with
+	// (index % number of writers) equal to number of writer.
+	struct CacheWriter
+	{
+		CacheWriter(Firebird::MemoryPool& p, BufferControl* bcb, ULONG number)
+			: cw_bcb(bcb),
+			  cw_number(number),
+			  cw_fini(p, cache_writer, THREAD_medium)
+		{}
+
+		void exceptionHandler(const Firebird::Exception& ex, ThreadFinishSync<CacheWriter*>::ThreadRoutine*)
+		{
+			cw_bcb->exceptionHandler(ex, nullptr);
+		}
+
+		BufferControl* const cw_bcb;
+		const ULONG cw_number;
+		ThreadFinishSync<CacheWriter*> cw_fini;		// Cache writer finalization
+	};
+
+	static void cache_writer(CacheWriter* writer);
+	Firebird::Semaphore bcb_writer_sem;		// Wake up cache writers
 	Firebird::Semaphore bcb_writer_init;	// Cache writer initialization
-	BcbThreadSync bcb_writer_fini;			// Cache writer finalization
-#ifdef SUPERSERVER_V2
+	Firebird::HalfStaticArray<CacheWriter*, 4> bcb_writers;
+
 	static void cache_reader(BufferControl* bcb);
-	// the code in cch.cpp is not tested for semaphore instead event !!!
 	Firebird::Semaphore bcb_reader_sem;		// Wake up cache reader
 	Firebird::Semaphore bcb_reader_init;	// Cache reader initialization
 	BcbThreadSync bcb_reader_fini;			// Cache reader finalization
 
-	PageBitmap*	bcb_prefetch;		// Bitmap of pages to prefetch
-#endif
+	Firebird::SyncObject	bcb_syncPrefetch;
+	Firebird::Array<ULONG>	bcb_prefetch;	// Pages to be read ahead by cache reader
+
+	Firebird::SyncObject	bcb_syncGhost;
+	GhostPages	bcb_ghost;			// Pages evicted from probation ques, see DbCachePolicy setting
 
 	void exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
@@ -169,18 +250,31 @@ public:
 		ULONG m_count;
 	};
 	Firebird::Array<BDBBlock>	bcb_bdbBlocks;		// all allocated BufferDesc's
+
+	// memory block allocated in huge pages, see UseHugePages setting
+	struct HugeBlock
+	{
+		UCHAR* m_memory;
+		size_t m_size;
+	};
+	Firebird::Array<HugeBlock>	bcb_hugeBlocks;		// such blocks are not in bcb_memory
+
+	// LRU partition to look for the replacement candidate for the given page
+	LruPartition* getLru(thread_db* tdbb, const PageNumber& page) const;
 };
 
 const int BCB_keep_pages	= 1;	// set during btc_flush(), pages not removed from dirty binary tree
 const int BCB_cache_writer	= 2;	// cache writer thread has been started
 const int BCB_writer_start  = 4;    // cache writer thread is starting now
 const int BCB_writer_active	= 8;	// no need to post writer event count
-#ifdef SUPERSERVER_V2
 const int BCB_cache_reader	= 16;	// cache reader thread has been started
 const int BCB_reader_active	= 32;	// cache reader not blocked on event
-#endif
 const int BCB_free_pending	= 64;	// request cache writer to free pages
 const int BCB_exclusive		= 128;	// there is only BCB in whole system
+const int BCB_reader_start	= 256;	// cache reader thread is starting now
+const int BCB_scan_resistant	= 512;	// 2Q replacement policy is used
+const int BCB_numa_interleave	= 1024;	// buffers memory is interleaved over NUMA nodes
+const int BCB_no_huge_pages		= 2048;	// huge pages allocation failed, don't try it again
 
 
 // BufferDesc -- Buffer descriptor block
@@ -193,6 +287,7 @@ public:
 		  bdb_page(0, 0)
 	{
 		bdb_lock = NULL;
+		bdb_lru = NULL;
 		QUE_INIT(bdb_que);
 		QUE_INIT(bdb_in_use);
 		QUE_INIT(bdb_dirty);
@@ -218,6 +313,7 @@ public:
 	void release(thread_db* tdbb, bool repost);
 
 	void lockIO(thread_db*);
+	bool lockIOConditional(thread_db*);
 	void unLockIO(thread_db*);
 
 	bool isLocked() const
@@ -239,6 +335,7 @@ public:
 	Firebird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
 	que			bdb_que;				// Either mod que in hash table or bcb_empty que if never used
+	LruPartition*	bdb_lru;			// LRU partition buffer belongs to
 	que			bdb_in_use;				// queue of buffers in use
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
@@ -266,6 +363,19 @@ public:
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
 };
 
+// Identifies the page image copied without latching its buffer, see CCH_copy_page()
+
+struct PageVersion
+{
+	const BufferDesc* pv_bdb;
+	PageNumber pv_page;
+	ULONG pv_incarnation;
+
+	PageVersion()
+		: pv_bdb(NULL), pv_page(0, 0), pv_incarnation(0)
+	{}
+};
+
 // bdb_flags
 
 // to set/clear BDB_dirty use set_dirty_flag()/clear_dirty_flag()
@@ -288,6 +398,8 @@ const int BDB_prefetch			= 0x4000;	// page has been prefetched but not yet refer
 const int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 const int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 const int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+const int BDB_read_ahead		= 0x40000;	// page image was read by cache reader and needs no disk read
+const int BDB_probation			= 0x80000;	// buffer is in probation que of LRU partition
 
 // bdb_ast_flags
 
@@ -345,34 +457,13 @@ enum LATCH
 
 
 
-#ifdef SUPERSERVER_V2
-#include "../jrd/os/pio.h"
-
-// Constants used by prefetch mechanism
-
-const int PREFETCH_MAX_TRANSFER	= 16384;	// maximum block I/O transfer (bytes)
-// maximum pages allowed per prefetch request
-const int PREFETCH_MAX_PAGES	= (2 * PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE);
+// Maximum number of pages scan could ask cache reader to read ahead at once
 
-// Prefetch block
+const ULONG MAX_READ_AHEAD_PAGES = 256;
 
-class Prefetch : public pool_alloc<type_prf>
-{
-public:
-	thread_db*	prf_tdbb;			// thread database context
-	SLONG		prf_start_page;		// starting page of multipage prefetch
-	USHORT		prf_max_prefetch;	// maximum no. of pages to prefetch
-	USHORT		prf_page_count;		// actual no. of pages being prefetched
-	phys_io_blk	prf_piob;			// physical I/O status block
-	SCHAR*		prf_aligned_buffer;	// buffer address aligned for raw (OS cache bypass) I/O
-	SCHAR*		prf_io_buffer;		// I/O buffer address
-	UCHAR		prf_flags;
-	BufferDesc*	prf_bdbs[PREFETCH_MAX_TRANSFER / MIN_PAGE_SIZE];
-	SCHAR		prf_unaligned_buffer[PREFETCH_MAX_TRANSFER + MIN_PAGE_SIZE];
-};
+// Maximum number of adjacent dirty pages written with single system call
 
-const int PRF_active	= 1;		// prefetch block currently in use
-#endif // SUPERSERVER_V2
+const ULONG MAX_WRITE_COALESCE_PAGES = 256;
 
 typedef Firebird::SortedArray<SLONG, Firebird::InlineStorage<SLONG, 256>, SLONG> PagesArray;
 
@@ -32,6 +32,10 @@ namespace Firebird {
 	class Sync;
 }
 
+namespace Jrd {
+	struct PageVersion;
+}
+
 enum LockState {
 	lsLatchTimeout = -2,	// was -2		*** now unused ***
 	lsLockTimeout,			// was -1
@@ -41,6 +45,7 @@ enum LockState {
 };
 
 void		CCH_clean_page(Jrd::thread_db*, Jrd::PageNumber);
+bool		CCH_copy_page(Jrd::thread_db*, Jrd::PageNumber, Ods::pag*, Jrd::PageVersion&);
 int			CCH_down_grade_dbb(void*);
 bool		CCH_exclusive(Jrd::thread_db*, USHORT, SSHORT, Firebird::Sync*);
 bool		CCH_exclusive_attachment(Jrd::thread_db*, USHORT, SSHORT, Firebird::Sync*);
@@ -63,16 +68,14 @@ void		CCH_must_write(Jrd::thread_db*, Jrd::win*);
 void		CCH_precedence(Jrd::thread_db*, Jrd::win*, ULONG);
 void		CCH_precedence(Jrd::thread_db*, Jrd::win*, Jrd::PageNumber);
 void		CCH_tra_precedence(Jrd::thread_db*, Jrd::win*, TraNumber traNum);
-#ifdef SUPERSERVER_V2
-void		CCH_prefetch(Jrd::thread_db*, SLONG*, SSHORT);
-bool		CCH_prefetch_pages(Jrd::thread_db*);
-#endif
+void		CCH_prefetch(Jrd::thread_db*, const ULONG*, FB_SIZE_T);
 void		CCH_release(Jrd::thread_db*, Jrd::win*, const bool);
 void		CCH_release_exclusive(Jrd::thread_db*);
 bool		CCH_rollover_to_shadow(Jrd::thread_db* tdbb, Jrd::Database* dbb, Jrd::jrd_file*, const bool);
 void		CCH_shutdown(Jrd::thread_db*);
 void		CCH_unwind(Jrd::thread_db*, const bool);
 bool		CCH_validate(Jrd::win*);
+bool		CCH_validate_copy(const Jrd::PageVersion&);
 void		CCH_flush_ast(Jrd::thread_db*);
 bool		CCH_write_all_shadows(Jrd::thread_db*, Jrd::Shadow*, Jrd::BufferDesc*, Ods::pag*,
 					 Jrd::FbStatusVector*, const bool);
@@ -134,12 +137,10 @@ inline void CCH_MARK_MUST_WRITE(Jrd::thread_db* tdbb, Jrd::win* window)
 	CCH_mark(tdbb, window, 0, 1);
 }
 
-#ifdef SUPERSERVER_V2
-inline void CCH_PREFETCH(Jrd::thread_db* tdbb, SLONG* pages, SSHORT count)
+inline void CCH_PREFETCH(Jrd::thread_db* tdbb, const ULONG* pages, FB_SIZE_T count)
 {
 	CCH_prefetch (tdbb, pages, count);
 }
-#endif
 
 //#define CCH_FETCH(tdbb, window, lock, type)		  CCH_fetch (tdbb, window, lock, type, 1, true)
 //#define CCH_FETCH_NO_SHADOW(tdbb, window, lock, type)		  CCH_fetch (tdbb, window, lock, type, 1, false)
@@ -285,7 +285,8 @@ enum stat_group_t {
 	stat_transaction = 2,
 	stat_statement = 3,
 	stat_call = 4,
-	stat_cmp_statement = 5
+	stat_cmp_statement = 5,
+	stat_page_cache = 6
 };
 
 enum InfoType
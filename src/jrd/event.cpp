@@ -37,6 +37,7 @@
 #include "../yvalve/gds_proto.h"
 #include "../common/isc_proto.h"
 #include "../common/isc_s_proto.h"
+#include "../common/classes/Hash.h"
 #include "../jrd/err_proto.h"
 #include "../common/os/isc_i_proto.h"
 #include "../common/utils_proto.h"
@@ -416,26 +417,19 @@ void EventManager::deliverEvents()
  **************************************/
 	acquire_shmem();
 
-	// Deliver requests for posted events
+	// Deliver requests for posted events. Posting a process does not release
+	// the mutex, so the process list stays intact and a single pass is enough.
 
-	bool flag = true;
-
-	while (flag)
+	srq* event_srq;
+	SRQ_LOOP (m_sharedMemory->getHeader()->evh_processes, event_srq)
 	{
-		flag = false;
-		srq* event_srq;
-		SRQ_LOOP (m_sharedMemory->getHeader()->evh_processes, event_srq)
+		prb* const process = (prb*) ((UCHAR*) event_srq - offsetof(prb, prb_processes));
+		if (process->prb_flags & PRB_wakeup)
 		{
-			prb* const process = (prb*) ((UCHAR*) event_srq - offsetof(prb, prb_processes));
-			if (process->prb_flags & PRB_wakeup)
+			if (!post_process(process))
 			{
-				if (!post_process(process))
-				{
-					release_shmem();
-					(Arg::Gds(isc_random) << "post_process() failed").raise();
-				}
-				flag = true;
-				break;
+				release_shmem();
+				(Arg::Gds(isc_random) << "post_process() failed").raise();
 			}
 		}
 	}
@@ -649,6 +643,21 @@ void EventManager::delete_event(evnt* event)
  *	Delete an unused and unloved event.
  *
  **************************************/
+	const ULONG slot = InternalHash::hash(event->evnt_length,
+		reinterpret_cast<const UCHAR*>(event->evnt_name), EVENT_HASH_SLOTS);
+
+	const SRQ_PTR event_offset = SRQ_REL_PTR(event);
+
+	for (SRQ_PTR* ptr = &m_sharedMemory->getHeader()->evh_hash_slots[slot]; *ptr;
+		 ptr = &((evnt*) SRQ_ABS_PTR(*ptr))->evnt_hash_next)
+	{
+		if (*ptr == event_offset)
+		{
+			*ptr = event->evnt_hash_next;
+			break;
+		}
+	}
+
 	remove_que(&event->evnt_events);
 	free_global((frb*) event);
 }
@@ -910,13 +919,17 @@ evnt* EventManager::find_event(USHORT length, const TEXT* string)
  *	Lookup an event.
  *
  **************************************/
-	srq* event_srq;
-	SRQ_LOOP(m_sharedMemory->getHeader()->evh_events, event_srq)
+	const ULONG slot = InternalHash::hash(length,
+		reinterpret_cast<const UCHAR*>(string), EVENT_HASH_SLOTS);
+
+	for (SRQ_PTR next = m_sharedMemory->getHeader()->evh_hash_slots[slot]; next;)
 	{
-		evnt* const event = (evnt*) ((UCHAR*) event_srq - offsetof(evnt, evnt_events));
+		evnt* const event = (evnt*) SRQ_ABS_PTR(next);
 
 		if (event->evnt_length == length && !memcmp(string, event->evnt_name, length))
 			return event;
+
+		next = event->evnt_hash_next;
 	}
 
 	return NULL;
@@ -1039,6 +1052,9 @@ bool EventManager::initialize(SharedMemoryBase* sm, bool init)
 		SRQ_INIT(header->evh_processes);
 		SRQ_INIT(header->evh_events);
 
+		for (ULONG i = 0; i < EVENT_HASH_SLOTS; i++)
+			header->evh_hash_slots[i] = 0;
+
 		frb* const free = (frb*) ((UCHAR*) header + sizeof(evh));
 		free->frb_header.hdr_length = sm->sh_mem_length_mapped - sizeof(evh);
 		free->frb_header.hdr_type = type_frb;
@@ -1091,6 +1107,13 @@ evnt* EventManager::make_event(USHORT length, const TEXT* string)
 	event->evnt_length = length;
 	memcpy(event->evnt_name, string, length);
 
+	const ULONG slot = InternalHash::hash(length,
+		reinterpret_cast<const UCHAR*>(string), EVENT_HASH_SLOTS);
+
+	SRQ_PTR* const head = &m_sharedMemory->getHeader()->evh_hash_slots[slot];
+	event->evnt_hash_next = *head;
+	*head = SRQ_REL_PTR(event);
+
 	return event;
 }
 
@@ -33,7 +33,9 @@
 
 // Global section header
 
-const USHORT EVENT_VERSION = 4;
+const USHORT EVENT_VERSION = 5;
+
+const ULONG EVENT_HASH_SLOTS = 509;	// Slots in event name hash table
 
 class evh : public Firebird::MemoryHeader
 {
@@ -44,6 +46,7 @@ public:
 	SRQ_PTR evh_free;				// Free blocks
 	SRQ_PTR evh_current_process;	// Current process, if any
 	SLONG evh_request_id;			// Next request id
+	SRQ_PTR evh_hash_slots[EVENT_HASH_SLOTS];	// Event name hash chains
 };
 
 // Common block header
@@ -106,6 +109,7 @@ struct evnt
 {
 	event_hdr evnt_header;
 	srq evnt_events;				// System event que (owned by header)
+	SRQ_PTR evnt_hash_next;			// Next event in the hash chain
 	srq evnt_interests;				// Que of request interests in event
 	SLONG evnt_count;				// Current event count
 	USHORT evnt_length;				// Length of event name
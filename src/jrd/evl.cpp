@@ -571,27 +571,11 @@ void EVL_make_value(thread_db* tdbb, const dsc* desc, impure_value* value, Memor
 
 	const USHORT length = MOV_get_string_ptr(tdbb, &from, &ttype, &address, &temp, sizeof(temp));
 
-	// Allocate a string block of sufficient size.
+	// Get a string block of sufficient size.
 
-	VaryingString* string = value->vlu_string;
-
-	if (string && string->str_length < length)
-	{
-		delete string;
-		string = NULL;
-	}
-
-	if (!string)
-	{
-		if (!pool)
-			pool = tdbb->getDefaultPool();
-
-		string = value->vlu_string = FB_NEW_RPT(*pool, length) VaryingString();
-		string->str_length = length;
-	}
+	UCHAR* const target = value->getString(pool ? *pool : *tdbb->getDefaultPool(), length);
 
 	value->vlu_desc.dsc_length = length;
-	UCHAR* target = string->str_data;
 	value->vlu_desc.dsc_address = target;
 	value->vlu_desc.dsc_sub_type = 0;
 	value->vlu_desc.dsc_scale = 0;
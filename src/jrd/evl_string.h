@@ -71,6 +71,29 @@ static void preKmp(const CharType *x, int m, SLONG kmpNext[])
 	kmpNext[++i] = ++j;
 }
 
+// Find the first occurrence of the character, single byte strings use the
+// vectorized memchr of the C library
+template <typename CharType>
+static inline const CharType* findChar(const CharType* str, const CharType* end, CharType c)
+{
+	while (str < end && *str != c)
+		++str;
+
+	return str;
+}
+
+static inline const UCHAR* findChar(const UCHAR* str, const UCHAR* end, UCHAR c)
+{
+	const void* const found = memchr(str, c, end - str);
+	return found ? static_cast<const UCHAR*>(found) : end;
+}
+
+static inline const char* findChar(const char* str, const char* end, char c)
+{
+	const void* const found = memchr(str, c, end - str);
+	return found ? static_cast<const char*>(found) : end;
+}
+
 class StaticAllocator
 {
 public:
@@ -194,6 +217,15 @@ public:
 		SLONG data_pos = 0;
 		while (data_pos < data_len)
 		{
+			if (offset == 0)
+			{
+				// Nothing matched so far, skip straight to the next possible start of the pattern
+				data_pos = findChar(data + data_pos, data + data_len, pattern_str[0]) - data;
+
+				if (data_pos >= data_len)
+					break;
+			}
+
 			while (offset > -1 && pattern_str[offset] != data[data_pos])
 				offset = kmpNext[offset];
 			offset++;
@@ -706,6 +706,9 @@ const unsigned XCP_MESSAGE_LENGTH = 1023;
 // Array which stores relative pointers to impure areas of invariant nodes
 typedef Firebird::SortedArray<ULONG> VarInvariantArray;
 
+// Array of outer fields referenced by a sub-query, as (stream << 16) | field id
+typedef Firebird::SortedArray<ULONG> OuterReferenceArray;
+
 } // namespace Jrd
 
 #endif // JRD_EXE_H
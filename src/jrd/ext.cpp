@@ -123,6 +123,10 @@ namespace {
 #endif
 	static const char* const FOPEN_READ_ONLY	= "rb";
 
+	// Stream buffer size. Records are read one by one, so the default
+	// stdio buffer means a system call every few records.
+	const size_t EXT_BUFFER_SIZE = 1024 * 1024;
+
 	FILE* ext_fopen(Database* dbb, ExternalFile* ext_file)
 	{
 		const char* file_name = ext_file->ext_filename;
@@ -153,6 +157,11 @@ namespace {
 			}
 		}
 
+		if (!ext_file->ext_buffer)
+			ext_file->ext_buffer = FB_NEW_POOL(*dbb->dbb_permanent) char[EXT_BUFFER_SIZE];
+
+		setvbuf(ext_file->ext_ifi, ext_file->ext_buffer, _IOFBF, EXT_BUFFER_SIZE);
+
 		return ext_file->ext_ifi;
 	}
 } // namespace
@@ -309,6 +318,7 @@ ExternalFile* EXT_file(jrd_rel* relation, const TEXT* file_name) //, bid* descri
 	strcpy(file->ext_filename, file_name);
 	file->ext_flags = 0;
 	file->ext_ifi = NULL;
+	file->ext_buffer = NULL;
 
 	return file;
 }
@@ -338,6 +348,7 @@ void EXT_fini(jrd_rel* relation, bool close_only)
 		// before zeroing out the rel_file we need to deallocate the memory
 		if (!close_only)
 		{
+			delete[] file->ext_buffer;
 			delete file;
 			relation->rel_file = NULL;
 		}
@@ -36,6 +36,7 @@ public:
 	USHORT	ext_flags;			// Misc and cruddy flags
 	USHORT	ext_tra_cnt;		// How many transactions used the file
 	FILE*	ext_ifi;			// Internal file identifier
+	char*	ext_buffer;			// Stream buffer of ext_ifi
 	char	ext_filename[1];
 };
 
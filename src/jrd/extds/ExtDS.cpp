@@ -619,6 +619,9 @@ Statement* Connection::createStatement(const string& sql)
 {
 	m_used_stmts++;
 
+	// Free statements are kept in order of release, most recent first
+	Statement** last_ptr = NULL;
+
 	for (Statement** stmt_ptr = &m_freeStatements; *stmt_ptr; stmt_ptr = &(*stmt_ptr)->m_nextFree)
 	{
 		Statement* stmt = *stmt_ptr;
@@ -629,13 +632,16 @@ Statement* Connection::createStatement(const string& sql)
 			m_free_stmts--;
 			return stmt;
 		}
+
+		last_ptr = stmt_ptr;
 	}
 
 	if (m_free_stmts >= MAX_CACHED_STMTS)
 	{
-		Statement* stmt = m_freeStatements;
-		m_freeStatements = stmt->m_nextFree;
-		stmt->m_nextFree = NULL;
+		// Reuse the least recently used statement, the recent ones are more
+		// likely to be executed again
+		Statement* stmt = *last_ptr;
+		*last_ptr = NULL;
 		m_free_stmts--;
 		return stmt;
 	}
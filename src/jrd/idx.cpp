@@ -65,6 +65,7 @@
 #include "../jrd/Collation.h"
 #include "../common/Task.h"
 #include "../jrd/WorkerAttachment.h"
+#include "../jrd/GarbageCollector.h"
 
 using namespace Jrd;
 using namespace Ods;
@@ -74,6 +75,7 @@ static idx_e check_duplicates(thread_db*, Record*, index_desc*, index_insertion*
 static idx_e check_foreign_key(thread_db*, Record*, jrd_rel*, jrd_tra*, index_desc*, IndexErrorContext&);
 static idx_e check_partner_index(thread_db*, jrd_rel*, Record*, jrd_tra*, index_desc*, jrd_rel*, USHORT);
 static bool cmpRecordKeys(thread_db*, Record*, jrd_rel*, index_desc*, Record*, jrd_rel*, index_desc*);
+static int cmpGarbageKeys(const void*, const void*);
 static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
@@ -1140,6 +1142,17 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
  *
  **************************************/
 	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	// Keys of the records staying in place may be removed later by the garbage
+	// collector thread, see IDX_garbage_collect_keys. Record numbers of deleted
+	// records are reused, so their keys are removed immediately.
+
+	GarbageCollector* const gc = (dbb->dbb_config->getDeferredIndexGC() && staying.hasData() &&
+		!rpb->rpb_relation->isTemporary() &&
+		!(tdbb->getAttachment()->att_flags & ATT_garbage_collector)) ?
+			dbb->dbb_garbage_collector : NULL;
+	bool deferred = false;
 
 	index_desc idx;
 
@@ -1227,6 +1240,13 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 
 				// Get rid of index node
 
+				if (gc && gc->addIndexKey(rpb->rpb_relation->rel_id, idx.idx_id, idx.idx_root,
+						*key1.operator->(), rpb->rpb_number))
+				{
+					deferred = true;
+					continue;
+				}
+
 				insertion.iib_key = key1;
 				BTR_remove(tdbb, &window, &insertion);
 				root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
@@ -1238,6 +1258,82 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 	}
 
 	CCH_RELEASE(tdbb, &window);
+
+	// Wake up the garbage collector if it sleeps
+
+	if (deferred)
+	{
+		dbb->dbb_flags |= DBB_gc_pending;
+
+		if (!(dbb->dbb_flags & DBB_gc_active))
+			dbb->dbb_gc_sem.release();
+	}
+}
+
+
+void IDX_garbage_collect_keys(thread_db* tdbb, jrd_rel* relation, const UCHAR* keys, FB_SIZE_T length)
+{
+/**************************************
+ *
+ *	I D X _ g a r b a g e _ c o l l e c t _ k e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Remove the garbage index keys queued by IDX_garbage_collect.
+ *	Keys are removed in the index and key order, so the removals
+ *	of adjacent keys find their pages in cache and shortly latched.
+ *	Keys of the indices deleted or recreated since are skipped.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	typedef GarbageCollector::GarbageKey GarbageKey;
+
+	HalfStaticArray<const GarbageKey*, 256> items;
+
+	for (FB_SIZE_T offset = 0; offset < length; )
+	{
+		const GarbageKey* const item = reinterpret_cast<const GarbageKey*>(keys + offset);
+		items.add(item);
+		offset += GarbageKey::getSize(item->length);
+	}
+
+	qsort(items.begin(), items.getCount(), sizeof(const GarbageKey*), cmpGarbageKeys);
+
+	index_desc idx;
+	temporary_key key;
+
+	index_insertion insertion;
+	insertion.iib_descriptor = &idx;
+	insertion.iib_relation = relation;
+	insertion.iib_btr_level = 0;
+	insertion.iib_key = &key;
+
+	WIN window(get_root_page(tdbb, relation));
+
+	for (const GarbageKey* const* iter = items.begin(); iter != items.end(); ++iter)
+	{
+		const GarbageKey* const item = *iter;
+
+		index_root_page* const root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
+
+		if (!BTR_description(tdbb, relation, root, &idx, item->idxID) || idx.idx_root != item->root)
+		{
+			CCH_RELEASE(tdbb, &window);
+			continue;
+		}
+
+		key.key_length = item->length;
+		key.key_nulls = item->nulls;
+		key.key_flags = item->flags;
+		memcpy(key.key_data, item->getData(), item->length);
+
+		insertion.iib_number.setValue(item->number);
+		BTR_remove(tdbb, &window, &insertion);
+
+		JRD_reschedule(tdbb);
+	}
 }
 
 
@@ -1608,6 +1704,36 @@ static bool cmpRecordKeys(thread_db* tdbb,
 	return false;
 }
 
+static int cmpGarbageKeys(const void* a, const void* b)
+{
+/**************************************
+ *
+ *	c m p G a r b a g e K e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compare garbage index keys for qsort.
+ *
+ **************************************/
+	const GarbageCollector::GarbageKey* const key1 = *(const GarbageCollector::GarbageKey* const*) a;
+	const GarbageCollector::GarbageKey* const key2 = *(const GarbageCollector::GarbageKey* const*) b;
+
+	if (key1->idxID != key2->idxID)
+		return (key1->idxID < key2->idxID) ? -1 : 1;
+
+	const int result = memcmp(key1->getData(), key2->getData(), MIN(key1->length, key2->length));
+
+	if (result)
+		return result;
+
+	if (key1->length != key2->length)
+		return (key1->length < key2->length) ? -1 : 1;
+
+	return (key1->number < key2->number) ? -1 : (key1->number > key2->number) ? 1 : 0;
+}
+
+
 static idx_e check_duplicates(thread_db* tdbb,
 							  Record* record,
 							  index_desc* record_idx,
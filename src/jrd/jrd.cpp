@@ -55,6 +55,7 @@
 #include "../jrd/req.h"
 #include "../jrd/tra.h"
 #include "../jrd/blb.h"
+#include "../jrd/btr.h"
 #include "../jrd/lck.h"
 #include "../jrd/nbak.h"
 #include "../jrd/scl.h"
@@ -113,6 +114,7 @@
 #include "../jrd/ThreadCollect.h"
 
 #include "../jrd/Database.h"
+#include "../jrd/RangeSummary.h"
 #include "../jrd/WorkerAttachment.h"
 
 #include "../common/config/config.h"
@@ -2219,15 +2221,8 @@ JAttachment* JProvider::internalAttach(CheckStatusWrapper* user_status, const ch
 
 				try
 				{
-					// load all database triggers
-					MET_load_db_triggers(tdbb, DB_TRIGGER_CONNECT);
-					MET_load_db_triggers(tdbb, DB_TRIGGER_DISCONNECT);
-					MET_load_db_triggers(tdbb, DB_TRIGGER_TRANS_START);
-					MET_load_db_triggers(tdbb, DB_TRIGGER_TRANS_COMMIT);
-					MET_load_db_triggers(tdbb, DB_TRIGGER_TRANS_ROLLBACK);
-
-					// load DDL triggers
-					MET_load_ddl_triggers(tdbb);
+					// load all database and DDL triggers
+					MET_load_all_db_triggers(tdbb);
 
 					const TrigVector* trig_connect = attachment->att_triggers[DB_TRIGGER_CONNECT];
 					if (trig_connect && !trig_connect->isEmpty())
@@ -3564,7 +3559,18 @@ int JBlob::getSegment(CheckStatusWrapper* user_status, unsigned int buffer_lengt
 
 		try
 		{
-			len = getHandle()->BLB_get_segment(tdbb, buffer, buffer_length);
+			blb* const blob = getHandle();
+
+			// Stream blobs have no segment boundaries, so fill a large
+			// buffer across many blob pages at once
+
+			if (buffer_length > MAX_USHORT && !blob->isSegmented())
+			{
+				len = blob->BLB_get_data(tdbb, static_cast<UCHAR*>(buffer),
+					(SLONG) MIN(buffer_length, (unsigned int) MAX_SLONG), false);
+			}
+			else
+				len = blob->BLB_get_segment(tdbb, buffer, (USHORT) MIN(buffer_length, MAX_USHORT));
 		}
 		catch (const Exception& ex)
 		{
@@ -7441,6 +7447,19 @@ static JAttachment* initAttachment(thread_db* tdbb, const PathName& expanded_nam
 		// now it's time to create DB objects that need MetaName
 		dbb->dbb_extManager = FB_NEW_POOL(*dbb->dbb_permanent) ExtEngineManager(*dbb->dbb_permanent);
 
+		// range summaries must see all record changes, so other processes may not write the database
+		if ((dbb->dbb_flags & DBB_shared) && dbb->dbb_config->getRangeSummaryPages())
+		{
+			dbb->dbb_range_summaries = FB_NEW_POOL(*dbb->dbb_permanent)
+				RangeSummaryCache(*dbb->dbb_permanent, dbb->dbb_config->getRangeSummaryPages());
+		}
+
+		if (dbb->dbb_config->getIndexProbeSlots())
+		{
+			dbb->dbb_index_probes = FB_NEW_POOL(*dbb->dbb_permanent)
+				IndexProbeCache(*dbb->dbb_permanent, dbb->dbb_config->getIndexProbeSlots());
+		}
+
 		jAtt = create_attachment(alias_name, dbb, provider, options, !attach_flag);
 		tdbb->setAttachment(jAtt->getHandle());
 	} // end scope
@@ -9251,6 +9270,9 @@ void thread_db::reschedule()
 
 	Monitoring::checkState(this);
 
+	// The thread may be moved to another CPU meanwhile
+	tdbb_numa_node = NUMA_NODE_UNQUERIED;
+
 	if (tdbb_quantum <= 0)
 		tdbb_quantum = (tdbb_flags & TDBB_sweeper) ? SWEEP_QUANTUM : QUANTUM;
 }
@@ -530,7 +530,8 @@ public:
 		  tdbb_flags(0),
 		  tdbb_temp_traid(0),
 		  tdbb_bdbs(*getDefaultMemoryPool()),
-		  tdbb_thread(Firebird::ThreadSync::getThread("thread_db"))
+		  tdbb_thread(Firebird::ThreadSync::getThread("thread_db")),
+		  tdbb_numa_node(NUMA_NODE_UNQUERIED)
 	{
 		reqStat = traStat = attStat = dbbStat = RuntimeStatistics::getDummy();
 		fb_utils::init_status(tdbb_status_vector);
@@ -558,6 +559,11 @@ public:
 	Firebird::HalfStaticArray<BufferDesc*, 16> tdbb_bdbs;
 	Firebird::ThreadSync* tdbb_thread;
 
+	// NUMA node of the CPU running the thread, -1 if unknown. It's queried on
+	// first use and again after reschedule, see BufferControl::getLru()
+	static const int NUMA_NODE_UNQUERIED = -2;
+	int			tdbb_numa_node;
+
 	MemoryPool* getDefaultPool()
 	{
 		return defaultPool;
@@ -627,6 +633,13 @@ public:
 		dbbStat->bumpValue(index, delta);
 	}
 
+	// Account the time passed since the given performance counter value
+	void bumpWaitTime(const RuntimeStatistics::StatType index, SINT64 startCounter)
+	{
+		const SINT64 elapsed = fb_utils::query_performance_counter() - startCounter;
+		bumpStats(index, elapsed * 1000000 / fb_utils::query_performance_frequency());
+	}
+
 	void bumpRelStats(const RuntimeStatistics::StatType index, SLONG relation_id, SINT64 delta = 1)
 	{
 		// We don't bump counters for dbbStat here, they're merged from attStats on demand
@@ -586,6 +586,7 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_repl_tables:
 	case LCK_dsql_statement_cache:
 	case LCK_profiler_listener:
+	case LCK_gen_cache:
 		owner_type = LCK_OWNER_attachment;
 		break;
 
@@ -946,11 +947,16 @@ static void enqueue(thread_db* tdbb, CheckStatusWrapper* statusVector, Lock* loc
 
 	fb_assert(LCK_CHECK_LOCK(lock));
 
+	const SINT64 startCounter = (wait != LCK_NO_WAIT) ? fb_utils::query_performance_counter() : 0;
+
 	lock->lck_id = dbb->lockManager()->enqueue(tdbb, statusVector, lock->lck_id,
 		lock->lck_type, lock->getKeyPtr(), lock->lck_length,
 		level, lock->lck_ast, lock->lck_object, lock->lck_data, wait,
 		lock->lck_owner_handle);
 
+	if (wait != LCK_NO_WAIT)
+		tdbb->bumpWaitTime(RuntimeStatistics::LOCK_WAIT, startCounter);
+
 	if (!lock->lck_id)
 	{
 		lock->lck_physical = lock->lck_logical = LCK_none;
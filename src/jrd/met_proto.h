@@ -95,6 +95,7 @@ bool		MET_get_repl_state(Jrd::thread_db*, const Jrd::MetaName&);
 void		MET_get_shadow_files(Jrd::thread_db*, bool);
 void		MET_load_db_triggers(Jrd::thread_db*, int);
 void		MET_load_ddl_triggers(Jrd::thread_db* tdbb);
+void		MET_load_all_db_triggers(Jrd::thread_db* tdbb);
 bool		MET_load_exception(Jrd::thread_db*, Jrd::ExceptionItem&);
 void		MET_load_trigger(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::MetaName&, Jrd::TrigVector**);
 void		MET_lookup_cnstrt_for_index(Jrd::thread_db*, Jrd::MetaName& constraint, const Jrd::MetaName& index_name);
@@ -697,6 +697,7 @@ bool BackupManager::actualizeAlloc(thread_db* tdbb, bool haveGlobalLock)
 		ex.stuffException(status_vector);
 		alloc_table = NULL;
 		last_allocated_page = 0;
+		allocIsValid = false;
 		return false;
 	}
 
@@ -727,8 +728,12 @@ ULONG BackupManager::getPageIndex(thread_db* tdbb, ULONG db_page)
 	{
 		LocalAllocReadGuard localAllocGuard(this);
 
+		// While the global alloc lock is cached the table is complete: other processes
+		// must take that lock for write (invalidating our copy) before allocating any
+		// page, so a missing page isn't in the difference file and there is no need
+		// to serialize on the write lock for every page read in stalled state.
 		const ULONG diff_page = findPageIndex(tdbb, db_page);
-		if (diff_page || backup_state == Ods::hdr_nbak_merge && allocIsValid)
+		if (diff_page || allocIsValid)
 			return diff_page;
 	}
 
@@ -797,6 +802,7 @@ ULONG BackupManager::allocateDifferencePage(thread_db* tdbb, ULONG db_page)
 		delete alloc_table;
 		alloc_table = NULL;
 		last_allocated_page = 0;
+		allocIsValid = false;
 		ex.stuffException(status_vector);
 		return 0;
 	}
@@ -124,7 +124,8 @@ const USHORT ODS_CURRENT12		= 0;
 
 const USHORT ODS_CURRENT13_0	= 0;	// Firebird 4.0 features
 const USHORT ODS_CURRENT13_1	= 1;	// Firebird 4.1 features
-const USHORT ODS_CURRENT13		= 1;
+const USHORT ODS_CURRENT13_2	= 2;	// Extended storage formats, see hdr_extended_storage
+const USHORT ODS_CURRENT13		= 2;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -146,6 +147,7 @@ const USHORT ODS_11_2		= ENCODE_ODS(ODS_VERSION11, 2);
 const USHORT ODS_12_0		= ENCODE_ODS(ODS_VERSION12, 0);
 const USHORT ODS_13_0		= ENCODE_ODS(ODS_VERSION13, 0);
 const USHORT ODS_13_1		= ENCODE_ODS(ODS_VERSION13, 1);
+const USHORT ODS_13_2		= ENCODE_ODS(ODS_VERSION13, 2);
 
 const USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -173,7 +175,7 @@ const USHORT ODS_RELEASED = ODS_CURRENT13_0;	// The lowest stable minor version
 const USHORT ODS_CURRENT = ODS_CURRENT13;		// The highest defined minor version
 												// number for this ODS_VERSION!
 
-const USHORT ODS_CURRENT_VERSION = ODS_13_1;	// Current ODS version in use which includes
+const USHORT ODS_CURRENT_VERSION = ODS_13_2;	// Current ODS version in use which includes
 												// both major and minor ODS versions!
 
 
@@ -228,7 +230,7 @@ struct pag
 {
 	UCHAR pag_type;
 	UCHAR pag_flags;
-	USHORT pag_reserved;		// not used but anyway present because of alignment rules
+	USHORT pag_checksum;		// page checksum, zero if not computed
 	ULONG pag_generation;
 	ULONG pag_scn;
 	ULONG pag_pageno;			// for validation
@@ -237,7 +239,7 @@ struct pag
 static_assert(sizeof(struct pag) == 16, "struct pag size mismatch");
 static_assert(offsetof(struct pag, pag_type) == 0, "pag_type offset mismatch");
 static_assert(offsetof(struct pag, pag_flags) == 1, "pag_flags offset mismatch");
-static_assert(offsetof(struct pag, pag_reserved) == 2, "pag_reserved offset mismatch");
+static_assert(offsetof(struct pag, pag_checksum) == 2, "pag_checksum offset mismatch");
 static_assert(offsetof(struct pag, pag_generation) == 4, "pag_generation offset mismatch");
 static_assert(offsetof(struct pag, pag_scn) == 8, "pag_scn offset mismatch");
 static_assert(offsetof(struct pag, pag_pageno) == 12, "pag_pageno offset mismatch");
@@ -348,6 +350,8 @@ const UCHAR dpg_large		= 0x04;		// Large object is on page
 const UCHAR dpg_swept		= 0x08;		// Sweep has nothing to do on this page
 const UCHAR dpg_secondary	= 0x10;	// Primary record versions not stored on this page
 									// Set in dpm.epp's extend_relation() but never tested.
+const UCHAR dpg_visible		= 0x20;		// Records on swept page are visible to every snapshot,
+										// valid together with dpg_swept and hdr_extended_storage only
 
 
 // Index root page
@@ -543,6 +547,16 @@ const USHORT hdr_no_reserve			= 0x8;		// 8	don't reserve space for versions
 const USHORT hdr_SQL_dialect_3		= 0x10;		// 16	database SQL dialect 3
 const USHORT hdr_read_only			= 0x20;		// 32	Database is ReadOnly. If not set, DB is RW
 const USHORT hdr_encrypted			= 0x40;		// 64	Database is encrypted
+const USHORT hdr_extended_storage	= 0x100;	// 256	Database may contain extended storage formats
+
+// hdr_extended_storage is set only for databases created in ODS 13.2 and never
+// for databases upgraded to it in place. Such databases can't contain records,
+// blobs and pages written by older engines, which may have used the same bits
+// and control values with another meaning. Older engines refuse ODS 13.2, thus
+// nobody but the current engine ever changes pages of these databases. Record
+// matches (LZRecordCompression), packed blobs on data pages (BlobCompression),
+// page checksums (PageChecksums) and all-visible data pages are used only when
+// the flag is set.
 
 const USHORT hdr_backup_mask		= 0xC00;
 const USHORT hdr_shutdown_mask		= 0x1080;
@@ -837,6 +851,7 @@ const USHORT rhd_gc_active		= 256;		// garbage collecting dead record version
 const USHORT rhd_uk_modified	= 512;		// record key field values are changed
 const USHORT rhd_long_tranum	= 1024;		// transaction number is 64-bit
 const USHORT rhd_not_packed		= 2048;		// record (or delta) is stored "as is"
+const USHORT rhd_packed_blob	= 4096;		// level 0 blob data is compressed, see hdr_extended_storage
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
@@ -68,7 +68,8 @@ InnerJoin::InnerJoin(thread_db* aTdbb, Optimizer* opt,
 	  plan(hasPlan),
 	  innerStreams(getPool(), streams.getCount()),
 	  joinedStreams(getPool()),
-	  bestStreams(getPool())
+	  bestStreams(getPool()),
+	  estimates(getPool())
 {
 	joinedStreams.grow(streams.getCount());
 
@@ -179,14 +180,11 @@ void InnerJoin::estimateCost(unsigned position,
 
 	const auto sort = (!position && sortPtr) ? *sortPtr : nullptr;
 
-	// Create the optimizer retrieval generation class and calculate
-	// which indexes will be used and the total estimated selectivity will be returned
-	Retrieval retrieval(tdbb, optimizer, stream->number, false, false, sort, true);
-	const auto candidate = retrieval.getInversion();
-	fb_assert(!position || candidate->dependencies);
+	const auto& candidate = getEstimate(stream, sort);
+	fb_assert(!position || candidate.dependencies);
 
 	// Calculate the relationship selectivity
-	double selectivity = candidate->selectivity;
+	double selectivity = candidate.selectivity;
 	if (selectivity < stream->baseSelectivity)
 		selectivity /= stream->baseSelectivity;
 
@@ -197,7 +195,7 @@ void InnerJoin::estimateCost(unsigned position,
 	const auto streamCardinality = tail->csb_cardinality;
 
 	// Calculate the nested loop cost, it's our default option
-	const auto loopCost = candidate->cost * cardinality;
+	const auto loopCost = candidate.cost * cardinality;
 	cost = loopCost;
 
 	if (position)
@@ -206,20 +204,21 @@ void InnerJoin::estimateCost(unsigned position,
 		// plus two cardinalities. Hashed stream cardinality means the cost of copying rows
 		// into the hash table and the outer cardinality represents probing the hash table.
 		const auto hashCardinality = stream->baseSelectivity * streamCardinality;
-		const auto hashCost = stream->baseCost + hashCardinality + cardinality;
+		auto hashCost = stream->baseCost + hashCardinality + cardinality;
+
+		// If the hashed stream doesn't fit a single hash table, both streams
+		// are partitioned into the temp space and read once again
+		if (hashCardinality > HashJoin::tableCapacity())
+			hashCost += hashCardinality + cardinality;
 
 		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity())
 		{
 			auto& equiMatches = joinedStreams[position].equiMatches;
 			fb_assert(!equiMatches.hasData());
 
-			// Scan the matches for possible equi-join conditions
-			for (const auto match : candidate->matches)
+			// Scan the equi-join conditions
+			for (const auto match : candidate.equiMatches)
 			{
-				// Check whether we have an equivalence operation
-				if (!optimizer->checkEquiJoin(match))
-					continue;
-
 				// Check whether the match references priorly joined streams
 				const auto end = joinedStreams.begin() + position;
 				for (auto iter = joinedStreams.begin(); iter != end; ++iter)
@@ -239,11 +238,67 @@ void InnerJoin::estimateCost(unsigned position,
 		}
 	}
 
-	const auto resultingCardinality = streamCardinality * candidate->selectivity;
+	const auto resultingCardinality = streamCardinality * candidate.selectivity;
 	cardinality = MAX(resultingCardinality, MINIMUM_CARDINALITY);
 }
 
 
+//
+// Get the retrieval estimate for the stream, reusing the one made before
+// for the same set of active streams
+//
+
+const InnerJoin::StreamEstimate& InnerJoin::getEstimate(const StreamInfo* stream, SortNode* sort)
+{
+	const bool cacheable = (innerStreams.getCount() <= 64);
+	FB_UINT64 activeStreams = 0;
+
+	if (cacheable)
+	{
+		for (FB_SIZE_T i = 0; i < innerStreams.getCount(); i++)
+		{
+			if (csb->csb_rpt[innerStreams[i]->number].csb_flags & csb_active)
+				activeStreams |= ((FB_UINT64) 1) << i;
+		}
+
+		for (const auto& estimate : estimates)
+		{
+			if (estimate.stream == stream->number &&
+				estimate.activeStreams == activeStreams &&
+				estimate.sorted == (sort != nullptr))
+			{
+				return estimate;
+			}
+		}
+	}
+
+	// Create the optimizer retrieval generation class and calculate
+	// which indexes will be used and the total estimated selectivity will be returned
+	Retrieval retrieval(tdbb, optimizer, stream->number, false, false, sort, true);
+	const auto candidate = retrieval.getInversion();
+
+	if (!cacheable)
+		estimates.clear();
+
+	auto& estimate = estimates.add();
+	estimate.stream = stream->number;
+	estimate.activeStreams = activeStreams;
+	estimate.sorted = (sort != nullptr);
+	estimate.cost = candidate->cost;
+	estimate.selectivity = candidate->selectivity;
+	estimate.dependencies = candidate->dependencies;
+
+	for (const auto match : candidate->matches)
+	{
+		// Keep only the equivalence operations, they're what hash joins need
+		if (optimizer->checkEquiJoin(match))
+			estimate.equiMatches.add(match);
+	}
+
+	return estimate;
+}
+
+
 //
 // Find the best order out of the streams. First return a stream if it can't use
 // an index based on a previous stream and it can't be used by another stream.
@@ -256,6 +311,9 @@ bool InnerJoin::findJoinOrder()
 	bestCount = 0;
 	remainingStreams = 0;
 
+	// Streams joined by the previous call may have changed the retrievals
+	estimates.clear();
+
 #ifdef OPT_DEBUG
 	// Debug
 	printStartOrder();
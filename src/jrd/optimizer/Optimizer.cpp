@@ -85,6 +85,7 @@
 #include "../dsql/ExprNodes.h"
 #include "../dsql/StmtNodes.h"
 #include "../jrd/ConfigTable.h"
+#include "../jrd/RangeSummary.h"
 
 #include "../jrd/optimizer/Optimizer.h"
 
@@ -555,6 +556,94 @@ namespace
 		}
 	}
 
+
+	FieldRangeNode* makeFieldRange(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
+								   BoolExprNode* boolean)
+	{
+		// Match the comparison of a stream field that may be skipped by range summaries
+
+		const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+
+		if (!cmpNode)
+			return nullptr;
+
+		const FieldNode* fieldNode = nullptr;
+		unsigned fieldArg = 0;
+
+		ValueExprNode* const args[] = {cmpNode->arg1, cmpNode->arg2, cmpNode->arg3};
+
+		for (unsigned i = 0; i < FB_NELEM(args) && !fieldNode; i++)
+		{
+			const auto node = nodeAs<FieldNode>(args[i]);
+
+			if (node && node->fieldStream == stream)
+			{
+				fieldNode = node;
+				fieldArg = i + 1;
+			}
+		}
+
+		if (!fieldNode)
+			return nullptr;
+
+		ValueExprNode* lower = nullptr;
+		ValueExprNode* upper = nullptr;
+
+		switch (cmpNode->blrOp)
+		{
+		case blr_eql:
+			lower = upper = (fieldArg == 1) ? cmpNode->arg2 : cmpNode->arg1;
+			break;
+
+		case blr_gtr:
+		case blr_geq:
+			if (fieldArg == 1)
+				lower = cmpNode->arg2;	// field > arg2
+			else
+				upper = cmpNode->arg1;	// arg1 > field
+			break;
+
+		case blr_lss:
+		case blr_leq:
+			if (fieldArg == 1)
+				upper = cmpNode->arg2;	// field < arg2
+			else
+				lower = cmpNode->arg1;	// arg1 < field
+			break;
+
+		case blr_between:
+			if (fieldArg == 1)		// field between arg2 and arg3
+			{
+				lower = cmpNode->arg2;
+				upper = cmpNode->arg3;
+			}
+			else if (fieldArg == 2)	// arg1 between field and arg3
+				upper = cmpNode->arg1;
+			else					// arg1 between arg2 and field
+				lower = cmpNode->arg1;
+			break;
+
+		default:
+			return nullptr;
+		}
+
+		if ((lower && !lower->computable(csb, stream, false)) ||
+			(upper && !upper->computable(csb, stream, false)))
+		{
+			return nullptr;
+		}
+
+		const auto format = CMP_format(tdbb, csb, stream);
+
+		if (fieldNode->fieldId >= format->fmt_count ||
+			!RangeSummary::isSupported(format->fmt_desc[fieldNode->fieldId]))
+		{
+			return nullptr;
+		}
+
+		return FB_NEW_POOL(csb->csb_pool) FieldRangeNode(fieldNode->fieldId, lower, upper);
+	}
+
 } // namespace
 
 
@@ -639,6 +728,19 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 	SortNode* project = rse->rse_projection;
 	SortNode* aggregate = rse->rse_aggregate;
 
+	// UNION DISTINCT may remove the duplicates by hashing inside the union itself
+
+	if (project && rse->rse_relations.getCount() == 1)
+	{
+		const auto unionNode = nodeAs<UnionSourceNode>(rse->rse_relations[0]);
+
+		if (unionNode && unionNode->isHashable(csb, project))
+		{
+			unionNode->hashDistinct = project;
+			project = nullptr;
+		}
+	}
+
 	BoolExprNodeStack conjunctStack;
 	unsigned conjunctCount = 0;
 
@@ -975,6 +1077,22 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 		sort = nullptr;
 	}
 
+	// If not too many groups are expected, let the aggregation
+	// collect them into a hash table instead of sorting the input
+
+	if (sort && !project && (rse->flags & RseNode::FLAG_HASH_GROUPING))
+	{
+		double groups = rsb->getCardinality();
+		for (auto count = sort->expressions.getCount(); count; count--)
+			groups *= REDUCE_SELECTIVITY_FACTOR_EQUALITY;
+
+		if (groups <= MAXIMUM_HASH_GROUPS)
+		{
+			rse->flags |= RseNode::FLAG_HASH_GROUPED;
+			sort = nullptr;
+		}
+	}
+
 	// Check index usage in all the base streams to ensure
 	// that any user-specified access plan is followed
 
@@ -996,7 +1114,25 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+		{
+			const auto sortRsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+
+			// If FIRST and SKIP are known at open time, let the sort keep only
+			// the records to be returned. SKIP LOCKED may need more of them.
+
+			const auto isKnownValue = [](const ValueExprNode* node)
+			{
+				return !node || nodeIs<LiteralNode>(node) || nodeIs<ParameterNode>(node);
+			};
+
+			if (rse->rse_first && isKnownValue(rse->rse_first) && isKnownValue(rse->rse_skip) &&
+				!rse->hasWriteLock())
+			{
+				sortRsb->setFirstRows(rse->rse_first, rse->rse_skip);
+			}
+
+			rsb = sortRsb;
+		}
 	}
 
 	// Add invariant booleans, if any. They should be evaluated before
@@ -2806,6 +2942,11 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 	BoolExprNode* boolean = nullptr;
 	double filterSelectivity = MAXIMUM_SELECTIVITY;
 
+	// Local booleans of a full table scan may let it skip the ranges of data pages
+	Array<FieldRangeNode*> fieldRanges;
+	const bool useSummaries = !rsb && !inversion && tdbb->getDatabase()->dbb_range_summaries &&
+		!relation->isSystem() && !relation->isTemporary();
+
 	for (auto iter = getConjuncts(outerFlag, innerFlag); iter.hasData(); ++iter)
 	{
 		if (!(iter & CONJUNCT_USED) &&
@@ -2830,6 +2971,12 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 
 					filterSelectivity *= getSelectivity(*iter);
 				}
+
+				if (useSummaries)
+				{
+					if (const auto fieldRange = makeFieldRange(tdbb, csb, stream, *iter))
+						fieldRanges.add(fieldRange);
+				}
 			}
 		}
 	}
@@ -2853,7 +3000,13 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 		}
 		else
 		{
-			rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges);
+			// Rows locked or modified by the request must be read by its own transaction
+			const bool parallel = !rse->hasWriteLock();
+
+			const auto scan = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation,
+				dbkeyRanges, parallel);
+			scan->setFieldRanges(fieldRanges);
+			rsb = scan;
 
 			if (boolean)
 				csb->csb_rpt[stream].csb_flags |= csb_unmatched;
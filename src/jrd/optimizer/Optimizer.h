@@ -36,6 +36,7 @@
 #include "../common/classes/alloc.h"
 #include "../common/classes/array.h"
 #include "../common/classes/fb_string.h"
+#include "../common/classes/objects_array.h"
 #include "../dsql/BoolNodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/RecordSourceNodes.h"
@@ -59,6 +60,9 @@ const double MINIMUM_CARDINALITY = 1.0;
 const double THRESHOLD_CARDINALITY = 5.0;
 const double DEFAULT_CARDINALITY = 1000.0;
 
+// Maximal estimated number of groups to prefer hashing over sorting
+const double MAXIMUM_HASH_GROUPS = 1000000.0;
+
 // Default depth of an index tree (including one leaf page),
 // also representing the minimal cost of the index scan.
 // We assume that the root page would be always cached,
@@ -557,6 +561,7 @@ struct IndexScratch
 	unsigned nonFullMatchedSegments = 0;
 	bool usePartialKey = false;				// Use INTL_KEY_PARTIAL
 	bool useMultiStartingKeys = false;		// Use INTL_KEY_MULTI_STARTING
+	bool skipScan = false;					// leading segment is skipped over
 
 	Firebird::ObjectsArray<IndexScratchSegment> segments;
 	MatchedBooleanList matches;					// matched booleans (partial indices only)
@@ -623,6 +628,7 @@ protected:
 	bool checkIndexExpression(const index_desc* idx, ValueExprNode* node) const;
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
+	double estimateSelectivity(const IndexScratch& scratch) const;
 	const Firebird::string& getAlias();
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
@@ -789,6 +795,26 @@ class InnerJoin : private Firebird::PermanentStorage
 
 	typedef Firebird::HalfStaticArray<JoinedStreamInfo, OPT_STATIC_ITEMS> JoinedStreamList;
 
+	// Retrieval estimate of a stream for the given set of active inner streams.
+	// Different join orders often reach the same set, so estimates are reused.
+	struct StreamEstimate
+	{
+		explicit StreamEstimate(MemoryPool& p)
+			: equiMatches(p)
+		{}
+
+		StreamType stream = 0;
+		FB_UINT64 activeStreams = 0;	// bit per position in innerStreams
+		bool sorted = false;
+
+		double cost = 0;
+		double selectivity = 0;
+		unsigned dependencies = 0;
+		MatchedBooleanList equiMatches;
+	};
+
+	typedef Firebird::ObjectsArray<StreamEstimate> StreamEstimateList;
+
 public:
 	InnerJoin(thread_db* tdbb, Optimizer* opt,
 			  const StreamList& streams,
@@ -806,6 +832,7 @@ public:
 protected:
 	void calculateStreamInfo();
 	void estimateCost(unsigned position, const StreamInfo* stream, double& cost, double& cardinality);
+	const StreamEstimate& getEstimate(const StreamInfo* stream, SortNode* sort);
 	void findBestOrder(unsigned position, StreamInfo* stream,
 		IndexedRelationships& processList, double cost, double cardinality);
 	void getIndexedRelationships(StreamInfo* testStream);
@@ -832,6 +859,7 @@ private:
 	StreamInfoList innerStreams;
 	JoinedStreamList joinedStreams;
 	JoinedStreamList bestStreams;
+	StreamEstimateList estimates;
 };
 
 } // namespace Jrd
@@ -124,6 +124,7 @@ IndexScratch::IndexScratch(MemoryPool& p, const IndexScratch& other)
 	  nonFullMatchedSegments(other.nonFullMatchedSegments),
 	  usePartialKey(other.usePartialKey),
 	  useMultiStartingKeys(other.useMultiStartingKeys),
+	  skipScan(other.skipScan),
 	  segments(p, other.segments),
 	  matches(p, other.matches)
 {}
@@ -365,7 +366,7 @@ IndexTableScan* Retrieval::getNavigation()
 	if (!navigationCandidate)
 		return nullptr;
 
-	IndexScratch* const scratch = navigationCandidate->scratch;
+	IndexScratch* scratch = navigationCandidate->scratch;
 
 	// Looks like we can do a navigational walk.  Flag that
 	// we have used this index for navigation, and allocate
@@ -375,6 +376,16 @@ IndexTableScan* Retrieval::getNavigation()
 	const USHORT key_length =
 		ROUNDUP(BTR_key_length(tdbb, relation, scratch->index), sizeof(SLONG));
 
+	// Navigation cannot skip over the leading segment, walk the whole index instead
+	IndexScratch fullScratch(getPool(), *scratch);
+
+	if (fullScratch.skipScan)
+	{
+		fullScratch.skipScan = false;
+		fullScratch.lowerCount = fullScratch.upperCount = 0;
+		scratch = &fullScratch;
+	}
+
 	InversionNode* const index_node = makeIndexScanNode(scratch);
 
 	return FB_NEW_POOL(getPool())
@@ -550,7 +561,7 @@ void Retrieval::analyzeNavigation(const InversionCandidateList& inversions)
 
 		for (const auto inversion : inversions)
 		{
-			if (inversion->scratch == &indexScratch)
+			if (inversion->scratch == &indexScratch && !indexScratch.skipScan)
 			{
 				candidate = inversion;
 				break;
@@ -808,6 +819,109 @@ bool Retrieval::checkIndexExpression(const index_desc* idx, ValueExprNode* node)
 		node->containsStream(stream, true);
 }
 
+// Estimate the selectivity of a single segment index scan having constant bounds
+// using the B-tree levels as a histogram. Returns a negative value if not possible.
+
+double Retrieval::estimateSelectivity(const IndexScratch& scratch) const
+{
+	const auto idx = scratch.index;
+
+	if (!relation || idx->idx_count != 1 || (idx->idx_flags & idx_descending) ||
+		scratch.useMultiStartingKeys)
+	{
+		return -1;
+	}
+
+	const auto& segment = scratch.segments[0];
+
+	const auto getLiteral = [](const ValueExprNode* node) -> const LiteralNode*
+	{
+		// Injected casts are evaluated inside the key compression as well
+		if (const auto cast = nodeAs<CastNode>(node))
+			node = cast->source;
+
+		return nodeAs<LiteralNode>(node);
+	};
+
+	const auto lowerLiteral = getLiteral(segment.lowerValue);
+	const auto upperLiteral = getLiteral(segment.upperValue);
+
+	bool hasLower = false, hasUpper = false, nullKey = false;
+
+	switch (segment.scanType)
+	{
+		case segmentScanMissing:
+			hasLower = hasUpper = nullKey = true;
+			break;
+
+		case segmentScanEqual:
+		case segmentScanEquivalent:
+		case segmentScanStarting:
+		case segmentScanBetween:
+			hasLower = hasUpper = true;
+			break;
+
+		case segmentScanLess:
+			hasUpper = true;
+			break;
+
+		case segmentScanGreater:
+			hasLower = true;
+			break;
+
+		default:
+			return -1;
+	}
+
+	if (!nullKey && ((hasLower && !lowerLiteral) || (hasUpper && !upperLiteral)))
+		return -1;
+
+	const bool partial = (segment.scanType == segmentScanStarting || scratch.usePartialKey);
+	const USHORT keyType = partial ? INTL_KEY_PARTIAL :
+		(idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+
+	temporary_key lower, upper;
+
+	try
+	{
+		if (nullKey)
+		{
+			BTR_make_null_key(tdbb, idx, &lower);
+			BTR_make_null_key(tdbb, idx, &upper);
+		}
+		else
+		{
+			if (hasLower)
+				BTR_make_value_key(tdbb, idx, &lowerLiteral->litDesc, &lower, keyType);
+			else
+			{
+				// NULLs are skipped by the ascending scan without a lower bound
+				lower.key_flags = 0;
+				lower.key_data[0] = 0;
+				lower.key_length = 1;
+				hasLower = true;
+			}
+
+			if (hasUpper)
+				BTR_make_value_key(tdbb, idx, &upperLiteral->litDesc, &upper, keyType);
+		}
+
+		if (lower.key_next || upper.key_next)
+			return -1;
+
+		return BTR_estimate(tdbb, relation, idx,
+			hasLower ? &lower : nullptr, hasUpper ? &upper : nullptr, partial);
+	}
+	catch (const Exception&)
+	{
+		// The value cannot be converted into the key,
+		// let the regular error be raised at runtime
+	}
+
+	return -1;
+}
+
+
 void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 									   IndexScratchList& fromIndexScratches,
 									   unsigned scope) const
@@ -828,14 +942,41 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 
 		const auto idx = scratch.index;
 
-		if (scratch.candidate)
+		// Without a match on the leading segment of a compound index, the next one
+		// still can be used by skipping over the distinct leading values. It's worth
+		// only if the leading segment has not many distinct values.
+		const double leadingSelectivity = idx->idx_rpt[0].idx_selectivity;
+
+		scratch.skipScan = !scratch.candidate && idx->idx_count > 1 &&
+			!(idx->idx_flags & (idx_descending | idx_expression)) &&
+			scratch.segments[0].scanType == segmentScanNone &&
+			scratch.segments[1].scanType != segmentScanNone &&
+			leadingSelectivity > 0 && 1 / leadingSelectivity < cardinality;
+
+		if (scratch.candidate || scratch.skipScan)
 		{
 			matches.assign(scratch.matches);
 			scratch.selectivity = idx->idx_fraction;
 
+			// For the skip scan, selectivity of the next segments is the selectivity
+			// of the compound key for the single leading value
+			const auto getSelectivity = [&](unsigned segment)
+			{
+				const double selectivity = idx->idx_rpt[segment].idx_selectivity;
+
+				return scratch.skipScan ?
+					MIN(selectivity / leadingSelectivity, MAXIMUM_SELECTIVITY) : selectivity;
+			};
+
+			if (scratch.skipScan)
+			{
+				scratch.lowerCount++;
+				scratch.upperCount++;
+			}
+
 			bool unique = false;
 
-			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
+			for (unsigned j = scratch.skipScan ? 1 : 0; j < scratch.segments.getCount(); j++)
 			{
 				const auto& segment = scratch.segments[j];
 
@@ -877,7 +1018,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					// This is a perfect usable segment thus update root selectivity
 					scratch.lowerCount++;
 					scratch.upperCount++;
-					scratch.selectivity = idx->idx_rpt[j].idx_selectivity;
+					scratch.selectivity = getSelectivity(j);
 					scratch.nonFullMatchedSegments = idx->idx_count - (j + 1);
 					// Add matches for this segment to the main matches list
 					matches.join(segment.matches);
@@ -895,7 +1036,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					//		   to return zero rows. Do we need yet another
 					//		   special case here?
 
-					if (single_match && ((j + 1) == idx->idx_count))
+					if (single_match && ((j + 1) == idx->idx_count) && !scratch.skipScan)
 					{
 						// We have found a full equal matching index and it's unique,
 						// so we can stop looking further, because this is the best
@@ -922,19 +1063,19 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 						case segmentScanBetween:
 							scratch.lowerCount++;
 							scratch.upperCount++;
-							selectivity = idx->idx_rpt[j].idx_selectivity;
+							selectivity = getSelectivity(j);
 							factor = REDUCE_SELECTIVITY_FACTOR_BETWEEN;
 							break;
 
 						case segmentScanLess:
 							scratch.upperCount++;
-							selectivity = idx->idx_rpt[j].idx_selectivity;
+							selectivity = getSelectivity(j);
 							factor = REDUCE_SELECTIVITY_FACTOR_LESS;
 							break;
 
 						case segmentScanGreater:
 							scratch.lowerCount++;
-							selectivity = idx->idx_rpt[j].idx_selectivity;
+							selectivity = getSelectivity(j);
 							factor = REDUCE_SELECTIVITY_FACTOR_GREATER;
 							break;
 
@@ -943,7 +1084,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 						case segmentScanEquivalent:
 							scratch.lowerCount++;
 							scratch.upperCount++;
-							selectivity = idx->idx_rpt[j].idx_selectivity;
+							selectivity = getSelectivity(j);
 							factor = REDUCE_SELECTIVITY_FACTOR_STARTING;
 							break;
 
@@ -969,6 +1110,24 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				}
 			}
 
+			if (scratch.scopeCandidate && !unique && scratch.lowerCount + scratch.upperCount)
+			{
+				// Value bounds known at prepare time allow to replace the reduce
+				// factors and the average selectivity with the number of keys
+				// really found in the range
+				const double estimate = estimateSelectivity(scratch);
+
+				if (estimate >= 0)
+				{
+					const double minSelectivity = 1 / MAX(cardinality, MINIMUM_CARDINALITY);
+					scratch.selectivity = MAX(estimate * idx->idx_fraction, minSelectivity);
+				}
+			}
+
+			// Multiple starting keys cannot be combined with the leading values
+			if (scratch.skipScan && scratch.useMultiStartingKeys)
+				scratch.scopeCandidate = false;
+
 			if (scratch.scopeCandidate)
 			{
 				// When selectivity is zero the statement is prepared on an
@@ -986,9 +1145,16 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				invCandidate->selectivity = selectivity;
 				// Calculate the cost (only index pages) for this index.
 				invCandidate->cost = DEFAULT_INDEX_COST + scratch.selectivity * scratch.cardinality;
+
+				// Skip scan looks for every leading value separately
+				if (scratch.skipScan)
+					invCandidate->cost += DEFAULT_INDEX_COST / leadingSelectivity;
 				invCandidate->nonFullMatchedSegments = scratch.nonFullMatchedSegments;
 				invCandidate->matchedSegments = MAX(scratch.lowerCount, scratch.upperCount);
 				invCandidate->indexes = 1;
+
+				if (scratch.skipScan)
+					invCandidate->matchedSegments--;
 				invCandidate->scratch = &scratch;
 				invCandidate->matches.join(matches);
 
@@ -1105,8 +1271,11 @@ InversionNode* Retrieval::makeIndexScanNode(IndexScratch* indexScratch) const
 
 		for (unsigned i = 0; i < count; i++)
 		{
-			if (segments[i].scanType == segmentScanMissing)
+			if (segments[i].scanType == segmentScanMissing ||
+				(i == 0 && indexScratch->skipScan))
 			{
+				// Skipped leading segment produces no key data,
+				// its values are taken from the index itself
 				*lower++ = *upper++ = NullNode::instance();
 				ignoreNullsOnScan = false;
 			}
@@ -1138,6 +1307,9 @@ InversionNode* Retrieval::makeIndexScanNode(IndexScratch* indexScratch) const
 
 		if (segments[count - 1].excludeUpper)
 			retrieval->irb_generic |= irb_exclude_upper;
+
+		if (indexScratch->skipScan)
+			retrieval->irb_generic |= irb_skip_scan;
 	}
 
 	if (indexScratch->usePartialKey)
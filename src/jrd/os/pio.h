@@ -38,6 +38,8 @@ namespace Jrd {
 
 #ifdef UNIX
 
+class IoRing;
+
 class jrd_file : public pool_alloc_rpt<SCHAR, type_fil>
 {
 public:
@@ -48,6 +50,7 @@ public:
 	USHORT fil_fudge;			// Fudge factor for page relocation
 	int fil_desc;
 	Firebird::Mutex fil_mutex;
+	IoRing* fil_ring;			// Kernel submission ring used for batched reads
 	USHORT fil_flags;
 	SCHAR fil_string[1];		// Expanded file name
 };
@@ -89,6 +92,7 @@ const USHORT FIL_readonly			= 4;	// file opened in readonly mode
 const USHORT FIL_sh_write			= 8;	// file opened in shared write mode
 const USHORT FIL_no_fast_extend		= 16;	// file not supports fast extending
 const USHORT FIL_raw_device			= 32;	// file is raw device
+const USHORT FIL_no_io_ring			= 64;	// batched reads are not supported by OS
 
 // Physical IO trace events
 
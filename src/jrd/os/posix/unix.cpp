@@ -48,6 +48,15 @@
 #ifdef HAVE_LINUX_FALLOC_H
 #include <linux/falloc.h>
 #endif
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define USE_IO_URING
+#endif
+#endif
 
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
@@ -139,6 +148,228 @@ static int  raw_devices_unlink_database (const PathName&);
 #endif
 static int	openFile(const Firebird::PathName&, const bool, const bool, const bool);
 static void	maybeCloseFile(int&);
+#ifdef USE_IO_URING
+static FB_SIZE_T ring_read_batch(Database*, jrd_file*, BufferDesc* const*, FB_SIZE_T, bool*);
+#endif
+#ifdef HAVE_PREADV
+static FB_SIZE_T vector_read_batch(Database*, jrd_file*, BufferDesc* const*, FB_SIZE_T, bool*);
+#endif
+
+
+#ifdef USE_IO_URING
+
+// Number of requests submitted to the kernel at once
+const unsigned IO_RING_ENTRIES = 64;
+
+namespace Jrd {
+
+// Thin wrapper around io_uring system calls - we need just a few of them
+// and don't want to depend on liburing. Ring is used by the cache reader
+// thread only, therefore it's not protected from concurrent access.
+
+class IoRing
+{
+public:
+	~IoRing();
+
+	static IoRing* create(MemoryPool& pool);
+
+	bool prepareRead(int desc, void* buffer, unsigned length, FB_UINT64 offset, FB_UINT64 userData);
+	bool submit();
+	bool complete(FB_UINT64* userData, int* result);
+
+	unsigned getEntries() const
+	{
+		return sqEntries;
+	}
+
+	// Number of prepared requests not accepted by the kernel yet, they are never executed
+	unsigned getUnsubmitted() const
+	{
+		return unsubmitted;
+	}
+
+private:
+	IoRing()
+		: ringDesc(-1), sqEntries(0), sqRing(MAP_FAILED), cqRing(MAP_FAILED), sqes(MAP_FAILED),
+		  sqRingSize(0), cqRingSize(0), sqesSize(0), unsubmitted(0)
+	{ }
+
+	int enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+	{
+		return syscall(__NR_io_uring_enter, ringDesc, toSubmit, minComplete, flags, NULL, 0);
+	}
+
+	int ringDesc;
+	unsigned sqEntries;
+
+	void* sqRing;
+	void* cqRing;
+	void* sqes;
+	size_t sqRingSize, cqRingSize, sqesSize;
+
+	unsigned* sqHead;
+	unsigned* sqTail;
+	unsigned* sqMask;
+	unsigned* sqArray;
+	unsigned* cqHead;
+	unsigned* cqTail;
+	unsigned* cqMask;
+	io_uring_cqe* cqes;
+
+	unsigned unsubmitted;
+	struct iovec iov[IO_RING_ENTRIES];
+};
+
+IoRing* IoRing::create(MemoryPool& pool)
+{
+	IoRing* const ring = FB_NEW_POOL(pool) IoRing;
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	ring->ringDesc = syscall(__NR_io_uring_setup, IO_RING_ENTRIES, &params);
+	if (ring->ringDesc < 0)
+	{
+		// ENOSYS (old kernel) or EPERM (disabled by administrator)
+		delete ring;
+		return NULL;
+	}
+
+	ring->sqEntries = MIN(params.sq_entries, IO_RING_ENTRIES);
+	ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	ring->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+	const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP);
+	if (singleMap)
+		ring->sqRingSize = ring->cqRingSize = MAX(ring->sqRingSize, ring->cqRingSize);
+
+	ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+		ring->ringDesc, IORING_OFF_SQ_RING);
+
+	if (ring->sqRing != MAP_FAILED)
+	{
+		ring->cqRing = singleMap ? ring->sqRing :
+			mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				ring->ringDesc, IORING_OFF_CQ_RING);
+	}
+
+	if (ring->cqRing != MAP_FAILED)
+	{
+		ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring->ringDesc, IORING_OFF_SQES);
+	}
+
+	if (ring->sqes == MAP_FAILED)
+	{
+		delete ring;
+		return NULL;
+	}
+
+	char* const sq = static_cast<char*>(ring->sqRing);
+	ring->sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	ring->sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	ring->sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+	ring->sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+	char* const cq = static_cast<char*>(ring->cqRing);
+	ring->cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	ring->cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	ring->cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+	ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	return ring;
+}
+
+IoRing::~IoRing()
+{
+	if (sqes != MAP_FAILED)
+		munmap(sqes, sqesSize);
+	if (cqRing != MAP_FAILED && cqRing != sqRing)
+		munmap(cqRing, cqRingSize);
+	if (sqRing != MAP_FAILED)
+		munmap(sqRing, sqRingSize);
+	if (ringDesc >= 0)
+		close(ringDesc);
+}
+
+bool IoRing::prepareRead(int desc, void* buffer, unsigned length, FB_UINT64 offset, FB_UINT64 userData)
+{
+	// Only this thread moves the tail while kernel moves the head
+	const unsigned tail = *sqTail;
+	if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+		return false;
+
+	const unsigned index = tail & *sqMask;
+
+	// IORING_OP_READV is supported since the very first io_uring kernel
+	iov[index % IO_RING_ENTRIES].iov_base = buffer;
+	iov[index % IO_RING_ENTRIES].iov_len = length;
+
+	io_uring_sqe* const sqe = static_cast<io_uring_sqe*>(sqes) + index;
+	memset(sqe, 0, sizeof(io_uring_sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = desc;
+	sqe->addr = (FB_UINT64)(IPTR) &iov[index % IO_RING_ENTRIES];
+	sqe->len = 1;
+	sqe->off = offset;
+	sqe->user_data = userData;
+
+	sqArray[index] = index;
+	__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+	unsubmitted++;
+
+	return true;
+}
+
+bool IoRing::submit()
+{
+	while (unsubmitted)
+	{
+		const int n = enter(unsubmitted, 0, 0);
+
+		if (n < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+
+			return false;
+		}
+
+		unsubmitted -= n;
+	}
+
+	return true;
+}
+
+bool IoRing::complete(FB_UINT64* userData, int* result)
+{
+	while (true)
+	{
+		const unsigned head = *cqHead;
+
+		if (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+		{
+			const io_uring_cqe* const cqe = cqes + (head & *cqMask);
+			*userData = cqe->user_data;
+			*result = cqe->res;
+
+			__atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+			return true;
+		}
+
+		if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 &&
+			!SYSCALL_INTERRUPTED(errno) && errno != EAGAIN && errno != EBUSY)
+		{
+			return false;
+		}
+	}
+}
+
+} // namespace Jrd
+
+#endif // USE_IO_URING
 
 int PIO_add_file(thread_db* tdbb, jrd_file* main_file, const PathName& file_name, SLONG start)
 {
@@ -198,6 +429,11 @@ void PIO_close(jrd_file* main_file)
 			file->fil_desc = -1;
 		}
 	}
+
+#ifdef USE_IO_URING
+	delete main_file->fil_ring;
+	main_file->fil_ring = NULL;
+#endif
 }
 
 
@@ -787,6 +1023,61 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+FB_SIZE_T PIO_read_batch(thread_db* tdbb, jrd_file* main_file, BufferDesc* const* bdbs,
+	FB_SIZE_T count, bool* done)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages sorted by page number, either
+ *	submitting them to the kernel at once or reading
+ *	pages following each other using vectored reads.
+ *	Returns number of pages read completely and marks
+ *	them in "done". Pages which were not read (any error,
+ *	short read or batched reads are not supported) are
+ *	left to the caller to be read with PIO_read, thus
+ *	errors are reported in the usual way.
+ *
+ **************************************/
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+		done[i] = false;
+
+	Database* const dbb = tdbb->getDatabase();
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+#ifdef USE_IO_URING
+	if (dbb->dbb_config->getUseIoUring() && !(main_file->fil_flags & FIL_no_io_ring))
+	{
+		if (!main_file->fil_ring)
+		{
+			main_file->fil_ring = IoRing::create(*dbb->dbb_permanent);
+
+			if (!main_file->fil_ring)
+			{
+				main_file->fil_flags |= FIL_no_io_ring;
+				gds__log("Database: %s\n\tio_uring is not available, using synchronous reads",
+					dbb->dbb_filename.c_str());
+			}
+		}
+
+		if (main_file->fil_ring)
+			return ring_read_batch(dbb, main_file, bdbs, count, done);
+	}
+#endif
+
+#ifdef HAVE_PREADV
+	return vector_read_batch(dbb, main_file, bdbs, count, done);
+#else
+	return 0;
+#endif
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -831,6 +1122,87 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_write_batch(thread_db* tdbb, jrd_file* main_file, BufferDesc* const* bdbs,
+	Ods::pag* const* pages, FB_SIZE_T count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of pages sorted by page number. Pages
+ *	following each other in the same file are written
+ *	using single vectored write.
+ *
+ **************************************/
+#ifdef HAVE_PWRITEV
+	Database* const dbb = tdbb->getDatabase();
+	const SLONG size = dbb->dbb_page_size;
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+	struct iovec iov[MAX_WRITE_COALESCE_PAGES];
+
+	for (FB_SIZE_T n = 0; n < count; )
+	{
+		FB_UINT64 offset;
+		jrd_file* const file = seek_file(main_file, bdbs[n], &offset, status_vector);
+		if (!file)
+			return false;
+
+		int iovcnt = 0;
+		FB_SIZE_T end = n;
+
+		for (; end < count && iovcnt < (int) MAX_WRITE_COALESCE_PAGES; end++, iovcnt++)
+		{
+			const ULONG pageNum = bdbs[end]->bdb_page.getPageNum();
+
+			if (end > n &&
+				(pageNum != bdbs[end - 1]->bdb_page.getPageNum() + 1 || pageNum > file->fil_max_page))
+			{
+				break;
+			}
+
+			iov[iovcnt].iov_base = pages[end];
+			iov[iovcnt].iov_len = size;
+		}
+
+		const SINT64 length = (SINT64) size * iovcnt;
+		int i;
+
+		// Short write is retried as a whole, as PIO_write does
+		for (i = 0; i < IO_RETRY; i++)
+		{
+			const SINT64 bytes = os_utils::pwritev(file->fil_desc, iov, iovcnt, LSEEK_OFFSET_CAST offset);
+
+			if (bytes == length)
+				break;
+
+			if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
+				return unix_error("pwritev", file, isc_io_write_err, status_vector);
+		}
+
+		if (i == IO_RETRY)
+			return unix_error("write_retry", file, isc_io_write_err, status_vector);
+
+		n = end;
+	}
+
+	return true;
+#else
+	for (FB_SIZE_T n = 0; n < count; n++)
+	{
+		if (!PIO_write(tdbb, main_file, bdbs[n], pages[n], status_vector))
+			return false;
+	}
+
+	return true;
+#endif
+}
+
+
 static jrd_file* seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 	FbStatusVector* status_vector)
 {
@@ -976,6 +1348,160 @@ static jrd_file* setup_file(Database* dbb,
 }
 
 
+#ifdef USE_IO_URING
+static FB_SIZE_T ring_read_batch(Database* dbb, jrd_file* main_file, BufferDesc* const* bdbs,
+	FB_SIZE_T count, bool* done)
+{
+/**************************************
+ *
+ *	r i n g _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages using io_uring, see PIO_read_batch.
+ *
+ **************************************/
+	IoRing* const ring = main_file->fil_ring;
+	const unsigned size = dbb->dbb_page_size;
+	FB_SIZE_T result = 0;
+
+	FB_SIZE_T next = 0;
+	while (next < count)
+	{
+		unsigned queued = 0;
+
+		for (; next < count && queued < ring->getEntries(); next++)
+		{
+			FbLocalStatus status;
+			FB_UINT64 offset;
+			jrd_file* const file = seek_file(main_file, bdbs[next], &offset, &status);
+
+			if (!file)
+				continue;
+
+			if (!ring->prepareRead(file->fil_desc, bdbs[next]->bdb_buffer, size, offset, next))
+				break;
+
+			queued++;
+		}
+
+		const bool failed = !ring->submit();
+
+		// Kernel reads into the page buffers of all accepted requests, so every one
+		// of them must complete before the buffers could be used for anything else,
+		// even if the ring is not going to be used anymore
+
+		queued -= ring->getUnsubmitted();
+
+		while (queued)
+		{
+			FB_UINT64 n;
+			int bytes;
+
+			if (!ring->complete(&n, &bytes))
+				ERR_bugcheck_msg("cannot complete io_uring read");
+
+			queued--;
+
+			if (bytes == (int) size)
+			{
+				done[n] = true;
+				result++;
+			}
+		}
+
+		if (failed)
+		{
+			// Should never happen. Don't use the ring anymore, pages not read
+			// yet are left to the caller to be read synchronously.
+
+			delete main_file->fil_ring;
+			main_file->fil_ring = NULL;
+			main_file->fil_flags |= FIL_no_io_ring;
+
+			gds__log("Database: %s\n\tio_uring failed with error %d, using synchronous reads",
+				dbb->dbb_filename.c_str(), errno);
+			break;
+		}
+	}
+
+	return result;
+}
+#endif // USE_IO_URING
+
+
+#ifdef HAVE_PREADV
+static FB_SIZE_T vector_read_batch(Database* dbb, jrd_file* main_file, BufferDesc* const* bdbs,
+	FB_SIZE_T count, bool* done)
+{
+/**************************************
+ *
+ *	v e c t o r _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages sorted by page number, pages
+ *	following each other in the same file are read
+ *	using single vectored read, see PIO_read_batch.
+ *
+ **************************************/
+	const SLONG size = dbb->dbb_page_size;
+	FB_SIZE_T result = 0;
+
+	struct iovec iov[MAX_READ_AHEAD_PAGES];
+
+	for (FB_SIZE_T n = 0; n < count; )
+	{
+		FbLocalStatus status;
+		FB_UINT64 offset;
+		jrd_file* const file = seek_file(main_file, bdbs[n], &offset, &status);
+
+		if (!file)
+		{
+			n++;
+			continue;
+		}
+
+		int iovcnt = 0;
+		FB_SIZE_T end = n;
+
+		for (; end < count && iovcnt < (int) MAX_READ_AHEAD_PAGES; end++, iovcnt++)
+		{
+			const ULONG pageNum = bdbs[end]->bdb_page.getPageNum();
+
+			if (end > n &&
+				(pageNum != bdbs[end - 1]->bdb_page.getPageNum() + 1 || pageNum > file->fil_max_page))
+			{
+				break;
+			}
+
+			iov[iovcnt].iov_base = bdbs[end]->bdb_buffer;
+			iov[iovcnt].iov_len = size;
+		}
+
+		SINT64 bytes;
+		do
+		{
+			bytes = os_utils::preadv(file->fil_desc, iov, iovcnt, LSEEK_OFFSET_CAST offset);
+		} while (bytes < 0 && SYSCALL_INTERRUPTED(errno));
+
+		// Pages read completely are done, even if read was short
+		for (; n < end && bytes >= size; n++, bytes -= size)
+		{
+			done[n] = true;
+			result++;
+		}
+
+		n = end;
+	}
+
+	return result;
+}
+#endif // HAVE_PREADV
+
+
 static void lockDatabaseFile(int& desc, const bool share, const bool temporary,
 							 const char* fileName, ISC_STATUS operation)
 {
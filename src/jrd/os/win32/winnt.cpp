@@ -602,6 +602,27 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+FB_SIZE_T PIO_read_batch(thread_db*, jrd_file*, BufferDesc* const*, FB_SIZE_T count, bool* done)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Batched reads are not implemented on Windows,
+ *	all pages are left to the caller to be read
+ *	with PIO_read.
+ *
+ **************************************/
+	for (FB_SIZE_T i = 0; i < count; i++)
+		done[i] = false;
+
+	return 0;
+}
+
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
@@ -780,6 +801,30 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_write_batch(thread_db* tdbb, jrd_file* main_file, BufferDesc* const* bdbs,
+	Ods::pag* const* pages, FB_SIZE_T count, FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ w r i t e _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Write a set of pages. Vectored writes are not
+ *	used on Windows, pages are written one by one.
+ *
+ **************************************/
+	for (FB_SIZE_T n = 0; n < count; n++)
+	{
+		if (!PIO_write(tdbb, main_file, bdbs[n], pages[n], status_vector))
+			return false;
+	}
+
+	return true;
+}
+
+
 ULONG PIO_get_number_of_pages(const jrd_file* file, const USHORT pagesize)
 {
 /**************************************
@@ -533,6 +533,19 @@ PAG PAG_allocate_pages(thread_db* tdbb, WIN* window, unsigned cntAlloc, bool ali
 			if (*bytes == 0)
 			{
 				toAlloc = cntAlloc;
+
+				// Skip the following fully used bytes a word at a time
+				while (bytes + sizeof(FB_UINT64) < end)
+				{
+					FB_UINT64 word;
+					memcpy(&word, bytes + 1, sizeof(word));
+
+					if (word)
+						break;
+
+					bytes += sizeof(word);
+				}
+
 				continue;
 			}
 
@@ -968,6 +981,10 @@ void PAG_format_header(thread_db* tdbb)
 	if (dbb->dbb_flags & DBB_DB_SQL_dialect_3)
 		header->hdr_flags |= hdr_SQL_dialect_3;
 
+	// New database can't contain anything written by older engines
+	header->hdr_flags |= hdr_extended_storage;
+	dbb->dbb_flags |= DBB_extended_storage;
+
 	dbb->dbb_ods_version = header->hdr_ods_version & ~ODS_FIREBIRD_FLAG;
 	dbb->dbb_minor_version = header->hdr_ods_minor;
 
@@ -1199,6 +1216,9 @@ void PAG_header(thread_db* tdbb, bool info)
 	if (header->hdr_flags & hdr_no_reserve)
 		dbb->dbb_flags |= DBB_no_reserve;
 
+	if ((header->hdr_flags & hdr_extended_storage) && dbb->getEncodedOdsVersion() >= ODS_13_2)
+		dbb->dbb_flags |= DBB_extended_storage;
+
 	const USHORT sd_flags = header->hdr_flags & hdr_shutdown_mask;
 	if (sd_flags)
 	{
@@ -1345,13 +1365,12 @@ void PAG_init(thread_db* tdbb)
 	dbb->dbb_max_records = Ods::maxRecsPerDP(dbb->dbb_page_size);
 	dbb->dbb_max_idx = Ods::maxIndices(dbb->dbb_page_size);
 
-	// Compute prefetch constants from database page size and maximum prefetch
-	// transfer size. Double pages per prefetch request so that cache reader
-	// can overlap prefetch I/O with database computation over previously prefetched pages.
-#ifdef SUPERSERVER_V2
-	dbb->dbb_prefetch_sequence = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
-	dbb->dbb_prefetch_pages = dbb->dbb_prefetch_sequence * 2;
-#endif
+	// Compute prefetch constants from the configured read-ahead size. Issue new
+	// prefetch request when half of previously requested pages is consumed so that
+	// cache reader can overlap prefetch I/O with database computation over
+	// previously prefetched pages.
+	dbb->dbb_prefetch_pages = (USHORT) MIN(dbb->dbb_config->getReadAheadPages(), MAX_READ_AHEAD_PAGES);
+	dbb->dbb_prefetch_sequence = MAX(dbb->dbb_prefetch_pages / 2, 1);
 }
 
 
@@ -18,7 +18,10 @@
  */
 
 #include "firebird.h"
+#include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
+#include "../jrd/TempSpace.h"
+#include "../dsql/AggNodes.h"
 #include "../dsql/Nodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
@@ -366,13 +369,402 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, Reques
 // Export the template for WindowedStream::WindowStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
 
+// ------------------------------------
+// Data access: hash based aggregation
+// ------------------------------------
+
+static const char* const SCRATCH = "fb_group_";
+
+// Groups collected by the hash aggregation. Every entry keeps the group key,
+// the image of the aggregated record and the images of the aggregate states.
+// The states are always copied back into their own impure slots before being
+// used, so descriptors pointing inside the slots remain valid. When there are
+// too many groups, all of them are moved into the partitions of the temporary
+// space and the table is started anew. Partitions are merged one by one after
+// the input is exhausted.
+
+class AggregatedStream::HashGroups : public PermanentStorage
+{
+	static const ULONG ENTRIES_PER_BLOCK = 256;
+	static const ULONG MIN_CAPACITY = 1024;
+	static const FB_SIZE_T MAX_MEMORY = 64 * 1024 * 1024;
+	static const FB_SIZE_T CHUNK_SIZE = 256 * 1024;
+	static const ULONG END_OF_CHAIN = MAX_ULONG;
+
+	struct Header
+	{
+		ULONG hash;
+		ULONG next;
+	};
+
+	struct Chunk
+	{
+		offset_t offset;
+		ULONG count;
+	};
+
+	typedef Array<Chunk> ChunkList;
+
+public:
+	static const ULONG PARTITION_COUNT = 64;
+
+	HashGroups(MemoryPool& pool, Database* dbb, ULONG keyLength, ULONG recordLength, ULONG stateCount)
+		: PermanentStorage(pool),
+		  m_keyLength(keyLength),
+		  m_recordLength(recordLength),
+		  m_stateCount(stateCount),
+		  m_recordOffset(sizeof(Header) + keyLength),
+		  m_stateOffset(FB_ALIGN(m_recordOffset + recordLength, alignof(impure_value_ex))),
+		  m_entrySize(FB_ALIGN(m_stateOffset + stateCount * sizeof(impure_value_ex),
+			alignof(impure_value_ex))),
+		  m_grant(dbb), m_blocks(pool), m_buckets(pool), m_count(0),
+		  m_space(NULL), m_partitions(pool), m_buffer(pool),
+		  m_current(NULL), m_chunk(0), m_position(0)
+	{
+		const FB_SIZE_T granted = m_grant.grant(0, MAX_MEMORY);
+		m_capacity = MAX((ULONG) (granted / m_entrySize), MIN_CAPACITY);
+
+		ULONG bits = 1;
+		while ((1U << bits) < m_capacity)
+			bits++;
+
+		m_shift = 32 - bits;
+		m_buckets.resize(1U << bits);
+		clear();
+	}
+
+	~HashGroups()
+	{
+		release();
+
+		for (UCHAR** block = m_blocks.begin(); block < m_blocks.end(); block++)
+			delete[] *block;
+
+		delete m_space;
+	}
+
+	ULONG getCount() const
+	{
+		return m_count;
+	}
+
+	bool isFull() const
+	{
+		return (m_count >= m_capacity);
+	}
+
+	bool isSpilled() const
+	{
+		return (m_space != NULL);
+	}
+
+	UCHAR* getEntry(ULONG index) const
+	{
+		fb_assert(index < m_count);
+		return m_blocks[index / ENTRIES_PER_BLOCK] + (index % ENTRIES_PER_BLOCK) * m_entrySize;
+	}
+
+	ULONG getHash(const UCHAR* entry) const
+	{
+		return reinterpret_cast<const Header*>(entry)->hash;
+	}
+
+	const UCHAR* getKey(const UCHAR* entry) const
+	{
+		return entry + sizeof(Header);
+	}
+
+	UCHAR* getRecord(UCHAR* entry) const
+	{
+		return entry + m_recordOffset;
+	}
+
+	UCHAR* getStates(UCHAR* entry) const
+	{
+		return entry + m_stateOffset;
+	}
+
+	const UCHAR* getStates(const UCHAR* entry) const
+	{
+		return entry + m_stateOffset;
+	}
+
+	UCHAR* find(ULONG hash, const UCHAR* key) const
+	{
+		for (ULONG index = m_buckets[getBucket(hash)]; index != END_OF_CHAIN;)
+		{
+			UCHAR* const entry = getEntry(index);
+			const Header* const header = reinterpret_cast<const Header*>(entry);
+
+			if (header->hash == hash && !memcmp(getKey(entry), key, m_keyLength))
+				return entry;
+
+			index = header->next;
+		}
+
+		return NULL;
+	}
+
+	UCHAR* add(ULONG hash, const UCHAR* key)
+	{
+		const ULONG index = m_count;
+		const ULONG block = index / ENTRIES_PER_BLOCK;
+
+		if (block >= m_blocks.getCount())
+			m_blocks.add(FB_NEW_POOL(getPool()) UCHAR[ENTRIES_PER_BLOCK * m_entrySize]);
+
+		m_count++;
+
+		UCHAR* const entry = getEntry(index);
+		Header* const header = reinterpret_cast<Header*>(entry);
+
+		ULONG& head = m_buckets[getBucket(hash)];
+		header->hash = hash;
+		header->next = head;
+		head = index;
+
+		memcpy(entry + sizeof(Header), key, m_keyLength);
+		return entry;
+	}
+
+	UCHAR* add(const UCHAR* image)
+	{
+		UCHAR* const entry = add(getHash(image), getKey(image));
+		memcpy(entry + m_recordOffset, image + m_recordOffset, m_entrySize - m_recordOffset);
+		return entry;
+	}
+
+	// Forget all the groups, optionally releasing the strings owned by their states
+	void clear(bool releaseStates = false)
+	{
+		if (releaseStates)
+			release();
+
+		m_count = 0;
+
+		for (ULONG* bucket = m_buckets.begin(); bucket < m_buckets.end(); bucket++)
+			*bucket = END_OF_CHAIN;
+	}
+
+	// Move all the groups into the partitions
+	void spill()
+	{
+		if (!m_space)
+		{
+			m_space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
+
+			for (ULONG i = 0; i < PARTITION_COUNT; i++)
+				m_partitions.add();
+		}
+
+		for (ULONG partition = 0; partition < PARTITION_COUNT; partition++)
+		{
+			m_buffer.clear();
+
+			for (ULONG index = 0; index < m_count; index++)
+			{
+				const UCHAR* const entry = getEntry(index);
+
+				if (getHash(entry) % PARTITION_COUNT != partition)
+					continue;
+
+				m_buffer.add(entry, m_entrySize);
+
+				if (m_buffer.getCount() >= CHUNK_SIZE)
+					flush(partition);
+			}
+
+			flush(partition);
+		}
+
+		// The strings are owned by the spilled images now
+		clear();
+	}
+
+	void rewind(ULONG partition)
+	{
+		fb_assert(m_space && partition < PARTITION_COUNT);
+
+		m_current = &m_partitions[partition];
+		m_chunk = 0;
+		m_buffer.clear();
+		m_position = 0;
+	}
+
+	const UCHAR* next()
+	{
+		fb_assert(m_current);
+
+		while (m_position >= m_buffer.getCount())
+		{
+			if (m_chunk >= m_current->getCount())
+				return NULL;
+
+			const Chunk& chunk = (*m_current)[m_chunk++];
+			const FB_SIZE_T length = chunk.count * m_entrySize;
+
+			m_buffer.resize(length);
+			m_space->read(chunk.offset, m_buffer.begin(), length);
+			m_position = 0;
+		}
+
+		const UCHAR* const image = m_buffer.begin() + m_position;
+		m_position += m_entrySize;
+		return image;
+	}
+
+	void releaseStrings(const UCHAR* states) const
+	{
+		for (ULONG i = 0; i < m_stateCount; i++)
+		{
+			impure_value_ex state;
+			memcpy(&state, states + i * sizeof(impure_value_ex), sizeof(state));
+			delete state.vlu_string;
+		}
+	}
+
+private:
+	ULONG getBucket(ULONG hash) const
+	{
+		return (hash * 0x9E3779B1U) >> m_shift;
+	}
+
+	void flush(ULONG partition)
+	{
+		if (m_buffer.isEmpty())
+			return;
+
+		const Chunk chunk = {m_space->getSize(), m_buffer.getCount() / m_entrySize};
+		m_space->write(chunk.offset, m_buffer.begin(), m_buffer.getCount());
+		m_partitions[partition].add(chunk);
+
+		m_buffer.clear();
+	}
+
+	void release()
+	{
+		for (ULONG index = 0; index < m_count; index++)
+			releaseStrings(getStates(getEntry(index)));
+	}
+
+	const ULONG m_keyLength;
+	const ULONG m_recordLength;
+	const ULONG m_stateCount;
+	const ULONG m_recordOffset;
+	const ULONG m_stateOffset;
+	const ULONG m_entrySize;
+	TempMemoryGrant m_grant;
+	ULONG m_capacity;
+	ULONG m_shift;
+	Array<UCHAR*> m_blocks;
+	Array<ULONG> m_buckets;
+	ULONG m_count;
+	TempSpace* m_space;
+	ObjectsArray<ChunkList> m_partitions;
+	Array<UCHAR> m_buffer;
+	const ChunkList* m_current;
+	FB_SIZE_T m_chunk;
+	FB_SIZE_T m_position;
+};
+
 // ------------------------------
 
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
-			const NestValueArray* group, MapNode* map, RecordSource* next)
-	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
+			const NestValueArray* group, MapNode* map, RecordSource* next, bool hashed)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next),
+	  m_hashed(hashed),
+	  m_keyDescs(csb->csb_pool),
+	  m_keyLengths(csb->csb_pool),
+	  m_keyLength(0),
+	  m_aggNodes(csb->csb_pool)
 {
 	fb_assert(map);
+
+	if (!m_hashed)
+		return;
+
+	fb_assert(group);
+
+	// Every key value is prefixed with a byte telling NULLs from empty and zero values
+
+	for (auto key : *group)
+	{
+		dsc desc;
+		key->getDesc(tdbb, csb, &desc);
+
+		const ULONG keyLength = HashJoin::getKeyLength(tdbb, desc);
+
+		m_keyDescs.add(desc);
+		m_keyLengths.add(keyLength);
+		m_keyLength += keyLength + 1;
+	}
+
+	for (const auto source : map->sourceList)
+	{
+		if (const auto aggNode = nodeAs<AggNode>(source))
+			m_aggNodes.add(aggNode);
+	}
+}
+
+bool AggregatedStream::isHashable(thread_db* tdbb, CompilerScratch* csb,
+	const NestValueArray* group, const MapNode* map)
+{
+	if (!group)
+		return false;
+
+	for (const auto source : map->sourceList)
+	{
+		const auto aggNode = nodeAs<AggNode>(source);
+
+		if (aggNode && !(aggNode->getCapabilities() & AggNode::CAP_COMBINES_STATES))
+			return false;
+	}
+
+	for (auto key : *group)
+	{
+		dsc desc;
+		key->getDesc(tdbb, csb, &desc);
+
+		if (desc.isBlob() || desc.dsc_dtype == dtype_array)
+			return false;
+	}
+
+	return true;
+}
+
+void AggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	BaseAggWinStream::internalOpen(tdbb);
+
+	if (m_hashed)
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		delete impure->irsb_groups;
+		impure->irsb_groups = NULL;
+
+		resetStrings(request);
+	}
+}
+
+void AggregatedStream::close(thread_db* tdbb) const
+{
+	if (m_hashed)
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		if (impure->irsb_groups)
+		{
+			delete impure->irsb_groups;
+			impure->irsb_groups = NULL;
+
+			resetStrings(request);
+		}
+	}
+
+	BaseAggWinStream::close(tdbb);
 }
 
 void AggregatedStream::getChildren(Array<const RecordSource*>& children) const
@@ -384,7 +776,7 @@ void AggregatedStream::print(thread_db* tdbb, string& plan, bool detailed, unsig
 {
 	if (detailed)
 	{
-		plan += printIndent(++level) + "Aggregate";
+		plan += printIndent(++level) + (m_hashed ? "Hash Aggregate" : "Aggregate");
 		printOptInfo(plan);
 	}
 
@@ -398,7 +790,7 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 
 	Request* const request = tdbb->getRequest();
 	record_param* const rpb = &request->req_rpb[m_stream];
-	Impure* const impure = getImpure(request);
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	if (!(impure->irsb_flags & irsb_open))
 	{
@@ -406,7 +798,33 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
-	if (!evaluateGroup(tdbb))
+	if (m_hashed)
+	{
+		if (!impure->irsb_groups)
+			aggregateGroups(tdbb, request, impure);
+
+		HashGroups* const groups = impure->irsb_groups;
+
+		while (impure->irsb_position >= groups->getCount())
+		{
+			if (!groups->isSpilled() || ++impure->irsb_partition >= HashGroups::PARTITION_COUNT)
+			{
+				rpb->rpb_number.setValid(false);
+				return false;
+			}
+
+			mergeGroups(tdbb, request, impure);
+		}
+
+		UCHAR* const entry = groups->getEntry(impure->irsb_position++);
+
+		Record* const record = rpb->rpb_record;
+		memcpy(record->getData(), groups->getRecord(entry), record->getLength());
+
+		restoreStates(request, groups->getStates(entry));
+		aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+	}
+	else if (!evaluateGroup(tdbb))
 	{
 		rpb->rpb_number.setValid(false);
 		return false;
@@ -415,3 +833,187 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+// Build the binary comparable key of the current group and return its hash value
+ULONG AggregatedStream::makeGroupKey(thread_db* tdbb, Request* request, UCHAR* key) const
+{
+	memset(key, 0, m_keyLength);
+
+	UCHAR* keyPtr = key;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		dsc* desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const ULONG keyLength = m_keyLengths[i];
+
+		if (desc && !(request->req_flags & req_null))
+		{
+			*keyPtr = 1;
+
+			// Keys are built from the declared data types, so convert the values of other types
+
+			const dsc& format = m_keyDescs[i];
+			UCHAR buffer[sizeof(impure_value::vlu_misc) + FB_ALIGNMENT];
+			dsc temp;
+
+			if (!desc->isText() && (desc->dsc_dtype != format.dsc_dtype ||
+				desc->dsc_scale != format.dsc_scale || desc->dsc_length != format.dsc_length))
+			{
+				fb_assert(format.dsc_length <= sizeof(impure_value::vlu_misc));
+
+				temp = format;
+				temp.dsc_address = FB_ALIGN(buffer, FB_ALIGNMENT);
+				MOV_move(tdbb, desc, &temp);
+				desc = &temp;
+			}
+
+			HashJoin::makeKey(tdbb, desc, keyLength, keyPtr + 1);
+		}
+
+		keyPtr += keyLength + 1;
+	}
+
+	fb_assert(keyPtr - key == m_keyLength);
+
+	return InternalHash::hash(m_keyLength, key);
+}
+
+// Read the whole input and collect the groups
+void AggregatedStream::aggregateGroups(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+	const ULONG recordLength = record->getLength();
+
+	HashGroups* const groups = impure->irsb_groups = FB_NEW_POOL(pool)
+		HashGroups(pool, tdbb->getDatabase(), m_keyLength, recordLength, m_aggNodes.getCount());
+
+	impure->irsb_partition = 0;
+	impure->irsb_position = 0;
+
+	UCharBuffer keyBuffer;
+	UCHAR* const key = keyBuffer.getBuffer(m_keyLength);
+
+	while (m_next->getRecord(tdbb))
+	{
+		const ULONG hash = makeGroupKey(tdbb, request, key);
+
+		UCHAR* entry = groups->find(hash, key);
+		const bool found = (entry != NULL);
+
+		if (found)
+			restoreStates(request, groups->getStates(entry));
+		else
+		{
+			if (groups->isFull())
+				groups->spill();
+
+			entry = groups->add(hash, key);
+
+			resetStrings(request);
+
+			aggInit(tdbb, request, m_groupMap);
+		}
+
+		try
+		{
+			aggPass(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+		}
+		catch (const Exception&)
+		{
+			saveStates(request, groups->getStates(entry));
+			throw;
+		}
+
+		if (!found)
+			memcpy(groups->getRecord(entry), record->getData(), recordLength);
+
+		saveStates(request, groups->getStates(entry));
+	}
+
+	if (groups->isSpilled())
+	{
+		groups->spill();
+		mergeGroups(tdbb, request, impure);
+	}
+}
+
+// Load the groups of the current partition, merging the states of the same groups
+void AggregatedStream::mergeGroups(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	HashGroups* const groups = impure->irsb_groups;
+
+	groups->clear(true);
+	resetStrings(request);
+
+	groups->rewind(impure->irsb_partition);
+	impure->irsb_position = 0;
+
+	while (const UCHAR* const image = groups->next())
+	{
+		UCHAR* const entry = groups->find(groups->getHash(image), groups->getKey(image));
+
+		if (!entry)
+		{
+			groups->add(image);
+			continue;
+		}
+
+		restoreStates(request, groups->getStates(entry));
+
+		const UCHAR* partials = groups->getStates(image);
+
+		for (const auto aggNode : m_aggNodes)
+		{
+			impure_value_ex* const slot = request->getImpure<impure_value_ex>(aggNode->impureOffset);
+
+			impure_value_ex partial;
+			memcpy(&partial, partials, sizeof(partial));
+			partials += sizeof(partial);
+
+			// The saved descriptor may point inside the impure slot it was copied from
+			const UCHAR* const base = reinterpret_cast<const UCHAR*>(slot);
+
+			if (partial.vlu_desc.dsc_address >= base &&
+				partial.vlu_desc.dsc_address < base + sizeof(impure_value_ex))
+			{
+				partial.vlu_desc.dsc_address = reinterpret_cast<UCHAR*>(&partial) +
+					(partial.vlu_desc.dsc_address - base);
+			}
+
+			aggNode->aggMerge(tdbb, request, &partial);
+
+			if (partial.vlu_string != slot->vlu_string)
+				delete partial.vlu_string;
+		}
+
+		saveStates(request, groups->getStates(entry));
+	}
+}
+
+// The strings referenced by the impure slots are owned by the saved group states
+void AggregatedStream::resetStrings(Request* request) const
+{
+	for (const auto aggNode : m_aggNodes)
+		request->getImpure<impure_value_ex>(aggNode->impureOffset)->vlu_string = NULL;
+}
+
+void AggregatedStream::saveStates(Request* request, UCHAR* states) const
+{
+	for (const auto aggNode : m_aggNodes)
+	{
+		memcpy(states, request->getImpure<impure_value_ex>(aggNode->impureOffset),
+			sizeof(impure_value_ex));
+		states += sizeof(impure_value_ex);
+	}
+}
+
+void AggregatedStream::restoreStates(Request* request, const UCHAR* states) const
+{
+	for (const auto aggNode : m_aggNodes)
+	{
+		memcpy(request->getImpure<impure_value_ex>(aggNode->impureOffset), states,
+			sizeof(impure_value_ex));
+		states += sizeof(impure_value_ex);
+	}
+}
@@ -21,6 +21,7 @@
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
 #include "../dsql/BoolNodes.h"
+#include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/mov_proto.h"
@@ -44,12 +45,15 @@ FilteredStream::FilteredStream(CompilerScratch* csb, RecordSource* next,
 	  m_anyBoolean(NULL),
 	  m_ansiAny(false),
 	  m_ansiAll(false),
-	  m_ansiNot(false)
+	  m_ansiNot(false),
+	  m_quickChecks(csb->csb_pool)
 {
 	fb_assert(m_next && m_boolean);
 
 	m_impure = csb->allocImpure<Impure>();
 
+	collectQuickChecks(m_boolean);
+
 	const auto cardinality = next->getCardinality();
 	Optimizer::adjustSelectivity(selectivity, MAXIMUM_SELECTIVITY, cardinality);
 	m_cardinality = cardinality * selectivity;
@@ -369,6 +373,9 @@ bool FilteredStream::evaluateBoolean(thread_db* tdbb) const
 	bool result = false;
 	while (m_next->getRecord(tdbb))
 	{
+		if (quickReject(request))
+			continue;
+
 		if (m_boolean->execute(tdbb, request))
 		{
 			result = true;
@@ -384,3 +391,188 @@ bool FilteredStream::evaluateBoolean(thread_db* tdbb) const
 
 	return result;
 }
+
+// Find the conjuncts comparing integer fields with constants. They're checked
+// against the record data before the boolean is evaluated, so most of the
+// records failing a selective condition are rejected without interpreting
+// the expression trees.
+
+void FilteredStream::collectQuickChecks(const BoolExprNode* boolean)
+{
+	if (const auto binaryNode = nodeAs<BinaryBoolNode>(boolean))
+	{
+		if (binaryNode->blrOp == blr_and)
+		{
+			collectQuickChecks(binaryNode->arg1);
+			collectQuickChecks(binaryNode->arg2);
+		}
+
+		return;
+	}
+
+	const auto cmpNode = nodeAs<ComparativeBoolNode>(boolean);
+	if (!cmpNode)
+		return;
+
+	UCHAR blrOp = cmpNode->blrOp;
+	const FieldNode* field = nodeAs<FieldNode>(cmpNode->arg1);
+	const LiteralNode* literal = nodeAs<LiteralNode>(cmpNode->arg2);
+
+	if (blrOp == blr_between)
+	{
+		// FIELD BETWEEN X AND Y is checked as FIELD >= X and FIELD <= Y
+		const LiteralNode* const upper = nodeAs<LiteralNode>(cmpNode->arg3);
+
+		if (field && literal && upper)
+		{
+			addQuickCheck(field, literal, blr_geq);
+			addQuickCheck(field, upper, blr_leq);
+		}
+
+		return;
+	}
+
+	if (!field || !literal)
+	{
+		field = nodeAs<FieldNode>(cmpNode->arg2);
+		literal = nodeAs<LiteralNode>(cmpNode->arg1);
+
+		// Mirror the comparison to have the field on the left side
+		switch (blrOp)
+		{
+			case blr_lss:
+				blrOp = blr_gtr;
+				break;
+			case blr_leq:
+				blrOp = blr_geq;
+				break;
+			case blr_gtr:
+				blrOp = blr_lss;
+				break;
+			case blr_geq:
+				blrOp = blr_leq;
+				break;
+		}
+	}
+
+	if (!field || !literal)
+		return;
+
+	switch (blrOp)
+	{
+		case blr_eql:
+		case blr_neq:
+		case blr_lss:
+		case blr_leq:
+		case blr_gtr:
+		case blr_geq:
+			break;
+
+		default:
+			return;
+	}
+
+	addQuickCheck(field, literal, blrOp);
+}
+
+void FilteredStream::addQuickCheck(const FieldNode* field, const LiteralNode* literal, UCHAR blrOp)
+{
+	const dsc& desc = literal->litDesc;
+
+	QuickCheck check;
+	check.stream = field->fieldStream;
+	check.id = field->fieldId;
+	check.blrOp = blrOp;
+	check.scale = desc.dsc_scale;
+
+	switch (desc.dsc_dtype)
+	{
+		case dtype_short:
+			check.value = *(SSHORT*) desc.dsc_address;
+			break;
+		case dtype_long:
+			check.value = *(SLONG*) desc.dsc_address;
+			break;
+		case dtype_int64:
+			check.value = *(SINT64*) desc.dsc_address;
+			break;
+		default:
+			return;
+	}
+
+	m_quickChecks.add(check);
+}
+
+// Return true if any of the quick checks is known to be false for the current records.
+// NULLs and the field types other than integers of the same scale are left to the boolean.
+
+bool FilteredStream::quickReject(const Request* request) const
+{
+	for (const auto& check : m_quickChecks)
+	{
+		const Record* const record = request->req_rpb[check.stream].rpb_record;
+
+		if (!record)
+			continue;
+
+		const Format* const format = record->getFormat();
+
+		if (check.id >= format->fmt_count || record->isNull(check.id))
+			continue;
+
+		const dsc& desc = format->fmt_desc[check.id];
+
+		if (desc.dsc_scale != check.scale)
+			continue;
+
+		const UCHAR* const data = record->getData() + (IPTR) desc.dsc_address;
+		SINT64 value;
+
+		switch (desc.dsc_dtype)
+		{
+			case dtype_short:
+				value = *(const SSHORT*) data;
+				break;
+			case dtype_long:
+				value = *(const SLONG*) data;
+				break;
+			case dtype_int64:
+				value = *(const SINT64*) data;
+				break;
+			default:
+				continue;
+		}
+
+		bool result;
+
+		switch (check.blrOp)
+		{
+			case blr_eql:
+				result = (value == check.value);
+				break;
+			case blr_neq:
+				result = (value != check.value);
+				break;
+			case blr_lss:
+				result = (value < check.value);
+				break;
+			case blr_leq:
+				result = (value <= check.value);
+				break;
+			case blr_gtr:
+				result = (value > check.value);
+				break;
+			case blr_geq:
+				result = (value >= check.value);
+				break;
+			default:
+				fb_assert(false);
+				continue;
+		}
+
+		if (!result)
+			return true;
+	}
+
+	return false;
+}
@@ -20,12 +20,19 @@
 #include "firebird.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
+#include "../jrd/tra.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/tra_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
 #include "../jrd/Attachment.h"
+#include "../jrd/RangeSummary.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
+#include "../common/classes/ClumpletWriter.h"
 
 #include "RecordSource.h"
 
@@ -36,13 +43,484 @@ using namespace Jrd;
 // Data access: sequential complete table scan
 // -------------------------------------------
 
+// Minimal number of data pages worth to be read by parallel workers
+static const ULONG MIN_PARALLEL_PAGES = 1024;
+
+// Number of data pages read by a worker at once
+static const USHORT SLICE_PAGES = 32;
+
+// Number of slices per worker read in a single batch
+static const ULONG SLICES_PER_WORKER = 4;
+
+// Number of the summarized page range containing the given record
+static ULONG getRangeNumber(thread_db* tdbb, RecordNumber number)
+{
+	const Database* const dbb = tdbb->getDatabase();
+	const ULONG rangePages = dbb->dbb_range_summaries->getRangePages();
+
+	return (ULONG) (number.getValue() / dbb->dbb_max_records / rangePages);
+}
+
+
+// Parallel scan reads the relation by batches of data page slices. Every worker
+// uses its own attachment and a read-only transaction sharing the snapshot of
+// the request, so it sees exactly the same record versions. Fetched records are
+// collected per slice into memory and then returned by the request thread in
+// the order of their record numbers.
+//
+// Worker transactions are started on the first batch and committed when the scan
+// is closed, so every open of the stream costs up to the number of workers
+// transaction starts. It's the reason why only big tables are read this way.
+
+class FullTableScan::ParallelScan : public Task
+{
+	struct RecordHeader
+	{
+		SINT64 number;
+		TraNumber transaction;
+		ULONG page;
+		ULONG b_page;
+		ULONG f_page;
+		USHORT line;
+		USHORT b_line;
+		USHORT f_line;
+		USHORT flags;
+		USHORT format;
+		ULONG length;
+	};
+
+public:
+	ParallelScan(thread_db* tdbb, MemoryPool* pool, jrd_rel* relation,
+				 CommitNumber snapshot, int workers, bool largeScan) : Task(),
+		m_pool(pool),
+		m_dbb(tdbb->getDatabase()),
+		m_tdbb_flags(tdbb->tdbb_flags),
+		m_relation(relation),
+		m_snapshot(snapshot),
+		m_ignoreLimbo(tdbb->getTransaction()->tra_flags & TRA_ignore_limbo),
+		m_largeScan(largeScan),
+		m_coord(pool),
+		m_items(*m_pool),
+		m_stop(false),
+		m_slicesPerPP((m_dbb->dbb_dp_per_pp + SLICE_PAGES - 1) / SLICE_PAGES),
+		m_countSlices(0),
+		m_nextSlice(0),
+		m_batchStart(0),
+		m_batchEnd(0),
+		m_chunks(*m_pool),
+		m_chunk(0),
+		m_offset(0),
+		m_interrupted(false)
+	{
+		m_position.setValue(BOF_NUMBER);
+
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+		m_countSlices = m_relation->getPages(tdbb)->rel_pages->count() * m_slicesPerPP;
+
+		for (ULONG i = 0; i < workers * SLICES_PER_WORKER; i++)
+			m_chunks.add();
+	}
+
+	virtual ~ParallelScan()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+	bool getResult(IStatus* status);
+
+	int getMaxWorkers()
+	{
+		return MIN(m_items.getCount(), m_batchEnd - m_batchStart);
+	}
+
+	bool fetch(thread_db* tdbb, record_param* rpb);
+
+	bool isComplete() const
+	{
+		return !m_interrupted && (m_nextSlice >= m_countSlices);
+	}
+
+	// Number of the last record returned by fetch(), the caller should continue
+	// from there if the scan is interrupted
+	RecordNumber getPosition() const
+	{
+		return m_position;
+	}
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(ParallelScan* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_tra(NULL),
+			m_record(NULL),
+			m_slice(0)
+		{}
+
+		virtual ~Item()
+		{
+			delete m_record;
+
+			if (!m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+			Attachment* att = NULL;
+
+			if (!m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				Arg::Gds(isc_bad_db_handle).copyTo(status);
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (!m_tra)
+			{
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+					ClumpletWriter tpb(ClumpletReader::Tpb, 128, isc_tpb_version3);
+					tpb.insertTag(isc_tpb_concurrency);
+					tpb.insertTag(isc_tpb_read);
+					if (getTask()->m_ignoreLimbo)
+						tpb.insertTag(isc_tpb_ignore_limbo);
+					tpb.insertTag(isc_tpb_no_auto_undo);
+					tpb.insertBigInt(isc_tpb_at_snapshot_number, getTask()->m_snapshot);
+
+					m_tra = TRA_start(tdbb, tpb.getBufferLength(), tpb.getBuffer());
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			return true;
+		}
+
+		ParallelScan* getTask() const
+		{
+			return reinterpret_cast<ParallelScan*> (m_task);
+		}
+
+		bool m_inuse;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		Record* m_record;
+		ULONG m_slice;
+	};
+
+private:
+	void setError(IStatus* status)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS)
+			m_status.save(status);
+
+		m_stop = true;
+	}
+
+	void composeSlice(RecordNumber& number, ULONG slice, USHORT offset) const
+	{
+		const ULONG ppSequence = slice / m_slicesPerPP;
+		const ULONG slot = (slice % m_slicesPerPP) * SLICE_PAGES + offset;
+
+		number.compose(m_dbb->dbb_max_records, m_dbb->dbb_dp_per_pp, 0,
+			(USHORT) MIN(slot, m_dbb->dbb_dp_per_pp), ppSequence);
+	}
+
+	bool fetchBatch(thread_db* tdbb);
+	void scanSlice(thread_db* tdbb, Item* item, jrd_rel* relation);
+
+	MemoryPool* m_pool;
+	Database* const m_dbb;
+	const ULONG m_tdbb_flags;
+	jrd_rel* const m_relation;
+	const CommitNumber m_snapshot;
+	const bool m_ignoreLimbo;
+	const bool m_largeScan;
+	Coordinator m_coord;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+
+	volatile bool m_stop;
+	const ULONG m_slicesPerPP;
+	ULONG m_countSlices;
+	ULONG m_nextSlice;
+	ULONG m_batchStart;
+	ULONG m_batchEnd;
+	ObjectsArray<Array<UCHAR> > m_chunks;
+	ULONG m_chunk;
+	FB_SIZE_T m_offset;
+	RecordNumber m_position;
+	bool m_interrupted;
+};
+
+bool FullTableScan::ParallelScan::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+	tdbb->tdbb_flags = m_tdbb_flags;
+
+	if (!item->init(tdbb))
+	{
+		setError(tdbb->tdbb_status_vector);
+		return false;
+	}
+
+	try
+	{
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		jrd_rel* const relation = MET_relation(tdbb, m_relation->rel_id);
+		if (!(relation->rel_flags & REL_scanned))
+			MET_scan_relation(tdbb, relation);
+
+		if (!m_stop)
+			scanSlice(tdbb, item, relation);
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		setError(tdbb->tdbb_status_vector);
+		return false;
+	}
+
+	return true;
+}
+
+void FullTableScan::ParallelScan::scanSlice(thread_db* tdbb, Item* item, jrd_rel* relation)
+{
+	Array<UCHAR>& chunk = m_chunks[item->m_slice - m_batchStart];
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.rpb_record = item->m_record;
+
+	if (m_largeScan)
+	{
+		rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+		rpb.rpb_org_scans = relation->rel_scan_count++;
+	}
+
+	composeSlice(rpb.rpb_number, item->m_slice, 0);
+	rpb.rpb_number.decrement();
+
+	RecordNumber lastNumber;
+	composeSlice(lastNumber, item->m_slice, SLICE_PAGES);
+
+	while (!m_stop && VIO_next_record(tdbb, &rpb, item->m_tra, m_pool, DPM_next_pointer_page))
+	{
+		if (rpb.rpb_number >= lastNumber)
+			break;
+
+		const Record* const record = rpb.rpb_record;
+
+		RecordHeader header;
+		header.number = rpb.rpb_number.getValue();
+		header.transaction = rpb.rpb_transaction_nr;
+		header.page = rpb.rpb_page;
+		header.b_page = rpb.rpb_b_page;
+		header.f_page = rpb.rpb_f_page;
+		header.line = rpb.rpb_line;
+		header.b_line = rpb.rpb_b_line;
+		header.f_line = rpb.rpb_f_line;
+		header.flags = rpb.rpb_flags;
+		header.format = record->getFormat()->fmt_version;
+		header.length = record->getLength();
+
+		chunk.add(reinterpret_cast<const UCHAR*>(&header), sizeof(header));
+		chunk.add(record->getData(), header.length);
+	}
+
+	if (m_largeScan && relation->rel_scan_count)
+		relation->rel_scan_count--;
+
+	item->m_record = rpb.rpb_record;
+}
+
+bool FullTableScan::ParallelScan::getWorkItem(WorkItem** pItem)
+{
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop)
+		return false;
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+	}
+
+	if (!item)
+		return false;
+
+	item->m_inuse = (m_nextSlice < m_batchEnd);
+
+	if (item->m_inuse)
+		item->m_slice = m_nextSlice++;
+
+	return item->m_inuse;
+}
+
+bool FullTableScan::ParallelScan::getResult(IStatus* status)
+{
+	if (status)
+	{
+		status->init();
+		status->setErrors(m_status.getErrors());
+	}
+
+	return m_status.isSuccess();
+}
+
+bool FullTableScan::ParallelScan::fetchBatch(thread_db* tdbb)
+{
+	if (m_nextSlice >= m_countSlices)
+		return false;
+
+	m_batchStart = m_nextSlice;
+	m_batchEnd = MIN(m_batchStart + m_chunks.getCount(), m_countSlices);
+
+	for (auto& chunk : m_chunks)
+		chunk.clear();
+
+	m_chunk = 0;
+	m_offset = 0;
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		FbLocalStatus local_status;
+		fb_utils::init_status(&local_status);
+
+		m_coord.runSync(this);
+
+		if (!getResult(&local_status))
+			local_status.raise();
+	}
+
+	fb_assert(m_nextSlice == m_batchEnd);
+	return true;
+}
+
+bool FullTableScan::ParallelScan::fetch(thread_db* tdbb, record_param* rpb)
+{
+	// Buffered records don't reflect changes made by the transaction since it started
+	// writing. Records are returned in order, so it's safe to drop the rest of them
+	// and let the caller continue from the current record on its own.
+
+	if (m_interrupted || (tdbb->getTransaction()->tra_flags & TRA_write))
+	{
+		m_interrupted = true;
+		return false;
+	}
+
+	while (true)
+	{
+		if (m_chunk < m_batchEnd - m_batchStart)
+		{
+			if (m_offset < m_chunks[m_chunk].getCount())
+				break;
+
+			m_chunk++;
+			m_offset = 0;
+			continue;
+		}
+
+		if (!fetchBatch(tdbb))
+			return false;
+	}
+
+	const UCHAR* const data = m_chunks[m_chunk].begin() + m_offset;
+
+	RecordHeader header;
+	memcpy(&header, data, sizeof(header));
+	m_offset += sizeof(header) + header.length;
+
+	const Format* const format = MET_format(tdbb, m_relation, header.format);
+	Record* const record = VIO_record(tdbb, rpb, format, tdbb->getRequest()->req_pool);
+
+	fb_assert(record->getLength() == header.length);
+	record->copyDataFrom(data + sizeof(header));
+
+	rpb->rpb_number.setValue(header.number);
+	rpb->rpb_transaction_nr = header.transaction;
+	rpb->rpb_format_number = header.format;
+	rpb->rpb_page = header.page;
+	rpb->rpb_line = header.line;
+	rpb->rpb_b_page = header.b_page;
+	rpb->rpb_b_line = header.b_line;
+	rpb->rpb_f_page = header.f_page;
+	rpb->rpb_f_line = header.f_line;
+	rpb->rpb_flags = header.flags;
+
+	m_position = rpb->rpb_number;
+	return true;
+}
+
+
 FullTableScan::FullTableScan(CompilerScratch* csb, const string& alias,
 							 StreamType stream, jrd_rel* relation,
-							 const Array<DbKeyRangeNode*>& dbkeyRanges)
+							 const Array<DbKeyRangeNode*>& dbkeyRanges,
+							 bool parallel)
 	: RecordStream(csb, stream),
 	  m_alias(csb->csb_pool, alias),
 	  m_relation(relation),
-	  m_dbkeyRanges(csb->csb_pool, dbkeyRanges)
+	  m_dbkeyRanges(csb->csb_pool, dbkeyRanges),
+	  m_fieldRanges(csb->csb_pool),
+	  m_parallel(parallel && dbkeyRanges.isEmpty() &&
+		!(csb->csb_rpt[stream].csb_flags & csb_update))
 {
 	m_impure = csb->allocImpure<Impure>();
 	m_cardinality = csb->csb_rpt[stream].csb_cardinality;
@@ -57,6 +535,9 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 
+	delete impure->irsb_parallel;
+	impure->irsb_parallel = NULL;
+
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
 
 	record_param* const rpb = &request->req_rpb[m_stream];
@@ -88,6 +569,18 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	rpb->rpb_number.setValue(BOF_NUMBER);
 
+	delete impure->irsb_ranges;
+	impure->irsb_ranges = NULL;
+
+	if (m_fieldRanges.hasData() && dbb->dbb_range_summaries)
+	{
+		impure->irsb_ranges = dbb->dbb_range_summaries->getCandidates(tdbb, m_relation,
+			request->req_transaction, m_fieldRanges, *tdbb->getDefaultPool());
+	}
+
+	if (m_parallel && !m_recursive && !impure->irsb_ranges)
+		startParallel(tdbb, impure, (rpb->getWindow(tdbb).win_flags & WIN_large_scan));
+
 	if (m_dbkeyRanges.hasData())
 	{
 		impure->irsb_lower.setValid(false);
@@ -123,6 +616,12 @@ void FullTableScan::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
+		delete impure->irsb_parallel;
+		impure->irsb_parallel = NULL;
+
+		delete impure->irsb_ranges;
+		impure->irsb_ranges = NULL;
+
 		record_param* const rpb = &request->req_rpb[m_stream];
 		if ((rpb->getWindow(tdbb).win_flags & WIN_large_scan) &&
 			m_relation->rel_scan_count)
@@ -146,22 +645,117 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
-	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all))
+	if (ParallelScan* const parallel = impure->irsb_parallel)
 	{
+		while (parallel->fetch(tdbb, rpb))
+		{
+			rpb->rpb_number.setValid(true);
+
+			if (checkFilter(tdbb))
+				return true;
+		}
+
+		if (parallel->isComplete())
+		{
+			rpb->rpb_number.setValid(false);
+			return false;
+		}
+
+		// The transaction has started writing, so continue the scan here to see its changes
+
+		rpb->rpb_number = parallel->getPosition();
+
+		delete impure->irsb_parallel;
+		impure->irsb_parallel = NULL;
+	}
+
+	while (true)
+	{
+		if (impure->irsb_ranges && !skipRanges(tdbb, rpb, impure))
+			break;
+
+		if (!VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all))
+			break;
+
 		if (impure->irsb_upper.isValid() && rpb->rpb_number > impure->irsb_upper)
 		{
 			rpb->rpb_number.setValid(false);
 			return false;
 		}
 
+		// The scan could step into the next page range that is to be skipped
+
+		if (impure->irsb_ranges && !impure->irsb_ranges->test(getRangeNumber(tdbb, rpb->rpb_number)))
+			continue;
+
 		rpb->rpb_number.setValid(true);
-		return true;
+
+		if (checkFilter(tdbb))
+			return true;
+
+		JRD_reschedule(tdbb);
 	}
 
 	rpb->rpb_number.setValid(false);
 	return false;
 }
 
+void FullTableScan::startParallel(thread_db* tdbb, Impure* impure, bool largeScan) const
+{
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	jrd_tra* const transaction = request->req_transaction;
+
+	const int workers = attachment->att_parallel_workers;
+
+	if (workers <= 1 || m_relation->isTemporary() ||
+		(transaction->tra_flags & (TRA_system | TRA_write | TRA_degree3)))
+	{
+		return;
+	}
+
+	// Workers must use the same snapshot as the request does
+
+	CommitNumber snapshot = 0;
+
+	if (!(transaction->tra_flags & TRA_read_committed))
+		snapshot = transaction->tra_snapshot_number;
+	else if ((transaction->tra_flags & TRA_read_consistency) && request->req_snapshot.m_owner)
+		snapshot = request->req_snapshot.m_owner->req_snapshot.m_number;
+
+	if (!snapshot || DPM_data_pages(tdbb, m_relation) < MIN_PARALLEL_PAGES)
+		return;
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	impure->irsb_parallel =
+		FB_NEW_POOL(pool) ParallelScan(tdbb, &pool, m_relation, snapshot, workers, largeScan);
+}
+
+bool FullTableScan::skipRanges(thread_db* tdbb, record_param* rpb, Impure* impure) const
+{
+	// Position the stream prior to the next page range whose summaries
+	// do not exclude the matching records
+
+	RecordNumber next = rpb->rpb_number;
+	next.increment();
+
+	const ULONG range = getRangeNumber(tdbb, next);
+	UInt32Bitmap* const ranges = impure->irsb_ranges;
+
+	if (ranges->test(range))
+		return true;
+
+	if (!ranges->locate(locGreat, range))
+		return false;
+
+	const Database* const dbb = tdbb->getDatabase();
+	const SINT64 rangeRecords = (SINT64) dbb->dbb_range_summaries->getRangePages() * dbb->dbb_max_records;
+
+	rpb->rpb_number.setValue(ranges->current() * rangeRecords - 1);
+	return true;
+}
+
 void FullTableScan::getChildren(Array<const RecordSource*>& children) const
 {
 }
@@ -188,6 +782,9 @@ void FullTableScan::print(thread_db* tdbb, string& plan, bool detailed, unsigned
 		else if (upperBounds)
 			bounds += " (upper bound)";
 
+		if (m_fieldRanges.hasData())
+			bounds += " (range summaries)";
+
 		plan += printIndent(++level) + "Table " +
 			printName(tdbb, m_relation->rel_name.c_str(), m_alias) + " Full Scan" + bounds;
 		printOptInfo(plan);
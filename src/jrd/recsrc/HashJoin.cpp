@@ -25,6 +25,7 @@
 #include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
+#include "../jrd/TempSpace.h"
 #include "../jrd/intl.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
@@ -41,179 +42,406 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static const ULONG HASH_SIZE = 1009;
-static const ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per slot
+// Bigger inputs are split into up to this number of partitions,
+// which are stored in the temp space and joined one by one
+static const ULONG MAX_PARTITIONS = 64;
+static const ULONG MIN_TABLE_CAPACITY = 32768;
+static const ULONG MAX_TABLE_CAPACITY = 4 * 1024 * 1024;
+
+// Estimated memory usage per hashed record, including the bucket directory
+static const ULONG HASH_ENTRY_SIZE = 4 * sizeof(ULONG);
+
+// The Bloom filter is dropped if it rejects less than 1/FILTER_MIN_REJECT_RATIO
+// of the checked records, tested on every FILTER_CHECK_PERIOD records
+static const ULONG FILTER_CHECK_PERIOD = 4096;
+static const ULONG FILTER_MIN_REJECT_RATIO = 10;
+
+static const char* const SCRATCH = "fb_hash_";
+
+unsigned HashJoin::tableCapacity()
+{
+	// Lookups don't depend on the table size, so it's limited by memory usage only
+	return MAX_TABLE_CAPACITY;
+}
 
 unsigned HashJoin::maxCapacity()
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	return tableCapacity() * MAX_PARTITIONS;
 }
 
 
-class HashJoin::HashTable : public PermanentStorage
+// Hashed records of both the inner streams and the leading stream, distributed
+// by their hash values. Every partition is written in chunks of entries into
+// the common temp space, so only the pending chunks are kept in memory.
+
+class HashJoin::Partitions : public PermanentStorage
 {
-	class CollisionList
+	static const ULONG CHUNK_ENTRIES = 1024;
+
+public:
+	enum Side { INNER_SIDE = 0, LEADER_SIDE = 1 };
+
+	struct Entry
+	{
+		ULONG stream;
+		ULONG hash;
+		ULONG position;
+	};
+
+private:
+	struct Chunk
 	{
-		static const FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
+		offset_t offset;
+		ULONG count;
+	};
+
+	typedef Array<Entry> EntryList;
+	typedef Array<Chunk> ChunkList;
 
-		struct Entry
+public:
+	Partitions(MemoryPool& pool, ULONG count)
+		: PermanentStorage(pool), m_count(count),
+		  m_space(pool, SCRATCH), m_pending(pool), m_chunks(pool), m_buffer(pool),
+		  m_chunk(0), m_current(NULL), m_position(0)
+	{
+		for (ULONG i = 0; i < 2 * m_count; i++)
 		{
-			Entry()
-				: hash(0), position(0)
-			{}
+			m_pending.add();
+			m_chunks.add();
+		}
+	}
 
-			Entry(ULONG h, ULONG pos)
-				: hash(h), position(pos)
-			{}
+	ULONG getCount() const
+	{
+		return m_count;
+	}
 
-			static const ULONG generate(const Entry& item)
-			{
-				return item.hash;
-			}
+	void put(Side side, ULONG stream, ULONG hash, ULONG position)
+	{
+		const ULONG index = side * m_count + hash % m_count;
+		EntryList& pending = m_pending[index];
 
-			ULONG hash;
-			ULONG position;
-		};
+		const Entry entry = {stream, hash, position};
+		pending.add(entry);
 
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
+		if (pending.getCount() >= CHUNK_ENTRIES)
+			flush(index);
+	}
+
+	void flush()
+	{
+		for (ULONG i = 0; i < 2 * m_count; i++)
+			flush(i);
+	}
+
+	void rewind(Side side, ULONG partition)
+	{
+		fb_assert(partition < m_count);
+		fb_assert(m_pending[side * m_count + partition].isEmpty());
+
+		m_current = &m_chunks[side * m_count + partition];
+		m_chunk = 0;
+		m_buffer.clear();
+		m_position = 0;
+	}
+
+	bool next(Entry& entry)
+	{
+		fb_assert(m_current);
+
+		while (m_position >= m_buffer.getCount())
 		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
+			if (m_chunk >= m_current->getCount())
+				return false;
+
+			const Chunk& chunk = (*m_current)[m_chunk++];
+
+			m_buffer.resize(chunk.count);
+			m_space.read(chunk.offset, m_buffer.begin(), chunk.count * sizeof(Entry));
+			m_position = 0;
 		}
 
-		void sort()
+		entry = m_buffer[m_position++];
+		return true;
+	}
+
+private:
+	void flush(ULONG index)
+	{
+		EntryList& pending = m_pending[index];
+
+		if (pending.isEmpty())
+			return;
+
+		const Chunk chunk = {m_space.getSize(), pending.getCount()};
+		m_space.write(chunk.offset, pending.begin(), chunk.count * sizeof(Entry));
+		m_chunks[index].add(chunk);
+
+		pending.clear();
+	}
+
+	const ULONG m_count;
+	TempSpace m_space;
+	ObjectsArray<EntryList> m_pending;
+	ObjectsArray<ChunkList> m_chunks;
+	EntryList m_buffer;
+	FB_SIZE_T m_chunk;
+	const ChunkList* m_current;
+	FB_SIZE_T m_position;
+};
+
+
+// Bloom filter over the hash values of the inner stream. It's checked
+// by the leading stream scan, so records having no matches are rejected
+// before they're passed through any other filters.
+
+class HashJoin::BloomFilter : public PermanentStorage
+{
+	static const ULONG BITS_PER_ENTRY = 8;
+	static const ULONG HASH_COUNT = 3;
+	static const ULONG MIN_BITS = 10;
+	static const ULONG MAX_BITS = 27;
+
+public:
+	BloomFilter(MemoryPool& pool, ULONG count)
+		: PermanentStorage(pool), m_bits(pool)
+	{
+		ULONG bits = MIN_BITS;
+		while (bits < MAX_BITS && (FB_UINT64(1) << bits) < FB_UINT64(count) * BITS_PER_ENTRY)
+			bits++;
+
+		m_mask = (1U << bits) - 1;
+		m_bits.grow((1U << bits) / 64);
+	}
+
+	void add(ULONG hash)
+	{
+		ULONG h1, h2;
+		mix(hash, h1, h2);
+
+		for (ULONG i = 0; i < HASH_COUNT; i++, h1 += h2)
 		{
-			m_collisions.sort();
+			const ULONG bit = h1 & m_mask;
+			m_bits[bit >> 6] |= FB_UINT64(1) << (bit & 63);
 		}
+	}
+
+	bool check(ULONG hash) const
+	{
+		ULONG h1, h2;
+		mix(hash, h1, h2);
+
+		for (ULONG i = 0; i < HASH_COUNT; i++, h1 += h2)
+		{
+			const ULONG bit = h1 & m_mask;
+
+			if (!(m_bits[bit >> 6] & (FB_UINT64(1) << (bit & 63))))
+				return false;
+		}
+
+		return true;
+	}
+
+private:
+	static void mix(ULONG hash, ULONG& h1, ULONG& h2)
+	{
+		// Bit positions are derived by double hashing,
+		// as the hash function may have weak lower bits
+		h1 = hash * 0x9E3779B1U;
+		h2 = ((hash ^ (hash >> 16)) * 0x85EBCA6BU) | 1;
+	}
+
+	Array<FB_UINT64> m_bits;
+	ULONG m_mask;
+};
+
+
+class HashJoin::HashTable : public PermanentStorage
+{
+	struct Entry
+	{
+		Entry()
+			: hash(0), position(0)
+		{}
+
+		Entry(ULONG h, ULONG pos)
+			: hash(h), position(pos)
+		{}
+
+		ULONG hash;
+		ULONG position;
+	};
+
+	// Entries of the every stream are ordered by buckets, so the entries of
+	// a bucket are stored contiguously together with their full hash values.
+	// The bucket directory keeps the starting offsets of all the buckets.
+	// The number of buckets is a power of two not less than the number of entries,
+	// so the average bucket contains at most one entry.
+
+	class StreamTable
+	{
+		static const ULONG MIN_BITS = 4;
+		static const ULONG MAX_BITS = 31;
+
+	public:
+		explicit StreamTable(MemoryPool& pool)
+			: m_entries(pool), m_directory(pool),
+			  m_shift(32 - MIN_BITS), m_iterator(0), m_end(0)
+		{}
 
 		void add(ULONG hash, ULONG position)
 		{
-			m_collisions.add(Entry(hash, position));
+			m_entries.add(Entry(hash, position));
+		}
+
+		void build(MemoryPool& pool)
+		{
+			const FB_SIZE_T count = m_entries.getCount();
+
+			ULONG bits = MIN_BITS;
+			while (bits < MAX_BITS && (FB_SIZE_T(1) << bits) < count)
+				bits++;
+
+			m_shift = 32 - bits;
+
+			const FB_SIZE_T buckets = FB_SIZE_T(1) << bits;
+
+			m_directory.clear();
+			m_directory.grow(buckets + 1);
+
+			for (const auto& entry : m_entries)
+				m_directory[getBucket(entry.hash) + 1]++;
+
+			for (FB_SIZE_T i = 1; i <= buckets; i++)
+				m_directory[i] += m_directory[i - 1];
+
+			// Distribute the entries, preserving their order inside buckets
+
+			Array<ULONG> offsets(pool);
+			offsets.assign(m_directory);
+
+			Array<Entry> entries(pool);
+			entries.grow(count);
+
+			for (const auto& entry : m_entries)
+				entries[offsets[getBucket(entry.hash)]++] = entry;
+
+			m_entries.assign(entries);
 		}
 
 		bool locate(ULONG hash)
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+			const ULONG bucket = getBucket(hash);
+
+			m_iterator = m_directory[bucket];
+			m_end = m_directory[bucket + 1];
+
+			while (m_iterator < m_end)
+			{
+				if (m_entries[m_iterator].hash == hash)
+					return true;
+
+				m_iterator++;
+			}
 
-			m_iterator = INVALID_ITERATOR;
 			return false;
 		}
 
 		bool iterate(ULONG hash, ULONG& position)
 		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
-
-			const Entry& collision = m_collisions[m_iterator++];
-
-			if (hash != collision.hash)
+			while (m_iterator < m_end)
 			{
-				m_iterator = INVALID_ITERATOR;
-				return false;
+				const Entry& entry = m_entries[m_iterator++];
+
+				if (entry.hash == hash)
+				{
+					position = entry.position;
+					return true;
+				}
 			}
 
-			position = collision.position;
-			return true;
+			return false;
+		}
+
+		void spill(Partitions* partitions, ULONG stream) const
+		{
+			for (const auto& entry : m_entries)
+				partitions->put(Partitions::INNER_SIDE, stream, entry.hash, entry.position);
+		}
+
+		void fill(BloomFilter* filter) const
+		{
+			for (const auto& entry : m_entries)
+				filter->add(entry.hash);
 		}
 
 	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		ULONG getBucket(ULONG hash) const
+		{
+			// Fibonacci hashing, as the hash function may have weak lower bits
+			return (ULONG) ((hash * 0x9E3779B1U) >> m_shift);
+		}
+
+		Array<Entry> m_entries;
+		Array<ULONG> m_directory;
+		ULONG m_shift;
+		ULONG m_iterator;
+		ULONG m_end;
 	};
 
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
-		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
-	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
-	}
-
-	~HashTable()
+	HashTable(MemoryPool& pool, ULONG streamCount)
+		: PermanentStorage(pool), m_tables(pool)
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
-
-		delete[] m_collisions;
+		for (ULONG i = 0; i < streamCount; i++)
+			m_tables.add();
 	}
 
 	void put(ULONG stream, ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
-
-		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
-
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
-
-		if (!collisions)
-		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
-		}
-
-		collisions->add(hash, position);
+		m_tables[stream].add(hash, position);
 	}
 
 	bool setup(ULONG hash)
 	{
-		const ULONG slot = hash % m_tableSize;
-
-		for (ULONG i = 0; i < m_streamCount; i++)
+		for (auto& table : m_tables)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
-
-			if (!collisions)
-				return false;
-
-			if (!collisions->locate(hash))
+			if (!table.locate(hash))
 				return false;
 		}
 
-		m_slot = slot;
 		return true;
 	}
 
 	void reset(ULONG stream, ULONG hash)
 	{
-		fb_assert(stream < m_streamCount);
-
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		m_tables[stream].locate(hash);
 	}
 
 	bool iterate(ULONG stream, ULONG hash, ULONG& position)
 	{
-		fb_assert(stream < m_streamCount);
+		return m_tables[stream].iterate(hash, position);
+	}
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+	void build()
+	{
+		for (auto& table : m_tables)
+			table.build(getPool());
 	}
 
-	void sort()
+	void spill(Partitions* partitions) const
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-		{
-			CollisionList* const collisions = m_collisions[i];
+		for (FB_SIZE_T i = 0; i < m_tables.getCount(); i++)
+			m_tables[i].spill(partitions, i);
+	}
 
-			if (collisions)
-				collisions->sort();
-		}
+	void fill(ULONG stream, BloomFilter* filter) const
+	{
+		m_tables[stream].fill(filter);
 	}
 
 private:
-	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	ObjectsArray<StreamTable> m_tables;
 };
 
 
@@ -240,23 +468,26 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 		dsc desc;
 		(*m_leader.keys)[j]->getDesc(tdbb, csb, &desc);
 
-		USHORT keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
-
-		if (IS_INTL_DATA(&desc))
-			keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
-		else if (desc.isTime())
-			keyLength = sizeof(ISC_TIME);
-		else if (desc.isTimeStamp())
-			keyLength = sizeof(ISC_TIMESTAMP);
-		else if (desc.dsc_dtype == dtype_dec64)
-			keyLength = Decimal64::getKeyLength();
-		else if (desc.dsc_dtype == dtype_dec128)
-			keyLength = Decimal128::getKeyLength();
+		const ULONG keyLength = getKeyLength(tdbb, desc);
 
 		m_leader.keyLengths[j] = keyLength;
 		m_leader.totalKeyLength += keyLength;
 	}
 
+	// The leading stream is buffered only if the inner streams must be partitioned
+
+	m_leaderBuffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_leader.source);
+
+	// If the leading keys depend on a single stream, try to push
+	// a Bloom filter of the inner keys down to the scan of that stream
+
+	SortedStreamList keyStreams;
+	for (const auto key : *m_leader.keys)
+		key->collectStreams(keyStreams);
+
+	m_filtered = (keyStreams.getCount() == 1 &&
+		m_leader.source->setRuntimeFilter(keyStreams[0], this));
+
 	for (FB_SIZE_T i = 1; i < count; i++)
 	{
 		RecordSource* const sub_rsb = args[i];
@@ -276,18 +507,7 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 			dsc desc;
 			(*sub.keys)[j]->getDesc(tdbb, csb, &desc);
 
-			USHORT keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
-
-			if (IS_INTL_DATA(&desc))
-				keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
-			else if (desc.isTime())
-				keyLength = sizeof(ISC_TIME);
-			else if (desc.isTimeStamp())
-				keyLength = sizeof(ISC_TIMESTAMP);
-			else if (desc.dsc_dtype == dtype_dec64)
-				keyLength = Decimal64::getKeyLength();
-			else if (desc.dsc_dtype == dtype_dec128)
-				keyLength = Decimal128::getKeyLength();
+			const ULONG keyLength = getKeyLength(tdbb, desc);
 
 			sub.keyLengths[j] = keyLength;
 			sub.totalKeyLength += keyLength;
@@ -315,6 +535,11 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 
 	delete impure->irsb_hash_table;
 	delete[] impure->irsb_leader_buffer;
+	delete impure->irsb_partitions;
+	impure->irsb_partitions = NULL;
+	delete impure->irsb_grant;
+	delete impure->irsb_bloom;
+	impure->irsb_bloom = NULL;
 
 	MemoryPool& pool = *tdbb->getDefaultPool();
 
@@ -323,7 +548,24 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
 	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
 
+	// The hash table gets its memory from the temp cache budget. It's granted
+	// step by step while the inner streams are read, so the table holds only
+	// as much of the budget as its actual rows need. If the inner streams
+	// don't fit, they're partitioned by their hash values into the temp space
+	// and then joined with the leading stream partition by partition.
+
+	impure->irsb_grant = FB_NEW_POOL(pool) TempMemoryGrant(tdbb->getDatabase());
+
+	const FB_SIZE_T minSize = (FB_SIZE_T) MIN_TABLE_CAPACITY * HASH_ENTRY_SIZE;
+	ULONG capacity = impure->irsb_grant->grant(minSize, minSize) / HASH_ENTRY_SIZE;
+
+	double cardinality = 0;
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+		cardinality += m_args[i].source->getCardinality();
+
 	UCharBuffer buffer(pool);
+	HalfStaticArray<ULONG, OPT_STATIC_ITEMS> counts(pool);
+	ULONG total = 0;
 
 	for (FB_SIZE_T i = 0; i < argCount; i++)
 	{
@@ -338,13 +580,72 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 		while (m_args[i].buffer->getRecord(tdbb))
 		{
 			const ULONG hash = computeHash(tdbb, request, m_args[i], keyBuffer);
+
+			if (impure->irsb_partitions)
+			{
+				impure->irsb_partitions->put(Partitions::INNER_SIDE, i, hash, counter++);
+				continue;
+			}
+
 			impure->irsb_hash_table->put(i, hash, counter++);
+
+			if (++total > capacity && capacity < tableCapacity())
+			{
+				// Double the table if the budget allows
+
+				const ULONG wanted = MIN(capacity, tableCapacity() - capacity);
+				capacity += impure->irsb_grant->grant(0, (FB_SIZE_T) wanted * HASH_ENTRY_SIZE) /
+					HASH_ENTRY_SIZE;
+			}
+
+			if (total > capacity)
+			{
+				const double estimated = MAX(cardinality, 2.0 * total);
+				const ULONG count = (ULONG) MIN(estimated / capacity + 1, MAX_PARTITIONS);
+
+				impure->irsb_partitions = FB_NEW_POOL(pool) Partitions(pool, count);
+				impure->irsb_hash_table->spill(impure->irsb_partitions);
+
+				delete impure->irsb_hash_table;
+				impure->irsb_hash_table = NULL;
+			}
 		}
+
+		counts.add(counter);
+	}
+
+	if (impure->irsb_partitions)
+		impure->irsb_partitions->flush();
+
+	if (m_filtered)
+		buildFilter(tdbb, impure, counts.begin());
+
+	if (!impure->irsb_partitions)
+	{
+		impure->irsb_hash_table->build();
+
+		m_leader.source->open(tdbb);
+		return;
+	}
+
+	// Cache the leading stream and distribute its records among the partitions
+
+	Partitions* const partitions = impure->irsb_partitions;
+
+	m_leaderBuffer->open(tdbb);
+
+	ULONG counter = 0;
+
+	while (m_leaderBuffer->getRecord(tdbb))
+	{
+		const ULONG hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+		partitions->put(Partitions::LEADER_SIDE, 0, hash, counter++);
 	}
 
-	impure->irsb_hash_table->sort();
+	partitions->flush();
 
-	m_leader.source->open(tdbb);
+	impure->irsb_partition = 0;
+	loadPartition(tdbb, impure);
 }
 
 void HashJoin::close(thread_db* tdbb) const
@@ -364,9 +665,19 @@ void HashJoin::close(thread_db* tdbb) const
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = NULL;
 
+		delete impure->irsb_partitions;
+		impure->irsb_partitions = NULL;
+
+		delete impure->irsb_grant;
+		impure->irsb_grant = NULL;
+
+		delete impure->irsb_bloom;
+		impure->irsb_bloom = NULL;
+
 		for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
 			m_args[i].buffer->close(tdbb);
 
+		m_leaderBuffer->close(tdbb);
 		m_leader.source->close(tdbb);
 	}
 }
@@ -387,13 +698,21 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 		{
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
-				return false;
+			if (impure->irsb_partitions)
+			{
+				if (!fetchLeader(tdbb, impure))
+					return false;
+			}
+			else
+			{
+				if (!m_leader.source->getRecord(tdbb))
+					return false;
 
-			// Compute and hash the comparison keys
+				// Compute and hash the comparison keys
 
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			}
 
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
@@ -522,6 +841,88 @@ void HashJoin::nullRecords(thread_db* tdbb) const
 		m_args[i].source->nullRecords(tdbb);
 }
 
+ULONG HashJoin::getKeyLength(thread_db* tdbb, const dsc& desc)
+{
+	if (IS_INTL_DATA(&desc))
+		return INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), desc.getStringLength());
+
+	if (desc.isText())
+		return desc.getStringLength();
+
+	if (desc.isTime())
+		return sizeof(ISC_TIME);
+
+	if (desc.isTimeStamp())
+		return sizeof(ISC_TIMESTAMP);
+
+	if (desc.dsc_dtype == dtype_dec64)
+		return Decimal64::getKeyLength();
+
+	if (desc.dsc_dtype == dtype_dec128)
+		return Decimal128::getKeyLength();
+
+	return desc.dsc_length;
+}
+
+// Put the binary comparable form of the value into the key buffer
+
+void HashJoin::makeKey(thread_db* tdbb, dsc* desc, ULONG keyLength, UCHAR* keyPtr)
+{
+	if (desc->isText())
+	{
+		dsc to;
+		to.makeText(keyLength, desc->getTextType(), keyPtr);
+
+		if (IS_INTL_DATA(desc))
+		{
+			// Convert the INTL string into the binary comparable form
+			INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
+							   desc, &to, INTL_KEY_UNIQUE);
+		}
+		else
+		{
+			// This call ensures that the padding bytes are appended
+			MOV_move(tdbb, desc, &to);
+		}
+	}
+	else
+	{
+		const auto data = desc->dsc_address;
+
+		if (desc->isDecFloat())
+		{
+			// Values inside our key buffer are not aligned,
+			// so ensure we satisfy our platform's alignment rules
+			OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(keyPtr, keyLength);
+
+			if (desc->dsc_dtype == dtype_dec64)
+				((Decimal64*) data)->makeKey(key);
+			else if (desc->dsc_dtype == dtype_dec128)
+				((Decimal128*) data)->makeKey(key);
+			else
+				fb_assert(false);
+		}
+		else if (desc->dsc_dtype == dtype_real && *(float*) data == 0)
+		{
+			fb_assert(keyLength == sizeof(float));
+			memset(keyPtr, 0, keyLength); // positive zero in binary
+		}
+		else if (desc->dsc_dtype == dtype_double && *(double*) data == 0)
+		{
+			fb_assert(keyLength == sizeof(double));
+			memset(keyPtr, 0, keyLength); // positive zero in binary
+		}
+		else
+		{
+			// We don't enforce proper alignments inside the key buffer,
+			// so use plain byte copying instead of MOV_move() to avoid bus errors.
+			// Note: for date/time with time zone, we copy only the UTC part.
+			fb_assert(keyLength <= desc->dsc_length);
+			memcpy(keyPtr, data, keyLength);
+		}
+	}
+}
+
 ULONG HashJoin::computeHash(thread_db* tdbb,
 							Request* request,
 						    const SubStream& sub,
@@ -534,64 +935,10 @@ ULONG HashJoin::computeHash(thread_db* tdbb,
 	for (FB_SIZE_T i = 0; i < sub.keys->getCount(); i++)
 	{
 		dsc* const desc = EVL_expr(tdbb, request, (*sub.keys)[i]);
-		const USHORT keyLength = sub.keyLengths[i];
+		const ULONG keyLength = sub.keyLengths[i];
 
 		if (desc && !(request->req_flags & req_null))
-		{
-			if (desc->isText())
-			{
-				dsc to;
-				to.makeText(keyLength, desc->getTextType(), keyPtr);
-
-				if (IS_INTL_DATA(desc))
-				{
-					// Convert the INTL string into the binary comparable form
-					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(desc),
-									   desc, &to, INTL_KEY_UNIQUE);
-				}
-				else
-				{
-					// This call ensures that the padding bytes are appended
-					MOV_move(tdbb, desc, &to);
-				}
-			}
-			else
-			{
-				const auto data = desc->dsc_address;
-
-				if (desc->isDecFloat())
-				{
-					// Values inside our key buffer are not aligned,
-					// so ensure we satisfy our platform's alignment rules
-					OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(keyPtr, keyLength);
-
-					if (desc->dsc_dtype == dtype_dec64)
-						((Decimal64*) data)->makeKey(key);
-					else if (desc->dsc_dtype == dtype_dec128)
-						((Decimal128*) data)->makeKey(key);
-					else
-						fb_assert(false);
-				}
-				else if (desc->dsc_dtype == dtype_real && *(float*) data == 0)
-				{
-					fb_assert(keyLength == sizeof(float));
-					memset(keyPtr, 0, keyLength); // positive zero in binary
-				}
-				else if (desc->dsc_dtype == dtype_double && *(double*) data == 0)
-				{
-					fb_assert(keyLength == sizeof(double));
-					memset(keyPtr, 0, keyLength); // positive zero in binary
-				}
-				else
-				{
-					// We don't enforce proper alignments inside the key buffer,
-					// so use plain byte copying instead of MOV_move() to avoid bus errors.
-					// Note: for date/time with time zone, we copy only the UTC part.
-					fb_assert(keyLength <= desc->dsc_length);
-					memcpy(keyPtr, data, keyLength);
-				}
-			}
-		}
+			makeKey(tdbb, desc, keyLength, keyPtr);
 
 		keyPtr += keyLength;
 	}
@@ -632,3 +979,112 @@ bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) co
 		}
 	}
 }
+
+bool HashJoin::fetchLeader(thread_db* tdbb, Impure* impure) const
+{
+	Partitions* const partitions = impure->irsb_partitions;
+
+	Partitions::Entry entry;
+	while (!partitions->next(entry))
+	{
+		if (++impure->irsb_partition >= partitions->getCount())
+			return false;
+
+		loadPartition(tdbb, impure);
+	}
+
+	m_leaderBuffer->locate(tdbb, entry.position);
+
+	if (!m_leaderBuffer->getRecord(tdbb))
+		return false;
+
+	impure->irsb_leader_hash = entry.hash;
+	return true;
+}
+
+void HashJoin::loadPartition(thread_db* tdbb, Impure* impure) const
+{
+	Partitions* const partitions = impure->irsb_partitions;
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, m_args.getCount());
+
+	Partitions::Entry entry;
+	partitions->rewind(Partitions::INNER_SIDE, impure->irsb_partition);
+
+	while (partitions->next(entry))
+		impure->irsb_hash_table->put(entry.stream, entry.hash, entry.position);
+
+	impure->irsb_hash_table->build();
+
+	partitions->rewind(Partitions::LEADER_SIDE, impure->irsb_partition);
+}
+
+void HashJoin::buildFilter(thread_db* tdbb, Impure* impure, const ULONG* counts) const
+{
+	// Build the filter over the smallest inner stream, as it's the most selective one
+
+	ULONG stream = 0;
+	for (FB_SIZE_T i = 1; i < m_args.getCount(); i++)
+	{
+		if (counts[i] < counts[stream])
+			stream = i;
+	}
+
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	BloomFilter* const filter = FB_NEW_POOL(pool) BloomFilter(pool, counts[stream]);
+
+	if (Partitions* const partitions = impure->irsb_partitions)
+	{
+		Partitions::Entry entry;
+
+		for (ULONG i = 0; i < partitions->getCount(); i++)
+		{
+			partitions->rewind(Partitions::INNER_SIDE, i);
+
+			while (partitions->next(entry))
+			{
+				if (entry.stream == stream)
+					filter->add(entry.hash);
+			}
+		}
+	}
+	else
+		impure->irsb_hash_table->fill(stream, filter);
+
+	impure->irsb_bloom = filter;
+	impure->irsb_bloom_checked = 0;
+	impure->irsb_bloom_rejected = 0;
+}
+
+bool HashJoin::checkRecord(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	const BloomFilter* const filter = impure->irsb_bloom;
+
+	if (!filter)
+		return true;
+
+	const ULONG hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+
+	if (filter->check(hash))
+	{
+		// Don't waste time if the filter appears to be useless
+
+		if (++impure->irsb_bloom_checked % FILTER_CHECK_PERIOD == 0 &&
+			impure->irsb_bloom_rejected < impure->irsb_bloom_checked / FILTER_MIN_REJECT_RATIO)
+		{
+			delete impure->irsb_bloom;
+			impure->irsb_bloom = NULL;
+		}
+
+		return true;
+	}
+
+	impure->irsb_bloom_checked++;
+	impure->irsb_bloom_rejected++;
+	return false;
+}
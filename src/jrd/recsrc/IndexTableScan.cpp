@@ -25,6 +25,7 @@
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/met_proto.h"
 #include "../jrd/vio_proto.h"
@@ -73,6 +74,9 @@ void IndexTableScan::internalOpen(thread_db* tdbb) const
 
 	rpb->rpb_number.setValue(BOF_NUMBER);
 
+	impure->irsb_nav_prefetch_page = 0;
+	impure->irsb_nav_prefetch_offset = 0;
+
 	fb_assert(!impure->irsb_nav_lower);
 	impure->irsb_nav_current_lower = impure->irsb_nav_lower = FB_NEW_POOL(*tdbb->getDefaultPool()) temporary_key;
 
@@ -186,6 +190,10 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 	const IndexRetrieval* const retrieval = m_index->retrieval;
 	const USHORT flags = retrieval->irb_generic & (irb_descending | irb_partial | irb_starting);
 
+	// Data pages of the records ahead are read in advance if read-ahead is enabled
+	const bool prefetch = tdbb->getDatabase()->dbb_prefetch_pages != 0;
+	PrefetchNumbers prefetchNumbers;
+
 	do
 	{
 		UCHAR* nextPointer = getPosition(tdbb, impure, &window);
@@ -261,8 +269,20 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 			rpb->rpb_number = number;
 			setPosition(tdbb, impure, rpb, &window, pointer, key);
 
+			if (prefetch)
+			{
+				prefetchRecords(tdbb, impure, &window, pointer, key,
+					retrieval->irb_upper_count ? &upper : NULL, flags, prefetchNumbers);
+			}
+
 			CCH_RELEASE(tdbb, &window);
 
+			if (prefetchNumbers.hasData())
+			{
+				DPM_prefetch_records(tdbb, m_relation, prefetchNumbers.begin(), prefetchNumbers.getCount());
+				prefetchNumbers.clear();
+			}
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				if (const auto result = recordKey.compose(rpb->rpb_record))
@@ -278,7 +298,9 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 							rpb->rpb_number.getValue());
 
 					rpb->rpb_number.setValid(true);
-					return true;
+
+					if (checkFilter(tdbb))
+						return true;
 				}
 			}
 
@@ -620,6 +642,82 @@ UCHAR* IndexTableScan::openStream(thread_db* tdbb, Impure* impure, win* window)
 	return page->btr_nodes + page->btr_jump_size;
 }
 
+void IndexTableScan::prefetchRecords(thread_db* tdbb, Impure* impure, win* window, UCHAR* pointer,
+									 const temporary_key& key, const temporary_key* upper, USHORT flags,
+									 PrefetchNumbers& numbers) const
+{
+	// Collect numbers of the records following the current index node up to the end
+	// of the leaf page, so that their data pages could be read ahead while the records
+	// are returned in the index order. The next batch is collected when half of the
+	// previous one is consumed.
+
+	const ULONG pageNumber = window->win_page.getPageNum();
+
+	if (impure->irsb_nav_prefetch_page == pageNumber &&
+		impure->irsb_nav_offset < impure->irsb_nav_prefetch_offset)
+	{
+		return;
+	}
+
+	const Database* const dbb = tdbb->getDatabase();
+	const index_desc* const idx = (index_desc*) ((SCHAR*) impure + m_offset);
+	UCHAR* const buffer = (UCHAR*) window->win_buffer;
+
+	temporary_key ahead;
+	memcpy(ahead.key_data, key.key_data, key.key_length);
+
+	IndexNode node;
+	pointer = node.readNode(pointer, true);
+
+	USHORT nextOffset = 0;
+	FB_SIZE_T pageCount = 0;
+	ULONG lastSequence = MAX_ULONG;
+
+	while (true)
+	{
+		UCHAR* const nodePointer = pointer;
+		pointer = node.readNode(pointer, true);
+
+		if (node.isEndLevel || node.isEndBucket)
+			break;
+
+		memcpy(ahead.key_data + node.prefix, node.data, node.length);
+		ahead.key_length = node.length + node.prefix;
+
+		if (upper && compareKeys(idx, ahead.key_data, ahead.key_length, upper, flags) > 0)
+			break;
+
+		const RecordNumber number = node.recordNumber;
+
+		if ((!(impure->irsb_flags & irsb_mustread) &&
+			(!impure->irsb_nav_bitmap ||
+				!RecordBitmap::test(*impure->irsb_nav_bitmap, number.getValue()))) ||
+			RecordBitmap::test(impure->irsb_nav_records_visited, number.getValue()))
+		{
+			continue;
+		}
+
+		const ULONG sequence = number.getValue() / dbb->dbb_max_records;
+
+		if (sequence != lastSequence)
+		{
+			if (pageCount == dbb->dbb_prefetch_sequence)
+				nextOffset = nodePointer - buffer;
+
+			if (pageCount == dbb->dbb_prefetch_pages)
+				break;
+
+			pageCount++;
+			lastSequence = sequence;
+		}
+
+		numbers.add(number);
+	}
+
+	impure->irsb_nav_prefetch_page = pageNumber;
+	impure->irsb_nav_prefetch_offset = nextOffset ? nextOffset : MAX_USHORT;
+}
+
 void IndexTableScan::setPage(thread_db* tdbb, Impure* impure, win* window) const
 {
 	const ULONG newPage = window ? window->win_page.getPageNum() : 0;
@@ -194,8 +194,10 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 				const bool equality = (retrieval->irb_generic & irb_equality);
 				const bool partial = (retrieval->irb_generic & irb_partial);
 
+				const bool skip = (retrieval->irb_generic & irb_skip_scan);
+
 				const bool fullscan = (maxSegs == 0);
-				const bool unique = uniqueIdx && equality && (minSegs == segCount);
+				const bool unique = uniqueIdx && equality && (minSegs == segCount) && !skip;
 
 				string bounds;
 				if (!unique && !fullscan)
@@ -229,7 +231,7 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 				}
 
 				plan += "Index " + printName(tdbb, indexName.c_str()) +
-					(fullscan ? " Full" : unique ? " Unique" : " Range") + " Scan" + bounds;
+					(fullscan ? " Full" : unique ? " Unique" : skip ? " Skip" : " Range") + " Scan" + bounds;
 			}
 			else
 			{
@@ -40,8 +40,11 @@ namespace Jrd
 	class jrd_prc;
 	class AggNode;
 	class BoolExprNode;
+	class FieldNode;
+	class LiteralNode;
 	class DeclareLocalTableNode;
 	class Sort;
+	class PartitionedSort;
 	class CompilerScratch;
 	class BtrPageGCLock;
 	struct index_desc;
@@ -53,6 +56,15 @@ namespace Jrd
 
 	enum JoinType { INNER_JOIN, OUTER_JOIN, SEMI_JOIN, ANTI_JOIN };
 
+	// Filter pushed by a parent record source (e.g. hash join) down to a table scan,
+	// to reject the current record of the scanned stream as early as possible
+
+	class RuntimeFilter
+	{
+	public:
+		virtual bool checkRecord(thread_db* tdbb) const = 0;
+	};
+
 	// Abstract base class
 
 	class RecordSource
@@ -79,6 +91,12 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Returns true if the filter is accepted by the scan of the given stream
+		virtual bool setRuntimeFilter(StreamType /*stream*/, const RuntimeFilter* /*filter*/)
+		{
+			return false;
+		}
+
 		virtual ~RecordSource();
 
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
@@ -161,8 +179,23 @@ namespace Jrd
 		void nullRecords(thread_db* tdbb) const override;
 
 	protected:
+		bool acceptFilter(StreamType stream, const RuntimeFilter* filter)
+		{
+			if (stream != m_stream || m_filter)
+				return false;
+
+			m_filter = filter;
+			return true;
+		}
+
+		bool checkFilter(thread_db* tdbb) const
+		{
+			return !m_filter || m_filter->checkRecord(tdbb);
+		}
+
 		const StreamType m_stream;
 		const Format* const m_format;
+		const RuntimeFilter* m_filter = nullptr;
 	};
 
 
@@ -170,19 +203,34 @@ namespace Jrd
 
 	class FullTableScan final : public RecordStream
 	{
+		class ParallelScan;
+
 		struct Impure : public RecordSource::Impure
 		{
 			RecordNumber irsb_lower;
 			RecordNumber irsb_upper;
+			ParallelScan* irsb_parallel;
+			UInt32Bitmap* irsb_ranges;		// page ranges to be scanned
 		};
 
 	public:
 		FullTableScan(CompilerScratch* csb, const Firebird::string& alias,
 					  StreamType stream, jrd_rel* relation,
-					  const Firebird::Array<DbKeyRangeNode*>& dbkeyRanges);
+					  const Firebird::Array<DbKeyRangeNode*>& dbkeyRanges,
+					  bool parallel = false);
 
 		void close(thread_db* tdbb) const override;
 
+		bool setRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return acceptFilter(stream, filter);
+		}
+
+		void setFieldRanges(const Firebird::Array<FieldRangeNode*>& fieldRanges)
+		{
+			m_fieldRanges.assign(fieldRanges);
+		}
+
 		void getChildren(Firebird::Array<const RecordSource*>& children) const override;
 
 		void print(thread_db* tdbb, Firebird::string& plan,
@@ -193,9 +241,14 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
+		void startParallel(thread_db* tdbb, Impure* impure, bool largeScan) const;
+		bool skipRanges(thread_db* tdbb, record_param* rpb, Impure* impure) const;
+
 		const Firebird::string m_alias;
 		jrd_rel* const m_relation;
 		Firebird::Array<DbKeyRangeNode*> m_dbkeyRanges;
+		Firebird::Array<FieldRangeNode*> m_fieldRanges;
+		const bool m_parallel;
 	};
 
 	class BitmapTableScan final : public RecordStream
@@ -212,6 +265,11 @@ namespace Jrd
 
 		void close(thread_db* tdbb) const override;
 
+		bool setRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return acceptFilter(stream, filter);
+		}
+
 		void getChildren(Firebird::Array<const RecordSource*>& children) const override;
 
 		void print(thread_db* tdbb, Firebird::string& plan,
@@ -241,12 +299,16 @@ namespace Jrd
 			temporary_key* irsb_nav_upper;				// upper (possible multiple) key
 			temporary_key* irsb_nav_current_lower;		// current lower key
 			temporary_key* irsb_nav_current_upper;		// current upper key
+			ULONG irsb_nav_prefetch_page;				// index page of the last data pages prefetch
 			USHORT irsb_nav_offset;						// page offset of current index node
+			USHORT irsb_nav_prefetch_offset;			// page offset to issue the next prefetch at
 			USHORT irsb_nav_upper_length;				// length of upper key value
 			USHORT irsb_nav_length;						// length of expanded key
 			UCHAR irsb_nav_data[1];						// expanded key, upper bound, and index desc
 		};
 
+		typedef Firebird::HalfStaticArray<RecordNumber, 64> PrefetchNumbers;
+
 	public:
 		IndexTableScan(CompilerScratch* csb, const Firebird::string& alias,
 					   StreamType stream, jrd_rel* relation,
@@ -255,6 +317,11 @@ namespace Jrd
 
 		void close(thread_db* tdbb) const override;
 
+		bool setRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return acceptFilter(stream, filter);
+		}
+
 		void getChildren(Firebird::Array<const RecordSource*>& children) const override;
 
 		void print(thread_db* tdbb, Firebird::string& plan,
@@ -278,6 +345,9 @@ namespace Jrd
 		UCHAR* getPosition(thread_db* tdbb, Impure* impure, win* window) const;
 		UCHAR* getStreamPosition(thread_db* tdbb, Impure* impure, win* window) const;
 		UCHAR* openStream(thread_db* tdbb, Impure* impure, win* window) const;
+		void prefetchRecords(thread_db* tdbb, Impure* impure, win* window, UCHAR* pointer,
+							 const temporary_key& key, const temporary_key* upper, USHORT flags,
+							 PrefetchNumbers& numbers) const;
 		void setPage(thread_db* tdbb, Impure* impure, win* window) const;
 		void setPosition(thread_db* tdbb, Impure* impure, record_param*,
 						 win* window, const UCHAR*, const temporary_key&) const;
@@ -566,6 +636,11 @@ namespace Jrd
 			m_ansiNot = ansiNot;
 		}
 
+		bool setRuntimeFilter(StreamType stream, const RuntimeFilter* filter) override
+		{
+			return !m_anyBoolean && m_next->setRuntimeFilter(stream, filter);
+		}
+
 	protected:
 		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
@@ -573,7 +648,20 @@ namespace Jrd
 		bool m_invariant = false;
 
 	private:
+		// Comparison of an integer field with a constant, checked directly in the record
+		struct QuickCheck
+		{
+			StreamType stream;
+			USHORT id;
+			UCHAR blrOp;
+			SSHORT scale;
+			SINT64 value;
+		};
+
 		bool evaluateBoolean(thread_db* tdbb) const;
+		void collectQuickChecks(const BoolExprNode* boolean);
+		void addQuickCheck(const FieldNode* field, const LiteralNode* literal, UCHAR blrOp);
+		bool quickReject(const Request* request) const;
 
 		NestConst<RecordSource> m_next;
 		NestConst<BoolExprNode> const m_boolean;
@@ -581,6 +669,7 @@ namespace Jrd
 		bool m_ansiAny;
 		bool m_ansiAll;
 		bool m_ansiNot;
+		Firebird::Array<QuickCheck> m_quickChecks;
 	};
 
 	class PreFilteredStream : public FilteredStream
@@ -599,6 +688,7 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			Sort* irsb_sort;
+			PartitionedSort* irsb_merge;	// merge of sort partitions, if any
 		};
 
 	public:
@@ -694,6 +784,13 @@ namespace Jrd
 
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
+		// Only the first (skip + first) records will be fetched
+		void setFirstRows(ValueExprNode* first, ValueExprNode* skip)
+		{
+			m_firstRows = first;
+			m_skipRows = skip;
+		}
+
 		UCHAR* getData(thread_db* tdbb) const;
 		void mapData(thread_db* tdbb, Request* request, UCHAR* data) const;
 
@@ -715,10 +812,13 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
-		Sort* init(thread_db* tdbb) const;
+		void init(thread_db* tdbb, Impure* impure) const;
+		void putRecord(thread_db* tdbb, Sort* sort) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		NestConst<ValueExprNode> m_firstRows;
+		NestConst<ValueExprNode> m_skipRows;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -887,17 +987,45 @@ namespace Jrd
 
 	class AggregatedStream final : public BaseAggWinStream<AggregatedStream, RecordSource>
 	{
+		class HashGroups;
+
 	public:
+		struct Impure : public BaseAggWinStream<AggregatedStream, RecordSource>::Impure
+		{
+			HashGroups* irsb_groups;
+			ULONG irsb_partition;
+			ULONG irsb_position;
+		};
+
 		AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
-			const NestValueArray* group, MapNode* map, RecordSource* next);
+			const NestValueArray* group, MapNode* map, RecordSource* next, bool hashed = false);
+
+		static bool isHashable(thread_db* tdbb, CompilerScratch* csb,
+			const NestValueArray* group, const MapNode* map);
 
 	public:
+		void close(thread_db* tdbb) const override;
+
 		void getChildren(Firebird::Array<const RecordSource*>& children) const override;
 		void print(thread_db* tdbb, Firebird::string& plan, bool detailed, unsigned level, bool recurse) const override;
 
 	protected:
+		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
 
+	private:
+		ULONG makeGroupKey(thread_db* tdbb, Request* request, UCHAR* key) const;
+		void aggregateGroups(thread_db* tdbb, Request* request, Impure* impure) const;
+		void mergeGroups(thread_db* tdbb, Request* request, Impure* impure) const;
+		void resetStrings(Request* request) const;
+		void saveStates(Request* request, UCHAR* states) const;
+		void restoreStates(Request* request, const UCHAR* states) const;
+
+		const bool m_hashed;
+		Firebird::Array<dsc> m_keyDescs;
+		Firebird::Array<ULONG> m_keyLengths;
+		ULONG m_keyLength;
+		Firebird::Array<const AggNode*> m_aggNodes;
 	};
 
 	class WindowedStream : public RecordSource
@@ -984,6 +1112,9 @@ namespace Jrd
 			SINT64 locateFrameRange(thread_db* tdbb, Request* request, Impure* impure,
 				const Frame* frame, const dsc* offsetDesc, SINT64 position) const;
 
+			bool aggRevert(thread_db* tdbb, Request* request,
+				SINT64 startPosition, SINT64 endPosition) const;
+
 		private:
 			NestConst<SortNode> m_order;
 			const MapNode* m_windowMap;
@@ -993,6 +1124,7 @@ namespace Jrd
 			NestValueArray m_winPassSources, m_winPassTargets;
 			Exclusion m_exclusion;
 			UCHAR m_invariantOffsets;	// 0x1 | 0x2 bitmask
+			bool m_removable;			// all aggregates support aggRevert
 		};
 
 	public:
@@ -1169,9 +1301,11 @@ namespace Jrd
 		NestConst<RecordSource> m_arg2;
 	};
 
-	class HashJoin : public RecordSource
+	class HashJoin : public RecordSource, public RuntimeFilter
 	{
 		class HashTable;
+		class Partitions;
+		class BloomFilter;
 
 		struct SubStream
 		{
@@ -1191,6 +1325,12 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			Partitions* irsb_partitions;
+			ULONG irsb_partition;
+			TempMemoryGrant* irsb_grant;
+			BloomFilter* irsb_bloom;
+			ULONG irsb_bloom_checked;
+			ULONG irsb_bloom_rejected;
 		};
 
 	public:
@@ -1214,7 +1354,13 @@ namespace Jrd
 		void findUsedStreams(StreamList& streams, bool expandAll = false) const override;
 		void nullRecords(thread_db* tdbb) const override;
 
+		bool checkRecord(thread_db* tdbb) const override;
+
 		static unsigned maxCapacity();
+		static unsigned tableCapacity();
+
+		static ULONG getKeyLength(thread_db* tdbb, const dsc& desc);
+		static void makeKey(thread_db* tdbb, dsc* desc, ULONG keyLength, UCHAR* keyPtr);
 
 	protected:
 		void internalOpen(thread_db* tdbb) const override;
@@ -1224,8 +1370,13 @@ namespace Jrd
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		bool fetchLeader(thread_db* tdbb, Impure* impure) const;
+		void loadPartition(thread_db* tdbb, Impure* impure) const;
+		void buildFilter(thread_db* tdbb, Impure* impure, const ULONG* counts) const;
 
 		SubStream m_leader;
+		BufferedStream* m_leaderBuffer;
+		bool m_filtered;
 		Firebird::Array<SubStream> m_args;
 	};
 
@@ -1320,15 +1471,19 @@ namespace Jrd
 
 	class Union final : public RecordStream
 	{
+		class Distinct;
+
 		struct Impure : public RecordSource::Impure
 		{
 			USHORT irsb_count;
+			Distinct* irsb_distinct;
+			ULONG irsb_partition;
 		};
 
 	public:
 		Union(CompilerScratch* csb, StreamType stream,
 			  FB_SIZE_T argCount, RecordSource* const* args, NestConst<MapNode>* maps,
-			  const StreamList& streams);
+			  const StreamList& streams, const SortNode* distinct = NULL);
 
 		void close(thread_db* tdbb) const override;
 
@@ -1349,9 +1504,17 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
+		bool fetchRecord(thread_db* tdbb, Impure* impure) const;
+		bool fetchDistinct(thread_db* tdbb, Impure* impure) const;
+		ULONG makeKey(thread_db* tdbb, const Record* record, UCHAR* key) const;
+
 		Firebird::Array<NestConst<RecordSource> > m_args;
 		Firebird::Array<NestConst<MapNode> > m_maps;
 		StreamList m_streams;
+		const bool m_distinct;
+		Firebird::Array<USHORT> m_keyIds;
+		Firebird::Array<ULONG> m_keyLengths;
+		ULONG m_keyLength;
 	};
 
 	class RecursiveStream final : public RecordStream
@@ -33,12 +33,195 @@
 #include "../jrd/mov_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/optimizer/Optimizer.h"
+#include "../jrd/sort.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
 
 #include "RecordSource.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Minimal estimated number of records per sort partition worth a separate worker
+	const double MIN_PARTITION_RECORDS = 10000;
+
+	// Performs the final sort pass of the sort partitions using parallel workers
+
+	class SortTask : public Task
+	{
+	public:
+		SortTask(thread_db* tdbb, MemoryPool* pool, const HalfStaticArray<Sort*, 8>& sorts) : Task(),
+			m_pool(pool),
+			m_dbb(tdbb->getDatabase()),
+			m_tdbb_flags(tdbb->tdbb_flags),
+			m_items(*m_pool),
+			m_stop(false)
+		{
+			for (Sort* const sort : sorts)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this, sort));
+
+			m_items[0]->m_ownAttach = false;
+			m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		}
+
+		virtual ~SortTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		bool handler(WorkItem& _item);
+		bool getWorkItem(WorkItem** pItem);
+		bool getResult(IStatus* status);
+
+		int getMaxWorkers()
+		{
+			return m_items.getCount();
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(SortTask* task, Sort* sort) : Task::WorkItem(task),
+				m_inuse(false),
+				m_ownAttach(true),
+				m_sort(sort)
+			{}
+
+			virtual ~Item()
+			{
+				if (!m_ownAttach || !m_attStable)
+					return;
+
+				FbLocalStatus status;
+				WorkerAttachment::releaseAttachment(&status, m_attStable);
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* status = tdbb->tdbb_status_vector;
+				Attachment* att = NULL;
+
+				if (m_ownAttach && !m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					Arg::Gds(isc_bad_db_handle).copyTo(status);
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				return true;
+			}
+
+			SortTask* getTask() const
+			{
+				return reinterpret_cast<SortTask*> (m_task);
+			}
+
+			bool m_inuse;
+			bool m_ownAttach;
+			RefPtr<StableAttachmentPart> m_attStable;
+			Sort* const m_sort;
+		};
+
+	private:
+		void setError(IStatus* status)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS)
+				m_status.save(status);
+
+			m_stop = true;
+		}
+
+		MemoryPool* m_pool;
+		Database* const m_dbb;
+		const ULONG m_tdbb_flags;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+	};
+
+	bool SortTask::handler(WorkItem& _item)
+	{
+		Item* item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(NULL);
+		tdbb->tdbb_flags = m_tdbb_flags;
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		try
+		{
+			WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+			if (!m_stop)
+				item->m_sort->sort(tdbb);
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SortTask::getWorkItem(WorkItem** pItem)
+	{
+		// Every worker sorts exactly one partition
+
+		if (*pItem)
+			return false;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop)
+			return false;
+
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = *p;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool SortTask::getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+} // namespace
+
 // -----------------------------
 // Data access: external sorting
 // -----------------------------
@@ -46,7 +229,9 @@ using namespace Jrd;
 SortedStream::SortedStream(CompilerScratch* csb, RecordSource* next, SortMap* map)
 	: RecordSource(csb),
 	  m_next(next),
-	  m_map(map)
+	  m_map(map),
+	  m_firstRows(nullptr),
+	  m_skipRows(nullptr)
 {
 	fb_assert(m_next && m_map);
 
@@ -65,11 +250,14 @@ void SortedStream::internalOpen(thread_db* tdbb) const
 	impure->irsb_flags = irsb_open;
 
 	// Get rid of the old sort areas if this request has been used already.
-	// Null the pointer before calling init() because it may throw.
+	// Null the pointers before calling init() because it may throw.
 	delete impure->irsb_sort;
 	impure->irsb_sort = nullptr;
 
-	impure->irsb_sort = init(tdbb);
+	delete impure->irsb_merge;
+	impure->irsb_merge = nullptr;
+
+	init(tdbb, impure);
 }
 
 void SortedStream::close(thread_db* tdbb) const
@@ -87,6 +275,9 @@ void SortedStream::close(thread_db* tdbb) const
 		delete impure->irsb_sort;
 		impure->irsb_sort = nullptr;
 
+		delete impure->irsb_merge;
+		impure->irsb_merge = nullptr;
+
 		m_next->close(tdbb);
 	}
 }
@@ -174,8 +365,10 @@ void SortedStream::nullRecords(thread_db* tdbb) const
 	m_next->nullRecords(tdbb);
 }
 
-Sort* SortedStream::init(thread_db* tdbb) const
+void SortedStream::init(thread_db* tdbb, Impure* impure) const
 {
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
 	Request* const request = tdbb->getRequest();
 
 	m_next->open(tdbb);
@@ -183,99 +376,193 @@ Sort* SortedStream::init(thread_db* tdbb) const
 	// Initialize for sort. If this is really a project operation,
 	// establish a callback routine to reject duplicate records.
 
-	AutoPtr<Sort> scb(FB_NEW_POOL(request->req_sorts.getPool())
-		Sort(tdbb->getDatabase(), &request->req_sorts,
-			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
-			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
+	const FPTR_REJECT_DUP_CALLBACK callback =
+		(m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr;
+
+	// If only the first records are needed, let the sort keep just them
+	// in memory instead of sorting the whole input
+
+	FB_UINT64 maxRecords = 0;
+
+	if (m_firstRows)
+	{
+		const dsc* desc = EVL_expr(tdbb, request, m_firstRows);
+		const SINT64 first = (desc && !(request->req_flags & req_null)) ? MOV_get_int64(tdbb, desc, 0) : 0;
+		SINT64 skip = 0;
+
+		if (m_skipRows)
+		{
+			desc = EVL_expr(tdbb, request, m_skipRows);
+			skip = (desc && !(request->req_flags & req_null)) ? MOV_get_int64(tdbb, desc, 0) : 0;
+		}
+
+		if (first > 0 && skip >= 0)
+			maxRecords = (FB_UINT64) first + skip;
+	}
+
+	// Big sorts are split into partitions. Their final sort passes are done
+	// by parallel workers and the results are merged while being fetched.
+	// Records are still fetched and mapped in the current thread.
+
+	ULONG partitions = 1;
+
+	if (attachment->att_parallel_workers > 1 && !maxRecords)
+	{
+		const double maxPartitions = m_cardinality / MIN_PARTITION_RECORDS;
+
+		if (maxPartitions >= 2)
+			partitions = (ULONG) MIN(maxPartitions, (double) attachment->att_parallel_workers);
+	}
+
+	MemoryPool& pool = request->req_sorts.getPool();
+	AutoPtr<Sort> scb;
+	AutoPtr<PartitionedSort> merge;
+	HalfStaticArray<Sort*, 8> sorts;
+
+	if (partitions == 1)
+	{
+		scb = FB_NEW_POOL(pool)
+			Sort(dbb, &request->req_sorts,
+				 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
+				 m_map->keyItems.begin(), callback, 0, maxRecords);
+
+		sorts.add(scb);
+	}
+	else
+	{
+		merge = FB_NEW_POOL(pool) PartitionedSort(dbb, &request->req_sorts, true);
+
+		for (ULONG i = 0; i < partitions; i++)
+		{
+			Sort* const sort = FB_NEW_POOL(pool)
+				Sort(dbb, &request->req_sorts,
+					 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
+					 m_map->keyItems.begin(), callback, 0);
+
+			merge->addPartition(sort);
+			sorts.add(sort);
+		}
+	}
 
 	// Pump the input stream dry while pushing records into sort. For
 	// each record, map all fields into the sort record. The reverse
 	// mapping is done in get_sort().
 
-	dsc to, temp;
+	ULONG part = 0;
 
 	while (m_next->getRecord(tdbb))
 	{
-		// "Put" a record to sort. Actually, get the address of a place
-		// to build a record.
+		putRecord(tdbb, sorts[part]);
 
-		UCHAR* data = nullptr;
-		scb->put(tdbb, reinterpret_cast<ULONG**>(&data));
+		if (++part == partitions)
+			part = 0;
+	}
 
-		// Zero out the sort key. This solves a multitude of problems.
+	if (!merge)
+	{
+		scb->sort(tdbb);
+		impure->irsb_sort = scb.release();
+		return;
+	}
 
-		memset(data, 0, m_map->length);
+	Coordinator coord(dbb->dbb_permanent);
+	SortTask task(tdbb, &pool, sorts);
 
-		// Loop thru all field (keys and hangers on) involved in the sort.
-		// Be careful to null field all unused bytes in the sort key.
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
 
-		const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
-		for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
-		{
-			to = item->desc;
-			to.dsc_address = data + (IPTR) to.dsc_address;
-			bool flag = false;
-			dsc* from = nullptr;
+		FbLocalStatus local_status;
+		fb_utils::init_status(&local_status);
 
-			if (item->node)
-			{
-				from = EVL_expr(tdbb, request, item->node);
-				if (request->req_flags & req_null)
-					flag = true;
-			}
-			else
-			{
-				from = &temp;
+		coord.runSync(&task);
 
-				record_param* const rpb = &request->req_rpb[item->stream];
+		if (!task.getResult(&local_status))
+			local_status.raise();
+	}
 
-				if (item->fieldId < 0)
-				{
-					switch (item->fieldId)
-					{
-					case ID_TRANS:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-						break;
-					case ID_DBKEY:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-						break;
-					case ID_DBKEY_VALID:
-						*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-						break;
-					default:
-						fb_assert(false);
-					}
-					continue;
-				}
+	merge->buildMergeTree();
+	impure->irsb_merge = merge.release();
+}
 
-				if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
-					flag = true;
-			}
+void SortedStream::putRecord(thread_db* tdbb, Sort* sort) const
+{
+	Request* const request = tdbb->getRequest();
+	dsc to, temp;
 
-			*(data + item->flagOffset) = flag ? TRUE : FALSE;
+	// "Put" a record to sort. Actually, get the address of a place
+	// to build a record.
 
-			if (!flag)
-			{
-				// If an INTL string is moved into the key portion of the sort record,
-				// then we want to sort by language dependent order
+	UCHAR* data = nullptr;
+	sort->put(tdbb, reinterpret_cast<ULONG**>(&data));
 
-				if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
-				{
-					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
-						(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
-				}
-				else
+	// Zero out the sort key. This solves a multitude of problems.
+
+	memset(data, 0, m_map->length);
+
+	// Loop thru all field (keys and hangers on) involved in the sort.
+	// Be careful to null field all unused bytes in the sort key.
+
+	const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
+	for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
+	{
+		to = item->desc;
+		to.dsc_address = data + (IPTR) to.dsc_address;
+		bool flag = false;
+		dsc* from = nullptr;
+
+		if (item->node)
+		{
+			from = EVL_expr(tdbb, request, item->node);
+			if (request->req_flags & req_null)
+				flag = true;
+		}
+		else
+		{
+			from = &temp;
+
+			record_param* const rpb = &request->req_rpb[item->stream];
+
+			if (item->fieldId < 0)
+			{
+				switch (item->fieldId)
 				{
-					MOV_move(tdbb, from, &to);
+				case ID_TRANS:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+					break;
+				case ID_DBKEY:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+					break;
+				case ID_DBKEY_VALID:
+					*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+					break;
+				default:
+					fb_assert(false);
 				}
+				continue;
 			}
+
+			if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
+				flag = true;
 		}
-	}
 
-	scb->sort(tdbb);
+		*(data + item->flagOffset) = flag ? TRUE : FALSE;
+
+		if (!flag)
+		{
+			// If an INTL string is moved into the key portion of the sort record,
+			// then we want to sort by language dependent order
 
-	return scb.release();
+			if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
+			{
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
+					(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
+			}
+			else
+			{
+				MOV_move(tdbb, from, &to);
+			}
+		}
+	}
 }
 
 bool SortedStream::compareKeys(const UCHAR* p, const UCHAR* q) const
@@ -325,7 +612,11 @@ UCHAR* SortedStream::getData(thread_db* tdbb) const
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	ULONG* data = nullptr;
-	impure->irsb_sort->get(tdbb, &data);
+
+	if (impure->irsb_merge)
+		impure->irsb_merge->get(tdbb, &data);
+	else
+		impure->irsb_sort->get(tdbb, &data);
 
 	return reinterpret_cast<UCHAR*>(data);
 }
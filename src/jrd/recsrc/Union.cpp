@@ -18,8 +18,11 @@
  */
 
 #include "firebird.h"
+#include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
+#include "../jrd/TempSpace.h"
+#include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/exe_proto.h"
 #include "../jrd/vio_proto.h"
@@ -33,11 +36,241 @@ using namespace Jrd;
 // Data access: regular union
 // --------------------------
 
+static const char* const SCRATCH = "fb_union_";
+
+// Keys of the records returned by UNION DISTINCT. When there are too many keys,
+// the records having new keys are written into the hash partitions of the
+// temporary space instead of being returned. Such records can't duplicate the
+// ones returned already, so every partition is deduplicated on its own later.
+
+class Union::Distinct : public PermanentStorage
+{
+	static const ULONG ENTRIES_PER_BLOCK = 1024;
+	static const ULONG MIN_CAPACITY = 1024;
+	static const FB_SIZE_T MAX_MEMORY = 64 * 1024 * 1024;
+	static const FB_SIZE_T CHUNK_SIZE = 64 * 1024;
+	static const ULONG END_OF_CHAIN = MAX_ULONG;
+
+	struct Header
+	{
+		ULONG hash;
+		ULONG next;
+	};
+
+	struct Chunk
+	{
+		offset_t offset;
+		FB_SIZE_T length;
+	};
+
+	typedef Array<UCHAR> Buffer;
+	typedef Array<Chunk> ChunkList;
+
+public:
+	static const ULONG PARTITION_COUNT = 64;
+
+	Distinct(MemoryPool& pool, Database* dbb, ULONG keyLength, ULONG recordLength)
+		: PermanentStorage(pool),
+		  m_keyLength(keyLength),
+		  m_recordLength(recordLength),
+		  m_entrySize(FB_ALIGN(sizeof(Header) + keyLength, sizeof(ULONG))),
+		  m_grant(dbb), m_key(pool), m_blocks(pool), m_buckets(pool), m_count(0),
+		  m_space(NULL), m_pending(pool), m_partitions(pool), m_buffer(pool),
+		  m_current(NULL), m_chunk(0), m_position(0)
+	{
+		const FB_SIZE_T granted = m_grant.grant(0, MAX_MEMORY);
+		m_capacity = MAX((ULONG) (granted / m_entrySize), MIN_CAPACITY);
+
+		ULONG bits = 1;
+		while ((1U << bits) < m_capacity)
+			bits++;
+
+		m_shift = 32 - bits;
+		m_buckets.resize(1U << bits);
+		m_key.resize(m_keyLength);
+		clear();
+	}
+
+	~Distinct()
+	{
+		for (UCHAR** block = m_blocks.begin(); block < m_blocks.end(); block++)
+			delete[] *block;
+
+		delete m_space;
+	}
+
+	UCHAR* getKeyBuffer()
+	{
+		return m_key.begin();
+	}
+
+	bool isFull() const
+	{
+		return (m_count >= m_capacity);
+	}
+
+	bool isSpilled() const
+	{
+		return (m_space != NULL);
+	}
+
+	bool find(ULONG hash, const UCHAR* key) const
+	{
+		for (ULONG index = m_buckets[getBucket(hash)]; index != END_OF_CHAIN;)
+		{
+			const UCHAR* const entry = getEntry(index);
+			const Header* const header = reinterpret_cast<const Header*>(entry);
+
+			if (header->hash == hash && !memcmp(entry + sizeof(Header), key, m_keyLength))
+				return true;
+
+			index = header->next;
+		}
+
+		return false;
+	}
+
+	void add(ULONG hash, const UCHAR* key)
+	{
+		const ULONG index = m_count;
+
+		if (index / ENTRIES_PER_BLOCK >= m_blocks.getCount())
+			m_blocks.add(FB_NEW_POOL(getPool()) UCHAR[ENTRIES_PER_BLOCK * m_entrySize]);
+
+		m_count++;
+
+		UCHAR* const entry = getEntry(index);
+		Header* const header = reinterpret_cast<Header*>(entry);
+
+		ULONG& head = m_buckets[getBucket(hash)];
+		header->hash = hash;
+		header->next = head;
+		head = index;
+
+		memcpy(entry + sizeof(Header), key, m_keyLength);
+	}
+
+	// Put the record aside into its partition
+	void spill(ULONG hash, const UCHAR* record)
+	{
+		if (!m_space)
+		{
+			m_space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH);
+
+			for (ULONG i = 0; i < PARTITION_COUNT; i++)
+			{
+				m_pending.add();
+				m_partitions.add();
+			}
+		}
+
+		const ULONG partition = hash % PARTITION_COUNT;
+		Buffer& pending = m_pending[partition];
+		pending.add(record, m_recordLength);
+
+		if (pending.getCount() >= CHUNK_SIZE)
+			flush(partition);
+	}
+
+	// Start deduplicating the records of the given partition
+	void rewind(ULONG partition)
+	{
+		fb_assert(m_space && partition < PARTITION_COUNT);
+
+		if (!partition)
+		{
+			for (ULONG i = 0; i < PARTITION_COUNT; i++)
+				flush(i);
+		}
+
+		clear();
+
+		m_current = &m_partitions[partition];
+		m_chunk = 0;
+		m_buffer.clear();
+		m_position = 0;
+	}
+
+	const UCHAR* next()
+	{
+		fb_assert(m_current);
+
+		while (m_position >= m_buffer.getCount())
+		{
+			if (m_chunk >= m_current->getCount())
+				return NULL;
+
+			const Chunk& chunk = (*m_current)[m_chunk++];
+
+			m_buffer.resize(chunk.length);
+			m_space->read(chunk.offset, m_buffer.begin(), chunk.length);
+			m_position = 0;
+		}
+
+		const UCHAR* const record = m_buffer.begin() + m_position;
+		m_position += m_recordLength;
+		return record;
+	}
+
+private:
+	ULONG getBucket(ULONG hash) const
+	{
+		return (hash * 0x9E3779B1U) >> m_shift;
+	}
+
+	UCHAR* getEntry(ULONG index) const
+	{
+		return m_blocks[index / ENTRIES_PER_BLOCK] + (index % ENTRIES_PER_BLOCK) * m_entrySize;
+	}
+
+	void clear()
+	{
+		m_count = 0;
+
+		for (ULONG* bucket = m_buckets.begin(); bucket < m_buckets.end(); bucket++)
+			*bucket = END_OF_CHAIN;
+	}
+
+	void flush(ULONG partition)
+	{
+		Buffer& pending = m_pending[partition];
+
+		if (pending.isEmpty())
+			return;
+
+		const Chunk chunk = {m_space->getSize(), pending.getCount()};
+		m_space->write(chunk.offset, pending.begin(), chunk.length);
+		m_partitions[partition].add(chunk);
+
+		pending.clear();
+	}
+
+	const ULONG m_keyLength;
+	const ULONG m_recordLength;
+	const ULONG m_entrySize;
+	TempMemoryGrant m_grant;
+	ULONG m_capacity;
+	ULONG m_shift;
+	Buffer m_key;
+	Array<UCHAR*> m_blocks;
+	Array<ULONG> m_buckets;
+	ULONG m_count;
+	TempSpace* m_space;
+	ObjectsArray<Buffer> m_pending;
+	ObjectsArray<ChunkList> m_partitions;
+	Buffer m_buffer;
+	const ChunkList* m_current;
+	FB_SIZE_T m_chunk;
+	FB_SIZE_T m_position;
+};
+
+
 Union::Union(CompilerScratch* csb, StreamType stream,
 			 FB_SIZE_T argCount, RecordSource* const* args, NestConst<MapNode>* maps,
-			 const StreamList& streams)
+			 const StreamList& streams, const SortNode* distinct)
 	: RecordStream(csb, stream), m_args(csb->csb_pool), m_maps(csb->csb_pool),
-	  m_streams(csb->csb_pool, streams)
+	  m_streams(csb->csb_pool, streams), m_distinct(distinct != NULL),
+	  m_keyIds(csb->csb_pool), m_keyLengths(csb->csb_pool), m_keyLength(0)
 {
 	fb_assert(argCount);
 
@@ -55,6 +288,24 @@ Union::Union(CompilerScratch* csb, StreamType stream,
 
 	for (FB_SIZE_T i = 0; i < argCount; i++)
 		m_maps[i] = maps[i];
+
+	if (m_distinct)
+	{
+		// Every key value is prefixed with a byte telling NULLs from empty and zero values
+
+		for (const auto expr : distinct->expressions)
+		{
+			const auto fieldNode = nodeAs<FieldNode>(expr);
+			fb_assert(fieldNode && fieldNode->fieldStream == m_stream);
+
+			const ULONG keyLength =
+				HashJoin::getKeyLength(JRD_get_thread_data(), m_format->fmt_desc[fieldNode->fieldId]);
+
+			m_keyIds.add(fieldNode->fieldId);
+			m_keyLengths.add(keyLength);
+			m_keyLength += keyLength + 1;
+		}
+	}
 }
 
 void Union::internalOpen(thread_db* tdbb) const
@@ -67,6 +318,18 @@ void Union::internalOpen(thread_db* tdbb) const
 	impure->irsb_count = 0;
 	VIO_record(tdbb, &request->req_rpb[m_stream], m_format, tdbb->getDefaultPool());
 
+	delete impure->irsb_distinct;
+	impure->irsb_distinct = NULL;
+
+	if (m_distinct)
+	{
+		MemoryPool& pool = *tdbb->getDefaultPool();
+
+		impure->irsb_distinct = FB_NEW_POOL(pool)
+			Distinct(pool, tdbb->getDatabase(), m_keyLength, m_format->fmt_length);
+		impure->irsb_partition = 0;
+	}
+
 	// Initialize the record number of each stream in the union
 
 	for (FB_SIZE_T i = 0; i < m_streams.getCount(); i++)
@@ -92,6 +355,9 @@ void Union::close(thread_db* tdbb) const
 
 		if (impure->irsb_count < m_args.getCount())
 			m_args[impure->irsb_count]->close(tdbb);
+
+		delete impure->irsb_distinct;
+		impure->irsb_distinct = NULL;
 	}
 }
 
@@ -109,6 +375,21 @@ bool Union::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (!(m_distinct ? fetchDistinct(tdbb, impure) : fetchRecord(tdbb, impure)))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	rpb->rpb_number.setValid(true);
+	return true;
+}
+
+bool Union::fetchRecord(thread_db* tdbb, Impure* impure) const
+{
+	if (impure->irsb_count >= m_args.getCount())
+		return false;
+
 	// March thru the sub-streams looking for a record
 
 	while (!m_args[impure->irsb_count]->getRecord(tdbb))
@@ -116,10 +397,7 @@ bool Union::internalGetRecord(thread_db* tdbb) const
 		m_args[impure->irsb_count]->close(tdbb);
 		impure->irsb_count++;
 		if (impure->irsb_count >= m_args.getCount())
-		{
-			rpb->rpb_number.setValid(false);
 			return false;
-		}
 		m_args[impure->irsb_count]->open(tdbb);
 	}
 
@@ -136,10 +414,92 @@ bool Union::internalGetRecord(thread_db* tdbb) const
 		EXE_assignment(tdbb, *source, *target);
 	}
 
-	rpb->rpb_number.setValid(true);
 	return true;
 }
 
+// Return the next record not returned before
+bool Union::fetchDistinct(thread_db* tdbb, Impure* impure) const
+{
+	Request* const request = tdbb->getRequest();
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+	Distinct* const distinct = impure->irsb_distinct;
+	UCHAR* const key = distinct->getKeyBuffer();
+
+	while (fetchRecord(tdbb, impure))
+	{
+		const ULONG hash = makeKey(tdbb, record, key);
+
+		if (distinct->find(hash, key))
+			continue;
+
+		if (distinct->isFull())
+		{
+			distinct->spill(hash, record->getData());
+			continue;
+		}
+
+		distinct->add(hash, key);
+		return true;
+	}
+
+	if (!distinct->isSpilled())
+		return false;
+
+	while (true)
+	{
+		if (impure->irsb_partition)
+		{
+			while (const UCHAR* const data = distinct->next())
+			{
+				memcpy(record->getData(), data, record->getLength());
+
+				const ULONG hash = makeKey(tdbb, record, key);
+
+				if (!distinct->find(hash, key))
+				{
+					distinct->add(hash, key);
+					return true;
+				}
+			}
+		}
+
+		if (impure->irsb_partition >= Distinct::PARTITION_COUNT)
+			return false;
+
+		distinct->rewind(impure->irsb_partition++);
+	}
+}
+
+// Build the binary comparable key of the record and return its hash value
+ULONG Union::makeKey(thread_db* tdbb, const Record* record, UCHAR* key) const
+{
+	memset(key, 0, m_keyLength);
+
+	UCHAR* keyPtr = key;
+
+	for (FB_SIZE_T i = 0; i < m_keyIds.getCount(); i++)
+	{
+		const USHORT id = m_keyIds[i];
+		const ULONG keyLength = m_keyLengths[i];
+
+		if (!record->isNull(id))
+		{
+			*keyPtr = 1;
+
+			dsc desc = m_format->fmt_desc[id];
+			desc.dsc_address = const_cast<UCHAR*>(record->getData()) + (IPTR) desc.dsc_address;
+
+			HashJoin::makeKey(tdbb, &desc, keyLength, keyPtr + 1);
+		}
+
+		keyPtr += keyLength + 1;
+	}
+
+	fb_assert(keyPtr - key == m_keyLength);
+
+	return InternalHash::hash(m_keyLength, key);
+}
+
 bool Union::refetchRecord(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
@@ -173,6 +533,10 @@ void Union::print(thread_db* tdbb, string& plan, bool detailed, unsigned level,
 	if (detailed)
 	{
 		plan += printIndent(++level) + (m_args.getCount() == 1 ? "Materialize" : "Union");
+
+		if (m_distinct)
+			plan += " (hash distinct)";
+
 		printOptInfo(plan);
 
 		if (recurse)
@@ -448,7 +448,8 @@ WindowedStream::WindowStream::WindowStream(thread_db* tdbb, CompilerScratch* csb
 	  m_winPassSources(csb->csb_pool),
 	  m_winPassTargets(csb->csb_pool),
 	  m_exclusion(exclusion),
-	  m_invariantOffsets(0)
+	  m_invariantOffsets(0),
+	  m_removable(false)
 {
 	// Separate nodes that requires the winPass call.
 
@@ -479,6 +480,20 @@ WindowedStream::WindowStream::WindowStream(thread_db* tdbb, CompilerScratch* csb
 		}
 	}
 
+	// A moving frame can be slid by taking back the records leaving it, instead of
+	// aggregating the whole frame again.
+
+	if (m_aggSources.hasData() && m_exclusion == Exclusion::NO_OTHERS)
+	{
+		m_removable = true;
+
+		for (const auto source : m_aggSources)
+		{
+			if (!(nodeAs<AggNode>(source)->getCapabilities() & AggNode::CAP_REMOVES_VALUES))
+				m_removable = false;
+		}
+	}
+
 	m_arithNodes.resize(2);
 
 	if (m_order)
@@ -518,8 +533,6 @@ WindowedStream::WindowStream::WindowStream(thread_db* tdbb, CompilerScratch* csb
 			}
 		}
 	}
-
-	(void) m_exclusion;	// avoid warning
 }
 
 void WindowedStream::WindowStream::internalOpen(thread_db* tdbb) const
@@ -785,7 +798,18 @@ bool WindowedStream::WindowStream::internalGetRecord(thread_db* tdbb) const
 			// This may be incompatible with some function like LIST, but currently LIST cannot
 			// be used in ordered windows anyway.
 
-			if (!lastWindow.isValid() ||
+			if (lastWindow.isValid() &&
+				impure->windowBlock.startPosition > lastWindow.startPosition &&
+				impure->windowBlock.startPosition <= lastWindow.endPosition + 1 &&
+				impure->windowBlock.endPosition >= lastWindow.endPosition &&
+				lastWindow.startPosition >= impure->partitionBlock.startPosition &&
+				m_removable &&
+				aggRevert(tdbb, request, lastWindow.startPosition, impure->windowBlock.startPosition))
+			{
+				// The frame has moved forward, the records left behind are taken back.
+				m_next->locate(tdbb, lastWindow.endPosition + 1);
+			}
+			else if (!lastWindow.isValid() ||
 				impure->windowBlock.startPosition > lastWindow.startPosition ||
 				impure->windowBlock.endPosition < lastWindow.endPosition)
 			{
@@ -954,6 +978,28 @@ const void WindowedStream::WindowStream::getFrameValue(thread_db* tdbb, Request*
 	}
 }
 
+// Take back the records in the given range from the window aggregates. If some aggregate cannot
+// do that, false is returned and the aggregation has to be started again.
+bool WindowedStream::WindowStream::aggRevert(thread_db* tdbb, Request* request,
+	SINT64 startPosition, SINT64 endPosition) const
+{
+	m_next->locate(tdbb, startPosition);
+
+	for (SINT64 position = startPosition; position < endPosition; position++)
+	{
+		if (!m_next->getRecord(tdbb))
+			fb_assert(false);
+
+		for (const auto source : m_aggSources)
+		{
+			if (!nodeAs<AggNode>(source)->aggRevert(tdbb, request))
+				return false;
+		}
+	}
+
+	return true;
+}
+
 SINT64 WindowedStream::WindowStream::locateFrameRange(thread_db* tdbb, Request* request, Impure* impure,
 	const Frame* frame, const dsc* offsetDesc, SINT64 position) const
 {
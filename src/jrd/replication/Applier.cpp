@@ -300,6 +300,16 @@ void Applier::process(thread_db* tdbb, ULONG length, const UCHAR* data)
 
 	tdbb->tdbb_flags |= TDBB_replicator;
 
+	// Blocks read from the compressed journal segments
+	UCharBuffer decompressed;
+
+	if (length >= sizeof(Block) && (((const Block*) data)->flags & BLOCK_COMPRESSED))
+	{
+		decompressBlock(length, data, decompressed);
+		length = decompressed.getCount();
+		data = decompressed.begin();
+	}
+
 	BlockReader reader(length, data);
 
 	const auto traNum = reader.getTransactionId();
@@ -547,12 +557,7 @@ void Applier::insertRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto format = findFormat(tdbb, relation, length);
 
@@ -683,12 +688,7 @@ void Applier::updateRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto orgFormat = findFormat(tdbb, relation, orgLength);
 
@@ -824,12 +824,7 @@ void Applier::deleteRecord(thread_db* tdbb, TraNumber traNum,
 
 	TRA_attach_request(transaction, m_request);
 
-	const auto relation = MET_lookup_relation(tdbb, relName);
-	if (!relation)
-		raiseError("Table %s is not found", relName.c_str());
-
-	if (!(relation->rel_flags & REL_scanned))
-		MET_scan_relation(tdbb, relation);
+	const auto relation = lookupRelation(tdbb, relName);
 
 	const auto format = findFormat(tdbb, relation, length);
 
@@ -978,9 +973,49 @@ void Applier::executeSql(thread_db* tdbb,
 						   NULL, NULL, NULL, NULL, false);
 }
 
+jrd_rel* Applier::lookupRelation(thread_db* tdbb, const MetaName& name)
+{
+	// Changes usually come in long runs for the same tables, so remember the relations
+	// instead of searching the whole metadata vector for every replicated record.
+	// Relation blocks live as long as the attachment, dropped ones are just flagged.
+
+	jrd_rel* relation = NULL;
+
+	if (!m_relations.get(name, relation) ||
+		(relation->rel_flags & (REL_deleted | REL_deleting | REL_check_existence)))
+	{
+		relation = MET_lookup_relation(tdbb, name);
+		if (!relation)
+			raiseError("Table %s is not found", name.c_str());
+
+		m_relations.put(name, relation);
+	}
+
+	if (!(relation->rel_flags & REL_scanned))
+		MET_scan_relation(tdbb, relation);
+
+	return relation;
+}
+
 bool Applier::lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& key)
 {
 	RelationPages* const relPages = relation->getPages(tdbb);
+
+	// The key once chosen for the relation is only re-validated instead of
+	// describing all its indices for every replicated record
+
+	USHORT keyId;
+	if (m_keys.get(relation->rel_id, keyId))
+	{
+		if (BTR_lookup(tdbb, relation, keyId, &key, relPages) &&
+			(key.idx_flags & (idx_primary | idx_unique)))
+		{
+			return true;
+		}
+
+		m_keys.remove(relation->rel_id);
+	}
+
 	auto page = relPages->rel_index_root;
 	if (!page)
 	{
@@ -1037,7 +1072,11 @@ bool Applier::lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& key)
 
 	CCH_RELEASE(tdbb, &window);
 
-	return (key.idx_id != idx_invalid);
+	if (key.idx_id == idx_invalid)
+		return false;
+
+	m_keys.put(relation->rel_id, key.idx_id);
+	return true;
 }
 
 bool Applier::compareKey(thread_db* tdbb, jrd_rel* relation, const index_desc& idx,
@@ -1361,6 +1400,9 @@ void Applier::doDelete(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 void Applier::logConflict(const char* msg, ...)
 {
+	if (const auto attachment = getAttachment())
+		++attachment->att_database->dbb_repl_conflicts;
+
 #ifdef LOG_CONFLICTS
 	char buffer[BUFFER_LARGE];
 
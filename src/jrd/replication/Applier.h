@@ -37,6 +37,8 @@ namespace Jrd
 	{
 		typedef Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<TraNumber, jrd_tra*> > > TransactionMap;
 		typedef Firebird::HalfStaticArray<bid, 16> BlobList;
+		typedef Firebird::GenericMap<Firebird::Pair<Firebird::Left<MetaName, jrd_rel*> > > RelationMap;
+		typedef Firebird::GenericMap<Firebird::Pair<Firebird::NonPooled<USHORT, USHORT> > > KeyMap;
 /*
 		class ReplicatedTransaction : public Firebird::IReplicatedTransaction
 		{
@@ -127,7 +129,7 @@ namespace Jrd
 				const Firebird::PathName& database,
 				Request* request, bool cascade)
 			: PermanentStorage(pool),
-			  m_txnMap(pool), m_database(pool, database),
+			  m_txnMap(pool), m_relations(pool), m_keys(pool), m_database(pool, database),
 			  m_request(request), m_enableCascade(cascade)
 		{}
 
@@ -149,6 +151,8 @@ namespace Jrd
 
 	private:
 		TransactionMap m_txnMap;
+		RelationMap m_relations;
+		KeyMap m_keys;
 		const Firebird::PathName m_database;
 		Request* m_request;
 		RecordBitmap* m_bitmap = nullptr;
@@ -185,6 +189,7 @@ namespace Jrd
 						const Firebird::string& sql,
 						const MetaName& owner);
 
+		jrd_rel* lookupRelation(thread_db* tdbb, const MetaName& name);
 		bool lookupKey(thread_db* tdbb, jrd_rel* relation, index_desc& idx);
 		bool compareKey(thread_db* tdbb, jrd_rel* relation,
 						const index_desc& idx,
@@ -131,11 +131,12 @@ ChangeLog::Segment::~Segment()
 	::close(m_handle);
 }
 
-void ChangeLog::Segment::init(FB_UINT64 sequence, const Guid& guid)
+void ChangeLog::Segment::init(FB_UINT64 sequence, const Guid& guid, bool compressed)
 {
 	fb_assert(sizeof(CHANGELOG_SIGNATURE) == sizeof(m_header->hdr_signature));
 	strcpy(m_header->hdr_signature, CHANGELOG_SIGNATURE);
-	m_header->hdr_version = CHANGELOG_CURRENT_VERSION;
+	// Segments without compressed blocks remain readable by older replicas
+	m_header->hdr_version = compressed ? CHANGELOG_VERSION_2 : CHANGELOG_VERSION_1;
 	m_header->hdr_state = SEGMENT_STATE_USED;
 	memcpy(&m_header->hdr_guid, &guid, sizeof(Guid));
 	m_header->hdr_sequence = sequence;
@@ -149,8 +150,11 @@ bool ChangeLog::Segment::validate(const Guid& guid) const
 	if (strcmp(m_header->hdr_signature, CHANGELOG_SIGNATURE))
 		return false;
 
-	if (m_header->hdr_version != CHANGELOG_CURRENT_VERSION)
+	if (m_header->hdr_version < CHANGELOG_VERSION_1 ||
+		m_header->hdr_version > CHANGELOG_CURRENT_VERSION)
+	{
 		return false;
+	}
 
 	if (m_header->hdr_state != SEGMENT_STATE_FREE &&
 		m_header->hdr_state != SEGMENT_STATE_USED &&
@@ -557,6 +561,14 @@ void ChangeLog::forceSwitch()
 
 FB_UINT64 ChangeLog::write(ULONG length, const UCHAR* data, bool sync)
 {
+	UCharBuffer compressed;
+
+	if (m_config->journalCompression && compressBlock(length, data, compressed))
+	{
+		length = compressed.getCount();
+		data = compressed.begin();
+	}
+
 	LockGuard guard(this);
 
 	auto segment = getSegment(length);
@@ -908,7 +920,7 @@ ChangeLog::Segment* ChangeLog::createSegment()
 
 	const auto segment = FB_NEW_POOL(getPool()) Segment(getPool(), filename, fd);
 
-	segment->init(sequence, m_guid);
+	segment->init(sequence, m_guid, m_config->journalCompression);
 	segment->addRef();
 
 	m_segments.add(segment);
@@ -957,7 +969,7 @@ ChangeLog::Segment* ChangeLog::reuseSegment(ChangeLog::Segment* segment)
 
 	segment = FB_NEW_POOL(getPool()) Segment(getPool(), newname, fd);
 
-	segment->init(sequence, m_guid);
+	segment->init(sequence, m_guid, m_config->journalCompression);
 	segment->addRef();
 
 	m_segments.add(segment);
@@ -58,7 +58,8 @@ namespace Replication
 	const char CHANGELOG_SIGNATURE[] = "FBCHANGELOG";
 
 	const USHORT CHANGELOG_VERSION_1 = 1;
-	const USHORT CHANGELOG_CURRENT_VERSION = CHANGELOG_VERSION_1;
+	const USHORT CHANGELOG_VERSION_2 = 2;	// blocks may be compressed
+	const USHORT CHANGELOG_CURRENT_VERSION = CHANGELOG_VERSION_2;
 
 	class ChangeLog : protected Firebird::PermanentStorage, public Firebird::IpcObject
 	{
@@ -143,7 +144,7 @@ namespace Replication
 			Segment(MemoryPool& pool, const Firebird::PathName& filename, int handle);
 			virtual ~Segment();
 
-			void init(FB_UINT64 sequence, const Firebird::Guid& guid);
+			void init(FB_UINT64 sequence, const Firebird::Guid& guid, bool compressed);
 			bool validate(const Firebird::Guid& guid) const;
 			void append(ULONG length, const UCHAR* data);
 			void copyTo(const Firebird::PathName& filename) const;
@@ -117,6 +117,7 @@ Config::Config()
 	  archiveDirectory(getPool()),
 	  archiveCommand(getPool()),
 	  archiveTimeout(DEFAULT_ARCHIVE_TIMEOUT),
+	  journalCompression(false),
 	  syncReplicas(getPool()),
 	  sourceDirectory(getPool()),
 	  sourceGuid{},
@@ -144,6 +145,7 @@ Config::Config(const Config& other)
 	  archiveDirectory(getPool(), other.archiveDirectory),
 	  archiveCommand(getPool(), other.archiveCommand),
 	  archiveTimeout(other.archiveTimeout),
+	  journalCompression(other.journalCompression),
 	  syncReplicas(getPool(), other.syncReplicas),
 	  sourceDirectory(getPool(), other.sourceDirectory),
 	  sourceGuid{},
@@ -270,6 +272,10 @@ Config* Config::get(const PathName& lookupName)
 				{
 					parseLong(value, config->archiveTimeout);
 				}
+				else if (key == "journal_compression")
+				{
+					parseBoolean(value, config->journalCompression);
+				}
 				else if (key == "plugin")
 				{
 					config->pluginName = value;
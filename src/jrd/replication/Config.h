@@ -51,6 +51,7 @@ namespace Replication
 		Firebird::PathName archiveDirectory;
 		Firebird::string archiveCommand;
 		ULONG archiveTimeout;
+		bool journalCompression;
 		Firebird::ObjectsArray<Firebird::string> syncReplicas;
 		Firebird::PathName sourceDirectory;
 		Firebird::Guid sourceGuid;
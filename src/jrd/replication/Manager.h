@@ -88,6 +88,12 @@ namespace Replication
 			return m_config;
 		}
 
+		// Size of the changes not yet passed to the journal and asynchronous replicas
+		ULONG getQueueSize() const
+		{
+			return m_queueSize;
+		}
+
 	private:
 		void bgWriter();
 
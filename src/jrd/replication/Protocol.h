@@ -33,6 +33,7 @@ namespace Replication
 	// Global (protocol neutral) flags
 	const USHORT BLOCK_BEGIN_TRANS	= 0x0001;
 	const USHORT BLOCK_END_TRANS	= 0x0002;
+	const USHORT BLOCK_COMPRESSED	= 0x0004;	// deflated data preceded by its original length
 
 	struct Block
 	{
@@ -27,10 +27,13 @@
 #include "../common/isc_f_proto.h"
 #include "../common/utils_proto.h"
 #include "../common/ScanDir.h"
+#include "../common/classes/init.h"
+#include "../common/classes/zip.h"
 #include "../common/os/mod_loader.h"
 #include "../common/os/path_utils.h"
 #include "../jrd/constants.h"
 
+#include "Protocol.h"
 #include "Utils.h"
 
 #ifdef HAVE_UNISTD_H
@@ -55,6 +58,13 @@ using namespace Replication;
 
 namespace
 {
+#ifdef HAVE_ZLIB_H
+	InitInstance<ZLib> zlib;
+#endif
+
+	// Blocks smaller than that are not worth compressing
+	const ULONG MIN_COMPRESSED_LENGTH = 256;
+
 	// Must match items inside enum LogMsgSide
 	const char* LOG_MSG_SIDES[] = {
 		"primary",	// LogMsgSide::PRIMARY_SIDE
@@ -274,4 +284,113 @@ namespace Replication
 		logMessage(REPLICA_SIDE, VERBOSE_MSG, database, message);
 	}
 
+	// Compress the block data if it makes the block shorter.
+	// The output block is marked with BLOCK_COMPRESSED and its data starts
+	// with the original data length, followed by the deflated data.
+
+	bool compressBlock(ULONG length, const UCHAR* data, UCharBuffer& output)
+	{
+		fb_assert(length >= sizeof(Block));
+
+		Block header;
+		memcpy(&header, data, sizeof(Block));
+
+		const ULONG dataLength = header.length;
+		fb_assert(dataLength == length - sizeof(Block));
+
+		if (dataLength < MIN_COMPRESSED_LENGTH || (header.flags & BLOCK_COMPRESSED))
+			return false;
+
+#ifdef HAVE_ZLIB_H
+		if (!zlib())
+			return false;
+
+		const ULONG prefixLength = sizeof(Block) + sizeof(ULONG);
+		UCHAR* const buffer = output.getBuffer(prefixLength + dataLength, false);
+
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		stream.zalloc = ZLib::allocFunc;
+		stream.zfree = ZLib::freeFunc;
+
+		if (zlib().deflateInit_(&stream, Z_DEFAULT_COMPRESSION, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+			return false;
+
+		// Leave no room for the deflated data to be as long as the original one
+		stream.next_in = const_cast<UCHAR*>(data + sizeof(Block));
+		stream.avail_in = dataLength;
+		stream.next_out = buffer + prefixLength;
+		stream.avail_out = dataLength - sizeof(ULONG) - 1;
+
+		const int ret = zlib().deflate(&stream, Z_FINISH);
+		const ULONG packedLength = stream.total_out;
+		zlib().deflateEnd(&stream);
+
+		if (ret != Z_STREAM_END)
+			return false;
+
+		header.flags |= BLOCK_COMPRESSED;
+		header.length = sizeof(ULONG) + packedLength;
+
+		memcpy(buffer, &header, sizeof(Block));
+		memcpy(buffer + sizeof(Block), &dataLength, sizeof(ULONG));
+		output.shrink(sizeof(Block) + header.length);
+
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	// Restore the original block from the one produced by compressBlock()
+
+	void decompressBlock(ULONG length, const UCHAR* data, UCharBuffer& output)
+	{
+		const ULONG prefixLength = sizeof(Block) + sizeof(ULONG);
+
+		Block header;
+		ULONG dataLength;
+
+		if (length < prefixLength)
+			raiseError("Compressed replication block is corrupted");
+
+		memcpy(&header, data, sizeof(Block));
+		memcpy(&dataLength, data + sizeof(Block), sizeof(ULONG));
+
+		fb_assert(header.flags & BLOCK_COMPRESSED);
+
+#ifdef HAVE_ZLIB_H
+		if (!zlib())
+			raiseError("Compressed replication block cannot be read, zlib is not available");
+
+		UCHAR* const buffer = output.getBuffer(sizeof(Block) + dataLength, false);
+
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		stream.zalloc = ZLib::allocFunc;
+		stream.zfree = ZLib::freeFunc;
+
+		if (zlib().inflateInit_(&stream, ZLIB_VERSION, sizeof(z_stream)) != Z_OK)
+			raiseError("Cannot initialize decompression of replication block");
+
+		stream.next_in = const_cast<UCHAR*>(data + prefixLength);
+		stream.avail_in = length - prefixLength;
+		stream.next_out = buffer + sizeof(Block);
+		stream.avail_out = dataLength;
+
+		const int ret = zlib().inflate(&stream, Z_FINISH);
+		const bool complete = (ret == Z_STREAM_END && !stream.avail_out);
+		zlib().inflateEnd(&stream);
+
+		if (!complete)
+			raiseError("Compressed replication block is corrupted");
+
+		header.flags &= ~BLOCK_COMPRESSED;
+		header.length = dataLength;
+		memcpy(buffer, &header, sizeof(Block));
+#else
+		raiseError("Compressed replication block cannot be read, zlib is not available");
+#endif
+	}
+
 } // namespace
@@ -24,6 +24,7 @@
 #ifndef JRD_REPLICATION_UTILS_H
 #define JRD_REPLICATION_UTILS_H
 
+#include "../common/classes/array.h"
 #include "../common/classes/fb_string.h"
 
 #ifdef WIN_NT
@@ -71,6 +72,9 @@ namespace Replication
 	void logReplicaVerbose(const Firebird::PathName& database,
 						   const Firebird::string& message);
 
+	bool compressBlock(ULONG length, const UCHAR* data, Firebird::UCharBuffer& output);
+	void decompressBlock(ULONG length, const UCHAR* data, Firebird::UCharBuffer& output);
+
 	class AutoFile
 	{
 	public:
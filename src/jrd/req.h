@@ -64,7 +64,7 @@ struct record_param
 		  rpb_b_page(0), rpb_b_line(0),
 		  rpb_address(NULL), rpb_length(0),
 		  rpb_flags(0), rpb_stream_flags(0), rpb_runtime_flags(0),
-		  rpb_org_scans(0), rpb_window(DB_PAGE_SPACE, -1)
+		  rpb_org_scans(0), rpb_field_count(0), rpb_window(DB_PAGE_SPACE, -1)
 	{
 	}
 
@@ -91,6 +91,7 @@ struct record_param
 	USHORT rpb_stream_flags;		// stream flags
 	USHORT rpb_runtime_flags;		// runtime flags
 	SSHORT rpb_org_scans;			// relation scan count at stream open
+	USHORT rpb_field_count;			// leading fields accessed by the stream, zero if all
 
 	inline WIN& getWindow(thread_db* tdbb)
 	{
@@ -135,6 +136,7 @@ const USHORT RPB_undo_data		= 0x02;	// data got from undo log
 const USHORT RPB_undo_read		= 0x04;	// read was performed using the undo log
 const USHORT RPB_undo_deleted	= 0x08;	// read was performed using the undo log, primary version is deleted
 const USHORT RPB_just_deleted	= 0x10;	// record was just deleted by us
+const USHORT RPB_all_visible	= 0x20;	// record is on a data page visible to every snapshot
 
 const USHORT RPB_UNDO_FLAGS		= (RPB_undo_data | RPB_undo_read | RPB_undo_deleted);
 const USHORT RPB_CLEAR_FLAGS	= (RPB_UNDO_FLAGS | RPB_just_deleted);
@@ -191,6 +191,7 @@ int SDW_add_file(thread_db* tdbb, const TEXT* file_name, SLONG start, USHORT sha
 	// And why doesn't the code check that the allocation succeeds?
 
 	SCHAR* spare_page = FB_ALIGN(spare_buffer, PAGE_ALIGNMENT);
+	memset(spare_page, 0, dbb->dbb_page_size);
 
 	try {
 
@@ -470,20 +471,18 @@ void SDW_dump_pages(thread_db* tdbb)
 
 	for (SLONG page_number = HEADER_PAGE + 1; page_number <= max; page_number++)
 	{
-#ifdef SUPERSERVER_V2
-		if (!(page_number % dbb->dbb_prefetch_sequence))
+		if (dbb->dbb_prefetch_pages && !(page_number % dbb->dbb_prefetch_sequence))
 		{
-			SLONG pages[PREFETCH_MAX_PAGES];
+			ULONG pages[MAX_READ_AHEAD_PAGES];
 
 			SLONG number = page_number;
-			SLONG i = 0;
+			FB_SIZE_T i = 0;
 			while (i < dbb->dbb_prefetch_pages && number <= max) {
 				pages[i++] = number++;
 			}
 
 			CCH_PREFETCH(tdbb, pages, i);
 		}
-#endif
 		for (Shadow* shadow = dbb->dbb_shadow; shadow; shadow = shadow->sdw_next)
 		{
 			if (!(shadow->sdw_flags & (SDW_INVALID | SDW_dumped)))
@@ -33,6 +33,7 @@
 #include <string.h>
 #include "../jrd/jrd.h"
 #include "../jrd/sort.h"
+#include "../jrd/sqz.h"
 #include "iberror.h"
 #include "../jrd/intl.h"
 #include "../common/TimeZoneUtil.h"
@@ -41,6 +42,9 @@
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
+#include "../common/ThreadStart.h"
+#include "../common/isc_proto.h"
+#include "../common/classes/semaphore.h"
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -63,8 +67,15 @@
 #endif
 
 const USHORT RUN_GROUP			= 8;
+const USHORT MAX_RUN_GROUP		= 64;
 const USHORT MAX_MERGE_LEVEL	= 2;
 
+// Unpacked length of frames of compressed runs
+const ULONG RUN_FRAME_SIZE		= 64 * 1024;
+
+// Minimal number of records to distribute by radix instead of quick sort
+const SLONG RADIX_THRESHOLD		= 1024;
+
 using namespace Jrd;
 using namespace Firebird;
 
@@ -168,7 +179,9 @@ Sort::Sort(Database* dbb,
 	: m_dbb(dbb), m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
-	  m_description(owner->getPool(), keys)
+	  m_description(owner->getPool(), keys),
+	  m_packed(owner->getPool()),
+	  m_grant(dbb)
 {
 /**************************************
  *
@@ -202,6 +215,16 @@ Sort::Sort(Database* dbb,
 		m_min_alloc_size = record_size * MIN_RECORDS_TO_ALLOC;
 		m_max_alloc_size = MAX(m_min_alloc_size, MAX_SORT_BUFFER_SIZE);
 
+		// Every intermediate merge re-reads the merged runs, so merge as many
+		// runs at once as the temp space cache could keep in memory, leaving
+		// the most of it for other sorts.
+
+		const FB_UINT64 group = dbb->dbb_config->getTempCacheLimit() / (m_max_alloc_size * 8);
+		m_run_group = (USHORT) MIN(MAX(group, RUN_GROUP), MAX_RUN_GROUP);
+
+		if (dbb->dbb_config->getTempCompression())
+			m_flags |= scb_compress;
+
 		m_dup_callback = call_back;
 		m_dup_callback_arg = user_arg;
 		m_max_records = max_records;
@@ -285,6 +308,8 @@ Sort::~Sort()
 		m_runs = run->run_next;
 		if (run->run_buff_alloc)
 			delete[] run->run_buffer;
+		delete run->run_frames;
+		delete[] run->run_unpacked;
 		delete run;
 	}
 
@@ -368,21 +393,34 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 		if ((UCHAR*) record < m_memory + m_longs ||
 			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
 		{
-			putRun(tdbb);
-			while (true)
+			if (m_max_records && !m_runs &&
+				m_max_records <= (FB_UINT64) (m_next_pointer - m_first_pointer - 1) / 2)
 			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
+				// Only the first records will be asked for and they fit
+				// into memory, so get rid of the others instead of
+				// writing a run
+
+				keepFirst(tdbb);
 			}
-			init();
+			else
+			{
+				putRun(tdbb);
+				while (true)
+				{
+					run_control* run = m_runs;
+					const USHORT depth = run->run_depth;
+					if (depth == MAX_MERGE_LEVEL)
+						break;
+					USHORT count = 1;
+					while ((run = run->run_next) && run->run_depth == depth)
+						count++;
+					if (count < m_run_group)
+						break;
+					mergeRuns(count);
+				}
+				init();
+			}
+
 			record = m_last_record;
 		}
 
@@ -563,6 +601,14 @@ void Sort::sort(thread_db* tdbb)
 
 		if (allocated < run_count)
 		{
+			// Private run buffers are limited by the share of the temp cache
+			// granted to this sort, but each run gets at least the minimum.
+
+			const ULONG missing = run_count - allocated;
+			const FB_UINT64 wanted = MIN((FB_UINT64) allocSize * missing, (FB_UINT64) MAX_ULONG);
+			const FB_SIZE_T granted = m_grant.grant(m_min_alloc_size * missing, (FB_SIZE_T) wanted);
+			allocSize = MAX(granted / missing, m_min_alloc_size);
+
 			for (run = m_runs; run; run = run->run_next)
 			{
 				if (!run->run_buffer)
@@ -1243,7 +1289,12 @@ sort_record* Sort::getMerge(merge_control* merge)
 			l = (ULONG) (run->run_end_buffer - run->run_buffer);
 			n = run->run_records * m_longs * sizeof(ULONG);
 			l = MIN(l, n);
-			run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
+			readRun(run, l);
+
+			// While the buffer is merged, let the next one be read in background
+
+			if (n > l)
+				prefetchRun(run, MIN(l, n - l));
 
 			record = reinterpret_cast<sort_record*>(run->run_buffer);
 			run->run_record =
@@ -1407,15 +1458,28 @@ void Sort::init()
 	// At this point we already allocated some memory for temp space so
 	// growing sort buffer space is not a big compared to that
 
+	// The bigger buffer is taken from the temp cache budget shared with
+	// other sorts and temp spaces, so don't grow it if there is no room.
+
 	if (m_size_memory <= m_max_alloc_size && m_runs &&
 		m_runs->run_depth == MAX_MERGE_LEVEL)
 	{
 		const ULONG mem_size = m_max_alloc_size * RUN_GROUP;
+		const FB_SIZE_T granted = m_grant.grant(0, mem_size);
+		UCHAR* mem = NULL;
 
-		try
+		if (granted == mem_size)
 		{
-			UCHAR* const mem = FB_NEW_POOL(m_owner->getPool()) UCHAR[mem_size];
+			try
+			{
+				mem = FB_NEW_POOL(m_owner->getPool()) UCHAR[mem_size];
+			}
+			catch (const BadAlloc&)
+			{} // no-op
+		}
 
+		if (mem)
+		{
 			releaseBuffer();
 
 			m_size_memory = mem_size;
@@ -1427,8 +1491,8 @@ void Sort::init()
 			for (run_control *run = m_runs; run; run = run->run_next)
 				run->run_depth--;
 		}
-		catch (const BadAlloc&)
-		{} // no-op
+		else
+			m_grant.release(granted);
 	}
 
 	m_next_pointer = m_first_pointer;
@@ -1479,7 +1543,7 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 	{
 		run->run_buffer = NULL;
 
-		UCHAR* const mem = m_space->inMemory(run->run_seek, run->run_size);
+		UCHAR* const mem = run->run_frames ? NULL : m_space->inMemory(run->run_seek, run->run_size);
 
 		if (mem)
 		{
@@ -1530,6 +1594,58 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 }
 
 
+void Sort::keepFirst(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Memory is full, but only the first m_max_records records will
+ * be asked for. Sort what we have and put the first records back
+ * into the emptied memory.
+ *
+ **************************************/
+	sortBuffer(tdbb);
+
+	const ULONG key_length = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) * sizeof(ULONG);
+
+	Array<UCHAR> kept(m_owner->getPool());
+	UCHAR* p = kept.getBuffer(m_max_records * key_length);
+	ULONG count = 0;
+
+	for (sort_record** ptr = m_first_pointer + 1; ptr < m_next_pointer && count < m_max_records; ptr++)
+	{
+		// Null pointer means the record has been eliminated as a duplicate
+		if (*ptr)
+		{
+			memcpy(p, *ptr, key_length);
+			p += key_length;
+			count++;
+		}
+	}
+
+	init();
+
+	p = kept.begin();
+	for (ULONG i = 0; i < count; i++)
+	{
+		SR* const record = NEXT_RECORD(m_last_record);
+		m_last_record = record;
+		record->sr_bckptr = m_next_pointer;
+		*m_next_pointer++ = reinterpret_cast<sort_record*>(record->sr_sort_record.sort_record_key);
+
+		memcpy(record->sr_sort_record.sort_record_key, p, key_length);
+		p += key_length;
+	}
+
+	m_records = count;
+
+	// All kept records are in the sortable form already, but the last one
+	// is transformed once again by put() or sort(), so revert it
+
+	if (count)
+		diddleKey((UCHAR*) m_last_record->sr_sort_record.sort_record_key, false, true);
+}
+
+
 void Sort::mergeRuns(USHORT n)
 {
 /**************************************
@@ -1539,11 +1655,12 @@ void Sort::mergeRuns(USHORT n)
  *
  **************************************/
 
-	// the only place we call mergeRuns with n != RUN_GROUP is SORT_sort
-	// and there n < RUN_GROUP * MAX_MERGE_LEVEL
-	merge_control blks[RUN_GROUP * MAX_MERGE_LEVEL];
+	// the only place we call mergeRuns with n != m_run_group is SORT_sort
+	// and there n < m_run_group * MAX_MERGE_LEVEL
+	fb_assert(n <= m_run_group * MAX_MERGE_LEVEL);
 
-	fb_assert((n - 1) <= FB_NELEM(blks));	// stack var big enough?
+	HalfStaticArray<merge_control, RUN_GROUP * MAX_MERGE_LEVEL> mergeBlocks(m_owner->getPool());
+	merge_control* const blks = mergeBlocks.getBuffer(n - 1);
 
 	m_longs -= SIZEOF_SR_BCKPTR_IN_LONGS;
 
@@ -1559,7 +1676,8 @@ void Sort::mergeRuns(USHORT n)
 	temp_run.run_size = 0;
 	temp_run.run_buff_alloc = false;
 
-	run_merge_hdr* streams[RUN_GROUP * MAX_MERGE_LEVEL];
+	HalfStaticArray<run_merge_hdr*, RUN_GROUP * MAX_MERGE_LEVEL> mergeStreams(m_owner->getPool());
+	run_merge_hdr** const streams = mergeStreams.getBuffer(n);
 	run_merge_hdr** m1 = streams;
 
 	sortRunsBySeek(n);
@@ -1654,9 +1772,17 @@ void Sort::mergeRuns(USHORT n)
 	CHECK_FILE(NULL);
 
 	sort_record* q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
-	FB_UINT64 seek = temp_run.run_seek = m_space->allocateSpace(temp_run.run_size);
+	const bool packed = (m_flags & scb_compress);
+	FB_UINT64 seek = 0;
 	temp_run.run_records = 0;
 
+	// Compressed run is allocated by frames while being written
+
+	if (packed)
+		temp_run.run_size = 0;
+	else
+		seek = temp_run.run_seek = m_space->allocateSpace(temp_run.run_size);
+
 	CHECK_FILE(&temp_run);
 
 	const sort_record* p;
@@ -1665,7 +1791,12 @@ void Sort::mergeRuns(USHORT n)
 		if (q >= (sort_record*) temp_run.run_end_buffer)
 		{
 			size = (UCHAR*) q - temp_run.run_buffer;
-			seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+
+			if (packed)
+				packRun(&temp_run, temp_run.run_buffer, size);
+			else
+				seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+
 			q = reinterpret_cast<sort_record*>(temp_run.run_buffer);
 		}
 		ULONG longs_count = m_longs;
@@ -1678,12 +1809,17 @@ void Sort::mergeRuns(USHORT n)
 	// Write the tail of the new run and return any unused space
 
 	if ( (size = (UCHAR*) q - temp_run.run_buffer) )
-		seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+	{
+		if (packed)
+			packRun(&temp_run, temp_run.run_buffer, size);
+		else
+			seek = writeBlock(m_space, seek, temp_run.run_buffer, size);
+	}
 
 	// If the records did not fill the allocated run (such as when duplicates are
 	// rejected), then free the remainder and diminish the size of the run accordingly
 
-	if (seek - temp_run.run_seek < temp_run.run_size)
+	if (!packed && seek - temp_run.run_seek < temp_run.run_size)
 	{
 		m_space->releaseSpace(seek, temp_run.run_seek + temp_run.run_size - seek);
 		temp_run.run_size = seek - temp_run.run_seek;
@@ -1696,11 +1832,16 @@ void Sort::mergeRuns(USHORT n)
 		// Remove run from list of in-use run blocks
 		run = m_runs;
 		m_runs = run->run_next;
-		seek = run->run_seek - run->run_size;
 
 		// Free the sort file space associated with the run
 
-		m_space->releaseSpace(seek, run->run_size);
+		if (run->run_frames)
+			releaseFrames(run);
+		else
+		{
+			seek = run->run_seek - run->run_size;
+			m_space->releaseSpace(seek, run->run_size);
+		}
 
 		if (run->run_mem_size)
 		{
@@ -1875,6 +2016,74 @@ void Sort::quick(SLONG size, SORTP** pointers, ULONG length)
 }
 
 
+void Sort::radix(SLONG size, SORTP** pointers, ULONG length, int shift)
+{
+/**************************************
+ *
+ * Distribute an array of record pointers into buckets by the byte
+ * of the first key longword at the given bit shift, starting with
+ * the most significant one (MSD radix, done in place). Big buckets
+ * are distributed further by the next byte, the others are passed
+ * to quick().
+ *
+ * Buckets are ordered by the first key longword, so neighbours of
+ * a bucket serve as its guard records when it's sorted by quick().
+ * The same final pass as after quick() is required.
+ *
+ **************************************/
+	SLONG counts[256];
+	memset(counts, 0, sizeof(counts));
+
+	for (SORTP** ptr = pointers; ptr < pointers + size; ptr++)
+		counts[(**ptr >> shift) & 0xFF]++;
+
+	SORTP** heads[256];
+	SORTP** tails[256];
+
+	SORTP** ptr = pointers;
+	for (int b = 0; b < 256; b++)
+	{
+		heads[b] = ptr;
+		ptr += counts[b];
+		tails[b] = ptr;
+	}
+
+	// Move every pointer into its bucket following permutation cycles
+
+	for (int b = 0; b < 256; b++)
+	{
+		while (heads[b] < tails[b])
+		{
+			SORTP* record = *heads[b];
+			int digit = (*record >> shift) & 0xFF;
+
+			while (digit != b)
+			{
+				SORTP* const temp = *heads[digit];
+				*heads[digit]++ = record;
+				record = temp;
+				digit = (*record >> shift) & 0xFF;
+			}
+
+			*heads[b]++ = record;
+		}
+	}
+
+	ptr = pointers;
+	for (int b = 0; b < 256; b++)
+	{
+		const SLONG count = counts[b];
+
+		if (count >= RADIX_THRESHOLD && shift > 0)
+			radix(count, ptr, length, shift - 8);
+		else if (count > 1)
+			quick(count, ptr, length);
+
+		ptr += count;
+	}
+}
+
+
 ULONG Sort::order()
 {
 /**************************************
@@ -1991,6 +2200,14 @@ void Sort::orderAndSave(thread_db* tdbb)
 	}
 
 	const ULONG key_length = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) * sizeof(ULONG);
+
+	if (m_flags & scb_compress)
+	{
+		order();
+		packRun(run, (UCHAR*) m_last_record, run->run_records * key_length);
+		return;
+	}
+
 	run->run_size = run->run_records * key_length;
 	run->run_seek = m_space->allocateSpace(run->run_size);
 
@@ -2022,6 +2239,152 @@ void Sort::orderAndSave(thread_db* tdbb)
 }
 
 
+void Sort::packRun(run_control* run, const UCHAR* data, ULONG length)
+{
+/**************************************
+ *
+ * Compress a piece of run by frames and append them to the
+ * scratch file. Space for all the frames is allocated at once
+ * after they are packed, so only their packed length is used.
+ *
+ **************************************/
+	if (!length)
+		return;
+
+	MemoryPool& pool = m_owner->getPool();
+
+	if (!run->run_frames)
+		run->run_frames = FB_NEW_POOL(pool) RunFrames(pool);
+
+	RunFrames& frames = *run->run_frames;
+	const FB_SIZE_T first = frames.getCount();
+
+	m_packed.clear();
+
+	for (ULONG offset = 0; offset < length; offset += RUN_FRAME_SIZE)
+	{
+		const ULONG frameLength = MIN(RUN_FRAME_SIZE, length - offset);
+		const Compressor dcc(pool, true, true, frameLength, data + offset);
+
+		run_frame frame;
+		frame.rfr_seek = m_packed.getCount();
+		frame.rfr_packed = dcc.getPackedLength();
+		frame.rfr_length = frameLength;
+
+		UCHAR* const output = m_packed.getBuffer(frame.rfr_seek + frame.rfr_packed) + frame.rfr_seek;
+		dcc.pack(data + offset, output);
+
+		frames.add(frame);
+	}
+
+	const ULONG size = m_packed.getCount();
+	const FB_UINT64 seek = m_space->allocateSpace(size);
+	writeBlock(m_space, seek, m_packed.begin(), size);
+
+	for (FB_SIZE_T i = first; i < frames.getCount(); i++)
+		frames[i].rfr_seek += seek;
+
+	if (!first)
+		run->run_seek = seek;
+
+	run->run_size += size;
+}
+
+
+void Sort::prefetchRun(run_control* run, ULONG length)
+{
+/**************************************
+ *
+ * Start reading the next part of the run in background.
+ * For compressed run, it's the next frame to unpack.
+ *
+ **************************************/
+	if (!run->run_frames)
+		m_space->prefetch(run->run_seek, length);
+	else if (run->run_frame < run->run_frames->getCount())
+	{
+		const run_frame& frame = (*run->run_frames)[run->run_frame];
+		m_space->prefetch(frame.rfr_seek, frame.rfr_packed);
+	}
+}
+
+
+void Sort::readRun(run_control* run, ULONG length)
+{
+/**************************************
+ *
+ * Fill the run buffer with the next part of the run. Frames of
+ * compressed run are released as soon as they are unpacked.
+ *
+ **************************************/
+	if (!run->run_frames)
+	{
+		run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, length);
+		return;
+	}
+
+	UCHAR* buffer = run->run_buffer;
+
+	while (length)
+	{
+		if (run->run_unpacked_ptr == run->run_unpacked_end)
+		{
+			fb_assert(run->run_frame < run->run_frames->getCount());
+			const run_frame& frame = (*run->run_frames)[run->run_frame++];
+
+			if (!run->run_unpacked)
+				run->run_unpacked = FB_NEW_POOL(m_owner->getPool()) UCHAR[RUN_FRAME_SIZE];
+
+			if (frame.rfr_packed < frame.rfr_length)
+			{
+				UCHAR* const packed = m_packed.getBuffer(frame.rfr_packed, false);
+				readBlock(m_space, frame.rfr_seek, packed, frame.rfr_packed);
+				Compressor::unpack(frame.rfr_packed, packed, frame.rfr_length, run->run_unpacked);
+			}
+			else
+				readBlock(m_space, frame.rfr_seek, run->run_unpacked, frame.rfr_length);
+
+			m_space->releaseSpace(frame.rfr_seek, frame.rfr_packed);
+			run->run_size -= frame.rfr_packed;
+
+			run->run_unpacked_ptr = run->run_unpacked;
+			run->run_unpacked_end = run->run_unpacked + frame.rfr_length;
+		}
+
+		const ULONG n = MIN(length, (ULONG) (run->run_unpacked_end - run->run_unpacked_ptr));
+		memcpy(buffer, run->run_unpacked_ptr, n);
+
+		run->run_unpacked_ptr += n;
+		buffer += n;
+		length -= n;
+	}
+}
+
+
+void Sort::releaseFrames(run_control* run)
+{
+/**************************************
+ *
+ * Release the scratch file space of unread frames of compressed
+ * run and the frames themselves.
+ *
+ **************************************/
+	for (FB_SIZE_T i = run->run_frame; i < run->run_frames->getCount(); i++)
+	{
+		const run_frame& frame = (*run->run_frames)[i];
+		m_space->releaseSpace(frame.rfr_seek, frame.rfr_packed);
+	}
+
+	delete run->run_frames;
+	run->run_frames = NULL;
+	run->run_frame = 0;
+	run->run_size = 0;
+
+	delete[] run->run_unpacked;
+	run->run_unpacked = run->run_unpacked_ptr = run->run_unpacked_end = NULL;
+}
+
+
 void Sort::putRun(thread_db* tdbb)
 {
 /**************************************
@@ -2081,7 +2444,10 @@ void Sort::sortBuffer(thread_db* tdbb)
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
+	if (n >= RADIX_THRESHOLD)
+		radix(n, j, m_longs, 24);
+	else
+		quick(n, j, m_longs);
 
 	// Scream through and correct any out of order pairs
 	// hvlad: don't compare user keys against high_key
@@ -2181,21 +2547,181 @@ void Sort::sortRunsBySeek(int n)
 }
 
 
+/// class PartitionedSort::MergeAhead
+
+// Merged records are copied into a ring of batches. The merging thread
+// fills free batches and the consumer returns records from the filled
+// ones, releasing every batch when it moves to the next one.
+
+class PartitionedSort::MergeAhead
+{
+	static const unsigned BATCHES = 4;
+	static const ULONG BATCH_SIZE = 256 * 1024;
+
+	struct Batch
+	{
+		UCHAR* data;
+		ULONG count;
+		bool eof;
+	};
+
+public:
+	MergeAhead(MemoryPool& pool, PartitionedSort* sort, ULONG recordLength)
+		: m_sort(sort),
+		  m_thread(pool, mergeThread),
+		  m_recordLength(recordLength),
+		  m_batchRecords(MAX(BATCH_SIZE / recordLength, 1)),
+		  m_produced(0),
+		  m_consumed(0),
+		  m_current(NULL),
+		  m_position(0),
+		  m_stop(false)
+	{
+		for (unsigned i = 0; i < BATCHES; i++)
+		{
+			m_batches[i].data = FB_NEW_POOL(pool) UCHAR[m_batchRecords * m_recordLength];
+			m_batches[i].count = 0;
+			m_batches[i].eof = false;
+		}
+
+		m_free.release(BATCHES);
+	}
+
+	~MergeAhead()
+	{
+		for (unsigned i = 0; i < BATCHES; i++)
+			delete[] m_batches[i].data;
+	}
+
+	void start()
+	{
+		m_thread.run(this);
+	}
+
+	void stop()
+	{
+		m_stop = true;
+		m_free.release(BATCHES);
+		m_thread.waitForCompletion();
+	}
+
+	sort_record* get()
+	{
+		if (!m_current || m_position == m_current->count)
+		{
+			if (m_current)
+			{
+				if (m_current->eof)
+					return NULL;
+
+				m_consumed++;
+				m_free.release();
+			}
+
+			m_ready.enter();
+			m_current = &m_batches[m_consumed % BATCHES];
+			m_position = 0;
+
+			if (m_status->getState() & IStatus::STATE_ERRORS)
+				m_status.raise();
+
+			if (!m_current->count)
+				return NULL;
+		}
+
+		return (sort_record*) (m_current->data + m_position++ * m_recordLength);
+	}
+
+	void exceptionHandler(const Exception& ex, ThreadFinishSync<MergeAhead*>::ThreadRoutine*)
+	{
+		iscLogException("Sort merge ahead thread", ex);
+	}
+
+private:
+	static void mergeThread(MergeAhead* mergeAhead)
+	{
+		mergeAhead->merge();
+	}
+
+	void merge()
+	{
+		bool eof = false;
+
+		while (!eof)
+		{
+			m_free.enter();
+
+			if (m_stop)
+				break;
+
+			Batch& batch = m_batches[m_produced++ % BATCHES];
+			batch.count = 0;
+
+			try
+			{
+				while (batch.count < m_batchRecords)
+				{
+					const sort_record* const record = m_sort->getNext();
+
+					if (!record)
+					{
+						eof = true;
+						break;
+					}
+
+					memcpy(batch.data + batch.count++ * m_recordLength, record, m_recordLength);
+				}
+			}
+			catch (const Exception& ex)
+			{
+				ex.stuffException(&m_status);
+				batch.count = 0;
+				eof = true;
+			}
+
+			batch.eof = eof;
+			m_ready.release();
+		}
+	}
+
+	PartitionedSort* const m_sort;
+	ThreadFinishSync<MergeAhead*> m_thread;
+	Semaphore m_free;					// batches to be filled
+	Semaphore m_ready;					// batches to be consumed
+	Batch m_batches[BATCHES];
+	FbLocalStatus m_status;				// merge error, if any
+	const ULONG m_recordLength;
+	const ULONG m_batchRecords;
+	ULONG m_produced;
+	ULONG m_consumed;
+	Batch* m_current;
+	ULONG m_position;
+	volatile bool m_stop;
+};
+
+
 /// class PartitionedSort
 
 
-PartitionedSort::PartitionedSort(Database* dbb, SortOwner* owner) :
+PartitionedSort::PartitionedSort(Database* dbb, SortOwner* owner, bool ownParts) :
 	m_owner(owner),
+	m_ownParts(ownParts),
 	m_parts(owner->getPool()),
 	m_nodes(owner->getPool()),
-	m_merge(NULL)
+	m_merge(NULL),
+	m_mergeAhead(NULL)
 {
 }
 
 PartitionedSort::~PartitionedSort()
 {
-//	for (ULONG p = 0; p < m_parts.getCount(); p++)
-//		delete m_parts[p].srt_sort;
+	stopMergeAhead();
+
+	if (m_ownParts)
+	{
+		for (ULONG p = 0; p < m_parts.getCount(); p++)
+			delete m_parts[p].srt_sort;
+	}
 }
 
 void PartitionedSort::buildMergeTree()
@@ -2253,14 +2779,40 @@ void PartitionedSort::buildMergeTree()
 		m_merge->mrg_header.rmh_parent = NULL;
 }
 
-void PartitionedSort::get(thread_db* tdbb, ULONG** record_address)
+void PartitionedSort::startMergeAhead()
 {
-	sort_record* record = NULL;
+	if (m_mergeAhead || m_parts.isEmpty())
+		return;
+
+	const Sort* const sort = m_parts[0].srt_sort;
+	const ULONG recordLength = sort->m_longs * sizeof(ULONG) - SIZEOF_SR_BCKPTR;
+
+	m_mergeAhead = FB_NEW_POOL(m_owner->getPool())
+		MergeAhead(m_owner->getPool(), this, recordLength);
+	m_mergeAhead->start();
+}
+
+void PartitionedSort::stopMergeAhead()
+{
+	if (m_mergeAhead)
+	{
+		m_mergeAhead->stop();
+		delete m_mergeAhead;
+		m_mergeAhead = NULL;
+	}
+}
 
+sort_record* PartitionedSort::getNext()
+{
 	if (!m_merge)
-		record = m_parts[0].srt_sort->getRecord();
-	else
-		record = getMerge();
+		return m_parts[0].srt_sort->getRecord();
+
+	return getMerge();
+}
+
+void PartitionedSort::get(thread_db* tdbb, ULONG** record_address)
+{
+	sort_record* const record = m_mergeAhead ? m_mergeAhead->get() : getNext();
 
 	*record_address = (ULONG*)record;
 
@@ -2369,7 +2921,7 @@ sort_record* PartitionedSort::getMerge()
 		if (l == 0 && aSort->m_dup_callback)
 		{
 			UCHAR* rec_a = (UCHAR*)merge->mrg_record_a;
-			UCHAR* rec_b = (UCHAR*)merge->mrg_record_a;
+			UCHAR* rec_b = (UCHAR*)merge->mrg_record_b;
 
 			aSort->diddleKey(rec_a, false, true);
 			aSort->diddleKey(rec_b, false, true);
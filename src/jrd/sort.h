@@ -225,6 +225,17 @@ const int RMH_TYPE_MRG	= 1;
 const int RMH_TYPE_SORT = 2;
 
 
+// Packed frame of a compressed run
+
+struct run_frame
+{
+	FB_UINT64		rfr_seek;			// Offset of frame in work file
+	ULONG			rfr_packed;			// Length of frame in work file
+	ULONG			rfr_length;			// Unpacked length of frame
+};
+
+typedef Firebird::Array<run_frame> RunFrames;
+
 // Run control block
 
 struct run_control
@@ -242,6 +253,11 @@ struct run_control
 	bool			run_buff_cache;		// run buffer is already in cache
 	FB_UINT64		run_mem_seek;		// position of run's buffer in in-memory part of sort file
 	ULONG			run_mem_size;		// size of run's buffer in in-memory part of sort file
+	RunFrames*		run_frames;			// ALLOC: frames of compressed run
+	FB_SIZE_T		run_frame;			// Next frame to read
+	UCHAR*			run_unpacked;		// ALLOC: last read frame, unpacked
+	UCHAR*			run_unpacked_ptr;	// Next unread byte of unpacked frame
+	UCHAR*			run_unpacked_end;	// End of unpacked frame
 };
 
 // Merge control block
@@ -272,6 +288,7 @@ typedef bool (*FPTR_REJECT_DUP_CALLBACK)(const UCHAR*, const UCHAR*, void*);
 
 const int scb_sorted		= 1;	// stream has been sorted
 const int scb_reuse_buffer	= 2;	// reuse buffer if possible
+const int scb_compress		= 4;	// compress runs written to scratch file
 
 class Sort
 {
@@ -314,10 +331,15 @@ private:
 	sort_record* getRecord();
 	ULONG allocate(ULONG, ULONG, bool);
 	void init();
+	void keepFirst(Jrd::thread_db*);
 	void mergeRuns(USHORT);
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
+	void packRun(run_control*, const UCHAR*, ULONG);
 	void putRun(Jrd::thread_db*);
+	void prefetchRun(run_control*, ULONG);
+	void readRun(run_control*, ULONG);
+	void releaseFrames(run_control*);
 	void sortBuffer(Jrd::thread_db*);
 	void sortRunsBySeek(int);
 
@@ -326,6 +348,7 @@ private:
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG);
+	static void radix(SLONG, SORTP**, ULONG, int);
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -339,7 +362,7 @@ private:
 	ULONG m_key_length;							// Key length
 	ULONG m_unique_length;						// Unique key length, used when duplicates eliminated
 	FB_UINT64 m_records;						// Number of records
-	FB_UINT64 m_max_records;					// Maximum number of records to store, assigned but unused.
+	FB_UINT64 m_max_records;					// Maximum number of records to return, if known
 	TempSpace* m_space;							// temporary space for scratch file
 	run_control* m_runs;						// ALLOC: Run on scratch file, if any
 	merge_control* m_merge;						// Top level merge block
@@ -351,15 +374,18 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	USHORT m_run_group;							// Number of runs merged at once
 
 	Firebird::Array<sort_key_def> m_description;
+	Firebird::Array<UCHAR> m_packed;			// Buffer for packed frames of runs
+	TempMemoryGrant m_grant;					// Share of the temp cache used by private buffers
 };
 
 
 class PartitionedSort
 {
 public:
-	PartitionedSort(Database*, SortOwner*);
+	PartitionedSort(Database*, SortOwner*, bool ownParts = false);
 	~PartitionedSort();
 
 	void get(Jrd::thread_db*, ULONG**);
@@ -376,13 +402,24 @@ public:
 
 	void buildMergeTree();
 
+	// Merge partitions by a separate thread ahead of get() calls, so that
+	// the merge overlaps the processing of the records already merged.
+	// Merge ahead must be stopped before partitions are destroyed.
+	void startMergeAhead();
+	void stopMergeAhead();
+
 private:
+	class MergeAhead;
+
+	sort_record* getNext();
 	sort_record* getMerge();
 
 	SortOwner* m_owner;
+	const bool m_ownParts;				// partitions are deleted together with the merge
 	Firebird::HalfStaticArray<sort_control, 8> m_parts;
 	Firebird::HalfStaticArray<merge_control, 8> m_nodes;	// nodes of merge tree
 	merge_control* m_merge;				// root of merge tree
+	MergeAhead* m_mergeAhead;			// merging thread, if started
 };
 
 
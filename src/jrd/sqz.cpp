@@ -25,6 +25,7 @@
 #include <string.h>
 #include "../jrd/sqz.h"
 #include "../jrd/req.h"
+#include "../jrd/ods.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
 
@@ -47,6 +48,14 @@ using namespace Jrd;
 // they do not compress much but increase total number of runs thus affecting decompression speed.
 // Starting from Firebird v5, we don't compress runs shorter than 8 bytes. But this rule is not
 // set in stone, so let's not use lenghts between 4 and 7 bytes as some other special markers.
+//
+// Runs of length 3 are never stored since Firebird v5, but older engines wrote them into
+// ODS 13.0 databases which may be upgraded to ODS 13.1 and later in place. So only in databases
+// created with ODS 13.2 (see hdr_extended_storage) length -3 is used as a marker of the
+// repetition of some prior bytes of the same fragment (LZ77 style match), if the
+// LZRecordCompression setting is on:
+//
+// {-3, two-byte distance back from the current output position, one-byte length - 8}
 
 namespace
 {
@@ -58,13 +67,105 @@ namespace
 	const int MAX_MEDIUM_RUN = MAX_USHORT;	// 2^16
 	const int MAX_LONG_RUN = MAX_SLONG;		// 2^31
 
+	const unsigned MIN_MATCH = 8;					// minimal length of repeated prior bytes
+	const unsigned MAX_MATCH = MIN_MATCH + MAX_UCHAR;	// 263
+	const unsigned MAX_MATCH_DISTANCE = MAX_USHORT;
+	const unsigned MATCH_SIZE = 1 + sizeof(USHORT) + 1;	// marker, distance, length
+
+	// Number of slots in the match finder. It doesn't depend on the input length, so
+	// the leading part of the input is compressed the same way as the whole input.
+	const unsigned HASH_SIZE = 1024;
+
 	inline int adjustRunLength(unsigned length)
 	{
 		return (length <= MAX_SHORT_RUN) ? 0 :
 			(length <= MAX_MEDIUM_RUN) ? sizeof(USHORT) : sizeof(ULONG);
 	}
+
+	// Word at a time helpers of the run detection
+
+	const FB_UINT64 LOW_BITS = 0x0101010101010101ULL;
+	const FB_UINT64 HIGH_BITS = 0x8080808080808080ULL;
+
+	inline FB_UINT64 loadWord(const UCHAR* data)
+	{
+		FB_UINT64 word;
+		memcpy(&word, data, sizeof(word));
+		return word;
+	}
+
+	inline bool hasZeroByte(FB_UINT64 word)
+	{
+		return ((word - LOW_BITS) & ~word & HIGH_BITS) != 0;
+	}
+
+	// Check if three equal bytes start at any of eight positions, ten bytes are read
+	inline bool hasTriple(const UCHAR* data)
+	{
+		const auto x = loadWord(data);
+		const auto y = loadWord(data + 1);
+		const auto z = loadWord(data + 2);
+
+		return hasZeroByte((x ^ y) | (y ^ z));
+	}
+
+	inline bool isMatchRun(int run)
+	{
+		return run > MAX_NONCOMP_RUN;
+	}
+
+	inline unsigned hashBytes(const UCHAR* data, unsigned mask)
+	{
+		const ULONG value = data[0] | (data[1] << 8) | (data[2] << 16) | ((ULONG) data[3] << 24);
+		return (value * 2654435761u >> 16) & mask;
+	}
 };
 
+bool Compressor::matchesAllowed(thread_db* tdbb)
+{
+	// See the compression scheme description above
+	return tdbb->getDatabase()->dbb_flags & DBB_extended_storage;
+}
+
+unsigned Compressor::runLength(int run) const
+{
+	// Number of input bytes represented by the run
+	return isMatchRun(run) ? m_matches[run - MAX_NONCOMP_RUN - 1].length : abs(run);
+}
+
+bool Compressor::findMatch(const UCHAR* input, const UCHAR* data, const UCHAR* end,
+						   HashTable& hashTable, Match& match)
+{
+	// Look for the prior bytes equal to the ones at the given position,
+	// then remember this position for the following lookups
+
+	if (end - data < (int) MIN_MATCH)
+		return false;
+
+	const auto slot = hashBytes(data, hashTable.getCount() - 1);
+	const auto prior = hashTable[slot];
+	hashTable[slot] = (ULONG) (data - input) + 1;
+
+	if (!prior)
+		return false;
+
+	const auto candidate = input + prior - 1;
+	const auto distance = data - candidate;
+
+	if (distance > (int) MAX_MATCH_DISTANCE || memcmp(candidate, data, MIN_MATCH))
+		return false;
+
+	const auto max = MIN(end - data, (int) MAX_MATCH);
+	unsigned length = MIN_MATCH;
+
+	while ((int) length < max && candidate[length] == data[length])
+		length++;
+
+	match.distance = (USHORT) distance;
+	match.length = (USHORT) length;
+	return true;
+}
+
 unsigned Compressor::nonCompressableRun(unsigned length)
 {
 	fb_assert(length && length <= MAX_NONCOMP_RUN);
@@ -98,21 +199,34 @@ Compressor::Compressor(thread_db* tdbb, ULONG length, const UCHAR* data)
 		tdbb->getDatabase()->getEncodedOdsVersion() >= ODS_13_1,
 		tdbb->getDatabase()->getEncodedOdsVersion() >= ODS_13_1,
 		length,
-		data)
+		data,
+		matchesAllowed(tdbb) && tdbb->getDatabase()->dbb_config->getLZRecordCompression())
 {
 }
 
-Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data)
+Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data,
+					   bool allowMatches)
 	: m_runs(pool),
+	  m_matches(pool),
 	  m_allowLongRuns(allowLongRuns),
-	  m_allowUnpacked(allowUnpacked)
+	  m_allowUnpacked(allowUnpacked),
+	  m_allowMatches(allowMatches && allowLongRuns)
 {
 	const auto end = data + length;
 	const auto input = data;
 
+	// Positions of the prior input bytes by the hash value of their leading bytes
+
+	HashTable hashTable(pool);
+
+	if (m_allowMatches)
+		hashTable.grow(HASH_SIZE);
+
 	while (auto count = end - data)
 	{
 		auto start = data;
+		Match match;
+		bool matched = false;
 
 		// Find length of non-compressable run
 
@@ -122,12 +236,28 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 			fb_assert(max > 1);
 
 			do {
+				// Skip eight positions at once unless a compressable run may start there
+
+				if (max >= 9 && hashTable.isEmpty() && !hasTriple(data))
+				{
+					data += sizeof(FB_UINT64);
+					max -= sizeof(FB_UINT64) - 1;
+					continue;
+				}
+
 				if (data[0] == data[1] && data[0] == data[2])
 				{
 					count = data - start;
 					break;
 				}
 
+				if (hashTable.hasData() && findMatch(input, data, end, hashTable, match))
+				{
+					count = data - start;
+					matched = true;
+					break;
+				}
+
 				data++;
 
 			} while (--max > 1);
@@ -144,6 +274,17 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 			count -= max;
 		}
 
+		// Store the repetition of the prior bytes
+
+		if (matched)
+		{
+			m_runs.add(MAX_NONCOMP_RUN + 1 + (int) m_matches.getCount());
+			m_matches.add(match);
+			m_length += MATCH_SIZE;
+			data += match.length;
+			continue;
+		}
+
 		// Find a compressable run which is long enough.
 		// Avoid compressing too short runs, this badly affects decompression speed.
 
@@ -154,15 +295,19 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 
 		start = data;
 		const auto c = *data;
+		const auto pattern = c * LOW_BITS;
 
-		do
+		while (max >= (int) sizeof(FB_UINT64) && loadWord(data) == pattern)
 		{
-			if (*data != c)
-				break;
+			data += sizeof(FB_UINT64);
+			max -= sizeof(FB_UINT64);
+		}
 
+		while (max && *data == c)
+		{
 			++data;
-
-		} while (--max);
+			--max;
+		}
 
 		count = data - start;
 
@@ -227,7 +372,17 @@ void Compressor::pack(const UCHAR* input, UCHAR* output) const
 
 	for (const auto length : m_runs)
 	{
-		if (length < 0)
+		if (isMatchRun(length))
+		{
+			const auto& match = m_matches[length - MAX_NONCOMP_RUN - 1];
+
+			*output++ = (UCHAR) -3;
+			put_short(output, match.distance);
+			output += sizeof(USHORT);
+			*output++ = (UCHAR) (match.length - MIN_MATCH);
+			input += match.length;
+		}
+		else if (length < 0)
 		{
 			const auto zipLength = (unsigned) -length;
 
@@ -291,7 +446,15 @@ ULONG Compressor::truncate(ULONG outLength)
 		if (--space <= 0)
 			break;
 
-		if (length < 0)
+		if (isMatchRun(length))
+		{
+			if ((space -= MATCH_SIZE - 1) < 0)
+				break;
+
+			m_length += MATCH_SIZE;
+			inLength += runLength(length);
+		}
+		else if (length < 0)
 		{
 			const auto zipLength = (unsigned) -length;
 			const auto runLength = 1 + adjustRunLength(zipLength);
@@ -363,7 +526,15 @@ ULONG Compressor::truncateTail(ULONG outLength)
 
 		auto length = m_runs.back();
 
-		if (length < 0)
+		if (isMatchRun(length))
+		{
+			if ((space -= MATCH_SIZE - 1) < 0)
+				break;
+
+			m_length -= MATCH_SIZE;
+			inLength += runLength(length);
+		}
+		else if (length < 0)
 		{
 			const auto zipLength = (unsigned) -length;
 			const auto runLength = 1 + adjustRunLength(zipLength);
@@ -402,7 +573,7 @@ ULONG Compressor::truncateTail(ULONG outLength)
 		// Check whether the remaining part is still compressible
 		ULONG orgLength = 0;
 		for (const auto run : m_runs)
-			orgLength += abs(run);
+			orgLength += runLength(run);
 
 		if (m_length >= orgLength)
 		{
@@ -414,7 +585,7 @@ ULONG Compressor::truncateTail(ULONG outLength)
 	return inLength;
 }
 
-ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
+ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input, bool allowMatches)
 {
 /**************************************
  *
@@ -428,7 +599,15 @@ ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
 	{
 		const int length = (signed char) *input++;
 
-		if (length < 0)
+		if (length == -3 && allowMatches)
+		{
+			if (input + MATCH_SIZE - 1 > end)
+				return 0; // decompression error
+
+			input += sizeof(USHORT);
+			result += *input++ + MIN_MATCH;
+		}
+		else if (length < 0)
 		{
 			auto zipLength = (unsigned) -length;
 
@@ -460,7 +639,7 @@ ULONG Compressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
 }
 
 UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
-						  ULONG outLength, UCHAR* output)
+						  ULONG outLength, UCHAR* output, bool allowMatches)
 {
 /**************************************
  *
@@ -468,14 +647,79 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
  *	Return the address where the output stopped.
  *
  **************************************/
+	return decompress(inLength, input, outLength, output, allowMatches, false);
+}
+
+UCHAR* Compressor::unpackPrefix(ULONG inLength, const UCHAR* input,
+								ULONG outLength, UCHAR* output, bool allowMatches)
+{
+/**************************************
+ *
+ *	Decompress the leading part of a compressed string into a buffer,
+ *	stopping as soon as the buffer is filled.
+ *	Return the address where the output stopped.
+ *
+ **************************************/
+	return decompress(inLength, input, outLength, output, allowMatches, true);
+}
+
+UCHAR* Compressor::decompress(ULONG inLength, const UCHAR* input,
+							  ULONG outLength, UCHAR* output, bool allowMatches, bool prefix)
+{
 	const auto end = input + inLength;
+	const auto output_start = output;
 	const auto output_end = output + outLength;
 
+	// Check whether the given number of bytes fits the buffer, if only the prefix
+	// is requested then cut the number down to the rest of the buffer instead
+
+	const auto fits = [&](unsigned& count)
+	{
+		if (output + count > output_end)
+		{
+			if (!prefix)
+				return false;
+
+			count = output_end - output;
+		}
+
+		return true;
+	};
+
 	while (input < end)
 	{
+		if (prefix && output == output_end)
+			break;
+
 		const int length = (signed char) *input++;
 
-		if (length < 0)
+		if (length == -3 && allowMatches)
+		{
+			if (input + MATCH_SIZE - 1 > end)
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			const unsigned distance = get_short(input);
+			input += sizeof(USHORT);
+			unsigned zipLength = *input++ + MIN_MATCH;
+
+			if (!distance || distance > (ULONG) (output - output_start) || !fits(zipLength))
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			// The repeated bytes may overlap the output, copy them one by one then
+			const UCHAR* from = output - distance;
+
+			if (distance >= zipLength)
+			{
+				memcpy(output, from, zipLength);
+				output += zipLength;
+			}
+			else
+			{
+				for (unsigned i = 0; i < zipLength; i++)
+					*output++ = *from++;
+			}
+		}
+		else if (length < 0)
 		{
 			auto zipLength = (unsigned) -length;
 
@@ -490,7 +734,7 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 				input += sizeof(ULONG);
 			}
 
-			if (input >= end || output + zipLength > output_end)
+			if (input >= end || !fits(zipLength))
 				BUGCHECK(179);	// msg 179 decompression overran buffer
 
 			const auto c = *input++;
@@ -499,11 +743,13 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 		}
 		else
 		{
-			if (input + length > end || output + length > output_end)
+			unsigned copyLength = length;
+
+			if (input + length > end || !fits(copyLength))
 				BUGCHECK(179);	// msg 179 decompression overran buffer
 
-			memcpy(output, input, length);
-			output += length;
+			memcpy(output, input, copyLength);
+			output += copyLength;
 			input += length;
 		}
 	}
@@ -35,7 +35,8 @@ namespace Jrd
 	{
 	public:
 		Compressor(thread_db* tdbb, ULONG length, const UCHAR* data);
-		Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data);
+		Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked, ULONG length, const UCHAR* data,
+				   bool allowMatches = false);
 
 		ULONG getPackedLength() const
 		{
@@ -51,19 +52,39 @@ namespace Jrd
 		ULONG truncate(ULONG outLength);
 		ULONG truncateTail(ULONG outLength);
 
-		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input);
+		static bool matchesAllowed(thread_db* tdbb);
+
+		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input, bool allowMatches = false);
 		static UCHAR* unpack(ULONG inLength, const UCHAR* input,
-							 ULONG outLength, UCHAR* output);
+							 ULONG outLength, UCHAR* output, bool allowMatches = false);
+		static UCHAR* unpackPrefix(ULONG inLength, const UCHAR* input,
+								   ULONG outLength, UCHAR* output, bool allowMatches = false);
 
 	private:
+		// Repetition of the prior input bytes
+		struct Match
+		{
+			USHORT distance;
+			USHORT length;
+		};
+
+		typedef Firebird::HalfStaticArray<ULONG, 1024> HashTable;
+
 		unsigned nonCompressableRun(unsigned length);
+		static bool findMatch(const UCHAR* input, const UCHAR* data, const UCHAR* end,
+							  HashTable& hashTable, Match& match);
+		unsigned runLength(int run) const;
+		static UCHAR* decompress(ULONG inLength, const UCHAR* input,
+								 ULONG outLength, UCHAR* output, bool allowMatches, bool prefix);
 
 		Firebird::HalfStaticArray<int, 256> m_runs;
+		Firebird::HalfStaticArray<Match, 16> m_matches;	// referenced by runs above MAX_NONCOMP_RUN
 		ULONG m_length = 0;
 
 		// Compatibility options
 		bool m_allowLongRuns = true;
 		bool m_allowUnpacked = true;
+		bool m_allowMatches = false;
 	};
 
 	class Difference
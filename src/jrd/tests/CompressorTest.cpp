@@ -1,5 +1,6 @@
 #include "firebird.h"
 #include "boost/test/unit_test.hpp"
+#include "../common/classes/fb_string.h"
 #include "../jrd/sqz.h"
 
 using namespace Firebird;
@@ -33,6 +34,86 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(PackAndUnpackMatchesTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const UCHAR data[] = "{\"name\": \"first\", \"value\": 1}, {\"name\": \"second\", \"value\": 2}";
+	const auto dataLength = sizeof(data) - 1;
+	const Compressor dcc(pool, true, true, dataLength, data, true);
+
+	const auto packedLength = dcc.getPackedLength();
+	BOOST_TEST(packedLength < dataLength);
+
+	Array<UCHAR> packBuffer;
+	dcc.pack(data, packBuffer.getBuffer(packedLength, false));
+
+	Array<UCHAR> unpackBuffer;
+	unpackBuffer.getBuffer(Compressor::getUnpackedLength(packBuffer.getCount(), packBuffer.begin(), true), false);
+	BOOST_TEST(unpackBuffer.getCount() == dataLength);
+
+	BOOST_TEST(dcc.unpack(packBuffer.getCount(), packBuffer.begin(),
+		unpackBuffer.getCount(), unpackBuffer.begin(), true) == unpackBuffer.end());
+
+	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(TruncateTailMatchesTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	string data, item;
+	for (unsigned i = 0; data.length() < 2000; i++)
+	{
+		item.printf("{\"id\": %u, \"state\": \"active\"}, ", i * 7919 % 1000);
+		data += item;
+	}
+
+	const auto input = reinterpret_cast<const UCHAR*>(data.c_str());
+	const ULONG dataLength = data.length();
+
+	// Leading part left after truncation must be compressed the same way as on its own,
+	// store_big_record() relies on it
+
+	const ULONG outLengths[] = {100, 500, 1000};
+
+	for (const auto outLength : outLengths)
+	{
+		Compressor dcc(pool, true, true, dataLength, input, true);
+		const auto tailLength = dcc.truncateTail(outLength);
+
+		const Compressor leadDcc(pool, true, true, dataLength - tailLength, input, true);
+		BOOST_TEST(leadDcc.getPackedLength() == dcc.getPackedLength());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(UnpackPrefixTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const UCHAR data[] = "111111111123456777777";
+	const auto dataLength = sizeof(data) - 1;
+	const Compressor dcc(pool, false, false, dataLength, data);
+
+	const auto packedLength = dcc.getPackedLength();
+	Array<UCHAR> packBuffer;
+	dcc.pack(data, packBuffer.getBuffer(packedLength, false));
+
+	// Stop inside the leading run, inside the literal and inside the trailing run
+
+	const ULONG prefixLengths[] = {5, 13, 18, dataLength};
+
+	for (const auto prefixLength : prefixLengths)
+	{
+		UCHAR unpackBuffer[sizeof(data)];
+
+		BOOST_TEST(dcc.unpackPrefix(packBuffer.getCount(), packBuffer.begin(),
+			prefixLength, unpackBuffer) == unpackBuffer + prefixLength);
+
+		BOOST_TEST(memcmp(data, unpackBuffer, prefixLength) == 0);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
@@ -0,0 +1,99 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/UtilSvc.h"
+#include "../common/classes/TempFile.h"
+#include "../common/classes/auto.h"
+#include "../common/os/guid.h"
+#include "../jrd/ods.h"
+#include "../utilities/nbackup/nbk_proto.h"
+#include <stdio.h>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(NBackupSuite)
+
+
+namespace
+{
+	const USHORT PAGE_SIZE = 8192;
+
+	// Level 0 backup of a database with page checksums, as copied while the
+	// database was locked: just the header page, checksummed by the engine
+	void writeLevel0(const PathName& fileName)
+	{
+		UCHAR buffer[PAGE_SIZE];
+		memset(buffer, 0, sizeof(buffer));
+
+		Ods::header_page* const header = reinterpret_cast<Ods::header_page*>(buffer);
+		header->hdr_header.pag_type = pag_header;
+		header->hdr_header.pag_checksum = 0x1234;
+		header->hdr_page_size = PAGE_SIZE;
+		header->hdr_ods_version = ODS_VERSION13 | ODS_FIREBIRD_FLAG;
+		header->hdr_ods_minor = ODS_CURRENT13;
+		header->hdr_flags = Ods::hdr_nbak_stalled | Ods::hdr_extended_storage;
+
+		Guid guid;
+		GenerateGuid(&guid);
+
+		UCHAR* p = header->hdr_data;
+		*p++ = Ods::HDR_backup_guid;
+		*p++ = sizeof(guid);
+		memcpy(p, &guid, sizeof(guid));
+		p += sizeof(guid);
+		*p = Ods::HDR_end;
+		header->hdr_end = p - buffer;
+
+		FILE* const file = fopen(fileName.c_str(), "wb");
+		BOOST_REQUIRE(file);
+		BOOST_REQUIRE(fwrite(buffer, 1, sizeof(buffer), file) == sizeof(buffer));
+		fclose(file);
+	}
+
+	void readHeader(const PathName& fileName, Ods::header_page* header)
+	{
+		FILE* const file = fopen(fileName.c_str(), "rb");
+		BOOST_REQUIRE(file);
+		BOOST_REQUIRE(fread(header, 1, HDR_SIZE, file) == HDR_SIZE);
+		fclose(file);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(NBackupTests)
+
+BOOST_AUTO_TEST_CASE(RestoreResetsChecksumTest)
+{
+	const PathName backupName = TempFile::create("fb_nbk_");
+	writeLevel0(backupName);
+
+	// nbackup creates the database file itself
+	const PathName databaseName = TempFile::create("fb_nbk_");
+	remove(databaseName.c_str());
+
+	char program[] = "nbackup";
+	char restore[] = "-R";
+	char* argv[] = {program, restore,
+		const_cast<char*>(databaseName.c_str()), const_cast<char*>(backupName.c_str())};
+
+	// Attaching the restored database fails as it has no pages but the header.
+	// The header is fixed up before that and must be accepted by the engine.
+	AutoPtr<UtilSvc> uSvc(UtilSvc::createStandalone(FB_NELEM(argv), argv));
+	NBACKUP_main(uSvc);
+
+	Ods::header_page header;
+	readHeader(databaseName, &header);
+
+	BOOST_TEST((header.hdr_flags & Ods::hdr_backup_mask) == Ods::hdr_nbak_normal);
+	BOOST_TEST((header.hdr_flags & Ods::hdr_extended_storage) != 0);
+	BOOST_TEST(header.hdr_header.pag_checksum == 0);
+
+	remove(databaseName.c_str());
+	remove(backupName.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// NBackupTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// NBackupSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
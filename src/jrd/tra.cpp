@@ -1532,14 +1532,21 @@ void TRA_set_state(thread_db* tdbb, jrd_tra* transaction, TraNumber number, int
 	CCH_MARK(tdbb, &window);
 	const ULONG generation = tip->tip_header.pag_generation;
 #else
-	if (!(dbb->dbb_flags & DBB_shared) || !transaction  ||
-		(transaction->tra_flags & TRA_write) ||
+	bool groupCommit = false;
+
+	if (!(dbb->dbb_flags & DBB_shared) || !transaction ||
 		old_state != tra_active || state != tra_committed)
 	{
 		CCH_MARK_MUST_WRITE(tdbb, &window);
 	}
 	else
+	{
+		// The TIP is lazily updated for read-only transactions. Commits of
+		// update transactions share the single write of the page (group commit).
+
 		CCH_MARK(tdbb, &window);
+		groupCommit = (transaction->tra_flags & TRA_write);
+	}
 #endif
 
 	// set the state on the TIP page
@@ -1552,8 +1559,34 @@ void TRA_set_state(thread_db* tdbb, jrd_tra* transaction, TraNumber number, int
 	if (dbb->dbb_tip_cache)
 		TPC_set_state(tdbb, number, state);
 
+#ifndef SUPERSERVER_V2
+	// The page is marked by us, so it cannot be written since then
+	// until we release it. Any write that follows carries our state.
+
+	const ULONG generation = tip->tip_header.pag_generation;
+#endif
+
 	CCH_RELEASE(tdbb, &window);
 
+#ifndef SUPERSERVER_V2
+	if (groupCommit)
+	{
+		// Exit the engine to allow concurrent commits to update the TIP too
+		// (or to finish the write in progress), then use page generation
+		// to determine if the page was already written by someone else.
+
+		{ // scope
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+			Thread::yield();
+		}
+
+		tip = reinterpret_cast<tx_inv_page*>(CCH_FETCH(tdbb, &window, LCK_write, pag_transactions));
+		if (generation == tip->tip_header.pag_generation)
+			CCH_MARK_MUST_WRITE(tdbb, &window);
+		CCH_RELEASE(tdbb, &window);
+	}
+#endif
+
 #ifdef SUPERSERVER_V2
 	// Let the TIP be lazily updated for read-only queries.
 	// To amortize write of TIP page for update transactions,
@@ -1630,7 +1663,14 @@ int TRA_snapshot_state(thread_db* tdbb, const jrd_tra* trans, TraNumber number,
 
 	if (TipCache* tip_cache = dbb->dbb_tip_cache)
 	{
-		stateCn = tip_cache->snapshotState(tdbb, number);
+		if (!att->att_tra_states.get(number, stateCn))
+		{
+			stateCn = tip_cache->snapshotState(tdbb, number);
+
+			if (stateCn != CN_ACTIVE && stateCn != CN_LIMBO)
+				att->att_tra_states.put(number, stateCn);
+		}
+
 		switch (stateCn)
 		{
 			case CN_ACTIVE:
@@ -3592,51 +3632,6 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 				tdbb, attachment->att_attachment_id, trans->tra_snapshot_number);
 		}
 
-		// Next task is to find the oldest active transaction on the system.  This
-		// is needed for garbage collection.  Things are made ever so slightly
-		// more complicated by the fact that existing transaction may have oldest
-		// actives older than they are.
-
-		Lock temp_lock(tdbb, sizeof(TraNumber), LCK_tra, trans);
-
-		trans->tra_oldest_active = number;
-		oldest_active = number;
-		bool cleanup = !(number % TRA_ACTIVE_CLEANUP);
-		int oldest_state;
-
-		for (; active < number; active++)
-		{
-			//oldest_state = TPC_cache_state(tdbb, active);
-			const ULONG mask = (1 << tra_active);
-			active = TPC_find_states(tdbb, active, number, mask, oldest_state);
-			if (!active)
-			{
-				active = number;
-				break;
-			}
-			fb_assert(oldest_state == tra_active);
-
-			if (oldest_state == tra_active)
-			{
-				temp_lock.setKey(active);
-				TraNumber data = LCK_read_data(tdbb, &temp_lock);
-				if (!data)
-				{
-					if (cleanup)
-					{
-						if (TRA_wait(tdbb, trans, active, jrd_tra::tra_no_wait) == tra_committed)
-							cleanup = false;
-						continue;
-					}
-
-					data = active;
-				}
-
-				oldest_active = active;
-				break;
-			}
-		}
-
 		// Calculate attachment-local oldest active and oldest snapshot numbers
 		// looking at current attachment's transactions only. Calculated values
 		// are used to determine garbage collection threshold for attachment-local
@@ -3658,80 +3653,139 @@ static void transaction_start(thread_db* tdbb, jrd_tra* trans)
 		if (attachment->att_oldest_snapshot < att_oldest_snapshot)
 			attachment->att_oldest_snapshot = att_oldest_snapshot;
 
-		// Put the TID of the oldest active transaction (just calculated)
-		// in the new transaction's lock.
-		// hvlad: for read-committed transaction put tra_number to prevent
-		// unnecessary blocking of garbage collection by read-committed
-		// transactions
+		// Read-only read committed transactions don't need to know exactly the oldest
+		// active and the oldest interesting transactions. Let them use the values
+		// already known for the database and leave the bookkeeping (which scans TIP
+		// cache and the lock table) to other transactions. This makes start of such
+		// transactions, often used for short reads, much cheaper.
 
-		const TraNumber lck_data = ((trans->tra_flags & TRA_read_committed) &&
-			!(trans->tra_flags & TRA_read_consistency)) ? number : oldest_active;
-
-		static_assert(sizeof(lock->lck_data) == sizeof(lck_data), "Check lock data type !");
-		if (lock->lck_data != (SINT64) lck_data)
-			LCK_write_data(tdbb, lock, lck_data);
+		if ((trans->tra_flags & TRA_readonly) && (trans->tra_flags & TRA_read_committed) &&
+			dbb->dbb_oldest_snapshot)
+		{
+			trans->tra_oldest_active = MIN(dbb->dbb_oldest_snapshot, number);
+		}
+		else
+		{
+			// Next task is to find the oldest active transaction on the system.  This
+			// is needed for garbage collection.  Things are made ever so slightly
+			// more complicated by the fact that existing transaction may have oldest
+			// actives older than they are.
 
-		// Query the minimum lock data for all active transaction locks.
-		// This will be the oldest active snapshot used for regulating garbage collection.
+			Lock temp_lock(tdbb, sizeof(TraNumber), LCK_tra, trans);
 
-		const TraNumber data = LCK_query_data(tdbb, LCK_tra, LCK_MIN);
-		if (data && data < trans->tra_oldest_active)
-			trans->tra_oldest_active = data;
+			trans->tra_oldest_active = number;
+			oldest_active = number;
+			bool cleanup = !(number % TRA_ACTIVE_CLEANUP);
+			int oldest_state;
 
-		// Finally, scan transactions looking for the oldest interesting transaction -- the oldest
-		// non-commited transaction.  This will not be updated immediately, but saved until the
-		// next update access to the header page
+			for (; active < number; active++)
+			{
+				//oldest_state = TPC_cache_state(tdbb, active);
+				const ULONG mask = (1 << tra_active);
+				active = TPC_find_states(tdbb, active, number, mask, oldest_state);
+				if (!active)
+				{
+					active = number;
+					break;
+				}
+				fb_assert(oldest_state == tra_active);
 
-		oldest_state = tra_committed;
+				if (oldest_state == tra_active)
+				{
+					temp_lock.setKey(active);
+					TraNumber data = LCK_read_data(tdbb, &temp_lock);
+					if (!data)
+					{
+						if (cleanup)
+						{
+							if (TRA_wait(tdbb, trans, active, jrd_tra::tra_no_wait) == tra_committed)
+								cleanup = false;
+							continue;
+						}
+
+						data = active;
+					}
 
-		for (oldest = trans->tra_oldest; oldest < number; oldest++)
-		{
-			//oldest_state = TPC_cache_state(tdbb, oldest);
-			const ULONG mask = ~((1 << tra_committed) | (1 << tra_precommitted));
-			oldest = TPC_find_states(tdbb, trans->tra_oldest, number, mask, oldest_state);
-			if (!oldest)
-			{
-				oldest = number;
-				break;
+					oldest_active = active;
+					break;
+				}
 			}
-			fb_assert(oldest_state != tra_committed && oldest_state != tra_precommitted);
 
-			if (oldest_state != tra_committed && oldest_state != tra_precommitted)
-				break;
-		}
+			// Put the TID of the oldest active transaction (just calculated)
+			// in the new transaction's lock.
+			// hvlad: for read-committed transaction put tra_number to prevent
+			// unnecessary blocking of garbage collection by read-committed
+			// transactions
 
-		if (oldest > number && dbb->dbb_flags & DBB_read_only)
-			oldest = number;
+			const TraNumber lck_data = ((trans->tra_flags & TRA_read_committed) &&
+				!(trans->tra_flags & TRA_read_consistency)) ? number : oldest_active;
 
-		if (--oldest > dbb->dbb_oldest_transaction)
-			dbb->dbb_oldest_transaction = oldest;
+			static_assert(sizeof(lock->lck_data) == sizeof(lck_data), "Check lock data type !");
+			if (lock->lck_data != (SINT64) lck_data)
+				LCK_write_data(tdbb, lock, lck_data);
 
-		if (oldest_active > dbb->dbb_oldest_active)
-			dbb->dbb_oldest_active = oldest_active;
+			// Query the minimum lock data for all active transaction locks.
+			// This will be the oldest active snapshot used for regulating garbage collection.
 
-		if (trans->tra_oldest_active > dbb->dbb_oldest_snapshot)
-		{
-			dbb->dbb_oldest_snapshot = trans->tra_oldest_active;
+			const TraNumber data = LCK_query_data(tdbb, LCK_tra, LCK_MIN);
+			if (data && data < trans->tra_oldest_active)
+				trans->tra_oldest_active = data;
 
-			if (!(dbb->dbb_flags & DBB_gc_active) && (dbb->dbb_flags & DBB_gc_background))
+			// Finally, scan transactions looking for the oldest interesting transaction -- the oldest
+			// non-commited transaction.  This will not be updated immediately, but saved until the
+			// next update access to the header page
+
+			oldest_state = tra_committed;
+
+			for (oldest = trans->tra_oldest; oldest < number; oldest++)
 			{
-				dbb->dbb_flags |= DBB_gc_pending;
-				dbb->dbb_gc_sem.release();
+				//oldest_state = TPC_cache_state(tdbb, oldest);
+				const ULONG mask = ~((1 << tra_committed) | (1 << tra_precommitted));
+				oldest = TPC_find_states(tdbb, trans->tra_oldest, number, mask, oldest_state);
+				if (!oldest)
+				{
+					oldest = number;
+					break;
+				}
+				fb_assert(oldest_state != tra_committed && oldest_state != tra_precommitted);
+
+				if (oldest_state != tra_committed && oldest_state != tra_precommitted)
+					break;
 			}
-		}
 
-		// Release TPC shared memory if counters moved sufficently forward
-		dbb->dbb_tip_cache->updateOldestTransaction(tdbb,
-			dbb->dbb_oldest_transaction, dbb->dbb_oldest_snapshot);
+			if (oldest > number && dbb->dbb_flags & DBB_read_only)
+				oldest = number;
 
-		// If the transaction block is getting out of hand, force a sweep
+			if (--oldest > dbb->dbb_oldest_transaction)
+				dbb->dbb_oldest_transaction = oldest;
 
-		if (dbb->dbb_sweep_interval &&
-			(trans->tra_oldest_active > oldest) &&
-			(trans->tra_oldest_active - oldest > dbb->dbb_sweep_interval) &&
-			oldest_state != tra_limbo)
-		{
-			start_sweeper(tdbb);
+			if (oldest_active > dbb->dbb_oldest_active)
+				dbb->dbb_oldest_active = oldest_active;
+
+			if (trans->tra_oldest_active > dbb->dbb_oldest_snapshot)
+			{
+				dbb->dbb_oldest_snapshot = trans->tra_oldest_active;
+
+				if (!(dbb->dbb_flags & DBB_gc_active) && (dbb->dbb_flags & DBB_gc_background))
+				{
+					dbb->dbb_flags |= DBB_gc_pending;
+					dbb->dbb_gc_sem.release();
+				}
+			}
+
+			// Release TPC shared memory if counters moved sufficently forward
+			dbb->dbb_tip_cache->updateOldestTransaction(tdbb,
+				dbb->dbb_oldest_transaction, dbb->dbb_oldest_snapshot);
+
+			// If the transaction block is getting out of hand, force a sweep
+
+			if (dbb->dbb_sweep_interval &&
+				(trans->tra_oldest_active > oldest) &&
+				(trans->tra_oldest_active - oldest > dbb->dbb_sweep_interval) &&
+				oldest_state != tra_limbo)
+			{
+				start_sweeper(tdbb);
+			}
 		}
 
 		// Start a 'transaction-level' savepoint, unless this is the
@@ -146,6 +146,17 @@ FB_SIZE_T TraceLog::write(const void* buf, FB_SIZE_T size)
 
 	fb_assert(!m_reader);
 
+	// Flags are checked once more under the mutex below, but while the log is
+	// full or nobody reads it there is no reason to make writers queue for it
+
+	const ULONG flags = ((volatile TraceLogHeader*) m_sharedMemory->getHeader())->flags;
+
+	if (flags & FLAG_DONE)
+		return size;
+
+	if (flags & FLAG_FULL)
+		return 0;
+
 	TraceLogGuard guard(this);
 
 	TraceLogHeader* header = m_sharedMemory->getHeader();
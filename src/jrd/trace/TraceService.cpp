@@ -287,7 +287,8 @@ void TraceSvcJrd::readSession(TraceSession& session)
 	MemoryPool& pool = *getDefaultMemoryPool();
 	AutoPtr<TraceLog> log(FB_NEW_POOL(pool) TraceLog(pool, session.ses_logfile, true));
 
-	UCHAR buff[1024];
+	// Read as much as possible at once, writers wait for the same mutex
+	UCHAR buff[MAX_USHORT];
 	int flags = session.ses_flags;
 	while (!m_svc.finished() && checkAliveAndFlags(session.ses_id, flags))
 	{
@@ -67,17 +67,82 @@ struct impure_state
 
 struct impure_value
 {
+	// Matchers compiled for the most recently used patterns of a node, in MRU order
 	struct PatternMatcherCache : pool_alloc_rpt<UCHAR>
 	{
+		static const unsigned MAX_ENTRIES = 8;
+
 		PatternMatcherCache(ULONG aKeySize)
 			: keySize(aKeySize)
 		{
 		}
 
+		template <typename Create>
+		static Jrd::PatternMatcher* get(MemoryPool& pool, PatternMatcherCache*& head, USHORT ttype,
+			const UCHAR* patternStr, ULONG patternLen, const UCHAR* escapeStr, ULONG escapeLen, Create create)
+		{
+			PatternMatcherCache** link = &head;
+			PatternMatcherCache** lastLink = nullptr;
+			unsigned count = 0;
+
+			for (PatternMatcherCache* entry; (entry = *link); link = &entry->next)
+			{
+				if (entry->ttype == ttype &&
+					entry->patternLen == patternLen &&
+					entry->escapeLen == escapeLen &&
+					memcmp(entry->key, patternStr, patternLen) == 0 &&
+					memcmp(entry->key + patternLen, escapeStr, escapeLen) == 0)
+				{
+					*link = entry->next;
+					entry->next = head;
+					head = entry;
+
+					entry->matcher->reset();
+					return entry->matcher;
+				}
+
+				lastLink = link;
+				++count;
+			}
+
+			Firebird::AutoPtr<Jrd::PatternMatcher> matcher(create());
+
+			// Reuse the least recently used entry when the cache is full
+			PatternMatcherCache* entry = nullptr;
+
+			if (count >= MAX_ENTRIES)
+			{
+				entry = *lastLink;
+				*lastLink = nullptr;
+
+				if (entry->keySize < patternLen + escapeLen)
+				{
+					delete entry;
+					entry = nullptr;
+				}
+			}
+
+			if (!entry)
+				entry = FB_NEW_RPT(pool, patternLen + escapeLen) PatternMatcherCache(patternLen + escapeLen);
+
+			entry->ttype = ttype;
+			entry->patternLen = patternLen;
+			entry->escapeLen = escapeLen;
+			memcpy(entry->key, patternStr, patternLen);
+			memcpy(entry->key + patternLen, escapeStr, escapeLen);
+			entry->matcher = matcher.release();
+
+			entry->next = head;
+			head = entry;
+
+			return entry->matcher;
+		}
+
 		ULONG keySize;
 		USHORT ttype;
 		USHORT patternLen;
 		Firebird::AutoPtr<Jrd::PatternMatcher> matcher;
+		PatternMatcherCache* next = nullptr;
 		USHORT escapeLen;
 		UCHAR key[1];
 	};
@@ -116,6 +181,8 @@ struct impure_value
 	void make_double(const double val);
 	void make_decimal128(const Firebird::Decimal128 val);
 	void make_decimal_fixed(const Firebird::Int128 val, const signed char scale);
+
+	UCHAR* getString(MemoryPool& pool, USHORT length);
 };
 
 // Do not use these methods where dsc_sub_type is not explicitly set to zero.
@@ -169,6 +236,31 @@ inline void impure_value::make_decimal_fixed(const Firebird::Int128 val, const s
 	this->vlu_desc.dsc_address = reinterpret_cast<UCHAR*>(&this->vlu_misc.vlu_int128);
 }
 
+// Return a string buffer of at least the given length. The buffer lives in the
+// request impure area and is reused by subsequent executions of the request.
+// When it has to be replaced, it grows at least twice to not reallocate it each
+// time a slightly longer value is evaluated.
+inline UCHAR* impure_value::getString(MemoryPool& pool, USHORT length)
+{
+	USHORT capacity = length;
+
+	if (vlu_string && vlu_string->str_length < length)
+	{
+		capacity = MAX(length, (USHORT) MIN(2 * (ULONG) vlu_string->str_length, (ULONG) MAX_USHORT));
+
+		delete vlu_string;
+		vlu_string = NULL;
+	}
+
+	if (!vlu_string)
+	{
+		vlu_string = FB_NEW_RPT(pool, capacity) VaryingString();
+		vlu_string->str_length = capacity;
+	}
+
+	return vlu_string->str_data;
+}
+
 struct impure_value_ex : public impure_value
 {
 	SINT64 vlux_count;
@@ -2610,6 +2610,23 @@ Validation::RTN Validation::walk_pointer_page(jrd_rel* relation, ULONG sequence)
 	USHORT slot = 0;
 	for (ULONG* pages = page->ppg_page; slot < page->ppg_count; slot++, pages++, seq++)
 	{
+		// Read ahead next data pages of the pointer page, like table scan does
+
+		if (dbb->dbb_prefetch_pages && !(slot % dbb->dbb_prefetch_sequence))
+		{
+			ULONG prefetch[MAX_READ_AHEAD_PAGES];
+			FB_SIZE_T count = 0;
+
+			for (USHORT slot2 = slot + 1;
+				 count < dbb->dbb_prefetch_pages && slot2 < page->ppg_count; slot2++)
+			{
+				if (page->ppg_page[slot2])
+					prefetch[count++] = page->ppg_page[slot2];
+			}
+
+			CCH_PREFETCH(vdr_tdbb, prefetch, count);
+		}
+
 		if (*pages)
 		{
 			UCHAR new_pp_bits = 0;
@@ -2797,8 +2814,10 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		length -= offsetof(rhd, rhd_data[0]);
 	}
 
+	const bool matches = Compressor::matchesAllowed(vdr_tdbb);
+
 	ULONG record_length = (header->rhd_flags & rhd_not_packed) ?
-		length : Compressor::getUnpackedLength(length, p);
+		length : Compressor::getUnpackedLength(length, p, matches);
 
 	// Next, chase down fragments, if any
 
@@ -2851,7 +2870,7 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		}
 
 		record_length += (fragment->rhdf_flags & rhd_not_packed) ?
-			length : Compressor::getUnpackedLength(length, p);
+			length : Compressor::getUnpackedLength(length, p, matches);
 
 		page_number = fragment->rhdf_f_page;
 		line_number = fragment->rhdf_f_line;
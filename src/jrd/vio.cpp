@@ -87,6 +87,7 @@
 #include "../jrd/Function.h"
 #include "../common/StatusArg.h"
 #include "../jrd/GarbageCollector.h"
+#include "../jrd/RangeSummary.h"
 #include "../jrd/ProfilerManager.h"
 #include "../jrd/trace/TraceManager.h"
 #include "../jrd/trace/TraceJrdHelpers.h"
@@ -108,6 +109,7 @@ static void expunge(thread_db*, record_param*, const jrd_tra*, ULONG);
 static bool dfw_should_know(thread_db*, record_param* org_rpb, record_param* new_rpb,
 	USHORT irrelevant_field, bool void_update_is_relevant = false);
 static void garbage_collect(thread_db*, record_param*, ULONG, RecordStack&);
+static bool gc_data_page(thread_db*, record_param*, jrd_tra*, ULONG);
 
 
 #ifdef VIO_DEBUG
@@ -185,6 +187,52 @@ static void verb_post(thread_db*, jrd_tra*, record_param*, Record*);
 namespace Jrd
 {
 
+// Keeps the rate of data pages read by a sweep below SweepPageRate
+
+class SweepThrottle
+{
+public:
+	SweepThrottle(thread_db* tdbb, unsigned workers)
+		: m_rate(tdbb->getDatabase()->dbb_config->getSweepPageRate()),
+		  m_workers(workers),
+		  m_pages(0),
+		  m_lastPage(0),
+		  m_start(fb_utils::query_performance_counter())
+	{}
+
+	void check(thread_db* tdbb, ULONG page)
+	{
+		if (!m_rate || page == m_lastPage)
+			return;
+
+		m_lastPage = page;
+
+		if (++m_pages % CHECK_PAGES)
+			return;
+
+		const SINT64 elapsed = (fb_utils::query_performance_counter() - m_start) * 1000 /
+			fb_utils::query_performance_frequency();
+		const SINT64 expected = (SINT64) m_pages * m_workers * 1000 / m_rate;
+
+		if (expected > elapsed)
+		{
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+			Thread::sleep((unsigned) MIN(expected - elapsed, MAX_SLEEP));
+		}
+	}
+
+private:
+	static const unsigned CHECK_PAGES = 16;		// pages read between checks
+	static const SINT64 MAX_SLEEP = 1000;		// ms
+
+	const ULONG m_rate;
+	const unsigned m_workers;
+	ULONG m_pages;
+	ULONG m_lastPage;
+	const SINT64 m_start;
+};
+
+
 class SweepTask : public Task
 {
 	struct RelInfo; // forward decl
@@ -463,6 +511,8 @@ bool SweepTask::handler(WorkItem& _item)
 			lastRecNo.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, item->m_lastPP + 1);
 			lastRecNo.decrement();
 
+			SweepThrottle throttle(tdbb, getMaxWorkers());
+
 			while (VIO_next_record(tdbb, &rpb, tran, NULL, DPM_next_pointer_page))
 			{
 				CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
@@ -477,6 +527,7 @@ bool SweepTask::handler(WorkItem& _item)
 					break;
 
 				JRD_reschedule(tdbb);
+				throttle.check(tdbb, rpb.rpb_page);
 
 				tran->tra_oldest_active = dbb->dbb_oldest_snapshot;
 			}
@@ -570,7 +621,8 @@ bool SweepTask::getWorkItem(WorkItem** pItem)
 
 namespace
 {
-	inline UCHAR* unpack(record_param* rpb, ULONG outLength, UCHAR* output)
+	inline UCHAR* unpack(thread_db* tdbb, record_param* rpb, ULONG outLength, UCHAR* output,
+		bool prefix = false)
 	{
 		if (rpb->rpb_flags & rpb_not_packed)
 		{
@@ -581,7 +633,7 @@ namespace
 			memcpy(output, rpb->rpb_address, length);
 			output += length;
 
-			if (rpb->rpb_length > length)
+			if (rpb->rpb_length > length && !prefix)
 			{
 				// Short records may be zero-padded up to the fragmented header size.
 				// Take it into account while checking for a possible buffer overrun.
@@ -599,7 +651,39 @@ namespace
 			return output;
 		}
 
-		return Compressor::unpack(rpb->rpb_length, rpb->rpb_address, outLength, output);
+		if (prefix)
+		{
+			return Compressor::unpackPrefix(rpb->rpb_length, rpb->rpb_address, outLength, output,
+				Compressor::matchesAllowed(tdbb));
+		}
+
+		return Compressor::unpack(rpb->rpb_length, rpb->rpb_address, outLength, output,
+			Compressor::matchesAllowed(tdbb));
+	}
+
+	// Return the length of the record prefix containing the given number of leading fields,
+	// or the full record length if the prefix cannot be used
+
+	ULONG getPrefixLength(const record_param* rpb, const Format* format)
+	{
+		const auto count = MIN(rpb->rpb_field_count, format->fmt_count);
+
+		// Delta versions are applied to the whole prior record
+
+		if (!count || (rpb->rpb_flags & (rpb_chained | rpb_delta)))
+			return format->fmt_length;
+
+		ULONG length = FLAG_BYTES(format->fmt_count);
+
+		for (USHORT id = 0; id < count; id++)
+		{
+			const auto& desc = format->fmt_desc[id];
+
+			if (desc.dsc_dtype)
+				length = MAX(length, (ULONG) (IPTR) desc.dsc_address + desc.dsc_length);
+		}
+
+		return MIN(length, format->fmt_length);
 	}
 };
 
@@ -1155,10 +1239,14 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 		rpb->rpb_f_page, rpb->rpb_f_line);
 #endif
 
-	CommitNumber current_snapshot_number;
+	CommitNumber current_snapshot_number = CN_ACTIVE;
 	bool int_gc_done = (attachment->att_flags & ATT_no_cleanup);
 
-	int state = TRA_snapshot_state(tdbb, transaction, rpb->rpb_transaction_nr, &current_snapshot_number);
+	// Records of swept data pages are committed and visible to every snapshot,
+	// don't bother the TIP cache about them
+
+	int state = (rpb->rpb_runtime_flags & RPB_all_visible) ? tra_committed :
+		TRA_snapshot_state(tdbb, transaction, rpb->rpb_transaction_nr, &current_snapshot_number);
 
 	// Reset (if appropriate) the garbage collect active flag to reattempt the backout
 
@@ -1804,6 +1892,11 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 	// Primary record version not uses prior version
 	Record* prior = (rpb->rpb_flags & rpb_chained) ? rpb->rpb_prior : nullptr;
 
+	// If the stream accesses only the leading fields, don't decompress the rest of the record
+
+	const ULONG expected = getPrefixLength(rpb, format);
+	const bool prefix = (expected < format->fmt_length);
+
 	if (prior)
 	{
 		tail = difference.getData();
@@ -1815,7 +1908,7 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 	else
 	{
 		tail = record->getData();
-		tail_end = tail + record->getLength();
+		tail_end = tail + expected;
 	}
 
 	// Set up prior record point for next version
@@ -1824,7 +1917,7 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	// Snarf data from record
 
-	tail = unpack(rpb, tail_end - tail, tail);
+	tail = unpack(tdbb, rpb, tail_end - tail, tail, prefix);
 
 	RuntimeStatistics::Accumulator fragments(tdbb, relation, RuntimeStatistics::RECORD_FRAGMENT_READS);
 
@@ -1834,10 +1927,10 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 		const USHORT back_line = rpb->rpb_b_line;
 		const USHORT save_flags = rpb->rpb_flags;
 
-		while (rpb->rpb_flags & rpb_incomplete)
+		while ((rpb->rpb_flags & rpb_incomplete) && !(prefix && tail == tail_end))
 		{
 			DPM_fetch_fragment(tdbb, rpb, LCK_read);
-			tail = unpack(rpb, tail_end - tail, tail);
+			tail = unpack(tdbb, rpb, tail_end - tail, tail, prefix);
 			++fragments;
 		}
 
@@ -1860,12 +1953,12 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 		length = tail - record->getData();
 	}
 
-	if (format->fmt_length != length)
+	if (expected != length)
 	{
 #ifdef VIO_DEBUG
 		VIO_trace(DEBUG_WRITES,
 			"VIO_data (record_param %" QUADFORMAT"d, length %d expected %d)\n",
-			rpb->rpb_number.getValue(), length, format->fmt_length);
+			rpb->rpb_number.getValue(), length, expected);
 
 		VIO_trace(DEBUG_WRITES_INFO,
 			"   record  %" SLONGFORMAT":%d, rpb_trans %" SQUADFORMAT
@@ -3293,6 +3386,10 @@ bool VIO_modify(thread_db* tdbb, record_param* org_rpb, record_param* new_rpb, j
 	if (transaction->tra_flags & TRA_system)
 	{
 		VIO_update_in_place(tdbb, transaction, org_rpb, new_rpb);
+
+		if (const auto summaries = tdbb->getDatabase()->dbb_range_summaries)
+			summaries->recordChanged(tdbb, relation, org_rpb->rpb_number, new_rpb->rpb_record);
+
 		tdbb->bumpRelStats(RuntimeStatistics::RECORD_UPDATES, relation->rel_id);
 		return true;
 	}
@@ -3647,6 +3744,9 @@ bool VIO_modify(thread_db* tdbb, record_param* org_rpb, record_param* new_rpb, j
 		IDX_modify_flag_uk_modified(tdbb, org_rpb, new_rpb, transaction);
 		VIO_update_in_place(tdbb, transaction, org_rpb, new_rpb);
 
+		if (const auto summaries = tdbb->getDatabase()->dbb_range_summaries)
+			summaries->recordChanged(tdbb, relation, org_rpb->rpb_number, new_rpb->rpb_record);
+
 		if (!(transaction->tra_flags & TRA_system) &&
 			transaction->tra_save_point && transaction->tra_save_point->isChanging())
 		{
@@ -3680,6 +3780,9 @@ bool VIO_modify(thread_db* tdbb, record_param* org_rpb, record_param* new_rpb, j
 
 	replace_record(tdbb, org_rpb, &stack, transaction);
 
+	if (const auto summaries = tdbb->getDatabase()->dbb_range_summaries)
+		summaries->recordChanged(tdbb, relation, org_rpb->rpb_number, new_rpb->rpb_record);
+
 	if (!(transaction->tra_flags & TRA_system) &&
 		transaction->tra_save_point && transaction->tra_save_point->isChanging())
 	{
@@ -4294,6 +4397,9 @@ void VIO_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 	rpb->rpb_record->pushPrecedence(PageNumber(TRANS_PAGE_SPACE, rpb->rpb_transaction_nr));
 	DPM_store(tdbb, rpb, rpb->rpb_record->getPrecedence(), DPM_primary);
 
+	if (const auto summaries = tdbb->getDatabase()->dbb_range_summaries)
+		summaries->recordChanged(tdbb, relation, rpb->rpb_number, rpb->rpb_record);
+
 #ifdef VIO_DEBUG
 	VIO_trace(DEBUG_WRITES_INFO,
 		"   record  %" SLONGFORMAT":%d, rpb_trans %" SQUADFORMAT
@@ -4407,6 +4513,8 @@ bool VIO_sweep(thread_db* tdbb, jrd_tra* transaction, TraceSweepEvent* traceSwee
 					gc->sweptRelation(transaction->tra_oldest_active, relation->rel_id);
 				}
 
+				SweepThrottle throttle(tdbb, 1);
+
 				while (VIO_next_record(tdbb, &rpb, transaction, 0, DPM_next_all))
 				{
 					CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
@@ -4415,6 +4523,7 @@ bool VIO_sweep(thread_db* tdbb, jrd_tra* transaction, TraceSweepEvent* traceSwee
 						break;
 
 					JRD_reschedule(tdbb);
+					throttle.check(tdbb, rpb.rpb_page);
 
 					transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
 					if (TipCache* cache = dbb->dbb_tip_cache)
@@ -4905,7 +5014,7 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 			tail_end = tail + record->getLength();
 		}
 
-		tail = unpack(rpb, tail_end - tail, tail);
+		tail = unpack(tdbb, rpb, tail_end - tail, tail);
 		rpb->rpb_prior = (rpb->rpb_flags & rpb_delta) ? record : nullptr;
 	}
 
@@ -4968,7 +5077,7 @@ static UCHAR* delete_tail(thread_db* tdbb,
 			BUGCHECK(248);		// msg 248 cannot find record fragment
 
 		if (tail)
-			tail = unpack(rpb, tail_end - tail, tail);
+			tail = unpack(tdbb, rpb, tail_end - tail, tail);
 
 		DPM_delete(tdbb, rpb, prior_page);
 		prior_page = rpb->rpb_page;
@@ -5217,6 +5326,342 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+static bool gc_data_page(thread_db* tdbb, record_param* rpb, jrd_tra* transaction, ULONG dp_sequence)
+{
+/**************************************
+ *
+ *	g c _ d a t a _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Attempt to garbage collect all records on the data page.
+ *	Return false if garbage collection of the relation
+ *	(or at all) should be stopped.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	jrd_rel* const relation = rpb->rpb_relation;
+
+	rpb->rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
+	const RecordNumber last(rpb->rpb_number.getValue() + dbb->dbb_max_records);
+
+	bool ret = true;
+
+	while (VIO_next_record(tdbb, rpb, transaction, NULL, DPM_next_data_page))
+	{
+		CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
+
+		if (!(dbb->dbb_flags & DBB_garbage_collector) ||
+			(relation->rel_flags & (REL_deleting | REL_gc_disabled)))
+		{
+			ret = false;
+			break;
+		}
+
+		JRD_reschedule(tdbb);
+
+		if (rpb->rpb_number >= last)
+			break;
+
+		// Refresh our notion of the oldest transactions for
+		// efficient garbage collection. This is very cheap.
+
+		transaction->tra_oldest = dbb->dbb_oldest_transaction;
+		transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+	}
+
+	if (TipCache* cache = dbb->dbb_tip_cache)
+		cache->updateActiveSnapshots(tdbb, &tdbb->getAttachment()->att_active_snapshots);
+
+	return ret;
+}
+
+
+namespace Jrd
+{
+
+// Garbage collect the data pages of a relation by a few workers in parallel.
+// The first work item uses the attachment and transaction of the garbage
+// collector thread, others use worker attachments with their own transactions.
+
+class GCTask : public Task
+{
+public:
+	// Number of data pages a worker handles before it takes the next portion of work
+	static const ULONG PAGES_PER_ITEM = 16;
+
+	GCTask(thread_db* tdbb, MemoryPool* pool, USHORT relID, PageBitmap* pages, int workers) :
+		Task(),
+		m_pool(pool),
+		m_dbb(tdbb->getDatabase()),
+		m_items(*m_pool),
+		m_stop(false),
+		m_relID(relID),
+		m_pages(pages)
+	{
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+		m_items[0]->m_ownAttach = false;
+		m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		m_items[0]->m_tra = tdbb->getTransaction();
+	}
+
+	virtual ~GCTask()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(GCTask* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_ownAttach(true),
+			m_tra(NULL),
+			m_attFlags(0),
+			m_pages(*task->m_pool)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_ownAttach || !m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+
+				att->att_flags = (att->att_flags & ~(ATT_garbage_collector | ATT_notify_gc)) | m_attFlags;
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		GCTask* getGCTask() const
+		{
+			return reinterpret_cast<GCTask*> (m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+
+			Attachment* att = NULL;
+
+			if (m_ownAttach && !m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, getGCTask()->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				Arg::Gds(isc_bad_db_handle).copyTo(status);
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (m_ownAttach && !m_tra)
+			{
+				// Act as the garbage collector itself, i.e. collect garbage
+				// rather than notify the garbage collector about it
+
+				m_attFlags = att->att_flags & (ATT_garbage_collector | ATT_notify_gc);
+				att->att_flags = (att->att_flags & ~ATT_notify_gc) | ATT_garbage_collector;
+
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+				}
+				catch(const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			tdbb->markAsSweeper();
+
+			return true;
+		}
+
+		bool m_inuse;
+		bool m_ownAttach;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		ULONG m_attFlags;
+
+		// part of work: data page sequences to garbage collect
+		Array<ULONG> m_pages;
+	};
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers()
+	{
+		return m_items.getCount();
+	}
+
+private:
+	void setError(IStatus* status)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS)
+			m_status.save(status);
+
+		m_stop = true;
+	}
+
+	MemoryPool* m_pool;
+	Database* m_dbb;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	volatile bool m_stop;
+	const USHORT m_relID;
+	PageBitmap* const m_pages;	// data pages not handled yet
+};
+
+
+bool GCTask::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		// Give the pages back to other workers, the first one never fails here
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		for (const auto dp_sequence : item->m_pages)
+			m_pages->set(dp_sequence);
+
+		item->m_pages.clear();
+		return false;
+	}
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	record_param rpb;
+
+	try
+	{
+		jrd_rel* const relation = MET_lookup_relation_id(tdbb, m_relID, false);
+
+		if (relation && !(relation->rel_flags & (REL_deleted | REL_deleting)))
+		{
+			jrd_rel::GCShared gcGuard(tdbb, relation);
+
+			if (gcGuard.gcEnabled())
+			{
+				rpb.rpb_relation = relation;
+				rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+				rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+
+				for (const auto dp_sequence : item->m_pages)
+				{
+					if (m_stop || !gc_data_page(tdbb, &rpb, item->m_tra, dp_sequence))
+					{
+						m_stop = true;
+						break;
+					}
+				}
+			}
+			else
+				m_stop = true;
+		}
+		else
+			m_stop = true;
+
+		delete rpb.rpb_record;
+		item->m_pages.clear();
+
+		return !m_stop;
+	}
+	catch(const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		delete rpb.rpb_record;
+	}
+
+	item->m_pages.clear();
+	setError(tdbb->tdbb_status_vector);
+	return false;
+}
+
+bool GCTask::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		{
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+		}
+
+		if (!item)
+			return false;
+	}
+
+	// Assign next portion of data pages to the item
+
+	while (!m_stop && item->m_pages.getCount() < PAGES_PER_ITEM && m_pages->getFirst())
+	{
+		const ULONG dp_sequence = m_pages->current();
+		m_pages->clear(dp_sequence);
+		item->m_pages.add(dp_sequence);
+	}
+
+	if (item->m_pages.hasData())
+		return true;
+
+	item->m_inuse = false;
+	return false;
+}
+
+} // namespace Jrd
+
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -5260,6 +5705,14 @@ void Database::garbage_collector(Database* dbb)
 
 		AutoPtr<GarbageCollector> gc(FB_NEW_POOL(*attachment->att_pool) GarbageCollector(
 			*attachment->att_pool, dbb));
+		Array<UCHAR> gc_keys(*attachment->att_pool);
+
+		// Workers are kept between relations to not start threads every time
+
+		const int gc_workers = dbb->dbb_config->getGCWorkers();
+		AutoPtr<Coordinator> coord;
+		if (gc_workers > 1)
+			coord = FB_NEW_POOL(*attachment->att_pool) Coordinator(attachment->att_pool);
 
 		try
 		{
@@ -5330,6 +5783,37 @@ void Database::garbage_collector(Database* dbb)
 
 						rpb.rpb_relation = relation;
 
+						if (!transaction && gc_bitmap->getFirst())
+						{
+							// Start a "precommitted" transaction by using read-only,
+							// read committed. Of particular note is the absence of a
+							// transaction lock which means the transaction does not
+							// inhibit garbage collection by its very existence.
+
+							transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+							tdbb->setTransaction(transaction);
+						}
+
+						if (coord && gc_bitmap->getFirst())
+						{
+							// Let a few workers share the data pages of the relation
+
+							found = flush = true;
+
+							GCTask task(tdbb, attachment->att_pool, relID, gc_bitmap, gc_workers);
+							{
+								EngineCheckout cout(tdbb, FB_FUNCTION);
+								coord->runSync(&task);
+							}
+
+							FbLocalStatus task_status;
+							if (!task.getResult(&task_status))
+								iscDbLogStatus(dbb->dbb_filename.c_str(), &task_status);
+
+							if (!(dbb->dbb_flags & DBB_garbage_collector))
+								gc_exit = true;
+						}
+
 						while (gc_bitmap->getFirst())
 						{
 							const ULONG dp_sequence = gc_bitmap->current();
@@ -5345,64 +5829,13 @@ void Database::garbage_collector(Database* dbb)
 
 							gc_bitmap->clear(dp_sequence);
 
-							if (!transaction)
-							{
-								// Start a "precommitted" transaction by using read-only,
-								// read committed. Of particular note is the absence of a
-								// transaction lock which means the transaction does not
-								// inhibit garbage collection by its very existence.
-
-								transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
-								tdbb->setTransaction(transaction);
-							}
-
 							found = flush = true;
-							rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
-							const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
 
-							// Attempt to garbage collect all records on the data page.
-
-							bool rel_exit = false;
-
-							while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
+							if (!gc_data_page(tdbb, &rpb, transaction, dp_sequence))
 							{
-								CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
-
-								if (!(dbb->dbb_flags & DBB_garbage_collector))
-								{
-									gc_exit = true;
-									break;
-								}
-
-								if (relation->rel_flags & REL_deleting)
-								{
-									rel_exit = true;
-									break;
-								}
-
-								if (relation->rel_flags & REL_gc_disabled)
-								{
-									rel_exit = true;
-									break;
-								}
-
-								JRD_reschedule(tdbb);
-
-								if (rpb.rpb_number >= last)
-									break;
-
-								// Refresh our notion of the oldest transactions for
-								// efficient garbage collection. This is very cheap.
-
-								transaction->tra_oldest = dbb->dbb_oldest_transaction;
-								transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
-							}
-
-							if (TipCache* cache = dbb->dbb_tip_cache)
-								cache->updateActiveSnapshots(tdbb, &attachment->att_active_snapshots);
-
-							if (gc_exit || rel_exit)
+								gc_exit = !(dbb->dbb_flags & DBB_garbage_collector);
 								break;
+							}
 						}
 
 						if (gc_exit)
@@ -5413,6 +5846,25 @@ void Database::garbage_collector(Database* dbb)
 					}
 				}
 
+				// Remove the garbage index keys queued by user attachments.
+				// Keys of a relation being deleted are not needed anymore.
+
+				if (gc->getIndexKeys(relID, gc_keys))
+				{
+					relation = MET_lookup_relation_id(tdbb, relID, false);
+
+					if (relation && !(relation->rel_flags & (REL_deleted | REL_deleting)))
+					{
+						jrd_rel::GCShared gcGuard(tdbb, relation);
+
+						if (gcGuard.gcEnabled())
+						{
+							IDX_garbage_collect_keys(tdbb, relation, gc_keys.begin(), gc_keys.getCount());
+							found = flush = true;
+						}
+					}
+				}
+
 				// If there's more work to do voluntarily ask to be rescheduled.
 				// Otherwise, wait for event notification.
 
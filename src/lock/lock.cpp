@@ -178,7 +178,8 @@ LockManager::LockManager(const string& id, const Config* conf)
 	  m_config(conf),
 	  m_acquireSpins(m_config->getLockAcquireSpins()),
 	  m_memorySize(m_config->getLockMemSize()),
-	  m_useBlockingThread(m_config->getServerMode() != MODE_SUPER)
+	  m_useBlockingThread(m_config->getServerMode() != MODE_SUPER),
+	  m_walkedRequests(getPool())
 #ifdef USE_SHMEM_EXT
 	  , m_extents(getPool())
 #endif
@@ -461,6 +462,9 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	if (!owner_offset)
 		return 0;
 
+	// Hash the lock key before acquiring the lock table mutex
+	const ULONG hash = InternalHash::hash(length, value);
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	own* owner = (own*) SRQ_ABS_PTR(owner_offset);
@@ -517,7 +521,7 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 	// See if the lock already exists
 
 	USHORT hash_slot;
-	lbl* lock = find_lock(series, value, length, &hash_slot);
+	lbl* lock = find_lock(series, value, length, hash, &hash_slot);
 	if (lock)
 	{
 		if (series < LCK_MAX_SERIES)
@@ -565,6 +569,7 @@ SRQ_PTR LockManager::enqueue(thread_db* tdbb,
 
 	lock->lbl_flags = 0;
 	lock->lbl_pending_lrq_count = 0;
+	lock->lbl_waits = 0;
 
 	memset(lock->lbl_counts, 0, sizeof(lock->lbl_counts));
 
@@ -974,6 +979,8 @@ LOCK_DATA_T LockManager::readData2(USHORT series,
 	if (!owner_offset)
 		return 0;
 
+	const ULONG hash = InternalHash::hash(length, value);
+
 	LockTableGuard guard(this, FB_FUNCTION, owner_offset);
 
 	++(m_sharedMemory->getHeader()->lhb_read_data);
@@ -984,7 +991,7 @@ LOCK_DATA_T LockManager::readData2(USHORT series,
 		++(m_sharedMemory->getHeader()->lhb_operations[0]);
 
 	USHORT junk;
-	const lbl* const lock = find_lock(series, value, length, &junk);
+	const lbl* const lock = find_lock(series, value, length, hash, &junk);
 
 	return lock ? lock->lbl_data : 0;
 }
@@ -1152,6 +1159,10 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 	if (prior_active > 0)
 	{
 		post_history(his_active, owner_offset, prior_active, (SRQ_PTR) 0, false);
+
+		// The dead process might leave deadlock scan bits set
+		deadlock_clear();
+
 		shb* const recover = (shb*) SRQ_ABS_PTR(m_sharedMemory->getHeader()->lhb_secondary);
 		if (recover->shb_remove_node)
 		{
@@ -1783,8 +1794,9 @@ void LockManager::deadlock_clear()
  **************************************
  *
  * Functional description
- *	Clear deadlock and scanned bits for pending requests
- *	in preparation for a deadlock scan.
+ *	Clear deadlock and scanned bits for all pending requests.
+ *	Normally every scan clears the bits it has set itself, this
+ *	is needed only when a process died in the middle of a scan.
  *
  **************************************/
 	ASSERT_ACQUIRED;
@@ -1825,15 +1837,26 @@ lrq* LockManager::deadlock_scan(own* owner, lrq* request)
 	ASSERT_ACQUIRED;
 	++(m_sharedMemory->getHeader()->lhb_scans);
 	post_history(his_scan, request->lrq_owner, request->lrq_lock, SRQ_REL_PTR(request), true);
-	deadlock_clear();
 
 #ifdef VALIDATE_LOCK_TABLE
 	validate_lhb(m_sharedMemory->getHeader());
 #endif
 
+	// Walk only the part of the wait-for graph reachable from the given request
+	// and then clear the bits set on the visited requests. This way the cost of
+	// the scan does not depend on the total number of owners.
+
 	bool maybe_deadlock = false;
 	lrq* victim = deadlock_walk(request, &maybe_deadlock);
 
+	for (const auto offset : m_walkedRequests)
+	{
+		lrq* const walked = (lrq*) SRQ_ABS_PTR(offset);
+		walked->lrq_flags &= ~(LRQ_deadlock | LRQ_scanned);
+	}
+
+	m_walkedRequests.clear();
+
 	// Only when it is certain that this request is not part of a deadlock do we
 	// mark this request as 'scanned' so that we will not check this request again.
 	// Note that this request might be part of multiple deadlocks.
@@ -1885,6 +1908,7 @@ lrq* LockManager::deadlock_walk(lrq* request, bool* maybe_deadlock)
 	// Remember that this request is part of the wait-for graph
 
 	request->lrq_flags |= LRQ_deadlock;
+	m_walkedRequests.add(SRQ_REL_PTR(request));
 
 	// Check if this is a conversion request
 
@@ -2036,6 +2060,7 @@ void LockManager::debug_delay(ULONG lineno)
 lbl* LockManager::find_lock(USHORT series,
 							const UCHAR* value,
 							USHORT length,
+							ULONG hash,
 							USHORT* slot)
 {
 /**************************************
@@ -2048,14 +2073,15 @@ lbl* LockManager::find_lock(USHORT series,
  *	Find a lock block given a resource
  *	name. If it doesn't exist, the hash
  *	slot will be useful for enqueing a
- *	lock.
+ *	lock. The key hash is computed by the
+ *	caller outside the lock table mutex.
  *
  **************************************/
 
 	// See if the lock already exists
 
 	const USHORT hash_slot = *slot =
-		(USHORT) InternalHash::hash(length, value, m_sharedMemory->getHeader()->lhb_hash_slots);
+		(USHORT) (hash % m_sharedMemory->getHeader()->lhb_hash_slots);
 
 	ASSERT_ACQUIRED;
 	srq* const hash_header = &m_sharedMemory->getHeader()->lhb_hash[hash_slot];
@@ -3734,6 +3760,12 @@ void LockManager::wait_for_request(thread_db* tdbb, lrq* request, SSHORT lck_wai
 	const SRQ_PTR lock_offset = request->lrq_lock;
 	lbl* lock = (lbl*) SRQ_ABS_PTR(lock_offset);
 	lock->lbl_pending_lrq_count++;
+	lock->lbl_waits++;
+
+	if (lock->lbl_series < LCK_MAX_SERIES)
+		++(m_sharedMemory->getHeader()->lhb_series_waits[lock->lbl_series]);
+	else
+		++(m_sharedMemory->getHeader()->lhb_series_waits[0]);
 
 	if (!request->lrq_state)
 	{
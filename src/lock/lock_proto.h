@@ -93,7 +93,7 @@ const UCHAR type_lpr	= 7;
 
 // Version number of the lock table.
 // Must be increased every time the shmem layout is changed.
-const USHORT BASE_LHB_VERSION = 19;
+const USHORT BASE_LHB_VERSION = 20;
 const USHORT PLATFORM_LHB_VERSION = 128;	// 64-bit target
 
 #if SIZEOF_VOID_P == 8
@@ -136,6 +136,7 @@ struct lhb : public Firebird::MemoryHeader
 	FB_UINT64 lhb_query_data;
 	FB_UINT64 lhb_operations[LCK_MAX_SERIES];
 	FB_UINT64 lhb_waits;
+	FB_UINT64 lhb_series_waits[LCK_MAX_SERIES];
 	FB_UINT64 lhb_denies;
 	FB_UINT64 lhb_timeouts;
 	FB_UINT64 lhb_blocks;
@@ -173,6 +174,7 @@ struct lbl
 	UCHAR lbl_series;				// Lock series
 	UCHAR lbl_flags;				// Unused. Misc flags
 	USHORT lbl_pending_lrq_count;	// count of lbl_requests with LRQ_pending
+	ULONG lbl_waits;				// Number of waits for this lock
 	USHORT lbl_counts[LCK_max];		// Counts of granted locks
 	UCHAR lbl_key[1];				// Key value
 };
@@ -427,7 +429,7 @@ private:
 	lrq* deadlock_scan(own*, lrq*);
 	lrq* deadlock_walk(lrq*, bool*);
 	void debug_delay(ULONG);
-	lbl* find_lock(USHORT, const UCHAR*, USHORT, USHORT*);
+	lbl* find_lock(USHORT, const UCHAR*, USHORT, ULONG, USHORT*);
 	lrq* get_request(SRQ_PTR);
 	void grant(lrq*, lbl*);
 	bool grant_or_que(thread_db*, lrq*, lbl*, SSHORT);
@@ -500,6 +502,9 @@ private:
 	const ULONG m_memorySize;
 	const bool m_useBlockingThread;
 
+	// Requests flagged by the current deadlock scan
+	Firebird::HalfStaticArray<SRQ_PTR, 64> m_walkedRequests;
+
 #ifdef USE_SHMEM_EXT
 	struct SecondaryFile : public Jrd::MemoryHeader
 	{
@@ -174,6 +174,7 @@ namespace
 static void prt_lock_activity(OUTFILE, const lhb*, USHORT, ULONG, ULONG);
 static void prt_history(OUTFILE, const lhb*, SRQ_PTR, const SCHAR*);
 static void prt_lock(OUTFILE, const lhb*, const lbl*, USHORT);
+static void prt_top_waits(OUTFILE, const lhb*);
 static void prt_owner(OUTFILE, const lhb*, const own*, bool, bool, bool);
 static void prt_owner_wait_cycle(OUTFILE, const lhb*, const own*, USHORT, waitque*);
 static void prt_request(OUTFILE, const lhb*, const lrq*);
@@ -872,6 +873,13 @@ int CLIB_ROUTINE main( int argc, char *argv[])
 	if (hash_max_count == LAST_MAX_COUNT_INDEX - 1)
 		FPRINTF(outfile, "\t\t>  : %8u\t(%d%%)\n", distribution[LAST_MAX_COUNT_INDEX], distribution[LAST_MAX_COUNT_INDEX] * 100 / LOCK_header->lhb_hash_slots);
 
+	FPRINTF(outfile, "\tWaits by series:");
+	for (int series = 1; series < LCK_MAX_SERIES; series++)
+		FPRINTF(outfile, " %d: %" UQUADFORMAT, series, LOCK_header->lhb_series_waits[series]);
+	FPRINTF(outfile, ", other: %" UQUADFORMAT"\n", LOCK_header->lhb_series_waits[0]);
+
+	prt_top_waits(outfile, LOCK_header);
+
 	const shb* a_shb = (shb*) SRQ_ABS_PTR(LOCK_header->lhb_secondary);
 	FPRINTF(outfile,
 			"\tRemove node: %6" SLONGFORMAT", Insert queue: %6" SLONGFORMAT
@@ -1340,8 +1348,8 @@ static void prt_lock(OUTFILE outfile, const lhb* LOCK_header, const lbl* lock, U
 		FPRINTF(outfile, "\tKey: %s,", temp);
 	}
 
-	FPRINTF(outfile, " Flags: 0x%02X, Pending request count: %6d\n",
-			lock->lbl_flags, lock->lbl_pending_lrq_count);
+	FPRINTF(outfile, " Flags: 0x%02X, Pending request count: %6d, Waits: %6" ULONGFORMAT"\n",
+			lock->lbl_flags, lock->lbl_pending_lrq_count, lock->lbl_waits);
 
 	prt_que(outfile, LOCK_header, "\tHash que", &lock->lbl_lhb_hash, offsetof(lbl, lbl_lhb_hash));
 
@@ -1589,6 +1597,59 @@ static void prt_request(OUTFILE outfile, const lhb* LOCK_header, const lrq* requ
 }
 
 
+static void prt_top_waits(OUTFILE outfile, const lhb* LOCK_header)
+{
+/**************************************
+ *
+ *      p r t _ t o p _ w a i t s
+ *
+ **************************************
+ *
+ * Functional description
+ *      Print the locks waited for most often.
+ *
+ **************************************/
+	const unsigned TOP_WAITS = 10;
+
+	const lbl* top[TOP_WAITS] = {};
+	unsigned count = 0;
+
+	USHORT i = 0;
+	for (const srq* slot = LOCK_header->lhb_hash; i < LOCK_header->lhb_hash_slots; slot++, i++)
+	{
+		for (const srq* que_inst = (SRQ) SRQ_ABS_PTR(slot->srq_forward); que_inst != slot;
+			 que_inst = (SRQ) SRQ_ABS_PTR(que_inst->srq_forward))
+		{
+			const lbl* lock = (lbl*) ((UCHAR*) que_inst - offsetof(lbl, lbl_lhb_hash));
+
+			if (!lock->lbl_waits || (count == TOP_WAITS && lock->lbl_waits <= top[count - 1]->lbl_waits))
+				continue;
+
+			// Keep the list ordered by waits, the smallest one falls off the end
+
+			unsigned pos = (count < TOP_WAITS) ? count++ : count - 1;
+
+			for (; pos > 0 && top[pos - 1]->lbl_waits < lock->lbl_waits; pos--)
+				top[pos] = top[pos - 1];
+
+			top[pos] = lock;
+		}
+	}
+
+	if (!count)
+		return;
+
+	FPRINTF(outfile, "\tMost waited locks:\n");
+
+	for (unsigned n = 0; n < count; n++)
+	{
+		FPRINTF(outfile, "\t\t%s, Series: %d, Waits: %6" ULONGFORMAT", Pending: %6d\n",
+				(const TEXT*) HtmlLink(preLock, SRQ_REL_PTR(top[n])), top[n]->lbl_series,
+				top[n]->lbl_waits, top[n]->lbl_pending_lrq_count);
+	}
+}
+
+
 static void prt_que(OUTFILE outfile,
 					const lhb* LOCK_header,
 					const SCHAR* string, const srq* que_inst, USHORT que_offset,
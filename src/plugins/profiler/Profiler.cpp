@@ -200,12 +200,34 @@ public:
 	void afterRecordSourceGetRecord(SINT64 requestId, unsigned cursorId, unsigned recSourceId,
 		IProfilerStats* stats) override;
 
+	// Events come in long runs for the same request, look it up only when it changes
+	Request* getRequest(SINT64 requestId)
+	{
+		if (requestId != lastRequestId || !lastRequest)
+		{
+			lastRequest = requests.get(requestId);
+			lastRequestId = requestId;
+		}
+
+		return lastRequest;
+	}
+
+	void removeRequest(SINT64 requestId)
+	{
+		if (requestId == lastRequestId)
+			lastRequest = nullptr;
+
+		requests.remove(requestId);
+	}
+
 public:
 	RefPtr<ProfilerPlugin> plugin;
 	NonPooledMap<SINT64, Statement> statements{defaultPool()};
 	NonPooledMap<StatementCursorKey, Cursor> cursors{defaultPool()};
 	NonPooledMap<StatementCursorRecSourceKey, RecordSource> recordSources{defaultPool()};
 	NonPooledMap<SINT64, Request> requests{defaultPool()};
+	Request* lastRequest = nullptr;
+	SINT64 lastRequestId = 0;
 	SINT64 id;
 	bool dirty = true;
 	ISC_TIMESTAMP_TZ startTimestamp;
@@ -901,7 +923,7 @@ void ProfilerPlugin::flush(ThrowStatusExceptionWrapper* status)
 			session->cursors.clear();
 
 			for (const auto requestId : finishedRequests)
-				session->requests.remove(requestId);
+				session->removeRequest(requestId);
 
 			++sessionIdx;
 		}
@@ -1448,7 +1470,7 @@ void Session::onRequestStart(ThrowStatusExceptionWrapper* status, SINT64 request
 void Session::onRequestFinish(ThrowStatusExceptionWrapper* status, SINT64 requestId,
 	ISC_TIMESTAMP_TZ timestamp, IProfilerStats* stats)
 {
-	if (auto request = requests.get(requestId))
+	if (auto request = getRequest(requestId))
 	{
 		request->dirty = true;
 		request->finishTimestamp = timestamp;
@@ -1458,7 +1480,7 @@ void Session::onRequestFinish(ThrowStatusExceptionWrapper* status, SINT64 reques
 
 void Session::afterPsqlLineColumn(SINT64 requestId, unsigned line, unsigned column, IProfilerStats* stats)
 {
-	if (auto request = requests.get(requestId))
+	if (auto request = getRequest(requestId))
 	{
 		const auto profileStats = request->psqlStats.getOrPut({line, column});
 		profileStats->hit(stats->getElapsedTime());
@@ -1467,7 +1489,7 @@ void Session::afterPsqlLineColumn(SINT64 requestId, unsigned line, unsigned colu
 
 void Session::afterRecordSourceOpen(SINT64 requestId, unsigned cursorId, unsigned recSourceId, IProfilerStats* stats)
 {
-	if (auto request = requests.get(requestId))
+	if (auto request = getRequest(requestId))
 	{
 		auto profileStats = request->recordSourcesStats.getOrPut({cursorId, recSourceId});
 		profileStats->openStats.hit(stats->getElapsedTime());
@@ -1476,7 +1498,7 @@ void Session::afterRecordSourceOpen(SINT64 requestId, unsigned cursorId, unsigne
 
 void Session::afterRecordSourceGetRecord(SINT64 requestId, unsigned cursorId, unsigned recSourceId, IProfilerStats* stats)
 {
-	if (auto request = requests.get(requestId))
+	if (auto request = getRequest(requestId))
 	{
 		auto profileStats = request->recordSourcesStats.getOrPut({cursorId, recSourceId});
 		profileStats->fetchStats.hit(stats->getElapsedTime());
@@ -577,6 +577,7 @@ private:
 	int blobAlign;
 	UCHAR blobPolicy;
 	bool segmented, defSegmented, batchActive;
+	bool syncPending;	// op_batch_sync was sent, its response is not received yet
 
 	ULONG messageCount, blobCount, serverSize, blobHeadSize;
 
@@ -1108,8 +1109,10 @@ static void move_error(const Arg::StatusVector& v);
 static void receive_after_start(Rrq*, USHORT);
 static void receive_packet(rem_port*, PACKET *);
 static void receive_packet_noqueue(rem_port*, PACKET *);
+static void receive_deferred_packets(rem_port*, FB_SIZE_T);
 static void receive_queued_packet(rem_port*, USHORT);
 static void receive_response(IStatus*, Rdb*, PACKET *);
+static void receive_segments(IStatus*, Rdb*, Rbl*);
 static void release_blob(Rbl*);
 static void release_event(Rvnt*);
 static void release_object(IStatus*, Rdb*, P_OP, USHORT);
@@ -2467,7 +2470,7 @@ Batch::Batch(Statement* s, IMessageMetadata* inFmt, unsigned parLength, const un
 	: messageStream(0), blobStream(nullptr), sizePointer(nullptr),
 	  messageSize(0), alignedSize(0), blobBufferSize(0), messageBufferSize(0), flags(0),
 	  stmt(s), format(inFmt), blobAlign(0), blobPolicy(BLOB_NONE),
-	  segmented(false), defSegmented(false), batchActive(false),
+	  segmented(false), defSegmented(false), batchActive(false), syncPending(false),
 	  messageCount(0), blobCount(0), serverSize(0), blobHeadSize(0),
 	  tmpStatement(false)
 {
@@ -2745,11 +2748,43 @@ void Batch::sendDeferredPacket(IStatus* status, rem_port* port, PACKET* packet,
 			((port->port_deferred_packets->getCount() >= DEFER_BATCH_LIMIT) || flash))
 		{
 			packet->p_operation = op_batch_sync;
-			send_packet(port, packet);
-			receive_packet(port, packet);
 
-			LocalStatus warning;
-			port->checkResponse(&warning, packet, false);
+			if (flash)
+			{
+				send_packet(port, packet);
+				receive_packet(port, packet);
+				syncPending = false;
+
+				LocalStatus warning;
+				port->checkResponse(&warning, packet, false);
+			}
+			else
+			{
+				// Don't wait for the server to handle the packets just sent. Receive
+				// responses only up to the previous sync point, so the server works
+				// on one part of the batch while the application adds the next one.
+
+				const bool waitPrevious = syncPending;
+
+				send_packet(port, packet);
+				defer_packet(port, packet, true);
+				syncPending = true;
+
+				if (waitPrevious)
+				{
+					FB_SIZE_T count = 0;
+					for (const rem_que_packet* p = port->port_deferred_packets->begin();
+						 p < port->port_deferred_packets->end(); ++p)
+					{
+						++count;
+						if (p->packet.p_operation == op_batch_sync)
+							break;
+					}
+
+					receive_deferred_packets(port, count);
+				}
+			}
+
 			Rsr* statement = stmt->getStatement();
 			if (statement->haveException())
 			{
@@ -4574,6 +4609,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 
 		statement->rsr_flags.clear(Rsr::STREAM_END | Rsr::PAST_END | Rsr::STREAM_ERR);
 		statement->rsr_rows_pending = 0;
+		statement->rsr_fetch_batch = 0;
 		statement->rsr_fetch_operation = operation;
 		statement->rsr_fetch_position = position;
 		statement->clearException();
@@ -4801,8 +4837,19 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		{
 			if (operation == fetch_next || operation == fetch_prior)
 			{
-				sqldata->p_sqldata_messages = REMOTE_compute_batch_size(
+				const USHORT max_batch = REMOTE_compute_batch_size(
 					port, 0, op_fetch_response, statement->rsr_select_format);
+
+				// Start with a small batch and double it with every next one.
+				// This way a point query doesn't make the server fetch all the
+				// rows it would fit into a batch, while a streaming consumer
+				// reaches the full batch size after a few round trips.
+
+				const ULONG next_batch = statement->rsr_fetch_batch ?
+					statement->rsr_fetch_batch * 2 : MIN_ROWS_PER_BATCH;
+
+				statement->rsr_fetch_batch = (USHORT) MIN(next_batch, max_batch);
+				sqldata->p_sqldata_messages = statement->rsr_fetch_batch;
 			}
 
 			// Reorder data when the local buffer is half empty
@@ -5437,25 +5484,21 @@ int Blob::getSegment(CheckStatusWrapper* status, unsigned int bufferLength, void
 				blob->rbl_buffer_length = (USHORT) new_size;
 			}
 
-			// We need more data.  Ask for it politely
+			// We need more data.  Use the buffer received in advance or ask for it politely
 
-			packet->p_operation = op_get_segment;
-			segment->p_sgmt_length = blob->rbl_buffer_length;
-			segment->p_sgmt_blob = blob->rbl_id;
-			segment->p_sgmt_segment.cstr_length = 0;
-			send_packet(rdb->rdb_port, packet);
-
-			response->p_resp_data.cstr_allocated = blob->rbl_buffer_length;
-			response->p_resp_data.cstr_address = blob->rbl_buffer;
+			if (blob->rbl_ahead_next >= blob->rbl_ahead.getCount())
+				receive_segments(status, rdb, blob);
 
-			receive_response(status, rdb, packet);
+			const Rbl::ReadAhead& ahead = blob->rbl_ahead[blob->rbl_ahead_next++];
+			fb_assert(ahead.length <= blob->rbl_buffer_length);
+			memcpy(blob->rbl_buffer, blob->rbl_ahead_data.begin() + ahead.offset, ahead.length);
 
-			blob->rbl_length = (USHORT) response->p_resp_data.cstr_length;
+			blob->rbl_length = ahead.length;
 			blob->rbl_ptr = blob->rbl_buffer;
 			blob->rbl_flags &= ~Rbl::SEGMENT;
-			if (response->p_resp_object == 1)
+			if (ahead.state == 1)
 				blob->rbl_flags |= Rbl::SEGMENT;
-			else if (response->p_resp_object == 2)
+			else if (ahead.state == 2)
 				blob->rbl_flags |= Rbl::EOF_PENDING;
 		}
 
@@ -6443,6 +6486,7 @@ int Blob::seek(CheckStatusWrapper* status, int mode, int offset)
 		blob->rbl_length = 0;
 		blob->rbl_fragment_length = 0;
 		blob->rbl_flags &= ~(Rbl::EOF_SET | Rbl::EOF_PENDING | Rbl::SEGMENT);
+		blob->resetReadAhead();
 
 		return blob->rbl_offset;
 	}
@@ -8710,9 +8754,30 @@ static void receive_packet_noqueue(rem_port* port, PACKET* packet)
 
 	// Receive responses for all deferred packets that were already sent
 
+	if (port->port_deferred_packets)
+		receive_deferred_packets(port, port->port_deferred_packets->getCount());
+
+	receive_packet_with_callback(port, packet);
+}
+
+
+static void receive_deferred_packets(rem_port* port, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	r e c e i v e _ d e f e r r e d _ p a c k e t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Receive responses for up to count deferred
+ *	packets that were already sent.
+ *
+ **************************************/
+
 	if (port->port_deferred_packets)
 	{
-		while (port->port_deferred_packets->getCount())
+		while (count-- && port->port_deferred_packets->getCount())
 		{
 			rem_que_packet* const p = port->port_deferred_packets->begin();
 			if (!p->sent)
@@ -8785,8 +8850,6 @@ static void receive_packet_noqueue(rem_port* port, PACKET* packet)
 			port->port_deferred_packets->remove(p);
 		}
 	}
-
-	receive_packet_with_callback(port, packet);
 }
 
 
@@ -8898,6 +8961,91 @@ static void receive_response(IStatus* status, Rdb* rdb, PACKET* packet)
 }
 
 
+static void receive_segments(IStatus* status, Rdb* rdb, Rbl* blob)
+{
+/**************************************
+ *
+ *	r e c e i v e _ s e g m e n t s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Ask for the next buffers of blob segments.
+ *	While the blob is read sequentially and has
+ *	no end, ask for more buffers at once, up to
+ *	BLOB_READ_AHEAD, to not wait for a round trip
+ *	for every one of them.
+ *
+ **************************************/
+	PACKET* packet = &rdb->rdb_packet;
+	P_SGMT* segment = &packet->p_sgmt;
+	P_RESP* response = &packet->p_resp;
+
+	const USHORT count = blob->rbl_ahead_requests;
+	const USHORT length = blob->rbl_buffer_length;
+
+	for (USHORT i = 0; i < count; i++)
+	{
+		packet->p_operation = op_get_segment;
+		segment->p_sgmt_length = length;
+		segment->p_sgmt_blob = blob->rbl_id;
+		segment->p_sgmt_segment.cstr_length = 0;
+
+		if (i < count - 1)
+			send_partial_packet(rdb->rdb_port, packet);
+		else
+			send_packet(rdb->rdb_port, packet);
+	}
+
+	blob->rbl_ahead.clear();
+	blob->rbl_ahead_next = 0;
+	UCHAR* const data = blob->rbl_ahead_data.getBuffer((ULONG) count * length);
+
+	// Receive all the responses, even past the end of blob or an error
+
+	Arg::StatusVector error;
+	bool eof = false;
+
+	for (USHORT i = 0; i < count; i++)
+	{
+		const ULONG offset = (ULONG) i * length;
+		response->p_resp_data.cstr_allocated = length;
+		response->p_resp_data.cstr_address = data + offset;
+
+		try
+		{
+			receive_response(status, rdb, packet);
+		}
+		catch (const Exception& ex)
+		{
+			if (!error.hasData())
+				error.assign(ex);
+			continue;
+		}
+
+		if (eof || error.hasData())
+			continue;
+
+		Rbl::ReadAhead& ahead = blob->rbl_ahead.add();
+		ahead.offset = offset;
+		ahead.length = (USHORT) response->p_resp_data.cstr_length;
+		ahead.state = (USHORT) response->p_resp_object;
+
+		if (ahead.state == 2)
+			eof = true;
+	}
+
+	if (error.hasData())
+	{
+		blob->resetReadAhead();
+		error.raise();
+	}
+
+	if (!eof && blob->rbl_ahead_requests < BLOB_READ_AHEAD)
+		blob->rbl_ahead_requests *= 2;
+}
+
+
 static void release_blob( Rbl* blob)
 {
 /**************************************
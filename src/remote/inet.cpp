@@ -95,6 +95,11 @@
 #include <sys/select.h>
 #endif
 
+#if defined(LINUX) && defined(HAVE_POLL)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #endif // !WIN_NT
 
 const int INET_RETRY_CALL = 5;
@@ -231,6 +236,7 @@ const ULONG DEF_MAX_DATA	= 8192;
 //const int MAXHOSTLEN		= 64;
 
 const int SELECT_TIMEOUT	= 60;		// Dispatch thread select timeout (sec)
+const int ACCEPT_BATCH		= 64;		// Max connections accepted per listener wakeup
 
 class Select
 {
@@ -249,16 +255,124 @@ private:
 	}
 #endif
 
+#ifdef USE_EPOLL
+	static const int SEL_EPOLL_EVENTS = 256;	// events fetched per epoll_wait() call
+
+	bool arm(SOCKET handle)
+	{
+		epoll_event ev;
+		ev.events = EPOLLIN | EPOLLONESHOT;
+		ev.data.fd = handle;
+
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_MOD, handle, &ev) == 0)
+			return true;
+
+		return errno == ENOENT && epoll_ctl(slct_epoll, EPOLL_CTL_ADD, handle, &ev) == 0;
+	}
+
+	void epollSet(SOCKET handle)
+	{
+		FB_SIZE_T pos;
+		if (!slct_registered.find(handle, pos))
+		{
+			EpollEntry entry;
+			entry.fd = handle;
+			entry.round = 0;
+			entry.armed = false;
+			slct_registered.insert(pos, entry);
+		}
+
+		EpollEntry& entry = slct_registered[pos];
+		entry.round = slct_round;
+		++slct_wanted;
+
+		// One-shot registration is re-armed only after it fired
+		if (!entry.armed)
+		{
+			if (arm(handle))
+				entry.armed = true;
+			else
+				slct_broken = true;
+		}
+	}
+
+	void epollSelect(timeval* timeout)
+	{
+		slct_poll.clear();
+		slct_ready.clear();
+
+		if (!slct_wanted || slct_broken)
+		{
+			errno = NOTASOCKET;
+			slct_count = -1;
+			return;
+		}
+
+		epoll_event events[SEL_EPOLL_EVENTS];
+		const int milliseconds = timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+		const int n = epoll_wait(slct_epoll, events, SEL_EPOLL_EVENTS, milliseconds);
+
+		if (n < 0)
+		{
+			slct_count = -1;
+			return;
+		}
+
+		for (int i = 0; i < n; i++)
+		{
+			FB_SIZE_T pos;
+			if (!slct_registered.find(events[i].data.fd, pos))
+				continue;
+
+			EpollEntry& entry = slct_registered[pos];
+			entry.armed = false;
+
+			// Descriptor was registered in one of the previous rounds
+			// but nobody waits for it now
+			if (entry.round != slct_round)
+				continue;
+
+			// Report errors and hangups as readiness, receive() will handle them
+			pollfd f;
+			f.fd = entry.fd;
+			f.events = f.revents = POLLIN;
+			slct_poll.add(f);
+		}
+
+		pollfd* const end = slct_poll.end();
+		for (pollfd* pf = slct_poll.begin(); pf < end; ++pf)
+			slct_ready.add(pf);
+
+		slct_count = slct_poll.getCount();
+	}
+#endif
+
 public:
 #ifdef HAVE_POLL
 	Select()
 		: slct_time(0), slct_count(0), slct_poll(*getDefaultMemoryPool()),
 		  slct_ready(*getDefaultMemoryPool())
+#ifdef USE_EPOLL
+		  , slct_registered(*getDefaultMemoryPool()),
+		  slct_epoll(-1), slct_round(0), slct_wanted(0), slct_broken(false)
+#endif
 	{ }
 
 	explicit Select(Firebird::MemoryPool& pool)
 		: slct_time(0), slct_count(0), slct_poll(pool), slct_ready(pool)
+#ifdef USE_EPOLL
+		  , slct_registered(pool),
+		  slct_epoll(-1), slct_round(0), slct_wanted(0), slct_broken(false)
+#endif
 	{ }
+
+#ifdef USE_EPOLL
+	~Select()
+	{
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+#endif
 #else
 	Select()
 		: slct_time(0), slct_count(0), slct_width(0)
@@ -275,6 +389,27 @@ public:
 
 	enum HandleState {SEL_BAD, SEL_DISCONNECTED, SEL_NO_DATA, SEL_READY};
 
+	// Keep descriptors registered in the kernel between select() calls, if
+	// the platform allows it. The cost of a wakeup is then proportional to
+	// the number of ready descriptors rather than to the number of ports.
+	// Callers must forget() a descriptor before closing it.
+	void setPersistent()
+	{
+#ifdef USE_EPOLL
+		if (slct_epoll < 0)
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+#endif
+	}
+
+	void forget(SOCKET handle)
+	{
+#ifdef USE_EPOLL
+		FB_SIZE_T pos;
+		if (slct_epoll >= 0 && slct_registered.find(handle, pos))
+			slct_registered.remove(pos);
+#endif
+	}
+
 	// set first port to check for readyness
 	void checkStart(RemPortPtr& port)
 	{
@@ -391,6 +526,13 @@ public:
 
 	void set(SOCKET handle)
 	{
+#ifdef USE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			epollSet(handle);
+			return;
+		}
+#endif
 #ifdef HAVE_POLL
 		FB_SIZE_T pos;
 		if (slct_poll.find(handle, pos))
@@ -419,6 +561,11 @@ public:
 		slct_count = 0;
 #if defined(HAVE_POLL)
 		slct_poll.clear();
+#ifdef USE_EPOLL
+		++slct_round;
+		slct_wanted = 0;
+		slct_broken = false;
+#endif
 #else
 		slct_width = 0;
 		FD_ZERO(&slct_fdset);
@@ -432,6 +579,13 @@ public:
 
 	void select(timeval* timeout)
 	{
+#ifdef USE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			epollSelect(timeout);
+			return;
+		}
+#endif
 #ifdef HAVE_POLL
 		slct_ready.clear();
 		bool hasRequest = false;
@@ -490,6 +644,26 @@ private:
 
 	SortedArray<pollfd, InlineStorage<pollfd, 8>, int, PollToFD>  slct_poll;
 	SortedArray<pollfd*, InlineStorage<pollfd*, 8>, int, PollToFD>  slct_ready;
+#ifdef USE_EPOLL
+	struct EpollEntry
+	{
+		SOCKET fd;
+		ULONG round;	// last round the descriptor was waited for
+		bool armed;		// registration not fired yet
+	};
+
+	class EpollToFD
+	{
+	public:
+		static int generate(const EpollEntry& e) { return e.fd; };
+	};
+
+	SortedArray<EpollEntry, EmptyStorage<EpollEntry>, int, EpollToFD> slct_registered;
+	int		slct_epoll;		// epoll descriptor or -1 when poll() is used
+	ULONG	slct_round;		// incremented by each clear()
+	int		slct_wanted;	// descriptors set in the current round
+	bool	slct_broken;	// failed to register some descriptor
+#endif
 #else
 	int		slct_width;
 	fd_set	slct_fdset;
@@ -565,6 +739,7 @@ static bool		packet_send(rem_port*, const SCHAR*, SSHORT);
 static rem_port*		receive(rem_port*, PACKET *);
 static rem_port*		select_accept(rem_port*);
 
+static bool		select_accept_pending(const rem_port*);
 static void		select_port(rem_port*, Select*, RemPortPtr&);
 static bool		select_multi(rem_port*, UCHAR* buffer, SSHORT bufsize, SSHORT* length, RemPortPtr&);
 static bool		select_wait(rem_port*, Select*);
@@ -728,6 +903,10 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		{
 			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress;
 		}
+
+		// Server of the same architecture may skip XDR translation of messages
+		if (cnct->p_cnct_versions[i].p_cnct_version >= PROTOCOL_VERSION13)
+			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_symmetric;
 	}
 
 	rem_port* port = inet_try_connect(packet, rdb, file_name, node_name, dpb, config, ref_db_name, af);
@@ -2096,6 +2275,7 @@ static bool select_multi(rem_port* main_port, UCHAR* buffer, SSHORT bufsize, SSH
 					main_port->port_state = rem_port::BROKEN;
 
 					shutdown(main_port->port_handle, 2);
+					INET_select->forget(main_port->port_handle);
 					SOCLOSE(main_port->port_handle);
 				}
 			}
@@ -2111,6 +2291,17 @@ static bool select_multi(rem_port* main_port, UCHAR* buffer, SSHORT bufsize, SSH
 #endif
 				return (*length) ? true : false;
 			}
+			else
+			{
+				// Drain the listen backlog while we are here, a reconnection
+				// storm should not cost a separate select round per client
+
+				for (int n = 1; n < ACCEPT_BATCH && !INET_shutting_down &&
+					select_accept_pending(main_port); n++)
+				{
+					select_accept(main_port);
+				}
+			}
 
 			continue;
 		}
@@ -2182,6 +2373,31 @@ static rem_port* select_accept( rem_port* main_port)
 	return 0;
 }
 
+static bool select_accept_pending(const rem_port* main_port)
+{
+/**************************************
+ *
+ *	s e l e c t _ a c c e p t _ p e n d i n g
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check without waiting whether one more
+ *	connection request can be accepted.
+ *
+ **************************************/
+
+	Select slct;
+	slct.set(main_port->port_handle);
+
+	timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = 0;
+
+	slct.select(&timeout);
+	return slct.getCount() > 0;
+}
+
 static void select_port(rem_port* main_port, Select* selct, RemPortPtr& port)
 {
 /**************************************
@@ -2249,6 +2465,8 @@ static bool select_wait( rem_port* main_port, Select* selct)
 	struct timeval timeout;
 	bool checkPorts = false;
 
+	selct->setPersistent();
+
 	for (;;)
 	{
 		selct->clear();
@@ -2275,6 +2493,7 @@ static bool select_wait( rem_port* main_port, Select* selct)
 			while (ports_to_close->hasData())
 			{
 				SOCKET s = ports_to_close->pop();
+				selct->forget(s);
 				SOCLOSE(s);
 			}
 
@@ -40,6 +40,7 @@ namespace Firebird {
 
 // dimitr: ask for asymmetric protocols only.
 // Comment it out to return back to FB 1.0 behaviour.
+// Symmetric connection may be requested with pflag_symmetric instead.
 #define ASYMMETRIC_PROTOCOLS_ONLY
 
 // The protocol is defined blocks, rather than messages, to
@@ -137,6 +138,7 @@ const USHORT ptype_MASK			= 0xFF;	// Mask - up to 255 types of protocol
 //
 // upper byte is used for protocol flags
 const USHORT pflag_compress		= 0x100;	// Turn on compression if possible
+const USHORT pflag_symmetric	= 0x200;	// Send messages in native format if architectures match
 
 // Generic object id
 
@@ -563,6 +563,7 @@ void REMOTE_reset_statement( Rsr* statement)
 	statement->rsr_msgs_waiting = 0;
 	statement->rsr_reorder_level = 0;
 	statement->rsr_batch_count = 0;
+	statement->rsr_fetch_batch = 0;
 
 	// only one entry
 
@@ -1578,7 +1579,8 @@ void rem_port::initCompression()
 		port_send_stream.zalloc = Firebird::ZLib::allocFunc;
 		port_send_stream.zfree = Firebird::ZLib::freeFunc;
 		port_send_stream.opaque = Z_NULL;
-		int ret = zlib().deflateInit(&port_send_stream, Z_DEFAULT_COMPRESSION);
+		const int level = getPortConfig()->getWireCompressionLevel();
+		int ret = zlib().deflateInit(&port_send_stream, level);
 		if (ret != Z_OK)
 			(Firebird::Arg::Gds(isc_deflate_init) << Firebird::Arg::Num(ret)).raise();
 		port_send_stream.next_out = NULL;
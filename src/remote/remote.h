@@ -88,6 +88,7 @@ DEFINE_TRACE_ROUTINE(remote_trace);
 #endif
 
 const int BLOB_LENGTH		= 16384;
+const int BLOB_READ_AHEAD	= 8;		// Max segment buffers requested per round trip
 
 #include "../remote/protocol.h"
 #include "fb_blk.h"
@@ -239,6 +240,19 @@ struct Rbl : public Firebird::GlobalStorage, public TypedHandle<rem_type_rbl>
 	USHORT		rbl_target_interp;	// destination interp (for reading)
 	Rbl**		rbl_self;
 
+	// Segment buffers received in advance (client side)
+	struct ReadAhead
+	{
+		ULONG offset;				// Position in rbl_ahead_data
+		USHORT length;				// Length of the buffer
+		USHORT state;				// Segment or EOF state of the buffer
+	};
+
+	Firebird::Array<UCHAR> rbl_ahead_data;
+	Firebird::Array<ReadAhead> rbl_ahead;
+	FB_SIZE_T	rbl_ahead_next;		// Next buffer to use
+	USHORT		rbl_ahead_requests;	// Buffers to request at next round trip
+
 public:
 	// Values for rbl_flags
 	enum {
@@ -254,9 +268,17 @@ public:
 		rbl_buffer(rbl_data.getBuffer(BLOB_LENGTH)), rbl_ptr(rbl_buffer), rbl_iface(NULL),
 		rbl_offset(0), rbl_id(0), rbl_flags(0),
 		rbl_buffer_length(BLOB_LENGTH), rbl_length(0), rbl_fragment_length(0),
-		rbl_source_interp(0), rbl_target_interp(0), rbl_self(NULL)
+		rbl_source_interp(0), rbl_target_interp(0), rbl_self(NULL),
+		rbl_ahead_data(getPool()), rbl_ahead(getPool()), rbl_ahead_next(0), rbl_ahead_requests(1)
 	{ }
 
+	void resetReadAhead()
+	{
+		rbl_ahead.clear();
+		rbl_ahead_next = 0;
+		rbl_ahead_requests = 1;
+	}
+
 	~Rbl()
 	{
 		if (rbl_self && *rbl_self == this)
@@ -483,6 +505,7 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	USHORT			rsr_msgs_waiting; 	// count of full rsr_messages
 	USHORT			rsr_reorder_level; 	// Trigger pipelining at this level
 	USHORT			rsr_batch_count; 	// Count of batches in pipeline
+	USHORT			rsr_fetch_batch;	// Size of the last requested fetch batch
 
 	Firebird::string rsr_cursor_name;	// Name for cursor to be set on open
 	bool			rsr_delayed_format;	// Out format was delayed on execute, set it on fetch
@@ -551,7 +574,7 @@ public:
 		rsr_format(0), rsr_message(0), rsr_buffer(0), rsr_status(0),
 		rsr_id(0), rsr_fmt_length(0),
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
-		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL),
+		rsr_fetch_batch(0), rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL),
 		rsr_fetch_operation(fetch_next), rsr_fetch_position(0)
 	{ }
 
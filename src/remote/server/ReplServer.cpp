@@ -593,8 +593,11 @@ namespace
 		if (strcmp(header->hdr_signature, CHANGELOG_SIGNATURE))
 			return false;
 
-		if (header->hdr_version != CHANGELOG_CURRENT_VERSION)
+		if (header->hdr_version < CHANGELOG_VERSION_1 ||
+			header->hdr_version > CHANGELOG_CURRENT_VERSION)
+		{
 			return false;
+		}
 
 		if (header->hdr_state != SEGMENT_STATE_FREE &&
 			header->hdr_state != SEGMENT_STATE_USED &&
@@ -1165,6 +1165,7 @@ static bool		accept_connection(rem_port*, P_CNCT*, PACKET*);
 static ISC_STATUS	allocate_statement(rem_port*, /*P_RLSE*,*/ PACKET*);
 static void		append_request_chain(server_req_t*, server_req_t**);
 static void		append_request_next(server_req_t*, server_req_t**);
+static bool		is_short_request(const server_req_t*);
 static void		attach_database(rem_port*, P_OP, P_ATCH*, PACKET*);
 static void		attach_service(rem_port*, P_ATCH*, PACKET*);
 static bool		continue_authentication(rem_port*, PACKET*, PACKET*);
@@ -1911,6 +1912,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	USHORT version = 0;
 	USHORT type = 0;
 	bool compress = false;
+	bool symmetric = false;
 	bool accepted = false;
 	USHORT weight = 0;
 	const p_cnct::p_cnct_repeat* protocol = connect->p_cnct_versions;
@@ -1931,9 +1933,15 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 			architecture = protocol->p_cnct_architecture;
 			type = MIN(protocol->p_cnct_max_type & ptype_MASK, ptype_lazy_send);
 			compress = protocol->p_cnct_max_type & pflag_compress;
+			symmetric = protocol->p_cnct_max_type & pflag_symmetric;
 		}
 	}
 
+	// Client of the same architecture asked to exchange messages in the native format
+
+	if (accepted && symmetric && connect->p_cnct_client == ARCHITECTURE)
+		architecture = ARCHITECTURE;
+
 	HANDSHAKE_DEBUG(fprintf(stderr, "Srv: accept_connection: protoaccept a=%d (v>=13)=%d %d %d\n",
 					accepted, version >= PROTOCOL_VERSION13, version, PROTOCOL_VERSION13));
 
@@ -2269,19 +2277,59 @@ static void append_request_next(server_req_t* request, server_req_t** que_inst)
  * Functional description
  *	Traverse using req_next ptr and append
  *	a request at the end of a que.
- *	Return count of pending requests.
+ *	A short request is placed after other short
+ *	requests at the head of the que, so it does not
+ *	wait for long requests of other ports.
  *
  **************************************/
 	MutexLockGuard queGuard(request_que_mutex, FB_FUNCTION);
 
-	while (*que_inst)
+	const bool isShort = is_short_request(request);
+
+	while (*que_inst && (!isShort || is_short_request(*que_inst)))
 		que_inst = &(*que_inst)->req_next;
 
+	request->req_next = *que_inst;
 	*que_inst = request;
 	ports_pending++;
 }
 
 
+static bool is_short_request(const server_req_t* request)
+{
+/**************************************
+ *
+ *	i s _ s h o r t _ r e q u e s t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if the request is an operation which
+ *	is known to complete quickly.
+ *
+ **************************************/
+	switch (request->req_receive.p_operation)
+	{
+	case op_commit:
+	case op_commit_retaining:
+	case op_rollback:
+	case op_rollback_retaining:
+	case op_transaction:
+	case op_free_statement:
+	case op_close_blob:
+	case op_cancel_blob:
+	case op_info_database:
+	case op_info_transaction:
+	case op_info_sql:
+	case op_ping:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+
 static void addClumplets(ClumpletWriter* dpb_buffer,
 						 const ParametersSet& par,
 						 const rem_port* port)
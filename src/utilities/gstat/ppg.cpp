@@ -155,6 +155,13 @@ void PPG_print_header(const header_page* header, ULONG page,
 			uSvc->printf(false, "crypt process");
 		}
 
+		if (flags & hdr_extended_storage)
+		{
+			if (flag_count++)
+				uSvc->printf(false, ", ");
+			uSvc->printf(false, "extended storage");
+		}
+
 		if (flags & (hdr_encrypted | hdr_crypt_process))
 		{
 			if (flag_count++)
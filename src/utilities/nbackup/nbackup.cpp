@@ -85,6 +85,13 @@
 // JRD regarding the matter for the moment.
 const FB_SIZE_T SECTOR_ALIGNMENT = PAGE_ALIGNMENT;
 
+// Number of pages collected in memory before they're written to the backup file
+const ULONG BACKUP_WRITE_BATCH = 64;
+
+// With direct IO, written backup data is dropped from the OS cache when it's
+// that many batches behind, to give the system a chance to flush it first
+const ULONG BACKUP_CACHE_LAG = 16;
+
 using namespace Firebird;
 
 namespace
@@ -899,6 +906,10 @@ void NBackup::fixup_database(bool repl_seq, bool set_readonly)
 
 	header->hdr_flags = new_flags;
 
+	// The page checksum, if any, doesn't match the modified header any more.
+	// Zero means no checksum, the engine writes a new one with the header.
+	header->hdr_header.pag_checksum = 0;
+
 	seek_file(dbase, 0);
 	write_file(dbase, header, size);
 
@@ -1366,6 +1377,44 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 			page_buff = reinterpret_cast<Ods::pag*>(FB_ALIGN(buf, SECTOR_ALIGNMENT));
 		} // end scope
 
+		// Pages are copied into this buffer and written to the backup file
+		// in batches to reduce the number of write calls
+		Array<UCHAR> unaligned_write_buffer;
+		UCHAR* const write_buff = FB_ALIGN(unaligned_write_buffer.getBuffer(
+			BACKUP_WRITE_BATCH * header->hdr_page_size + SECTOR_ALIGNMENT), SECTOR_ALIGNMENT);
+		ULONG write_count = 0;
+		FB_UINT64 written = 0, uncached = 0;
+
+		const auto flushWrites = [&]()
+		{
+			if (write_count)
+			{
+				write_file(backup, write_buff, write_count * header->hdr_page_size);
+				written += write_count * header->hdr_page_size;
+				write_count = 0;
+			}
+
+#if !defined(WIN_NT) && defined(POSIX_FADV_DONTNEED)
+			// Don't let the backup file evict the server's working set from the OS cache.
+			// Errors are ignored: the backup may be written to a pipe.
+			const FB_UINT64 lag = (FB_UINT64) BACKUP_CACHE_LAG * BACKUP_WRITE_BATCH * header->hdr_page_size;
+			if (direct_io && written > uncached + lag)
+			{
+				fb_fadvise(backup, uncached, written - lag - uncached, POSIX_FADV_DONTNEED);
+				uncached = written - lag;
+			}
+#endif
+		};
+
+		const auto writePage = [&]()
+		{
+			memcpy(write_buff + write_count * header->hdr_page_size, page_buff, header->hdr_page_size);
+			page_writes++;
+
+			if (++write_count == BACKUP_WRITE_BATCH)
+				flushWrites();
+		};
+
 		ULONG db_size = db_size_pages;
 		seek_file(dbase, 0);
 
@@ -1412,8 +1461,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 
 			memset(page_buff, 0, header->hdr_page_size);
 			memcpy(page_buff, &bh, sizeof(bh));
-			write_file(backup, page_buff, header->hdr_page_size);
-			page_writes++;
+			writePage();
 
 			seek_file(dbase, 0);
 			if (read_file(dbase, page_buff, header->hdr_page_size) != header->hdr_page_size)
@@ -1443,10 +1491,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 			}
 
 			if (!level || page_buff->pag_scn > prev_scn)
-			{
-				write_file(backup, page_buff, header->hdr_page_size);
-				page_writes++;
-			}
+				writePage();
 
 			checkCtrlC(uSvc);
 
@@ -1460,6 +1505,7 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 						 !scns && curPage % pagesPerSCN == scnsSlot);
 
 				ULONG nextSCN = scns ? (scns->scn_sequence + 1) * pagesPerSCN : FIRST_SCN_PAGE;
+				const ULONG prevPage = curPage;
 
 				while (true)
 				{
@@ -1470,7 +1516,10 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 						curPage == nextSCN ||
 						curPage == lastPage)
 					{
-						seek_file(dbase, (SINT64) curPage * header->hdr_page_size);
+						// File position is already right after the previous page
+						// unless some unchanged pages were skipped
+						if (curPage != prevPage + 1)
+							seek_file(dbase, (SINT64) curPage * header->hdr_page_size);
 						break;
 					}
 				}
@@ -1532,6 +1581,8 @@ void NBackup::backup_database(int level, Guid& guid, const PathName& fname)
 				}
 			}
 		}
+		flushWrites();
+
 		close_database();
 		close_backup();
 
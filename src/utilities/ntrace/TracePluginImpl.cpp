@@ -508,6 +508,18 @@ void TracePluginImpl::appendGlobalCounts(const PerformanceInfo* info)
 		record.append(temp);
 	}
 
+	if ((cnt = info->pin_counters[PerformanceInfo::READ_WAIT] / 1000) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d ms read wait", cnt);
+		record.append(temp);
+	}
+
+	if ((cnt = info->pin_counters[PerformanceInfo::LOCK_WAIT] / 1000) != 0)
+	{
+		temp.printf(", %" QUADFORMAT"d ms lock wait", cnt);
+		record.append(temp);
+	}
+
 	record.append(NEWLINE);
 }
 